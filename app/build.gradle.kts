@@ -30,6 +30,10 @@ android {
             )
         }
     }
+    androidResources {
+        // Stored entries can be mmap'ed by the native asset source, png/jpg are already stored by default
+        noCompress += listOf("ktx2")
+    }
     compileOptions {
         sourceCompatibility = JavaVersion.VERSION_11
         targetCompatibility = JavaVersion.VERSION_11
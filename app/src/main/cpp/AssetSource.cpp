@@ -0,0 +1,105 @@
+#include "AssetSource.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Common.h"
+#ifdef __ANDROID__
+#include <android/asset_manager.h>
+#endif
+
+namespace hiveVG
+{
+#define HIVE_LOGTAG hiveVG::TAG_KEYWORD::ASSET_SOURCE_TAG
+    CAssetBuffer::~CAssetBuffer()
+    {
+        if (m_pMapBase != nullptr) munmap(m_pMapBase, m_MapLength);
+    }
+
+    std::unique_ptr<CAssetBuffer> CAssetBuffer::mapFile(int vFileDescriptor, int64_t vOffset, size_t vLength)
+    {
+        if (vLength == 0) return fromBytes({});
+
+        const int64_t PageSize      = sysconf(_SC_PAGESIZE);
+        const int64_t AlignedOffset = vOffset - vOffset % PageSize;
+        const size_t  Lead          = static_cast<size_t>(vOffset - AlignedOffset);
+        void *pMapBase = mmap(nullptr, vLength + Lead, PROT_READ, MAP_PRIVATE, vFileDescriptor, static_cast<off_t>(AlignedOffset));
+        if (pMapBase == MAP_FAILED) return nullptr;
+        // Every decoder walks the file front to back once
+        madvise(pMapBase, vLength + Lead, MADV_SEQUENTIAL);
+
+        std::unique_ptr<CAssetBuffer> pBuffer(new CAssetBuffer());
+        pBuffer->m_pMapBase  = pMapBase;
+        pBuffer->m_MapLength = vLength + Lead;
+        pBuffer->m_pData     = static_cast<const uint8_t *>(pMapBase) + Lead;
+        pBuffer->m_Size      = vLength;
+        return pBuffer;
+    }
+
+    std::unique_ptr<CAssetBuffer> CAssetBuffer::fromBytes(std::vector<uint8_t> &&vBytes)
+    {
+        std::unique_ptr<CAssetBuffer> pBuffer(new CAssetBuffer());
+        pBuffer->m_Bytes = std::move(vBytes);
+        pBuffer->m_pData = pBuffer->m_Bytes.data();
+        pBuffer->m_Size  = pBuffer->m_Bytes.size();
+        return pBuffer;
+    }
+
+#ifdef __ANDROID__
+    std::unique_ptr<CAssetBuffer> CApkAssetSource::open(const std::string &vAssetPath)
+    {
+        AAsset *pAsset = AAssetManager_open(m_pAssetManager, vAssetPath.c_str(), AASSET_MODE_STREAMING);
+        if (pAsset == nullptr)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Failed to open asset %s", vAssetPath.c_str());
+            return nullptr;
+        }
+
+        std::unique_ptr<CAssetBuffer> pBuffer;
+        off64_t Start = 0, Length = 0;
+        // Only succeeds for entries stored uncompressed in the APK
+        int FileDescriptor = AAsset_openFileDescriptor64(pAsset, &Start, &Length);
+        if (FileDescriptor >= 0)
+        {
+            pBuffer = CAssetBuffer::mapFile(FileDescriptor, Start, static_cast<size_t>(Length));
+            close(FileDescriptor);
+        }
+        if (pBuffer == nullptr)
+        {
+            std::vector<uint8_t> Bytes(static_cast<size_t>(AAsset_getLength64(pAsset)));
+            size_t ReadSize = 0;
+            while (ReadSize < Bytes.size())
+            {
+                int Count = AAsset_read(pAsset, Bytes.data() + ReadSize, Bytes.size() - ReadSize);
+                if (Count <= 0) break;
+                ReadSize += static_cast<size_t>(Count);
+            }
+            if (ReadSize == Bytes.size())
+                pBuffer = CAssetBuffer::fromBytes(std::move(Bytes));
+            else
+                LOG_ERROR(HIVE_LOGTAG, "Short read of asset %s (%zu of %zu bytes)", vAssetPath.c_str(), ReadSize, Bytes.size());
+        }
+        AAsset_close(pAsset);
+        return pBuffer;
+    }
+#endif
+
+    std::unique_ptr<CAssetBuffer> CDirectoryAssetSource::open(const std::string &vAssetPath)
+    {
+        const std::string FilePath = m_RootDirectory.empty() ? vAssetPath : m_RootDirectory + "/" + vAssetPath;
+        int FileDescriptor = ::open(FilePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (FileDescriptor < 0)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Failed to open file %s", FilePath.c_str());
+            return nullptr;
+        }
+
+        std::unique_ptr<CAssetBuffer> pBuffer;
+        struct stat FileStat{};
+        if (fstat(FileDescriptor, &FileStat) == 0)
+            pBuffer = CAssetBuffer::mapFile(FileDescriptor, 0, static_cast<size_t>(FileStat.st_size));
+        close(FileDescriptor);
+        if (pBuffer == nullptr) LOG_ERROR(HIVE_LOGTAG, "Failed to map file %s", FilePath.c_str());
+        return pBuffer;
+    }
+}
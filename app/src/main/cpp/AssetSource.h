@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __ANDROID__
+struct AAssetManager;
+#endif
+
+namespace hiveVG
+{
+    /*!
+     * Read only bytes of one asset. They are either a private read only mapping of the file (stored APK entries, loose
+     * files) or a heap copy when the bytes cannot be mapped (deflated APK entries). Decoders read getData() in place.
+     */
+    class CAssetBuffer
+    {
+    public:
+        ~CAssetBuffer();
+
+        CAssetBuffer(const CAssetBuffer &) = delete;
+        CAssetBuffer &operator=(const CAssetBuffer &) = delete;
+
+        [[nodiscard]] const uint8_t *getData() const { return m_pData; }
+        [[nodiscard]] size_t         getSize() const { return m_Size; }
+        [[nodiscard]] bool           isMapped() const { return m_pMapBase != nullptr; }
+
+        // vOffset need not be page aligned, the mapping starts at the page below it.
+        static std::unique_ptr<CAssetBuffer> mapFile(int vFileDescriptor, int64_t vOffset, size_t vLength);
+        static std::unique_ptr<CAssetBuffer> fromBytes(std::vector<uint8_t> &&vBytes);
+
+    private:
+        CAssetBuffer() = default;
+
+        void*                m_pMapBase  = nullptr;
+        size_t               m_MapLength = 0;
+        std::vector<uint8_t> m_Bytes;
+        const uint8_t*       m_pData     = nullptr;
+        size_t               m_Size      = 0;
+    };
+
+    // Where asset paths such as "Textures/farSnow.png" are resolved. open() may be called from any thread.
+    class IAssetSource
+    {
+    public:
+        virtual ~IAssetSource() = default;
+
+        virtual std::unique_ptr<CAssetBuffer> open(const std::string &vAssetPath) = 0;
+        [[nodiscard]] virtual const char*     getName() const = 0;
+    };
+
+#ifdef __ANDROID__
+    // Maps stored APK entries through AAsset_openFileDescriptor64, streams compressed ones into a heap buffer.
+    class CApkAssetSource final : public IAssetSource
+    {
+    public:
+        explicit CApkAssetSource(AAssetManager *vAssetManager) : m_pAssetManager(vAssetManager) {}
+
+        std::unique_ptr<CAssetBuffer> open(const std::string &vAssetPath) override;
+        [[nodiscard]] const char*     getName() const override { return "apk"; }
+
+    private:
+        AAssetManager* m_pAssetManager = nullptr;
+    };
+#endif
+
+    // Maps loose files under a root directory, the host stand-in for the APK so loaders run in Linux benchmarks.
+    class CDirectoryAssetSource final : public IAssetSource
+    {
+    public:
+        explicit CDirectoryAssetSource(std::string vRootDirectory) : m_RootDirectory(std::move(vRootDirectory)) {}
+
+        std::unique_ptr<CAssetBuffer> open(const std::string &vAssetPath) override;
+        [[nodiscard]] const char*     getName() const override { return "directory"; }
+
+    private:
+        std::string m_RootDirectory;
+    };
+}
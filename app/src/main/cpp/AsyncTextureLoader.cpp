@@ -0,0 +1,529 @@
+#include "AsyncTextureLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include "Common.h"
+#include "FrameSequence.h"
+#include "ImageDecoder.h"
+#include "MipChain.h"
+#include "PixelConvert.h"
+#include "SequenceStreamer.h"
+#include "SequenceTexture.h"
+
+namespace hiveVG
+{
+#define HIVE_LOGTAG hiveVG::TAG_KEYWORD::TEXTURE_LOADER_TAG
+    CAsyncTextureLoader::CAsyncTextureLoader(IAssetSource *vAssetSource, size_t vWorkerCount)
+        : m_pAssetSource(vAssetSource), m_WorkerPool(vWorkerCount)
+    {
+        LOG_INFO(HIVE_LOGTAG, "Texture loader started with %zu decode workers reading from the %s asset source", m_WorkerPool.getThreadCount(), m_pAssetSource->getName());
+    }
+
+    CAsyncTextureLoader::~CAsyncTextureLoader()
+    {
+        m_IsShuttingDown = true;
+    }
+
+    std::shared_ptr<CTextureAsset> CAsyncTextureLoader::loadAsync(const std::string &vAssetPath, const STextureLoadOptions &vOptions)
+    {
+        std::shared_ptr<CTextureAsset> pTexture(new CTextureAsset());
+        ++m_PendingCount;
+        m_WorkerPool.submit([this, pTexture, vAssetPath, vOptions]() { __decodeTask(pTexture, vAssetPath, vOptions); });
+        return pTexture;
+    }
+
+    std::shared_ptr<CSequenceTexture> CAsyncTextureLoader::loadSequenceAsync(const std::string &vSequencePath, const STextureLoadOptions &vOptions, int vRows, int vColumns,
+                                                                             int vWindowSize, int vFramesPerSecond)
+    {
+        auto pSequence = std::make_shared<CSequenceTexture>(vRows * vColumns, vWindowSize);
+        m_WorkerPool.submit([this, pSequence, vSequencePath, vOptions, vRows, vColumns, vFramesPerSecond]() {
+            if (m_IsShuttingDown) return;
+            if (isFrameSequencePath(vSequencePath))
+            {
+                if (__streamFrameSequence(pSequence, vSequencePath, vOptions, vRows * vColumns, vFramesPerSecond)) return;
+                __streamAtlasSequence(pSequence, getFrameSequenceFallbackPath(vSequencePath), vOptions, vRows, vColumns, vFramesPerSecond);
+            }
+            else
+                __streamAtlasSequence(pSequence, vSequencePath, vOptions, vRows, vColumns, vFramesPerSecond);
+        });
+        return pSequence;
+    }
+
+    void CAsyncTextureLoader::setDecodeTarget(const SDecodeTarget &vTarget)
+    {
+        std::lock_guard<std::mutex> Lock(m_DecodeTargetMutex);
+        m_DecodeTarget = vTarget;
+    }
+
+    SDecodeTarget CAsyncTextureLoader::getDecodeTarget() const
+    {
+        std::lock_guard<std::mutex> Lock(m_DecodeTargetMutex);
+        return m_DecodeTarget;
+    }
+
+    size_t CAsyncTextureLoader::processCompletedUploads(size_t vMaxUploads)
+    {
+        size_t UploadCount = 0;
+        while (UploadCount < vMaxUploads)
+        {
+            SCompletedDecode Completed;
+            {
+                std::lock_guard<std::mutex> Lock(m_CompletedMutex);
+                if (m_CompletedQueue.empty()) break;
+                Completed = std::move(m_CompletedQueue.front());
+                m_CompletedQueue.pop_front();
+            }
+
+            if (Completed.IsRows)
+            {
+                if (__uploadRows(Completed)) ++UploadCount;
+                continue;
+            }
+
+            if (Completed.IsMappingRequested)
+            {
+                // Not an upload yet: the worker decodes into the mapping and queues the texture again
+                Completed.IsMappingRequested = false;
+                if (!m_pUploadRing->mapImage(Completed.pDecoder->getWidth(), Completed.pDecoder->getHeight(), Completed.Mapped))
+                    LOG_WARN(HIVE_LOGTAG, "Decoding %s on the heap, no upload buffer could be mapped for it", Completed.AssetPath.c_str());
+                m_WorkerPool.submit([this, pCompleted = std::make_shared<SCompletedDecode>(std::move(Completed))]() { __decodeIntoMapping(*pCompleted); });
+                continue;
+            }
+
+            if (Completed.IsCompressed && !CTextureAsset::isCompressedFormatSupported(Completed.Ktx2.pFormat->GLInternalFormat))
+            {
+                // Only the GL thread can ask the driver, so the PNG fallback is decoded in a second pass.
+                auto FallbackPath = getKtx2FallbackPath(Completed.AssetPath);
+                LOG_WARN(HIVE_LOGTAG, "%s uses %s which this device cannot sample, loading %s", Completed.AssetPath.c_str(), Completed.Ktx2.pFormat->pName, FallbackPath.c_str());
+                m_WorkerPool.submit([this, pTexture = Completed.pTexture, FallbackPath, Options = Completed.Options]() { __decodeTask(pTexture, FallbackPath, Options); });
+                continue;
+            }
+
+            if (Completed.IsCached && Completed.pTexture->__uploadCached(Completed.Cached, Completed.Options, m_pUploadRing))
+                LOG_INFO(HIVE_LOGTAG, "Uploaded %s (%dx%d, %zu levels) from the disk cache into TextureID %d", Completed.AssetPath.c_str(), Completed.Cached.getWidth(),
+                         Completed.Cached.getHeight(), Completed.Cached.Levels.size(), Completed.pTexture->getTextureID());
+            else if (Completed.IsCompressed && Completed.pTexture->__uploadKtx2(Completed.pKtx2Buffer->getData(), Completed.Ktx2, Completed.Options))
+                LOG_INFO(HIVE_LOGTAG, "Uploaded %s (%dx%d %s, %zu levels) into TextureID %d", Completed.AssetPath.c_str(), Completed.Ktx2.Width, Completed.Ktx2.Height,
+                         Completed.Ktx2.pFormat->pName, Completed.Ktx2.Levels.size(), Completed.pTexture->getTextureID());
+            else if (Completed.IsMapped && Completed.pTexture->__uploadMapped(Completed.Mapped, Completed.Options, *m_pUploadRing))
+                LOG_INFO(HIVE_LOGTAG, "Uploaded %s (%dx%d) into TextureID %d straight from its decode buffer", Completed.AssetPath.c_str(),
+                         Completed.pTexture->getWidth(), Completed.pTexture->getHeight(), Completed.pTexture->getTextureID());
+            else if (Completed.IsDecoded && Completed.pTexture->__uploadImage(Completed.Image, Completed.MipLevels, Completed.Options, m_pUploadRing))
+                LOG_INFO(HIVE_LOGTAG, "Uploaded %s (%dx%d) into TextureID %d", Completed.AssetPath.c_str(), Completed.Image.Width, Completed.Image.Height, Completed.pTexture->getTextureID());
+            else
+            {
+                if (Completed.Mapped.Buffer != 0) m_pUploadRing->releaseImage(Completed.Mapped);
+                Completed.pTexture->m_state = ETextureState::Failed;
+                LOG_ERROR(HIVE_LOGTAG, "Failed to load texture %s", Completed.AssetPath.c_str());
+            }
+            --m_PendingCount;
+            ++UploadCount;
+        }
+        return UploadCount;
+    }
+
+    bool CAsyncTextureLoader::__uploadRows(SCompletedDecode &vioCompleted)
+    {
+        CTextureAsset &Texture = *vioCompleted.pTexture;
+        // A failed slice is always the last one, so the later slices of a failed texture never arrive
+        bool IsUploaded = vioCompleted.IsDecoded && Texture.getState() != ETextureState::Failed;
+        if (IsUploaded && vioCompleted.FirstRow == 0) IsUploaded = Texture.__allocateRows(vioCompleted.FullWidth, vioCompleted.FullHeight, vioCompleted.LevelCount);
+        if (IsUploaded) IsUploaded = Texture.__uploadRows(vioCompleted.Image, vioCompleted.FirstRow, vioCompleted.MipLevels);
+
+        if (IsUploaded)
+            LOG_INFO(HIVE_LOGTAG, "Uploaded rows %d..%d of %s into TextureID %d", vioCompleted.FirstRow, vioCompleted.FirstRow + vioCompleted.Image.Height,
+                     vioCompleted.AssetPath.c_str(), Texture.getTextureID());
+        else if (Texture.getState() != ETextureState::Failed)
+        {
+            if (Texture.m_textureID != 0) glDeleteTextures(1, &Texture.m_textureID);
+            Texture.m_textureID = 0;
+            Texture.m_state = ETextureState::Failed;
+            LOG_ERROR(HIVE_LOGTAG, "Failed to load texture %s", vioCompleted.AssetPath.c_str());
+        }
+        if (vioCompleted.IsLastRows) --m_PendingCount;
+        return IsUploaded;
+    }
+
+    bool CAsyncTextureLoader::__decodeRowsTask(const std::shared_ptr<CTextureAsset> &vTexture, const std::string &vAssetPath, const STextureLoadOptions &vOptions,
+                                               const std::string &vDiskCacheKey)
+    {
+        auto pBuffer = __openAsset(vAssetPath);
+        if (pBuffer == nullptr) return false;
+        auto pDecoder = createImageRegionDecoder(pBuffer->getData(), pBuffer->getSize(), vOptions.Decoder);
+        if (pDecoder == nullptr) return false;
+        __fitToSurface(*pDecoder, vAssetPath, vOptions, vOptions.AtlasColumns, vOptions.ProgressiveRows);
+
+        const int Width = pDecoder->getWidth(), Height = pDecoder->getHeight();
+        const int FrameRowCount = vOptions.ProgressiveRows;
+        if (Height % FrameRowCount != 0)
+        {
+            LOG_WARN(HIVE_LOGTAG, "%s is %d rows high, which does not split into %d frame rows, decoding it whole", vAssetPath.c_str(), Height, FrameRowCount);
+            return false;
+        }
+        const int FrameHeight = Height / FrameRowCount;
+        // Slices start on multiples of FrameHeight, the mips stay exact as long as 2^level divides it
+        int LevelCount = 1;
+        if (!vOptions.IsScreenAligned && vOptions.MipMode != EMipMode::None)
+        {
+            const int AlignedLevelCount = 1 + __builtin_ctz(static_cast<unsigned>(FrameHeight));
+            LevelCount = std::min(AlignedLevelCount, computeFullMipLevelCount(Width, Height));
+        }
+
+        // The bands of every level are also collected into whole levels for the disk cache, band mips are exact slices of them
+        std::vector<SImageData> CachedLevels(vDiskCacheKey.empty() ? 0 : LevelCount);
+        for (int Level = 0; Level < static_cast<int>(CachedLevels.size()); ++Level)
+        {
+            CachedLevels[Level].Width  = std::max(Width >> Level, 1);
+            CachedLevels[Level].Height = std::max(Height >> Level, 1);
+            CachedLevels[Level].Pixels.resize(CachedLevels[Level].getByteSize());
+        }
+
+        // Growing slices: AImageDecoder rereads the rows above each crop, so the total stays near two full decodes.
+        // Every frame row of a slice is handed over on its own, so one upload never covers more than a frame row.
+        int FirstFrameRow = 0;
+        for (int SliceFrameRows = 1; FirstFrameRow < FrameRowCount && !m_IsShuttingDown; SliceFrameRows *= 2)
+        {
+            const int SliceRowCount = std::min(SliceFrameRows, FrameRowCount - FirstFrameRow);
+            auto StartTime = std::chrono::steady_clock::now();
+            SImageData Slice;
+            const bool IsDecoded = pDecoder->decodeRows(FirstFrameRow * FrameHeight, SliceRowCount * FrameHeight, Slice);
+            if (IsDecoded) premultiplyAlpha(Slice, vOptions.AlphaConversion);
+            LOG_INFO(HIVE_LOGTAG, "Decoded frame rows %d..%d of %s in %.2f ms", FirstFrameRow, FirstFrameRow + SliceRowCount, vAssetPath.c_str(),
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count());
+
+            for (int Band = 0; Band < (IsDecoded ? SliceRowCount : 1); ++Band)
+            {
+                SCompletedDecode Completed;
+                Completed.pTexture   = vTexture;
+                Completed.AssetPath  = vAssetPath;
+                Completed.Options    = vOptions;
+                Completed.IsRows     = true;
+                Completed.IsDecoded  = IsDecoded;
+                Completed.FirstRow   = (FirstFrameRow + Band) * FrameHeight;
+                Completed.FullWidth  = Width;
+                Completed.FullHeight = Height;
+                Completed.LevelCount = LevelCount;
+                Completed.IsLastRows = !IsDecoded || FirstFrameRow + Band + 1 == FrameRowCount;
+                if (IsDecoded)
+                {
+                    Completed.Image.Width  = Width;
+                    Completed.Image.Height = FrameHeight;
+                    const auto BandBegin = Slice.Pixels.begin() + static_cast<ptrdiff_t>(Slice.getRowPitch() * Band * FrameHeight);
+                    Completed.Image.Pixels.assign(BandBegin, BandBegin + static_cast<ptrdiff_t>(Completed.Image.getByteSize()));
+                    Completed.MipLevels = generateSubLevels(Completed.Image, getMipAlphaMode(vOptions), LevelCount);
+                    for (size_t Level = 0; Level < CachedLevels.size() && Level <= Completed.MipLevels.size(); ++Level)
+                    {
+                        const SImageData &BandLevel = Level == 0 ? Completed.Image : Completed.MipLevels[Level - 1];
+                        std::copy_n(BandLevel.Pixels.data(), BandLevel.getByteSize(),
+                                    CachedLevels[Level].Pixels.data() + CachedLevels[Level].getRowPitch() * (Completed.FirstRow >> Level));
+                    }
+                }
+                std::lock_guard<std::mutex> Lock(m_CompletedMutex);
+                m_CompletedQueue.push_back(std::move(Completed));
+            }
+            if (!IsDecoded) return true;
+            FirstFrameRow += SliceRowCount;
+        }
+        if (!CachedLevels.empty() && FirstFrameRow == FrameRowCount)
+        {
+            SImageData Base = std::move(CachedLevels.front());
+            CachedLevels.erase(CachedLevels.begin());
+            m_pDiskCache->store(vDiskCacheKey, Base, CachedLevels);
+        }
+        return true;
+    }
+
+    void CAsyncTextureLoader::__streamAtlasSequence(const std::shared_ptr<CSequenceTexture> &vSequence, const std::string &vAtlasPath, const STextureLoadOptions &vOptions,
+                                                    int vRows, int vColumns, int vFramesPerSecond)
+    {
+        if (m_IsShuttingDown) return;
+        auto StartTime = std::chrono::steady_clock::now();
+        // The cached atlas is already scaled and converted, only the per frame mips are built again
+        const std::string DiskCacheKey = __makeDiskCacheKey(vAtlasPath, vOptions, "sequence " + std::to_string(vRows) + "x" + std::to_string(vColumns));
+        SCachedTexture Cached;
+        bool IsCached = !DiskCacheKey.empty() && m_pDiskCache->load(DiskCacheKey, Cached);
+
+        auto pBuffer  = IsCached ? nullptr : __openAsset(vAtlasPath);
+        auto pDecoder = pBuffer != nullptr ? createImageRegionDecoder(pBuffer->getData(), pBuffer->getSize(), vOptions.Decoder) : nullptr;
+        if (pDecoder != nullptr) __fitToSurface(*pDecoder, vAtlasPath, vOptions, vColumns, vRows);
+        const int AtlasWidth  = IsCached ? Cached.getWidth() : (pDecoder != nullptr ? pDecoder->getWidth() : 0);
+        const int AtlasHeight = IsCached ? Cached.getHeight() : (pDecoder != nullptr ? pDecoder->getHeight() : 0);
+        if (AtlasWidth < vColumns || AtlasHeight < vRows)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Failed to load sequence atlas %s", vAtlasPath.c_str());
+            vSequence->__markFailed();
+            return;
+        }
+
+        // Cells are cut at integer positions, a remainder at the right or bottom edge is not part of any frame
+        SSequenceStreamFormat Format;
+        Format.FrameWidth   = AtlasWidth / vColumns;
+        Format.FrameHeight  = AtlasHeight / vRows;
+        Format.LevelCount   = !vOptions.IsScreenAligned && vOptions.MipMode != EMipMode::None ? computeFullMipLevelCount(Format.FrameWidth, Format.FrameHeight) : 1;
+        Format.MipAlphaMode = getMipAlphaMode(vOptions);
+        vSequence->__setLayout(Format.FrameWidth, Format.FrameHeight, Format.LevelCount);
+
+        // Frame rows below the grid are not decoded, nor cached
+        const auto pAtlas = IsCached ? std::make_shared<CStreamedAtlas>(std::move(Cached), vRows)
+                                     : std::make_shared<CStreamedAtlas>(AtlasWidth, vRows * Format.FrameHeight, vRows);
+        // One layer stays with the frame on screen, the decoder fills the others ahead of it
+        const int Lookahead = std::max(vSequence->getWindowSize() - 1, 1);
+        vSequence->__attachStreamer(std::make_unique<CSequenceStreamer>(std::make_unique<CAtlasFrameSource>(pAtlas, vRows, vColumns, Format), Lookahead,
+                                                                        vFramesPerSecond));
+        LOG_INFO(HIVE_LOGTAG, "Streaming %s: %d frames of %dx%d re-sliced from the %s atlas at %d fps, %d frames ahead, attached in %.2f ms", vAtlasPath.c_str(),
+                 vRows * vColumns, Format.FrameWidth, Format.FrameHeight, IsCached ? "mapped" : "progressively decoded", vFramesPerSecond, Lookahead,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count());
+        if (IsCached) return;
+
+        // On a task of its own, so the sequence is not kept alive by the decode
+        m_WorkerPool.submit([this, pAtlas, pBuffer = std::shared_ptr<CAssetBuffer>(std::move(pBuffer)), pDecoder = std::shared_ptr<IImageRegionDecoder>(std::move(pDecoder)),
+                             vAtlasPath, vOptions, DiskCacheKey, vRows, FrameHeight = Format.FrameHeight]() {
+            __decodeAtlasRows(*pAtlas, *pDecoder, vAtlasPath, vOptions, DiskCacheKey, vRows, FrameHeight);
+        });
+    }
+
+    void CAsyncTextureLoader::__decodeAtlasRows(CStreamedAtlas &vioAtlas, IImageRegionDecoder &vioDecoder, const std::string &vAtlasPath, const STextureLoadOptions &vOptions,
+                                                const std::string &vDiskCacheKey, int vFrameRowCount, int vFrameHeight)
+    {
+        // Growing slices as for progressive textures: the first frame row is playable after decoding one frame row, and
+        // AImageDecoder rereading the rows above each crop keeps the total near two full decodes
+        int FirstFrameRow = 0;
+        for (int SliceFrameRows = 1; FirstFrameRow < vFrameRowCount; SliceFrameRows *= 2)
+        {
+            if (m_IsShuttingDown)
+            {
+                vioAtlas.markFailed();
+                return;
+            }
+            const int SliceRowCount = std::min(SliceFrameRows, vFrameRowCount - FirstFrameRow);
+            auto StartTime = std::chrono::steady_clock::now();
+            SImageData Slice;
+            if (!vioDecoder.decodeRows(FirstFrameRow * vFrameHeight, SliceRowCount * vFrameHeight, Slice))
+            {
+                LOG_ERROR(HIVE_LOGTAG, "Failed to decode frame rows %d..%d of sequence atlas %s", FirstFrameRow, FirstFrameRow + SliceRowCount, vAtlasPath.c_str());
+                vioAtlas.markFailed();
+                return;
+            }
+            premultiplyAlpha(Slice, vOptions.AlphaConversion);
+            if (!vioAtlas.addFrameRows(FirstFrameRow, Slice)) return;
+            LOG_INFO(HIVE_LOGTAG, "Decoded frame rows %d..%d of %s in %.2f ms", FirstFrameRow, FirstFrameRow + SliceRowCount, vAtlasPath.c_str(),
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count());
+            FirstFrameRow += SliceRowCount;
+        }
+
+        // Playback already runs from the heap atlas, mapped back from the cache its pages belong to the file instead
+        if (vDiskCacheKey.empty()) return;
+        auto StartTime = std::chrono::steady_clock::now();
+        SCachedTexture Cached;
+        if (m_pDiskCache->store(vDiskCacheKey, vioAtlas.getDecodedImage(), {}) && m_pDiskCache->load(vDiskCacheKey, Cached))
+        {
+            vioAtlas.replaceWithMapping(std::move(Cached));
+            LOG_INFO(HIVE_LOGTAG, "Stored the %s atlas in the disk cache and now re-slice it from the mapping, %.2f ms", vAtlasPath.c_str(),
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count());
+        }
+    }
+
+    std::unique_ptr<CAssetBuffer> CAsyncTextureLoader::__openFrameSequence(const std::string &vSequencePath, const STextureLoadOptions &vOptions, int vFrameCount,
+                                                                           SFrameSequence &voSequence, SSequenceStreamFormat &voFormat)
+    {
+        auto pBuffer = __openAsset(vSequencePath);
+        if (pBuffer == nullptr) return nullptr;
+        std::string Error;
+        if (!parseFrameSequence(pBuffer->getData(), pBuffer->getSize(), voSequence, Error))
+        {
+            LOG_WARN(HIVE_LOGTAG, "Cannot read frame sequence %s: %s", vSequencePath.c_str(), Error.c_str());
+            return nullptr;
+        }
+        if (voSequence.getFrameCount() != vFrameCount)
+        {
+            LOG_WARN(HIVE_LOGTAG, "%s holds %d frames, %d were expected", vSequencePath.c_str(), voSequence.getFrameCount(), vFrameCount);
+            return nullptr;
+        }
+
+        // Every frame covers the surface on its own, the same size the atlas cells would be fitted to
+        voFormat.FrameWidth  = voSequence.FrameWidth;
+        voFormat.FrameHeight = voSequence.FrameHeight;
+        if (vOptions.IsFitToSurface)
+            computeDecodeSize(getDecodeTarget(), voSequence.FrameWidth, voSequence.FrameHeight, 1, 1, voFormat.FrameWidth, voFormat.FrameHeight);
+        const bool IsMipmapped   = !vOptions.IsScreenAligned && vOptions.MipMode != EMipMode::None;
+        voFormat.LevelCount      = IsMipmapped ? computeFullMipLevelCount(voFormat.FrameWidth, voFormat.FrameHeight) : 1;
+        voFormat.AlphaConversion = vOptions.AlphaConversion;
+        voFormat.MipAlphaMode    = getMipAlphaMode(vOptions);
+        return pBuffer;
+    }
+
+    bool CAsyncTextureLoader::__streamFrameSequence(const std::shared_ptr<CSequenceTexture> &vSequence, const std::string &vSequencePath, const STextureLoadOptions &vOptions,
+                                                    int vFrameCount, int vFramesPerSecond)
+    {
+        SFrameSequence Sequence;
+        SSequenceStreamFormat Format;
+        auto pBuffer = __openFrameSequence(vSequencePath, vOptions, vFrameCount, Sequence, Format);
+        if (pBuffer == nullptr) return false;
+        vSequence->__setLayout(Format.FrameWidth, Format.FrameHeight, Format.LevelCount);
+        // One layer stays with the frame on screen, the decoder fills the others ahead of it
+        const int Lookahead = std::max(vSequence->getWindowSize() - 1, 1);
+        LOG_INFO(HIVE_LOGTAG, "Streaming %s: %d frames of %dx%d at %d fps, %d frames ahead", vSequencePath.c_str(), vFrameCount, Format.FrameWidth,
+                 Format.FrameHeight, vFramesPerSecond, Lookahead);
+        vSequence->__attachStreamer(std::make_unique<CSequenceStreamer>(std::make_unique<CFrameSequenceSource>(std::move(pBuffer), std::move(Sequence), Format),
+                                                                        Lookahead, vFramesPerSecond));
+        return true;
+    }
+
+    void CAsyncTextureLoader::__decodeTask(const std::shared_ptr<CTextureAsset> &vTexture, const std::string &vAssetPath, const STextureLoadOptions &vOptions)
+    {
+        if (m_IsShuttingDown) return;
+        SCompletedDecode Completed;
+        Completed.pTexture  = vTexture;
+        Completed.AssetPath = vAssetPath;
+        Completed.Options   = vOptions;
+
+        // Saves a heap image and its copy into the upload buffer, the disk cache would need the pixels on the heap
+        if (__requestUploadMapping(Completed)) return;
+        const std::string DiskCacheKey = isKtx2Path(vAssetPath) ? std::string() : __makeDiskCacheKey(vAssetPath, vOptions, "texture");
+        if (!DiskCacheKey.empty() && m_pDiskCache->load(DiskCacheKey, Completed.Cached))
+        {
+            // Progressive loads included, one upload from the mapping beats decoding the first frame row
+            Completed.IsCached = true;
+            std::lock_guard<std::mutex> Lock(m_CompletedMutex);
+            m_CompletedQueue.push_back(std::move(Completed));
+            return;
+        }
+        if (vOptions.ProgressiveRows > 0 && !isKtx2Path(vAssetPath) && __decodeRowsTask(vTexture, vAssetPath, vOptions, DiskCacheKey)) return;
+
+        auto StartTime = std::chrono::steady_clock::now();
+        if (isKtx2Path(vAssetPath))
+        {
+            Completed.IsCompressed = __readKtx2(vAssetPath, Completed);
+            if (!Completed.IsCompressed)
+            {
+                Completed.AssetPath = getKtx2FallbackPath(vAssetPath);
+                Completed.IsDecoded = __decodeImage(Completed.AssetPath, Completed);
+            }
+        }
+        else
+            Completed.IsDecoded = __decodeImage(vAssetPath, Completed);
+        if (Completed.IsDecoded) premultiplyAlpha(Completed.Image, vOptions.AlphaConversion);
+        if (Completed.IsDecoded && vOptions.MipMode == EMipMode::Precomputed && !vOptions.IsScreenAligned)
+            Completed.MipLevels = generateSubLevels(Completed.Image, getMipAlphaMode(vOptions));
+        if (Completed.IsDecoded && !DiskCacheKey.empty()) m_pDiskCache->store(DiskCacheKey, Completed.Image, Completed.MipLevels);
+        double DecodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+        LOG_INFO(HIVE_LOGTAG, "Decoded %s in %.2f ms", Completed.AssetPath.c_str(), DecodeMs);
+
+        std::lock_guard<std::mutex> Lock(m_CompletedMutex);
+        m_CompletedQueue.push_back(std::move(Completed));
+    }
+
+    bool CAsyncTextureLoader::__readKtx2(const std::string &vAssetPath, SCompletedDecode &voCompleted)
+    {
+        // The mapping is kept until the GL thread has uploaded the levels straight from it
+        voCompleted.pKtx2Buffer = __openAsset(vAssetPath);
+        if (voCompleted.pKtx2Buffer == nullptr) return false;
+
+        std::string Error;
+        if (!parseKtx2(voCompleted.pKtx2Buffer->getData(), voCompleted.pKtx2Buffer->getSize(), voCompleted.Ktx2, Error))
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Invalid KTX2 %s: %s", vAssetPath.c_str(), Error.c_str());
+            voCompleted.pKtx2Buffer.reset();
+            return false;
+        }
+        return true;
+    }
+
+    bool CAsyncTextureLoader::__decodeImage(const std::string &vAssetPath, SCompletedDecode &voCompleted)
+    {
+        auto pBuffer = __openAsset(vAssetPath);
+        if (pBuffer == nullptr) return false;
+        const STextureLoadOptions &Options = voCompleted.Options;
+        if (Options.IsFitToSurface && getDecodeTarget().isActive())
+        {
+            // One slice covering the whole target, the region decoder is what knows how to decode at a smaller size
+            auto pDecoder = createImageRegionDecoder(pBuffer->getData(), pBuffer->getSize(), Options.Decoder);
+            if (pDecoder != nullptr)
+            {
+                __fitToSurface(*pDecoder, vAssetPath, Options, Options.AtlasColumns, std::max(Options.ProgressiveRows, 1));
+                return pDecoder->decodeRows(0, pDecoder->getHeight(), voCompleted.Image);
+            }
+        }
+        return decodeImageFromMemory(pBuffer->getData(), pBuffer->getSize(), voCompleted.Image, Options.Decoder);
+    }
+
+    bool CAsyncTextureLoader::__requestUploadMapping(SCompletedDecode &vioCompleted)
+    {
+        // A write mapping must not be read, so neither mips nor linear premultiply can be built from it
+        const STextureLoadOptions &Options = vioCompleted.Options;
+        if (m_pUploadRing == nullptr || isKtx2Path(vioCompleted.AssetPath) || Options.ProgressiveRows > 0 ||
+            Options.AlphaConversion == EAlphaConversion::PremultiplyLinear || (Options.MipMode == EMipMode::Precomputed && !Options.IsScreenAligned))
+            return false;
+        auto pEncoded = __openAsset(vioCompleted.AssetPath);
+        if (pEncoded == nullptr) return false;
+        auto pDecoder = createImageRegionDecoder(pEncoded->getData(), pEncoded->getSize(), Options.Decoder);
+        if (pDecoder == nullptr) return false;
+        __fitToSurface(*pDecoder, vioCompleted.AssetPath, Options, Options.AtlasColumns, 1);
+        if (Options.AlphaConversion == EAlphaConversion::Premultiply) pDecoder->setPremultipliedOutput();
+
+        vioCompleted.pEncoded           = std::move(pEncoded);
+        vioCompleted.pDecoder           = std::move(pDecoder);
+        vioCompleted.IsMappingRequested = true;
+        std::lock_guard<std::mutex> Lock(m_CompletedMutex);
+        m_CompletedQueue.push_back(std::move(vioCompleted));
+        return true;
+    }
+
+    void CAsyncTextureLoader::__decodeIntoMapping(SCompletedDecode &vioCompleted)
+    {
+        // The mapping goes with the ring
+        if (m_IsShuttingDown) return;
+        auto StartTime = std::chrono::steady_clock::now();
+        IImageRegionDecoder &Decoder = *vioCompleted.pDecoder;
+        if (vioCompleted.Mapped.pTexels != nullptr)
+            vioCompleted.IsMapped = Decoder.decodeRowsInto(0, Decoder.getHeight(), vioCompleted.Mapped.pTexels, vioCompleted.Mapped.RowPitch);
+        else
+            vioCompleted.IsDecoded = Decoder.decodeRows(0, Decoder.getHeight(), vioCompleted.Image);
+        vioCompleted.pDecoder.reset();
+        vioCompleted.pEncoded.reset();
+        LOG_INFO(HIVE_LOGTAG, "Decoded %s%s in %.2f ms", vioCompleted.AssetPath.c_str(), vioCompleted.IsMapped ? " into its upload buffer" : "",
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count());
+
+        std::lock_guard<std::mutex> Lock(m_CompletedMutex);
+        m_CompletedQueue.push_back(std::move(vioCompleted));
+    }
+
+    std::string CAsyncTextureLoader::__makeDiskCacheKey(const std::string &vAssetPath, const STextureLoadOptions &vOptions, const std::string &vLayout)
+    {
+        if (m_pDiskCache == nullptr) return {};
+        auto pEncoded = __openAsset(vAssetPath);
+        if (pEncoded == nullptr) return {};
+
+        const SDecodeTarget Target = vOptions.IsFitToSurface ? getDecodeTarget() : SDecodeTarget();
+        char Settings[256];
+        std::snprintf(Settings, sizeof(Settings), "|%zu bytes|%016llx|aligned %d|mips %d|decoder %d|alpha %d|rows %d|columns %d|target %dx%d %s|",
+                      pEncoded->getSize(), static_cast<unsigned long long>(CDiskTextureCache::hashBytes(pEncoded->getData(), pEncoded->getSize())),
+                      vOptions.IsScreenAligned, static_cast<int>(vOptions.MipMode), static_cast<int>(vOptions.Decoder), static_cast<int>(vOptions.AlphaConversion),
+                      vOptions.ProgressiveRows, vOptions.AtlasColumns, Target.SurfaceWidth, Target.SurfaceHeight, getQualityTierName(Target.Tier));
+        return vAssetPath + Settings + vLayout;
+    }
+
+    void CAsyncTextureLoader::__fitToSurface(IImageRegionDecoder &vioDecoder, const std::string &vAssetPath, const STextureLoadOptions &vOptions, int vColumns, int vRows) const
+    {
+        if (!vOptions.IsFitToSurface) return;
+        const SDecodeTarget Target = getDecodeTarget();
+        const int SourceWidth = vioDecoder.getWidth(), SourceHeight = vioDecoder.getHeight();
+        int Width, Height;
+        if (!computeDecodeSize(Target, SourceWidth, SourceHeight, vColumns, vRows, Width, Height)) return;
+        if (vioDecoder.setTargetSize(Width, Height))
+            LOG_INFO(HIVE_LOGTAG, "Decoding %s at %dx%d instead of %dx%d (%s tier, %dx%d surface)", vAssetPath.c_str(), Width, Height, SourceWidth, SourceHeight,
+                     getQualityTierName(Target.Tier), Target.SurfaceWidth, Target.SurfaceHeight);
+        else
+            LOG_WARN(HIVE_LOGTAG, "Cannot decode %s at %dx%d, keeping %dx%d", vAssetPath.c_str(), Width, Height, SourceWidth, SourceHeight);
+    }
+
+    std::unique_ptr<CAssetBuffer> CAsyncTextureLoader::__openAsset(const std::string &vAssetPath)
+    {
+        auto StartTime = std::chrono::steady_clock::now();
+        auto pBuffer = m_pAssetSource->open(vAssetPath);
+        if (pBuffer != nullptr)
+            LOG_INFO(HIVE_LOGTAG, "%s %s (%zu bytes) in %.2f ms", pBuffer->isMapped() ? "Mapped" : "Read", vAssetPath.c_str(), pBuffer->getSize(),
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count());
+        return pBuffer;
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "AssetSource.h"
+#include "DiskTextureCache.h"
+#include "ImageData.h"
+#include "Ktx2Container.h"
+#include "PixelUnpackRing.h"
+#include "QualityTier.h"
+#include "ThreadPool.h"
+#include "TextureAsset.h"
+
+
+namespace hiveVG
+{
+    class CSequenceTexture;
+    class CStreamedAtlas;
+    struct SFrameSequence;
+    struct SSequenceStreamFormat;
+    class IImageRegionDecoder;
+
+    /*!
+     * Decodes textures on a worker pool and hands the decoded pixels back to the GL thread through a completion queue.
+     * loadAsync() returns a pending CTextureAsset at once, it turns ready after processCompletedUploads() uploads it.
+     * With STextureLoadOptions::ProgressiveRows the atlas is decoded in growing slices (1, 2, 4... frame rows) and
+     * uploaded one frame row at a time, so playback can start after the first frame row.
+     */
+    class CAsyncTextureLoader
+    {
+    public:
+        // vAssetSource must outlive the loader, it is read from the worker threads.
+        CAsyncTextureLoader(IAssetSource *vAssetSource, size_t vWorkerCount);
+        ~CAsyncTextureLoader();
+
+        // Precomputed mips are built on the worker too, the GL thread only uploads them.
+        std::shared_ptr<CTextureAsset> loadAsync(const std::string &vAssetPath, const STextureLoadOptions &vOptions = {});
+        // Plays a vRows x vColumns frame sequence from a fixed ring of vWindowSize layers, a decoder thread keeps it filled
+        // ahead of playback at vFramesPerSecond, see CSequenceStreamer. A .hseq path is decoded frame by frame, its .png
+        // atlas is used if the file is unusable. An atlas is decoded on a worker in growing slices of frame rows while
+        // playback already re-slices the rows that arrived, see CStreamedAtlas, then read from the disk cache's mapping.
+        std::shared_ptr<CSequenceTexture> loadSequenceAsync(const std::string &vSequencePath, const STextureLoadOptions &vOptions, int vRows, int vColumns,
+                                                            int vWindowSize, int vFramesPerSecond);
+        // Call on the GL thread, at most vMaxUploads textures are uploaded so one frame never pays for all of them.
+        size_t                         processCompletedUploads(size_t vMaxUploads = std::numeric_limits<size_t>::max());
+        [[nodiscard]] bool             hasPendingLoads() const { return m_PendingCount.load() > 0; }
+        // Optional, uploads then go through the PBO ring in row bands instead of one glTexImage2D. Textures without
+        // precomputed mips or linear premultiply are then decoded straight into a mapped PBO, and skip the disk cache.
+        void                           setUploadRing(CPixelUnpackRing *vUploadRing) { m_pUploadRing = vUploadRing; }
+        // Size that STextureLoadOptions::IsFitToSurface textures are decoded to, applies to loads started afterwards
+        void                           setDecodeTarget(const SDecodeTarget &vTarget);
+        [[nodiscard]] SDecodeTarget    getDecodeTarget() const;
+        // Optional and set before the first load, must outlive the loader. PNG/JPG results are then looked up there
+        // before decoding and written there after, KTX2 files are never cached.
+        void                           setDiskCache(CDiskTextureCache *vDiskCache) { m_pDiskCache = vDiskCache; }
+
+    private:
+        struct SCompletedDecode
+        {
+            std::shared_ptr<CTextureAsset>       pTexture;
+            std::string                          AssetPath;
+            STextureLoadOptions                  Options;
+            SImageData                           Image;
+            std::vector<SImageData>              MipLevels;
+            std::unique_ptr<CAssetBuffer>        pKtx2Buffer;
+            SKtx2Texture                         Ktx2;
+            SCachedTexture                       Cached;
+            bool                                 IsDecoded    = false;
+            bool                                 IsCompressed = false;
+            bool                                 IsCached     = false;
+            // Progressive loads only: Image holds full width rows starting at FirstRow of a FullWidth x FullHeight atlas
+            bool                                 IsRows       = false;
+            bool                                 IsLastRows   = true;
+            int                                  FirstRow     = 0;
+            int                                  FullWidth    = 0;
+            int                                  FullHeight   = 0;
+            int                                  LevelCount   = 1;
+            // Pixels nothing reads on the CPU: sent once to have the GL thread map an upload buffer, then again once the
+            // worker decoded into Mapped (IsMapped) or, if it could not be mapped, into Image
+            bool                                 IsMappingRequested = false;
+            bool                                 IsMapped           = false;
+            std::shared_ptr<CAssetBuffer>        pEncoded;
+            std::shared_ptr<IImageRegionDecoder> pDecoder;
+            SMappedPixelImage                    Mapped;
+        };
+
+        void   __decodeTask(const std::shared_ptr<CTextureAsset> &vTexture, const std::string &vAssetPath, const STextureLoadOptions &vOptions);
+        bool   __readKtx2(const std::string &vAssetPath, SCompletedDecode &voCompleted);
+        bool   __decodeImage(const std::string &vAssetPath, SCompletedDecode &voCompleted);
+        // False if vioCompleted needs a CPU pass over its pixels or cannot be decoded in place, it is then decoded on the heap
+        bool   __requestUploadMapping(SCompletedDecode &vioCompleted);
+        void   __decodeIntoMapping(SCompletedDecode &vioCompleted);
+        // False if the asset cannot be split into vOptions.ProgressiveRows bands, the caller then decodes it whole
+        bool   __decodeRowsTask(const std::shared_ptr<CTextureAsset> &vTexture, const std::string &vAssetPath, const STextureLoadOptions &vOptions,
+                                const std::string &vDiskCacheKey);
+        bool   __uploadRows(SCompletedDecode &vioCompleted);
+        void   __streamAtlasSequence(const std::shared_ptr<CSequenceTexture> &vSequence, const std::string &vAtlasPath, const STextureLoadOptions &vOptions,
+                                     int vRows, int vColumns, int vFramesPerSecond);
+        // After the streamer is attached: decodes vioAtlas in growing slices of frame rows, then swaps it for its disk cache mapping
+        void   __decodeAtlasRows(CStreamedAtlas &vioAtlas, IImageRegionDecoder &vioDecoder, const std::string &vAtlasPath, const STextureLoadOptions &vOptions,
+                                 const std::string &vDiskCacheKey, int vFrameRowCount, int vFrameHeight);
+        // Maps and validates a .hseq file, and works out the frame size and levels vOptions ask for
+        std::unique_ptr<CAssetBuffer> __openFrameSequence(const std::string &vSequencePath, const STextureLoadOptions &vOptions, int vFrameCount,
+                                                          SFrameSequence &voSequence, SSequenceStreamFormat &voFormat);
+        // False if the file is missing or unusable, so the atlas fallback can be tried
+        bool   __streamFrameSequence(const std::shared_ptr<CSequenceTexture> &vSequence, const std::string &vSequencePath, const STextureLoadOptions &vOptions,
+                                     int vFrameCount, int vFramesPerSecond);
+        std::unique_ptr<CAssetBuffer> __openAsset(const std::string &vAssetPath);
+        // Everything the decoded pixels depend on: the encoded bytes, the options and the decode target. vLayout tells
+        // whole textures from sequence atlases. Empty without a disk cache or when the asset cannot be opened.
+        std::string __makeDiskCacheKey(const std::string &vAssetPath, const STextureLoadOptions &vOptions, const std::string &vLayout);
+        // Shrinks vioDecoder to the decode target when vOptions ask for it, vColumns x vRows frames each cover the surface
+        void   __fitToSurface(IImageRegionDecoder &vioDecoder, const std::string &vAssetPath, const STextureLoadOptions &vOptions, int vColumns, int vRows) const;
+
+        IAssetSource*                m_pAssetSource  = nullptr;
+        CPixelUnpackRing*            m_pUploadRing   = nullptr;
+        CDiskTextureCache*           m_pDiskCache    = nullptr;
+        mutable std::mutex           m_DecodeTargetMutex;
+        SDecodeTarget                m_DecodeTarget;
+        std::mutex                   m_CompletedMutex;
+        std::deque<SCompletedDecode> m_CompletedQueue;
+        std::atomic<int>             m_PendingCount{0};
+        std::atomic<bool>            m_IsShuttingDown{false};
+        // Declared last so the workers are joined before the queue they push into is destroyed.
+        CThreadPool                  m_WorkerPool;
+    };
+}
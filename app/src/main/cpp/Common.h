@@ -1,11 +1,35 @@
 #pragma once
 
+#ifdef __ANDROID__
 #include <android/log.h>
 
 #define LOG_DEBUG(...) __android_log_print(ANDROID_LOG_DEBUG, __VA_ARGS__)
 #define LOG_INFO(...) __android_log_print(ANDROID_LOG_INFO, __VA_ARGS__)
 #define LOG_WARN(...) __android_log_print(ANDROID_LOG_WARN, __VA_ARGS__)
 #define LOG_ERROR(...) __android_log_print(ANDROID_LOG_ERROR, __VA_ARGS__)
+#else
+#include <cstdarg>
+#include <cstdio>
+
+namespace hiveVG
+{
+    // Host builds (tools, benchmarks) print to stderr with the same tag/format signature as logcat.
+    inline void hostLogPrint(const char *vLevel, const char *vTag, const char *vFormat, ...)
+    {
+        va_list Args;
+        va_start(Args, vFormat);
+        std::fprintf(stderr, "%s/%s: ", vLevel, vTag);
+        std::vfprintf(stderr, vFormat, Args);
+        std::fputc('\n', stderr);
+        va_end(Args);
+    }
+}
+
+#define LOG_DEBUG(...) hiveVG::hostLogPrint("D", __VA_ARGS__)
+#define LOG_INFO(...) hiveVG::hostLogPrint("I", __VA_ARGS__)
+#define LOG_WARN(...) hiveVG::hostLogPrint("W", __VA_ARGS__)
+#define LOG_ERROR(...) hiveVG::hostLogPrint("E", __VA_ARGS__)
+#endif
 
 
 namespace hiveVG::TAG_KEYWORD
@@ -13,4 +37,10 @@ namespace hiveVG::TAG_KEYWORD
     const char *const MAIN_TAG = "Main";
     const char *const RENDERER_TAG = "CRenderer";
     const char *const SeqFrame_RENDERER_TAG = "CSequenceFrameRenderer";
+    const char *const TEXTURE_ASSET_TAG = "CTextureAsset";
+    const char *const TEXTURE_LOADER_TAG = "CAsyncTextureLoader";
+    const char *const TEXTURE_CACHE_TAG = "CTextureCache";
+    const char *const ASSET_SOURCE_TAG = "CAssetSource";
+    const char *const DISK_CACHE_TAG = "CDiskTextureCache";
+    const char *const SCENE_TAG = "SceneDescription";
 }
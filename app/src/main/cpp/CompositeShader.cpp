@@ -0,0 +1,169 @@
+#include "CompositeShader.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include "MotionVectors.h"
+
+namespace hiveVG
+{
+    namespace
+    {
+        void appendFormat(std::string &vioText, const char *vFormat, ...)
+        {
+            char Line[512];
+            va_list Arguments;
+            va_start(Arguments, vFormat);
+            std::vsnprintf(Line, sizeof(Line), vFormat, Arguments);
+            va_end(Arguments);
+            vioText += Line;
+        }
+
+        /*
+         * Bilinear between the four texels around vUV, with the weights pushed towards the nearest texel as far as the
+         * alpha range of the four times vEdgeSharpness: across a flake's edge it stays crisp, inside it and in empty
+         * space it is plain bilinear.
+         */
+        const char UpsampleFunctionSource[] = R"glsl(
+vec4 upsampleLayer(sampler2D vLayer, highp vec2 vUV, float vEdgeSharpness)
+{
+    if (vEdgeSharpness <= 0.0)
+        return texture(vLayer, vUV);
+    ivec2 Size = textureSize(vLayer, 0);
+    // Texel positions of a full HD target need more than mediump's 11 bits
+    highp vec2 Position = vUV * vec2(Size) - 0.5;
+    highp vec2 Corner = floor(Position);
+    vec2 Fraction = Position - Corner;
+    ivec2 Base = ivec2(Corner);
+    ivec2 MaxTexel = Size - 1;
+    vec4 Texel00 = texelFetch(vLayer, clamp(Base, ivec2(0), MaxTexel), 0);
+    vec4 Texel10 = texelFetch(vLayer, clamp(Base + ivec2(1, 0), ivec2(0), MaxTexel), 0);
+    vec4 Texel01 = texelFetch(vLayer, clamp(Base + ivec2(0, 1), ivec2(0), MaxTexel), 0);
+    vec4 Texel11 = texelFetch(vLayer, clamp(Base + ivec2(1, 1), ivec2(0), MaxTexel), 0);
+    float AlphaRange = max(max(Texel00.a, Texel10.a), max(Texel01.a, Texel11.a)) - min(min(Texel00.a, Texel10.a), min(Texel01.a, Texel11.a));
+    Fraction = mix(Fraction, smoothstep(0.0, 1.0, Fraction), clamp(AlphaRange * vEdgeSharpness, 0.0, 1.0));
+    return mix(mix(Texel00, Texel10, Fraction.x), mix(Texel01, Texel11, Fraction.x), Fraction.y);
+}
+)glsl";
+
+        // Color is the layer's texel, Destination what the layers below left, as GL would blend them
+        const char* getBlendStatement(ESceneBlendMode vMode)
+        {
+            switch (vMode)
+            {
+                case ESceneBlendMode::Opaque:        return "Destination = Color;";
+                case ESceneBlendMode::Premultiplied: return "Destination = Color + Destination * (1.0 - Color.a);";
+                case ESceneBlendMode::Additive:      return "Destination = Color * Color.a + Destination;";
+                default:                             return "Destination = Color * Color.a + Destination * (1.0 - Color.a);";
+            }
+        }
+
+        // The body of SnowArrayFragmentShaderSource or SnowFragmentShaderSource with layer i's uniforms
+        void appendSequenceSampling(const SCompositeLayer &vLayer, int vIndex, std::string &vioSource)
+        {
+            const std::string Texture = getCompositeSamplerName(vIndex, false);
+            appendFormat(vioSource, "        Cell = %s[%d];\n        Playback = %s[%d];\n", COMPOSITE_SHADER::CellsUniform, vIndex,
+                         COMPOSITE_SHADER::PlaybackUniform, vIndex);
+            vioSource += "        Motion = vec2(0.0);\n";
+            if (vLayer.HasMotion)
+                appendFormat(vioSource, "        if (Playback.w > 0.0)\n"
+                                        "            Motion = (texture(%s, TexCoord * vec2(%.8f, %.8f) + Cell.xy).rg * 2.0 - 1.0) * %.8f * Playback.w;\n",
+                             getCompositeSamplerName(vIndex, true).c_str(), vLayer.CellWidth, vLayer.CellHeight, MOTION_VECTOR_FORMAT::MaxDisplacement);
+            if (vLayer.IsArray)
+            {
+                appendFormat(vioSource, "        Color = texture(%s, vec3(TexCoord - Playback.z * Motion, Playback.x));\n", Texture.c_str());
+                appendFormat(vioSource, "        if (Playback.z > 0.0)\n"
+                                        "            Color = mix(Color, texture(%s, vec3(TexCoord + (1.0 - Playback.z) * Motion, Playback.y)), Playback.z);\n",
+                             Texture.c_str());
+                return;
+            }
+            // Warped lookups stay inside their cell, as in SnowFragmentShaderSource
+            appendFormat(vioSource, "        Color = texture(%s, clamp(TexCoord - Playback.z * Motion, 0.0, 1.0) * vec2(%.8f, %.8f) + Cell.xy);\n",
+                         Texture.c_str(), vLayer.CellWidth, vLayer.CellHeight);
+            appendFormat(vioSource, "        if (Playback.z > 0.0)\n"
+                                    "            Color = mix(Color, texture(%s, clamp(TexCoord + (1.0 - Playback.z) * Motion, 0.0, 1.0) * vec2(%.8f, %.8f) + Cell.zw), Playback.z);\n",
+                         Texture.c_str(), vLayer.CellWidth, vLayer.CellHeight);
+        }
+    }
+
+    bool buildCompositeShader(const std::vector<SCompositeLayer> &vLayers, const float vClearColor[4], int vMaxTextureUnits, SCompositeShader &voShader)
+    {
+        voShader = SCompositeShader();
+        for (const SCompositeLayer &Layer : vLayers)
+        {
+            const bool IsSequence = Layer.Kind == ESceneLayerKind::Sequence;
+            voShader.TextureUnits.push_back(voShader.TextureUnitCount++);
+            voShader.MotionUnits.push_back(IsSequence && Layer.HasMotion ? voShader.TextureUnitCount++ : -1);
+        }
+        if (vLayers.empty() || voShader.TextureUnitCount > vMaxTextureUnits) return false;
+
+        const int LayerCount = static_cast<int>(vLayers.size());
+        std::string &Source = voShader.FragmentSource;
+        Source = "#version 300 es\n"
+                 "precision mediump float;\n"
+                 "precision mediump sampler2DArray;\n"
+                 "out vec4 FragColor;\n"
+                 "in highp vec2 TexCoord;\n";
+        appendFormat(Source, "uniform vec4 %s[%d];\nuniform vec4 %s[%d];\n", COMPOSITE_SHADER::CellsUniform, LayerCount, COMPOSITE_SHADER::PlaybackUniform, LayerCount);
+        for (int i = 0; i < LayerCount; ++i)
+        {
+            const SCompositeLayer &Layer = vLayers[i];
+            appendFormat(Source, "uniform %s %s;\n", Layer.IsArray ? "sampler2DArray" : "sampler2D", getCompositeSamplerName(i, false).c_str());
+            if (voShader.MotionUnits[i] >= 0) appendFormat(Source, "uniform sampler2D %s;\n", getCompositeSamplerName(i, true).c_str());
+        }
+
+        if (std::any_of(vLayers.begin(), vLayers.end(), [](const SCompositeLayer &vLayer) { return vLayer.IsUpsampled; }))
+            Source += UpsampleFunctionSource;
+        Source += "void main()\n{\n";
+        appendFormat(Source, "    vec4 Destination = vec4(%.6f, %.6f, %.6f, %.6f);\n", vClearColor[0], vClearColor[1], vClearColor[2], vClearColor[3]);
+        Source += "    vec4 Color;\n    vec4 Cell;\n    vec4 Playback;\n    vec2 Motion;\n";
+        for (int i = 0; i < LayerCount; ++i)
+        {
+            const SCompositeLayer &Layer = vLayers[i];
+            appendFormat(Source, "    // layer %d, %s\n    {\n", i, getSceneBlendModeName(Layer.BlendMode));
+            if (Layer.Kind == ESceneLayerKind::Sequence)
+            {
+                appendSequenceSampling(Layer, i, Source);
+                appendFormat(Source, "        if (Color.a >= %.2f)\n            %s\n", COMPOSITE_SHADER::DiscardAlpha, getBlendStatement(Layer.BlendMode));
+            }
+            else if (Layer.IsUpsampled)
+            {
+                appendFormat(Source, "        Color = upsampleLayer(%s, TexCoord, %.6f);\n", getCompositeSamplerName(i, false).c_str(), Layer.EdgeSharpness);
+                appendFormat(Source, "        %s\n", getBlendStatement(Layer.BlendMode));
+            }
+            else
+            {
+                appendFormat(Source, "        Color = texture(%s, TexCoord);\n", getCompositeSamplerName(i, false).c_str());
+                appendFormat(Source, "        %s\n", getBlendStatement(Layer.BlendMode));
+            }
+            Source += "    }\n";
+        }
+        Source += "    FragColor = Destination;\n}\n";
+        return true;
+    }
+
+    std::string buildUpsampleShader()
+    {
+        std::string Source = "#version 300 es\n"
+                             "precision mediump float;\n"
+                             "out vec4 FragColor;\n"
+                             "in highp vec2 TexCoord;\n"
+                             "uniform sampler2D reducedLayer;\n"
+                             "uniform float edgeSharpness;\n";
+        Source += UpsampleFunctionSource;
+        Source += "void main()\n{\n    FragColor = upsampleLayer(reducedLayer, TexCoord, edgeSharpness);\n}\n";
+        return Source;
+    }
+
+    std::string getCompositeSamplerName(int vLayer, bool vIsMotion)
+    {
+        return (vIsMotion ? "layerMotion" : "layerTexture") + std::to_string(vLayer);
+    }
+
+    int computeFramebufferBytesPerPixel(const std::vector<SCompositeLayer> &vLayers)
+    {
+        int Bytes = 4;
+        for (const SCompositeLayer &Layer : vLayers)
+            Bytes += Layer.BlendMode == ESceneBlendMode::Opaque ? 4 : 8;
+        return Bytes;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "SceneDescription.h"
+
+namespace hiveVG
+{
+    namespace COMPOSITE_SHADER
+    {
+        constexpr const char *CellsUniform    = "compositeCells";      // vec4 per layer: frame cell offset, next frame cell offset
+        constexpr const char *PlaybackUniform = "compositePlayback";   // vec4 per layer: array layer, next array layer, blend factor, motion strength
+        constexpr float       DiscardAlpha    = 0.1f;                  // sequence texels below it are skipped, as the snow shaders discard them
+        // How far the edge upsample filter moves towards the nearest texels per unit of alpha range between the four it
+        // blends. 1 was the best of 0 to 8 against full resolution frames, see textureBench --upsample.
+        constexpr float       EdgeSharpness   = 1.0f;
+    }
+
+    // What the composite shader samples for one scene layer
+    struct SCompositeLayer
+    {
+        ESceneLayerKind Kind       = ESceneLayerKind::Image;
+        ESceneBlendMode BlendMode  = ESceneBlendMode::Alpha;
+        bool            IsArray    = false;   // sequences: frames in texture array layers instead of atlas cells
+        bool            HasMotion  = false;   // sequences: a motion vector atlas is bound, see MotionVectors.h
+        float           CellWidth  = 1.0f;    // sequences: of one atlas cell, in UV
+        float           CellHeight = 1.0f;
+        bool            IsUpsampled   = false;   // images: a layer drawn at a reduced scale, its texture is premultiplied
+        float           EdgeSharpness = 0.0f;    // upsampled images: 0 is plain bilinear
+    };
+
+    struct SCompositeShader
+    {
+        std::string      FragmentSource;   // takes TexCoord from SnowVertexShaderSource
+        std::vector<int> TextureUnits;     // per layer, the unit of its colour texture
+        std::vector<int> MotionUnits;      // per layer, the unit of its motion atlas or -1
+        int              TextureUnitCount = 0;
+    };
+
+    /*!
+     * Generates one fragment shader that samples every layer and folds them back to front with the blend equation
+     * each layer's blend mode sets in GL (ONE, ONE_MINUS_SRC_ALPHA for premultiplied and so on), starting from
+     * vClearColor, so the framebuffer is written once instead of read and written per layer. Sequences play as the
+     * snow shaders play them: cross faded or warped towards the next frame by their row of the per layer uniform arrays.
+     * @return false if the layers need more than vMaxTextureUnits samplers
+     */
+    bool buildCompositeShader(const std::vector<SCompositeLayer> &vLayers, const float vClearColor[4], int vMaxTextureUnits, SCompositeShader &voShader);
+
+    /*!
+     * Fragment shader drawing a layer rendered at a reduced scale (premultiplied RGBA in the reducedLayer sampler) over
+     * the surface, upsampled with the edgeSharpness uniform as buildCompositeShader() upsamples them. Takes TexCoord from
+     * SnowVertexShaderSource.
+     */
+    std::string buildUpsampleShader();
+
+    // Sampler uniform of layer vLayer's colour texture or motion atlas in the generated shader
+    std::string getCompositeSamplerName(int vLayer, bool vIsMotion);
+
+    /*!
+     * Framebuffer bytes per pixel of RGBA8 full screen passes: a write for the clear and each opaque layer, a read and
+     * a write for each blended one. A single composite pass costs the write of one.
+     */
+    int computeFramebufferBytesPerPixel(const std::vector<SCompositeLayer> &vLayers);
+}
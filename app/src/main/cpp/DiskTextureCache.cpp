@@ -0,0 +1,331 @@
+#include "DiskTextureCache.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include "Common.h"
+#include "Lz4Block.h"
+
+namespace hiveVG
+{
+#define HIVE_LOGTAG hiveVG::TAG_KEYWORD::DISK_CACHE_TAG
+    namespace
+    {
+        constexpr char   FileMagic[8]     = {'H', 'I', 'V', 'E', 'T', 'E', 'X', '\n'};
+        constexpr char   EntryExtension[] = ".htex";
+        constexpr size_t PayloadAlignment = 64;
+
+        // Little endian on every target this runs on, written and read as is
+        struct SFileHeader
+        {
+            char     Magic[8];
+            uint32_t FormatVersion;
+            uint32_t Compression;
+            uint32_t KeyLength;
+            uint32_t LevelCount;
+            uint64_t PayloadOffset;
+            uint64_t PayloadSize;     // as stored
+            uint64_t RawSize;         // after decompression
+            uint64_t Checksum;        // of this header with Checksum = 0, the key and the level table
+        };
+        static_assert(sizeof(SFileHeader) == 56, "SFileHeader is part of the file format");
+
+        struct SLevelRecord
+        {
+            uint32_t Width;
+            uint32_t Height;
+            uint64_t ByteOffset;
+        };
+        static_assert(sizeof(SLevelRecord) == 16, "SLevelRecord is part of the file format");
+
+        uint64_t computeHeaderChecksum(SFileHeader vHeader, const char *vKey, const SLevelRecord *vLevels)
+        {
+            vHeader.Checksum = 0;
+            uint64_t Checksum = CDiskTextureCache::hashBytes(reinterpret_cast<const uint8_t *>(&vHeader), sizeof(vHeader));
+            Checksum = CDiskTextureCache::hashBytes(reinterpret_cast<const uint8_t *>(vKey), vHeader.KeyLength, Checksum);
+            return CDiskTextureCache::hashBytes(reinterpret_cast<const uint8_t *>(vLevels), sizeof(SLevelRecord) * vHeader.LevelCount, Checksum);
+        }
+
+        bool writeAll(int vFileDescriptor, const void *vData, size_t vSize)
+        {
+            auto pBytes = static_cast<const uint8_t *>(vData);
+            while (vSize > 0)
+            {
+                const ssize_t Written = write(vFileDescriptor, pBytes, vSize);
+                if (Written < 0 && errno == EINTR) continue;
+                if (Written <= 0) return false;
+                pBytes += Written;
+                vSize  -= static_cast<size_t>(Written);
+            }
+            return true;
+        }
+
+        bool createDirectories(const std::string &vDirectory)
+        {
+            for (size_t Slash = vDirectory.find('/', 1); ; Slash = vDirectory.find('/', Slash + 1))
+            {
+                const std::string Prefix = vDirectory.substr(0, Slash);
+                if (!Prefix.empty() && mkdir(Prefix.c_str(), 0700) != 0 && errno != EEXIST) return false;
+                if (Slash == std::string::npos) return true;
+            }
+        }
+
+        bool hasSuffix(const char *vName, const char *vSuffix)
+        {
+            const size_t NameLength = std::strlen(vName), SuffixLength = std::strlen(vSuffix);
+            return NameLength >= SuffixLength && std::strcmp(vName + NameLength - SuffixLength, vSuffix) == 0;
+        }
+
+        double getElapsedMs(std::chrono::steady_clock::time_point vStartTime)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - vStartTime).count();
+        }
+    }
+
+    CDiskTextureCache::CDiskTextureCache(std::string vDirectory, EDiskTextureCompression vCompression)
+        : m_Directory(std::move(vDirectory)), m_Compression(vCompression)
+    {
+        if (!createDirectories(m_Directory)) LOG_ERROR(HIVE_LOGTAG, "Cannot create texture cache directory %s: %s", m_Directory.c_str(), std::strerror(errno));
+    }
+
+    uint64_t CDiskTextureCache::hashBytes(const uint8_t *vData, size_t vSize, uint64_t vSeed)
+    {
+        constexpr uint64_t Multiplier = 0x9E3779B97F4A7C15ull;
+        uint64_t Hash = vSeed ^ (vSize * Multiplier);
+        size_t i = 0;
+        for (; i + 8 <= vSize; i += 8)
+        {
+            uint64_t Word;
+            std::memcpy(&Word, vData + i, sizeof(Word));
+            Hash = (Hash ^ Word) * Multiplier;
+            Hash ^= Hash >> 29;
+        }
+        for (; i < vSize; ++i) Hash = (Hash ^ vData[i]) * Multiplier;
+        Hash ^= Hash >> 32;
+        return Hash * Multiplier ^ (Hash >> 29);
+    }
+
+    std::string CDiskTextureCache::getEntryPath(const std::string &vKey) const
+    {
+        char FileName[32];
+        std::snprintf(FileName, sizeof(FileName), "%016" PRIx64 "%s", hashBytes(reinterpret_cast<const uint8_t *>(vKey.data()), vKey.size()), EntryExtension);
+        return m_Directory + "/" + FileName;
+    }
+
+    bool CDiskTextureCache::load(const std::string &vKey, SCachedTexture &voTexture)
+    {
+        auto StartTime = std::chrono::steady_clock::now();
+        const std::string Path = getEntryPath(vKey);
+        int FileDescriptor = ::open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (FileDescriptor < 0)
+        {
+            std::lock_guard<std::mutex> Lock(m_StatsMutex);
+            ++m_Stats.MissCount;
+            return false;
+        }
+        std::unique_ptr<CAssetBuffer> pFile;
+        struct stat FileStat{};
+        if (fstat(FileDescriptor, &FileStat) == 0) pFile = CAssetBuffer::mapFile(FileDescriptor, 0, static_cast<size_t>(FileStat.st_size));
+        close(FileDescriptor);
+
+        if (pFile == nullptr || !__validate(vKey, *pFile, voTexture))
+        {
+            __reject(Path, pFile == nullptr ? "cannot be mapped" : "does not validate");
+            return false;
+        }
+        const size_t StoredBytes = pFile->getSize();
+        if (voTexture.pBuffer == nullptr) voTexture.pBuffer = std::move(pFile);
+
+        std::lock_guard<std::mutex> Lock(m_StatsMutex);
+        ++m_Stats.HitCount;
+        m_Stats.BytesLoaded += StoredBytes;
+        m_Stats.LoadMs += getElapsedMs(StartTime);
+        return true;
+    }
+
+    bool CDiskTextureCache::__validate(const std::string &vKey, const CAssetBuffer &vFile, SCachedTexture &voTexture) const
+    {
+        const uint8_t *pData = vFile.getData();
+        const size_t   Size  = vFile.getSize();
+        if (Size < sizeof(SFileHeader)) return false;
+        SFileHeader Header;
+        std::memcpy(&Header, pData, sizeof(Header));
+        if (std::memcmp(Header.Magic, FileMagic, sizeof(FileMagic)) != 0 || Header.FormatVersion != FormatVersion) return false;
+        if (Header.Compression > static_cast<uint32_t>(EDiskTextureCompression::LZ4) || Header.KeyLength != vKey.size() || Header.LevelCount == 0 || Header.LevelCount > 32)
+            return false;
+
+        const size_t TableOffset = sizeof(SFileHeader) + Header.KeyLength;
+        const size_t TableEnd    = TableOffset + sizeof(SLevelRecord) * Header.LevelCount;
+        if (TableEnd > Size || Header.PayloadOffset < TableEnd || Header.PayloadOffset > Size || Header.PayloadSize != Size - Header.PayloadOffset) return false;
+        if (std::memcmp(pData + sizeof(SFileHeader), vKey.data(), vKey.size()) != 0) return false;
+        std::vector<SLevelRecord> Records(Header.LevelCount);
+        std::memcpy(Records.data(), pData + TableOffset, sizeof(SLevelRecord) * Records.size());
+        if (computeHeaderChecksum(Header, vKey.data(), Records.data()) != Header.Checksum) return false;
+
+        // Each level halves the one before it and lies inside the payload, so uploads can trust the table
+        voTexture.Levels.clear();
+        uint64_t ExpectedOffset = 0;
+        for (size_t i = 0; i < Records.size(); ++i)
+        {
+            const SLevelRecord &Record = Records[i];
+            const bool IsHalf = i == 0 ? Record.Width > 0 && Record.Height > 0 && Record.Width <= 16384 && Record.Height <= 16384
+                                       : Record.Width == std::max(Records[i - 1].Width / 2, 1u) && Record.Height == std::max(Records[i - 1].Height / 2, 1u);
+            if (!IsHalf || Record.ByteOffset != ExpectedOffset) return false;
+            ExpectedOffset += static_cast<uint64_t>(Record.Width) * Record.Height * 4;
+            voTexture.Levels.push_back({static_cast<int>(Record.Width), static_cast<int>(Record.Height), static_cast<size_t>(Record.ByteOffset)});
+        }
+        if (ExpectedOffset != Header.RawSize) return false;
+
+        if (Header.Compression == static_cast<uint32_t>(EDiskTextureCompression::None))
+        {
+            if (Header.PayloadSize != Header.RawSize) return false;
+            voTexture.PayloadOffset = static_cast<size_t>(Header.PayloadOffset);
+            return true;
+        }
+        std::vector<uint8_t> Raw(static_cast<size_t>(Header.RawSize));
+        if (!decompressLz4Block(pData + Header.PayloadOffset, static_cast<size_t>(Header.PayloadSize), Raw.data(), Raw.size())) return false;
+        voTexture.pBuffer = CAssetBuffer::fromBytes(std::move(Raw));
+        voTexture.PayloadOffset = 0;
+        return true;
+    }
+
+    void CDiskTextureCache::__reject(const std::string &vPath, const char *vReason)
+    {
+        LOG_WARN(HIVE_LOGTAG, "Dropping cached texture %s, it %s", vPath.c_str(), vReason);
+        unlink(vPath.c_str());
+        std::lock_guard<std::mutex> Lock(m_StatsMutex);
+        ++m_Stats.RejectCount;
+    }
+
+    bool CDiskTextureCache::store(const std::string &vKey, const SImageData &vBase, const std::vector<SImageData> &vMipLevels)
+    {
+        auto StartTime = std::chrono::steady_clock::now();
+        std::vector<const SImageData *> Levels = {&vBase};
+        for (const auto &Mip : vMipLevels) Levels.push_back(&Mip);
+
+        SFileHeader Header{};
+        std::memcpy(Header.Magic, FileMagic, sizeof(FileMagic));
+        Header.FormatVersion = FormatVersion;
+        Header.Compression   = static_cast<uint32_t>(EDiskTextureCompression::None);
+        Header.KeyLength     = static_cast<uint32_t>(vKey.size());
+        Header.LevelCount    = static_cast<uint32_t>(Levels.size());
+        std::vector<SLevelRecord> Records;
+        for (const SImageData *pLevel : Levels)
+        {
+            if (pLevel->Channels != 4 || !pLevel->isValid()) return false;
+            Records.push_back({static_cast<uint32_t>(pLevel->Width), static_cast<uint32_t>(pLevel->Height), Header.RawSize});
+            Header.RawSize += pLevel->getByteSize();
+        }
+        const size_t TableEnd = sizeof(SFileHeader) + vKey.size() + sizeof(SLevelRecord) * Records.size();
+        Header.PayloadOffset  = (TableEnd + PayloadAlignment - 1) / PayloadAlignment * PayloadAlignment;
+        Header.PayloadSize    = Header.RawSize;
+
+        std::vector<uint8_t> Compressed;
+        if (m_Compression == EDiskTextureCompression::LZ4)
+        {
+            std::vector<uint8_t> Raw;
+            Raw.reserve(static_cast<size_t>(Header.RawSize));
+            for (const SImageData *pLevel : Levels) Raw.insert(Raw.end(), pLevel->Pixels.begin(), pLevel->Pixels.begin() + static_cast<ptrdiff_t>(pLevel->getByteSize()));
+            Compressed.resize(getLz4BlockBound(Raw.size()));
+            Compressed.resize(compressLz4Block(Raw.data(), Raw.size(), Compressed.data(), Compressed.size()));
+            if (!Compressed.empty() && Compressed.size() < Raw.size() / 4 * 3)
+            {
+                Header.Compression = static_cast<uint32_t>(EDiskTextureCompression::LZ4);
+                Header.PayloadSize = Compressed.size();
+            }
+            else
+                Compressed.clear();
+        }
+        Header.Checksum = computeHeaderChecksum(Header, vKey.data(), Records.data());
+
+        // Unique per process and call, concurrent stores of the same key each rename a complete file
+        static std::atomic<uint32_t> s_TemporaryCounter{0};
+        const std::string Path = getEntryPath(vKey);
+        const std::string TemporaryPath = Path + "." + std::to_string(getpid()) + "." + std::to_string(s_TemporaryCounter++) + ".tmp";
+        int FileDescriptor = ::open(TemporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        bool IsWritten = FileDescriptor >= 0;
+        if (IsWritten)
+        {
+            const std::vector<uint8_t> Padding(static_cast<size_t>(Header.PayloadOffset) - TableEnd, 0);
+            IsWritten = writeAll(FileDescriptor, &Header, sizeof(Header)) && writeAll(FileDescriptor, vKey.data(), vKey.size()) &&
+                        writeAll(FileDescriptor, Records.data(), sizeof(SLevelRecord) * Records.size()) && writeAll(FileDescriptor, Padding.data(), Padding.size());
+            if (!Compressed.empty())
+                IsWritten = IsWritten && writeAll(FileDescriptor, Compressed.data(), Compressed.size());
+            else
+                for (const SImageData *pLevel : Levels) IsWritten = IsWritten && writeAll(FileDescriptor, pLevel->Pixels.data(), pLevel->getByteSize());
+            IsWritten = fsync(FileDescriptor) == 0 && IsWritten;
+            IsWritten = close(FileDescriptor) == 0 && IsWritten;
+            IsWritten = IsWritten && rename(TemporaryPath.c_str(), Path.c_str()) == 0;
+            if (!IsWritten) unlink(TemporaryPath.c_str());
+        }
+        if (!IsWritten) LOG_WARN(HIVE_LOGTAG, "Failed to write cached texture %s: %s", Path.c_str(), std::strerror(errno));
+
+        std::lock_guard<std::mutex> Lock(m_StatsMutex);
+        if (IsWritten)
+        {
+            ++m_Stats.StoreCount;
+            m_Stats.BytesStored += Header.PayloadOffset + Header.PayloadSize;
+        }
+        else
+            ++m_Stats.StoreFailureCount;
+        m_Stats.StoreMs += getElapsedMs(StartTime);
+        return IsWritten;
+    }
+
+    size_t CDiskTextureCache::trim(uint64_t vMaxBytes)
+    {
+        struct SEntry
+        {
+            std::string Path;
+            uint64_t    Size;
+            int64_t     WriteTime;
+        };
+        std::vector<SEntry> Entries;
+        DIR *pDirectory = opendir(m_Directory.c_str());
+        if (pDirectory == nullptr) return 0;
+        size_t RemovedCount = 0;
+        while (dirent *pEntry = readdir(pDirectory))
+        {
+            const std::string Path = m_Directory + "/" + pEntry->d_name;
+            // Leftovers of a store that never got to its rename
+            if (hasSuffix(pEntry->d_name, ".tmp"))
+                RemovedCount += unlink(Path.c_str()) == 0;
+            struct stat FileStat{};
+            if (hasSuffix(pEntry->d_name, EntryExtension) && stat(Path.c_str(), &FileStat) == 0)
+                Entries.push_back({Path, static_cast<uint64_t>(FileStat.st_size), static_cast<int64_t>(FileStat.st_mtime)});
+        }
+        closedir(pDirectory);
+
+        std::sort(Entries.begin(), Entries.end(), [](const SEntry &vLeft, const SEntry &vRight) { return vLeft.WriteTime > vRight.WriteTime; });
+        uint64_t KeptBytes = 0;
+        for (const SEntry &Entry : Entries)
+        {
+            if (KeptBytes + Entry.Size <= vMaxBytes)
+                KeptBytes += Entry.Size;
+            else
+                RemovedCount += unlink(Entry.Path.c_str()) == 0;
+        }
+        return RemovedCount;
+    }
+
+    SDiskTextureCacheStats CDiskTextureCache::getStats() const
+    {
+        std::lock_guard<std::mutex> Lock(m_StatsMutex);
+        return m_Stats;
+    }
+
+    void CDiskTextureCache::logStats() const
+    {
+        const SDiskTextureCacheStats Stats = getStats();
+        LOG_INFO(HIVE_LOGTAG, "Disk cache %s: %llu hits (%.1f MiB in %.2f ms), %llu misses, %llu rejected, %llu stored (%.1f MiB in %.2f ms), %llu store failures",
+                 m_Directory.c_str(), static_cast<unsigned long long>(Stats.HitCount), Stats.BytesLoaded / 1048576.0, Stats.LoadMs,
+                 static_cast<unsigned long long>(Stats.MissCount), static_cast<unsigned long long>(Stats.RejectCount), static_cast<unsigned long long>(Stats.StoreCount),
+                 Stats.BytesStored / 1048576.0, Stats.StoreMs, static_cast<unsigned long long>(Stats.StoreFailureCount));
+    }
+}
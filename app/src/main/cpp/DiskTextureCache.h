@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AssetSource.h"
+#include "ImageData.h"
+
+namespace hiveVG
+{
+    enum class EDiskTextureCompression
+    {
+        None,   // the payload is uploaded straight from the mapping
+        LZ4     // kept only if it saves a quarter of the bytes, costs one decompression per load
+    };
+
+    struct SDiskTextureCacheStats
+    {
+        uint64_t HitCount          = 0;
+        uint64_t MissCount         = 0;
+        uint64_t RejectCount       = 0;   // present but stale or damaged, the file is deleted
+        uint64_t StoreCount        = 0;
+        uint64_t StoreFailureCount = 0;
+        uint64_t BytesLoaded       = 0;   // stored bytes, before decompression
+        uint64_t BytesStored       = 0;
+        double   LoadMs            = 0.0;
+        double   StoreMs           = 0.0;
+    };
+
+    struct SCachedTextureLevel
+    {
+        int    Width      = 0;
+        int    Height     = 0;
+        size_t ByteOffset = 0;   // into the payload
+    };
+
+    // RGBA8 levels of one cache entry, getLevelData() points into pBuffer.
+    struct SCachedTexture
+    {
+        std::unique_ptr<CAssetBuffer>    pBuffer;   // the mapped file, or the decompressed payload of an LZ4 entry
+        size_t                           PayloadOffset = 0;
+        std::vector<SCachedTextureLevel> Levels;
+
+        [[nodiscard]] int            getWidth() const { return Levels.empty() ? 0 : Levels[0].Width; }
+        [[nodiscard]] int            getHeight() const { return Levels.empty() ? 0 : Levels[0].Height; }
+        [[nodiscard]] const uint8_t* getLevelData(size_t vLevel) const { return pBuffer->getData() + PayloadOffset + Levels[vLevel].ByteOffset; }
+        [[nodiscard]] size_t         getLevelSize(size_t vLevel) const { return static_cast<size_t>(Levels[vLevel].Width) * Levels[vLevel].Height * 4; }
+    };
+
+    /*!
+     * Decoded textures kept on disk between launches, one file per key in a flat directory.
+     * The key is whatever identifies the decode result (asset path, a hash of the encoded bytes, loader settings),
+     * it is stored in full in the file so a hash collision reads as a miss. A file holds a fixed header, the key,
+     * a level table and the RGBA8 levels back to back, raw or as one LZ4 block.
+     * Files are written under a temporary name and renamed into place, so a reader only ever sees complete files.
+     * Anything that does not validate (magic, FormatVersion, header checksum, key, level table, file size) is deleted.
+     * load() and store() may be called from several worker threads at once.
+     */
+    class CDiskTextureCache
+    {
+    public:
+        // Bump whenever the file layout or the meaning of the stored pixels changes
+        static constexpr uint32_t FormatVersion = 1;
+
+        CDiskTextureCache(std::string vDirectory, EDiskTextureCompression vCompression);
+
+        bool   load(const std::string &vKey, SCachedTexture &voTexture);
+        // vMipLevels may be shorter than the full chain, they must halve vBase level by level
+        bool   store(const std::string &vKey, const SImageData &vBase, const std::vector<SImageData> &vMipLevels);
+        // Deletes the least recently written entries until at most vMaxBytes remain, not while stores are running
+        size_t trim(uint64_t vMaxBytes);
+        void   clear() { trim(0); }
+
+        [[nodiscard]] std::string            getEntryPath(const std::string &vKey) const;
+        [[nodiscard]] const std::string&     getDirectory() const { return m_Directory; }
+        [[nodiscard]] SDiskTextureCacheStats getStats() const;
+        void                                 logStats() const;
+
+        // 64 bit hash of arbitrary bytes, e.g. to put the encoded asset into the key
+        static uint64_t hashBytes(const uint8_t *vData, size_t vSize, uint64_t vSeed = 0);
+
+    private:
+        bool   __validate(const std::string &vKey, const CAssetBuffer &vFile, SCachedTexture &voTexture) const;
+        void   __reject(const std::string &vPath, const char *vReason);
+
+        std::string                    m_Directory;
+        EDiskTextureCompression        m_Compression = EDiskTextureCompression::None;
+        mutable std::mutex             m_StatsMutex;
+        SDiskTextureCacheStats         m_Stats;
+    };
+}
@@ -0,0 +1,188 @@
+#include "FrameSequence.h"
+#include <algorithm>
+#include <cstring>
+#include "Lz4Block.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HIVE_SEQUENCE_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HIVE_SEQUENCE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace hiveVG
+{
+    namespace
+    {
+        template<typename T>
+        T readLE(const uint8_t *vData)
+        {
+            T Value = 0;
+            for (size_t i = 0; i < sizeof(T); ++i) Value |= static_cast<T>(vData[i]) << (8 * i);
+            return Value;
+        }
+
+        bool hasSuffix(const std::string &vPath, const char *vSuffix)
+        {
+            const size_t SuffixLength = std::strlen(vSuffix);
+            return vPath.size() >= SuffixLength && vPath.compare(vPath.size() - SuffixLength, SuffixLength, vSuffix) == 0;
+        }
+    }
+
+    void xorBytes(uint8_t *vioDst, const uint8_t *vSrc, size_t vSize)
+    {
+        size_t i = 0;
+#if defined(HIVE_SEQUENCE_SSE2)
+        for (; i + 16 <= vSize; i += 16)
+        {
+            const __m128i Dst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(vioDst + i));
+            const __m128i Src = _mm_loadu_si128(reinterpret_cast<const __m128i *>(vSrc + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(vioDst + i), _mm_xor_si128(Dst, Src));
+        }
+#elif defined(HIVE_SEQUENCE_NEON)
+        for (; i + 16 <= vSize; i += 16) vst1q_u8(vioDst + i, veorq_u8(vld1q_u8(vioDst + i), vld1q_u8(vSrc + i)));
+#endif
+        for (; i < vSize; ++i) vioDst[i] ^= vSrc[i];
+    }
+
+    int SFrameSequence::getKeyframe(int vFrame) const
+    {
+        while (vFrame > 0 && !Frames[vFrame].IsKeyframe) --vFrame;
+        return vFrame;
+    }
+
+    bool parseFrameSequence(const uint8_t *vData, size_t vSize, SFrameSequence &voSequence, std::string &voError)
+    {
+        using namespace FRAME_SEQUENCE_FORMAT;
+        if (vData == nullptr || vSize < HeaderSize || std::memcmp(vData, Magic, sizeof(Magic)) != 0)
+        {
+            voError = "not a frame sequence";
+            return false;
+        }
+        const uint32_t FileVersion = readLE<uint32_t>(vData + 8);
+        const uint32_t Width       = readLE<uint32_t>(vData + 12);
+        const uint32_t Height      = readLE<uint32_t>(vData + 16);
+        const uint32_t FrameCount  = readLE<uint32_t>(vData + 20);
+        const uint32_t TileSize    = readLE<uint32_t>(vData + 24);
+        if (FileVersion != Version)
+        {
+            voError = "unsupported version " + std::to_string(FileVersion);
+            return false;
+        }
+        if (Width == 0 || Height == 0 || Width > 16384 || Height > 16384 || FrameCount == 0 || TileSize < 4 || TileSize > 256 || (TileSize & (TileSize - 1)) != 0)
+        {
+            voError = "invalid frame size, frame count or tile size";
+            return false;
+        }
+        if (FrameCount > (vSize - HeaderSize) / RecordSize)
+        {
+            voError = "frame index runs past the end of the file";
+            return false;
+        }
+
+        voSequence.FrameWidth  = static_cast<int>(Width);
+        voSequence.FrameHeight = static_cast<int>(Height);
+        voSequence.TileSize    = static_cast<int>(TileSize);
+        voSequence.Frames.assign(FrameCount, {});
+        const size_t FrameBytes = static_cast<size_t>(Width) * Height * 4;
+        const size_t TileCount  = static_cast<size_t>(voSequence.getTileColumns()) * voSequence.getTileRows();
+        for (uint32_t i = 0; i < FrameCount; ++i)
+        {
+            const uint8_t *pRecord = vData + HeaderSize + RecordSize * i;
+            SFrameSequenceRecord &Record = voSequence.Frames[i];
+            Record.ByteOffset       = static_cast<size_t>(readLE<uint64_t>(pRecord));
+            Record.StoredSize       = readLE<uint32_t>(pRecord + 8);
+            Record.RawSize          = readLE<uint32_t>(pRecord + 12);
+            Record.IsKeyframe       = (readLE<uint32_t>(pRecord + 16) & KeyframeFlag) != 0;
+            Record.ChangedTileCount = static_cast<int>(readLE<uint32_t>(pRecord + 20));
+
+            const bool IsInFile  = Record.ByteOffset <= vSize && Record.StoredSize <= vSize - Record.ByteOffset;
+            const bool IsSized   = Record.IsKeyframe ? Record.RawSize == FrameBytes
+                                                     : Record.RawSize <= FrameBytes && static_cast<size_t>(Record.ChangedTileCount) <= TileCount &&
+                                                       Record.StoredSize >= voSequence.getTileMaskSize();
+            if (!IsInFile || !IsSized || (i == 0 && !Record.IsKeyframe))
+            {
+                voError = "invalid index record for frame " + std::to_string(i);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isFrameSequencePath(const std::string &vPath)
+    {
+        return hasSuffix(vPath, ".hseq");
+    }
+
+    std::string getFrameSequenceFallbackPath(const std::string &vPath)
+    {
+        return isFrameSequencePath(vPath) ? vPath.substr(0, vPath.size() - 5) + ".png" : vPath;
+    }
+
+    CFrameSequenceDecoder::CFrameSequenceDecoder(const uint8_t *vData, const SFrameSequence &vSequence) : m_pData(vData), m_Sequence(vSequence)
+    {
+        m_Frame.Width  = vSequence.FrameWidth;
+        m_Frame.Height = vSequence.FrameHeight;
+        m_Frame.Pixels.resize(m_Frame.getByteSize());
+    }
+
+    bool CFrameSequenceDecoder::decodeFrame(int vFrame)
+    {
+        if (vFrame < 0 || vFrame >= m_Sequence.getFrameCount()) return false;
+        if (vFrame == m_CurrentFrame) return true;
+        const int Keyframe = m_Sequence.getKeyframe(vFrame);
+        const int FirstFrame = (m_CurrentFrame >= Keyframe && m_CurrentFrame < vFrame) ? m_CurrentFrame + 1 : Keyframe;
+        for (int Frame = FirstFrame; Frame <= vFrame; ++Frame)
+        {
+            if (!__applyFrame(Frame))
+            {
+                m_CurrentFrame = -1;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CFrameSequenceDecoder::__applyFrame(int vFrame)
+    {
+        const SFrameSequenceRecord &Record = m_Sequence.Frames[vFrame];
+        const uint8_t *pPayload = m_pData + Record.ByteOffset;
+        ++m_AppliedFrameCount;
+        if (Record.IsKeyframe)
+        {
+            if (!decompressLz4Block(pPayload, Record.StoredSize, m_Frame.Pixels.data(), m_Frame.Pixels.size())) return false;
+            m_CurrentFrame = vFrame;
+            return true;
+        }
+
+        const size_t MaskSize = m_Sequence.getTileMaskSize();
+        m_TileBuffer.resize(Record.RawSize);
+        if (Record.RawSize > 0 && !decompressLz4Block(pPayload + MaskSize, Record.StoredSize - MaskSize, m_TileBuffer.data(), m_TileBuffer.size())) return false;
+
+        // Walks the changed tiles in mask order, each one's rows are back to back in the tile buffer
+        const int TileSize = m_Sequence.TileSize, TileColumns = m_Sequence.getTileColumns(), TileRows = m_Sequence.getTileRows();
+        const size_t RowPitch = m_Frame.getRowPitch();
+        size_t Consumed = 0;
+        int ChangedCount = 0;
+        for (int TileY = 0; TileY < TileRows; ++TileY)
+        {
+            for (int TileX = 0; TileX < TileColumns; ++TileX)
+            {
+                const size_t TileIndex = static_cast<size_t>(TileY) * TileColumns + TileX;
+                if ((pPayload[TileIndex / 8] & (1u << (TileIndex % 8))) == 0) continue;
+                const int X0 = TileX * TileSize, Y0 = TileY * TileSize;
+                const size_t TileRowBytes = static_cast<size_t>(std::min(TileSize, m_Frame.Width - X0)) * 4;
+                const int    TileHeight   = std::min(TileSize, m_Frame.Height - Y0);
+                if (Consumed + TileRowBytes * TileHeight > m_TileBuffer.size()) return false;
+                for (int y = 0; y < TileHeight; ++y, Consumed += TileRowBytes)
+                    xorBytes(m_Frame.Pixels.data() + RowPitch * (Y0 + y) + static_cast<size_t>(X0) * 4, m_TileBuffer.data() + Consumed, TileRowBytes);
+                ++ChangedCount;
+            }
+        }
+        if (Consumed != m_TileBuffer.size() || ChangedCount != Record.ChangedTileCount) return false;
+        m_CurrentFrame = vFrame;
+        return true;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ImageData.h"
+
+namespace hiveVG
+{
+    /*!
+     * .hseq frame sequence container, all fields little endian:
+     *   header    Magic "HIVESEQ\n", then u32 FormatVersion, FrameWidth, FrameHeight, FrameCount, TileSize, Reserved
+     *   index     FrameCount records of u64 ByteOffset, u32 StoredSize, u32 RawSize, u32 Flags, u32 ChangedTileCount
+     *   payloads  keyframe: the straight alpha RGBA8 frame as one LZ4 block
+     *             delta:    a bit per TileSize x TileSize tile (row major, LSB first) telling which tiles changed since
+     *                       the previous frame, then one LZ4 block of those tiles XORed with the previous frame
+     * Frame 0 is always a keyframe. Written by tools/SequenceEncoder.
+     */
+    namespace FRAME_SEQUENCE_FORMAT
+    {
+        constexpr char     Magic[8]        = {'H', 'I', 'V', 'E', 'S', 'E', 'Q', '\n'};
+        constexpr uint32_t Version         = 1;
+        constexpr size_t   HeaderSize      = 8 + 6 * 4;
+        constexpr size_t   RecordSize      = 8 + 4 * 4;
+        constexpr uint32_t KeyframeFlag    = 1;
+    }
+
+    struct SFrameSequenceRecord
+    {
+        size_t ByteOffset       = 0;
+        size_t StoredSize       = 0;
+        size_t RawSize          = 0;
+        bool   IsKeyframe       = false;
+        int    ChangedTileCount = 0;
+    };
+
+    struct SFrameSequence
+    {
+        int                               FrameWidth  = 0;
+        int                               FrameHeight = 0;
+        int                               TileSize    = 0;
+        std::vector<SFrameSequenceRecord> Frames;
+
+        [[nodiscard]] int    getFrameCount() const { return static_cast<int>(Frames.size()); }
+        [[nodiscard]] int    getTileColumns() const { return (FrameWidth + TileSize - 1) / TileSize; }
+        [[nodiscard]] int    getTileRows() const { return (FrameHeight + TileSize - 1) / TileSize; }
+        [[nodiscard]] size_t getTileMaskSize() const { return (static_cast<size_t>(getTileColumns()) * getTileRows() + 7) / 8; }
+        // Nearest keyframe at or before vFrame
+        [[nodiscard]] int    getKeyframe(int vFrame) const;
+    };
+
+    /*!
+     * Validates the header and the frame index, payloads are checked as they are decoded.
+     * Record offsets refer to vData, which has to stay alive while frames are decoded.
+     * @return false with a reason in voError if the file is malformed
+     */
+    bool parseFrameSequence(const uint8_t *vData, size_t vSize, SFrameSequence &voSequence, std::string &voError);
+    bool isFrameSequencePath(const std::string &vPath);
+    // Atlas used when the sequence cannot be read, "a/b.hseq" -> "a/b.png".
+    std::string getFrameSequenceFallbackPath(const std::string &vPath);
+
+    /*!
+     * Rebuilds frames of one sequence into a single reusable RGBA8 buffer, one instance per thread.
+     * Playing forward costs one delta per frame. Any other jump replays from the keyframe at or before the target,
+     * or from the current frame when that is closer.
+     */
+    class CFrameSequenceDecoder
+    {
+    public:
+        // Neither vData nor vSequence are copied, both must outlive the decoder
+        CFrameSequenceDecoder(const uint8_t *vData, const SFrameSequence &vSequence);
+
+        bool                            decodeFrame(int vFrame);
+        [[nodiscard]] const SImageData& getFrame() const { return m_Frame; }
+        [[nodiscard]] int               getCurrentFrame() const { return m_CurrentFrame; }
+        // Payloads applied so far, more than the frames asked for when random access had to replay deltas
+        [[nodiscard]] uint64_t          getAppliedFrameCount() const { return m_AppliedFrameCount; }
+
+    private:
+        bool __applyFrame(int vFrame);
+
+        const uint8_t*        m_pData = nullptr;
+        const SFrameSequence& m_Sequence;
+        SImageData            m_Frame;
+        std::vector<uint8_t>  m_TileBuffer;
+        int                   m_CurrentFrame      = -1;
+        uint64_t              m_AppliedFrameCount = 0;
+    };
+
+    // vioDst ^= vSrc over vSize bytes, the SIMD core of delta frames
+    void xorBytes(uint8_t *vioDst, const uint8_t *vSrc, size_t vSize);
+}
@@ -0,0 +1,130 @@
+#include "GLStateCache.h"
+#include <algorithm>
+#include <cassert>
+
+namespace hiveVG
+{
+    bool CGLStateCache::__isChanged(uint32_t &vioShadow, uint32_t vValue)
+    {
+        if (vioShadow == vValue)
+        {
+            ++m_FrameStats.ElidedCount;
+            return false;
+        }
+        vioShadow = vValue;
+        ++m_FrameStats.IssuedCount;
+        return true;
+    }
+
+    void CGLStateCache::useProgram(uint32_t vProgram)
+    {
+        if (__isChanged(m_Program, vProgram)) m_Dispatch.UseProgram(vProgram);
+    }
+
+    void CGLStateCache::bindVertexArray(uint32_t vArray)
+    {
+        if (__isChanged(m_VertexArray, vArray)) m_Dispatch.BindVertexArray(vArray);
+    }
+
+    void CGLStateCache::bindTexture(int vUnit, uint32_t vTarget, uint32_t vTexture)
+    {
+        auto Iterator = std::find_if(m_TextureBindings.begin(), m_TextureBindings.end(),
+                                     [&](const STextureBinding &vBinding) { return vBinding.Unit == vUnit && vBinding.Target == vTarget; });
+        if (Iterator != m_TextureBindings.end() && Iterator->Texture == vTexture)
+        {
+            // Bound already, so the unit does not need to be active either: both calls are saved
+            m_FrameStats.ElidedCount += 2;
+            return;
+        }
+        if (__isChanged(m_ActiveUnit, static_cast<uint32_t>(vUnit))) m_Dispatch.ActiveTexture(Texture0Enum + static_cast<uint32_t>(vUnit));
+        m_Dispatch.BindTexture(vTarget, vTexture);
+        ++m_FrameStats.IssuedCount;
+        if (Iterator != m_TextureBindings.end()) Iterator->Texture = vTexture;
+        else m_TextureBindings.push_back({vUnit, vTarget, vTexture});
+    }
+
+    void CGLStateCache::setEnabled(uint32_t vCapability, bool vIsEnabled)
+    {
+        auto Iterator = std::find_if(m_Capabilities.begin(), m_Capabilities.end(), [&](const auto &vState) { return vState.first == vCapability; });
+        if (Iterator != m_Capabilities.end() && Iterator->second == vIsEnabled)
+        {
+            ++m_FrameStats.ElidedCount;
+            return;
+        }
+        (vIsEnabled ? m_Dispatch.Enable : m_Dispatch.Disable)(vCapability);
+        ++m_FrameStats.IssuedCount;
+        if (Iterator != m_Capabilities.end()) Iterator->second = vIsEnabled;
+        else m_Capabilities.emplace_back(vCapability, vIsEnabled);
+    }
+
+    void CGLStateCache::setBlendFunc(uint32_t vSource, uint32_t vDestination)
+    {
+        if (__isBlendFuncSet(vSource, vDestination, vSource, vDestination)) return;
+        m_Dispatch.BlendFunc(vSource, vDestination);
+    }
+
+    void CGLStateCache::setBlendFuncSeparate(uint32_t vSourceRGB, uint32_t vDestinationRGB, uint32_t vSourceAlpha, uint32_t vDestinationAlpha)
+    {
+        if (__isBlendFuncSet(vSourceRGB, vDestinationRGB, vSourceAlpha, vDestinationAlpha)) return;
+        m_Dispatch.BlendFuncSeparate(vSourceRGB, vDestinationRGB, vSourceAlpha, vDestinationAlpha);
+    }
+
+    bool CGLStateCache::__isBlendFuncSet(uint32_t vSourceRGB, uint32_t vDestinationRGB, uint32_t vSourceAlpha, uint32_t vDestinationAlpha)
+    {
+        if (m_BlendSourceRGB == vSourceRGB && m_BlendDestinationRGB == vDestinationRGB && m_BlendSourceAlpha == vSourceAlpha && m_BlendDestinationAlpha == vDestinationAlpha)
+        {
+            ++m_FrameStats.ElidedCount;
+            return true;
+        }
+        m_BlendSourceRGB        = vSourceRGB;
+        m_BlendDestinationRGB   = vDestinationRGB;
+        m_BlendSourceAlpha      = vSourceAlpha;
+        m_BlendDestinationAlpha = vDestinationAlpha;
+        ++m_FrameStats.IssuedCount;
+        return false;
+    }
+
+    void CGLStateCache::registerProgram(uint32_t vProgram, const char *const *vNames, size_t vCount)
+    {
+        std::vector<int32_t> Locations(vCount);
+        for (size_t i = 0; i < vCount; ++i) Locations[i] = m_Dispatch.GetUniformLocation(vProgram, vNames[i]);
+        auto Iterator = std::find_if(m_ProgramUniforms.begin(), m_ProgramUniforms.end(), [&](const auto &vProgramUniforms) { return vProgramUniforms.first == vProgram; });
+        if (Iterator != m_ProgramUniforms.end()) Iterator->second = std::move(Locations);
+        else m_ProgramUniforms.emplace_back(vProgram, std::move(Locations));
+    }
+
+    int32_t CGLStateCache::getUniformLocation(uint32_t vProgram, size_t vUniform) const
+    {
+        for (const auto &[Program, Locations] : m_ProgramUniforms)
+        {
+            if (Program != vProgram) continue;
+            assert(vUniform < Locations.size());
+            return Locations[vUniform];
+        }
+        assert(false && "program was not registered");
+        return -1;
+    }
+
+    void CGLStateCache::invalidate()
+    {
+        m_Program          = Unknown;
+        m_VertexArray      = Unknown;
+        m_BlendSourceRGB   = m_BlendDestinationRGB = Unknown;
+        m_BlendSourceAlpha = m_BlendDestinationAlpha = Unknown;
+        m_Capabilities.clear();
+        invalidateTextureBindings();
+    }
+
+    void CGLStateCache::invalidateTextureBindings()
+    {
+        m_ActiveUnit = Unknown;
+        m_TextureBindings.clear();
+    }
+
+    SGLStateStats CGLStateCache::endFrame()
+    {
+        const SGLStateStats Stats = m_FrameStats;
+        m_FrameStats = SGLStateStats();
+        return Stats;
+    }
+}
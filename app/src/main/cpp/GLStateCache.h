@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace hiveVG
+{
+    /*!
+     * GL entry points CGLStateCache issues, in GL's own signatures with the typedefs spelled out so this header needs
+     * no GL headers. The renderer fills it with the real functions; a host check fills it with a recording stub.
+     */
+    struct SGLDispatch
+    {
+        void    (*UseProgram)(uint32_t vProgram)                        = nullptr;
+        void    (*BindVertexArray)(uint32_t vArray)                     = nullptr;
+        void    (*ActiveTexture)(uint32_t vUnitEnum)                    = nullptr;
+        void    (*BindTexture)(uint32_t vTarget, uint32_t vTexture)     = nullptr;
+        void    (*Enable)(uint32_t vCapability)                         = nullptr;
+        void    (*Disable)(uint32_t vCapability)                        = nullptr;
+        void    (*BlendFunc)(uint32_t vSource, uint32_t vDestination)   = nullptr;
+        void    (*BlendFuncSeparate)(uint32_t vSourceRGB, uint32_t vDestinationRGB, uint32_t vSourceAlpha, uint32_t vDestinationAlpha) = nullptr;
+        int32_t (*GetUniformLocation)(uint32_t vProgram, const char *vName) = nullptr;
+    };
+
+    struct SGLStateStats
+    {
+        uint32_t IssuedCount = 0;   // state calls that reached GL
+        uint32_t ElidedCount = 0;   // state calls that matched the shadowed state and were dropped
+    };
+
+    /*!
+     * Shadows the bound program, vertex array, texture units and blend state, and only passes on calls that change
+     * them. GL calls made around the cache leave the shadow stale: texture uploads rebind the active unit, so
+     * invalidateTextureBindings() has to follow them, and invalidate() anything else.
+     * Uniform locations are resolved once per program by registerProgram() and read back by index.
+     * GL thread only.
+     */
+    class CGLStateCache
+    {
+    public:
+        explicit CGLStateCache(const SGLDispatch &vDispatch) : m_Dispatch(vDispatch) {}
+
+        void    useProgram(uint32_t vProgram);
+        void    bindVertexArray(uint32_t vArray);
+        void    bindTexture(int vUnit, uint32_t vTarget, uint32_t vTexture);
+        void    setEnabled(uint32_t vCapability, bool vIsEnabled);
+        void    setBlendFunc(uint32_t vSource, uint32_t vDestination);
+        void    setBlendFuncSeparate(uint32_t vSourceRGB, uint32_t vDestinationRGB, uint32_t vSourceAlpha, uint32_t vDestinationAlpha);
+
+        // Looks up the vCount uniforms of vNames in vProgram, getUniformLocation(vProgram, i) then returns the i-th
+        void    registerProgram(uint32_t vProgram, const char *const *vNames, size_t vCount);
+        // -1 for a uniform the program does not have (or the compiler dropped), which glUniform* ignores
+        [[nodiscard]] int32_t getUniformLocation(uint32_t vProgram, size_t vUniform) const;
+
+        void    invalidate();
+        void    invalidateTextureBindings();
+        // Counts of the frame that ends, the next one starts from zero
+        SGLStateStats endFrame();
+        [[nodiscard]] const SGLStateStats& getFrameStats() const { return m_FrameStats; }
+
+    private:
+        static constexpr uint32_t Unknown      = 0xFFFFFFFFu;   // no GL object or enum has this value
+        static constexpr uint32_t Texture0Enum = 0x84C0;        // GL_TEXTURE0
+
+        struct STextureBinding
+        {
+            int      Unit    = 0;
+            uint32_t Target  = 0;
+            uint32_t Texture = 0;
+        };
+
+        // Counts the call and tells whether it has to be issued
+        bool    __isChanged(uint32_t &vioShadow, uint32_t vValue);
+        // Counts the call and tells whether the blend factors are set already, shadowing them otherwise
+        bool    __isBlendFuncSet(uint32_t vSourceRGB, uint32_t vDestinationRGB, uint32_t vSourceAlpha, uint32_t vDestinationAlpha);
+
+        SGLDispatch                                         m_Dispatch;
+        SGLStateStats                                       m_FrameStats;
+        uint32_t                                            m_Program          = Unknown;
+        uint32_t                                            m_VertexArray      = Unknown;
+        uint32_t                                            m_ActiveUnit       = Unknown;
+        uint32_t                                            m_BlendSourceRGB   = Unknown;
+        uint32_t                                            m_BlendDestinationRGB = Unknown;
+        uint32_t                                            m_BlendSourceAlpha = Unknown;
+        uint32_t                                            m_BlendDestinationAlpha = Unknown;
+        std::vector<STextureBinding>                        m_TextureBindings;   // known bindings only
+        std::vector<std::pair<uint32_t, bool>>              m_Capabilities;      // known enable states only
+        std::vector<std::pair<uint32_t, std::vector<int32_t>>> m_ProgramUniforms;
+    };
+}
@@ -0,0 +1,113 @@
+#include "HullMesh.h"
+#include <cmath>
+#include <cstring>
+
+namespace hiveVG
+{
+    namespace
+    {
+        template<typename T>
+        T readLE(const uint8_t *vData)
+        {
+            T Value = 0;
+            for (size_t i = 0; i < sizeof(T); ++i) Value |= static_cast<T>(vData[i]) << (8 * i);
+            return Value;
+        }
+
+        template<typename T>
+        void appendLE(std::vector<uint8_t> &vioBytes, T vValue)
+        {
+            for (size_t i = 0; i < sizeof(T); ++i) vioBytes.push_back(static_cast<uint8_t>(static_cast<uint64_t>(vValue) >> (8 * i)));
+        }
+    }
+
+    bool parseHullMesh(const uint8_t *vData, size_t vSize, SHullMesh &voMesh, std::string &voError)
+    {
+        using namespace HULL_MESH_FORMAT;
+        if (vData == nullptr || vSize < HeaderSize || std::memcmp(vData, Magic, sizeof(Magic)) != 0)
+        {
+            voError = "not a hull mesh";
+            return false;
+        }
+        const uint32_t FileVersion = readLE<uint32_t>(vData + 8);
+        const uint32_t FrameWidth  = readLE<uint32_t>(vData + 12);
+        const uint32_t FrameHeight = readLE<uint32_t>(vData + 16);
+        const uint32_t FrameCount  = readLE<uint32_t>(vData + 20);
+        const uint32_t VertexCount = readLE<uint32_t>(vData + 24);
+        if (FileVersion != Version)
+        {
+            voError = "unsupported version " + std::to_string(FileVersion);
+            return false;
+        }
+        if (FrameWidth == 0 || FrameHeight == 0 || FrameWidth > 65535 || FrameHeight > 65535 || FrameCount == 0 || VertexCount > (1u << 26))
+        {
+            voError = "invalid frame size, frame count or vertex count";
+            return false;
+        }
+        if (vSize != HeaderSize + static_cast<size_t>(FrameCount) * FrameRecordSize + static_cast<size_t>(VertexCount) * VertexRecordSize)
+        {
+            voError = "size does not match " + std::to_string(FrameCount) + " frames and " + std::to_string(VertexCount) + " vertices";
+            return false;
+        }
+
+        voMesh.FrameWidth  = static_cast<int>(FrameWidth);
+        voMesh.FrameHeight = static_cast<int>(FrameHeight);
+        voMesh.Frames.resize(FrameCount);
+        const uint8_t *pRecord = vData + HeaderSize;
+        for (uint32_t i = 0; i < FrameCount; ++i, pRecord += FrameRecordSize)
+        {
+            SHullFrame &Frame = voMesh.Frames[i];
+            Frame.FirstVertex   = readLE<uint32_t>(pRecord);
+            Frame.VertexCount   = readLE<uint32_t>(pRecord + 4);
+            Frame.VisibleTexels = readLE<uint32_t>(pRecord + 8);
+            if (Frame.VertexCount % 3 != 0 || Frame.FirstVertex > VertexCount || Frame.VertexCount > VertexCount - Frame.FirstVertex ||
+                Frame.VisibleTexels > FrameWidth * FrameHeight)
+            {
+                voError = "frame " + std::to_string(i) + " has an invalid vertex range or texel count";
+                return false;
+            }
+        }
+        voMesh.Vertices.resize(static_cast<size_t>(VertexCount) * 2);
+        for (uint32_t i = 0; i < VertexCount; ++i, pRecord += VertexRecordSize)
+        {
+            voMesh.Vertices[i * 2]     = readLE<uint16_t>(pRecord);
+            voMesh.Vertices[i * 2 + 1] = readLE<uint16_t>(pRecord + 2);
+            if (voMesh.Vertices[i * 2] > FrameWidth || voMesh.Vertices[i * 2 + 1] > FrameHeight)
+            {
+                voError = "vertex " + std::to_string(i) + " is outside the frame";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> serializeHullMesh(const SHullMesh &vMesh)
+    {
+        using namespace HULL_MESH_FORMAT;
+        const size_t VertexCount = vMesh.Vertices.size() / 2;
+        std::vector<uint8_t> Bytes(Magic, Magic + sizeof(Magic));
+        Bytes.reserve(HeaderSize + vMesh.Frames.size() * FrameRecordSize + VertexCount * VertexRecordSize);
+        for (uint32_t Value : {Version, static_cast<uint32_t>(vMesh.FrameWidth), static_cast<uint32_t>(vMesh.FrameHeight),
+                               static_cast<uint32_t>(vMesh.Frames.size()), static_cast<uint32_t>(VertexCount)})
+            appendLE(Bytes, Value);
+        for (const SHullFrame &Frame : vMesh.Frames)
+            for (uint32_t Value : {Frame.FirstVertex, Frame.VertexCount, Frame.VisibleTexels})
+                appendLE(Bytes, Value);
+        for (uint16_t Value : vMesh.Vertices) appendLE(Bytes, Value);
+        return Bytes;
+    }
+
+    double computeHullArea(const SHullMesh &vMesh, int vFrame)
+    {
+        const SHullFrame &Frame = vMesh.Frames[vFrame];
+        double Area = 0.0;
+        for (uint32_t i = Frame.FirstVertex; i < Frame.FirstVertex + Frame.VertexCount; i += 3)
+        {
+            const uint16_t *pVertex = vMesh.Vertices.data() + static_cast<size_t>(i) * 2;
+            const double AX = pVertex[2] - pVertex[0], AY = pVertex[3] - pVertex[1];
+            const double BX = pVertex[4] - pVertex[0], BY = pVertex[5] - pVertex[1];
+            Area += std::abs(AX * BY - AY * BX) * 0.5;
+        }
+        return Area;
+    }
+}
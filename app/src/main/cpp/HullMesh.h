@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hiveVG
+{
+    /*!
+     * .hhul hull meshes of a sequence, all fields little endian:
+     *   header    Magic "HIVEHUL\n", then u32 FormatVersion, FrameWidth, FrameHeight, FrameCount, VertexCount
+     *   frames    FrameCount records of u32 FirstVertex, VertexCount, VisibleTexels
+     *   vertices  VertexCount records of u16 X, Y in texel corners of the frame, y down
+     * A frame's vertices are a triangle list covering every texel that can be visible while the frame is on screen:
+     * its own opaque texels and those of the frame it cross fades to, grown by the baker's dilation. Fully
+     * transparent frame pairs have no vertices. VisibleTexels counts the frame's own texels above the alpha threshold.
+     * Written by tools/HullBaker.
+     */
+    namespace HULL_MESH_FORMAT
+    {
+        constexpr char     Magic[8]         = {'H', 'I', 'V', 'E', 'H', 'U', 'L', '\n'};
+        constexpr uint32_t Version          = 1;
+        constexpr size_t   HeaderSize       = 8 + 5 * 4;
+        constexpr size_t   FrameRecordSize  = 3 * 4;
+        constexpr size_t   VertexRecordSize = 2 * 2;
+    }
+
+    struct SHullFrame
+    {
+        uint32_t FirstVertex   = 0;
+        uint32_t VertexCount   = 0;   // a multiple of 3
+        uint32_t VisibleTexels = 0;
+    };
+
+    struct SHullMesh
+    {
+        int                     FrameWidth  = 0;
+        int                     FrameHeight = 0;
+        std::vector<SHullFrame> Frames;
+        std::vector<uint16_t>   Vertices;     // X, Y pairs
+
+        [[nodiscard]] int getFrameCount() const { return static_cast<int>(Frames.size()); }
+    };
+
+    /*!
+     * Validates the header, every frame's vertex range and every vertex against the frame.
+     * @return false with a reason in voError if the file is malformed
+     */
+    bool parseHullMesh(const uint8_t *vData, size_t vSize, SHullMesh &voMesh, std::string &voError);
+    std::vector<uint8_t> serializeHullMesh(const SHullMesh &vMesh);
+    // Area of frame vFrame's triangles in texels, what drawing them rasterises at the frame's resolution
+    double computeHullArea(const SHullMesh &vMesh, int vFrame);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hiveVG
+{
+    // CPU side RGBA8 pixels produced by a decoder and consumed by the GL upload.
+    struct SImageData
+    {
+        int                  Width    = 0;
+        int                  Height   = 0;
+        int                  Channels = 4;
+        std::vector<uint8_t> Pixels;
+
+        [[nodiscard]] bool   isValid() const { return Width > 0 && Height > 0 && Pixels.size() >= getByteSize(); }
+        [[nodiscard]] size_t getRowPitch() const { return static_cast<size_t>(Width) * Channels; }
+        [[nodiscard]] size_t getByteSize() const { return getRowPitch() * Height; }
+    };
+}
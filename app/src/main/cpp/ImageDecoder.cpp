@@ -0,0 +1,320 @@
+#include "ImageDecoder.h"
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <mutex>
+#include "Common.h"
+#include "ImageResize.h"
+#include "PixelConvert.h"
+#include "stb_image.h"
+#ifdef __ANDROID__
+#include <android/bitmap.h>
+#include <android/imagedecoder.h>
+#endif
+
+namespace hiveVG
+{
+#define HIVE_LOGTAG hiveVG::TAG_KEYWORD::TEXTURE_LOADER_TAG
+    namespace
+    {
+        constexpr size_t BackendCount = static_cast<size_t>(EImageDecoderBackend::Count);
+        constexpr size_t FormatCount  = static_cast<size_t>(EImageFormat::Count);
+
+#ifdef __ANDROID__
+        constexpr EImageDecoderBackend DefaultBackend = EImageDecoderBackend::AndroidImageDecoder;
+#else
+        constexpr EImageDecoderBackend DefaultBackend = EImageDecoderBackend::StbImage;
+#endif
+
+        std::atomic<EImageDecoderBackend> g_PreferredBackends[FormatCount] = {
+                {DefaultBackend}, {DefaultBackend}, {DefaultBackend}, {DefaultBackend}};
+        std::mutex                        g_StatsMutex;
+        SImageDecoderStats                g_Stats[BackendCount][FormatCount];
+
+        const char *getBackendName(EImageDecoderBackend vBackend)
+        {
+            IImageDecoder *pDecoder = getImageDecoder(vBackend);
+            return pDecoder != nullptr ? pDecoder->getName() : "unavailable";
+        }
+
+        void recordDecode(EImageDecoderBackend vBackend, EImageFormat vFormat, double vDecodeMs, int vWidth, int vHeight, bool vIsDecoded)
+        {
+            std::lock_guard<std::mutex> Lock(g_StatsMutex);
+            SImageDecoderStats &Stats = g_Stats[static_cast<size_t>(vBackend)][static_cast<size_t>(vFormat)];
+            ++Stats.DecodeCount;
+            Stats.TotalMs += vDecodeMs;
+            if (vIsDecoded)
+                Stats.PixelCount += static_cast<uint64_t>(vWidth) * vHeight;
+            else
+                ++Stats.FailureCount;
+        }
+
+        double getElapsedMs(std::chrono::steady_clock::time_point vStartTime)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - vStartTime).count();
+        }
+
+        class CStbRegionDecoder final : public IImageRegionDecoder
+        {
+        public:
+            CStbRegionDecoder(const uint8_t *vData, size_t vSize, EImageFormat vFormat, int vWidth, int vHeight)
+                : m_pData(vData), m_Size(vSize), m_Format(vFormat), m_SourceWidth(vWidth), m_SourceHeight(vHeight), m_Width(vWidth), m_Height(vHeight) {}
+
+            [[nodiscard]] int getWidth() const override { return m_Width; }
+            [[nodiscard]] int getHeight() const override { return m_Height; }
+
+            bool setTargetSize(int vWidth, int vHeight) override
+            {
+                if (m_Image.isValid() || vWidth <= 0 || vHeight <= 0 || vWidth > m_SourceWidth || vHeight > m_SourceHeight) return false;
+                m_Width  = vWidth;
+                m_Height = vHeight;
+                return true;
+            }
+
+            void setPremultipliedOutput() override { m_IsPremultiplied = true; }
+
+            bool decodeRowsInto(int vFirstRow, int vRowCount, uint8_t *voDst, size_t vRowPitch) override
+            {
+                if (vFirstRow < 0 || vRowCount <= 0 || vFirstRow + vRowCount > m_Height) return false;
+                if (!m_Image.isValid())
+                {
+                    auto StartTime = std::chrono::steady_clock::now();
+                    SImageData Source;
+                    bool IsDecoded = CStbImageDecoder().decode(m_pData, m_Size, Source);
+                    recordDecode(EImageDecoderBackend::StbImage, m_Format, getElapsedMs(StartTime), Source.Width, Source.Height, IsDecoded);
+                    if (!IsDecoded || Source.Width != m_SourceWidth || Source.Height != m_SourceHeight) return false;
+                    m_Image = (m_Width == m_SourceWidth && m_Height == m_SourceHeight) ? std::move(Source) : downscaleImage(Source, m_Width, m_Height);
+                    if (m_IsPremultiplied) premultiplyAlpha(m_Image, EAlphaConversion::Premultiply);
+                }
+                for (int Row = 0; Row < vRowCount; ++Row)
+                    std::memcpy(voDst + vRowPitch * Row, m_Image.Pixels.data() + m_Image.getRowPitch() * (vFirstRow + Row), m_Image.getRowPitch());
+                return true;
+            }
+
+        private:
+            const uint8_t* m_pData           = nullptr;
+            size_t         m_Size            = 0;
+            EImageFormat   m_Format          = EImageFormat::Unknown;
+            int            m_SourceWidth     = 0;
+            int            m_SourceHeight    = 0;
+            int            m_Width           = 0;
+            int            m_Height          = 0;
+            bool           m_IsPremultiplied = false;
+            SImageData     m_Image;
+        };
+
+#ifdef __ANDROID__
+        class CAndroidRegionDecoder final : public IImageRegionDecoder
+        {
+        public:
+            CAndroidRegionDecoder(AImageDecoder *vDecoder, EImageFormat vFormat) : m_pDecoder(vDecoder), m_Format(vFormat)
+            {
+                const AImageDecoderHeaderInfo *pHeader = AImageDecoder_getHeaderInfo(m_pDecoder);
+                m_Width  = AImageDecoderHeaderInfo_getWidth(pHeader);
+                m_Height = AImageDecoderHeaderInfo_getHeight(pHeader);
+            }
+            ~CAndroidRegionDecoder() override { AImageDecoder_delete(m_pDecoder); }
+
+            [[nodiscard]] int getWidth() const override { return m_Width; }
+            [[nodiscard]] int getHeight() const override { return m_Height; }
+
+            bool setTargetSize(int vWidth, int vHeight) override
+            {
+                // Crops set later are in target coordinates, the decoder samples the source while it decodes
+                if (AImageDecoder_setTargetSize(m_pDecoder, vWidth, vHeight) != ANDROID_IMAGE_DECODER_SUCCESS) return false;
+                m_Width  = vWidth;
+                m_Height = vHeight;
+                return true;
+            }
+
+            void setPremultipliedOutput() override { AImageDecoder_setUnpremultipliedRequired(m_pDecoder, false); }
+
+            bool decodeRowsInto(int vFirstRow, int vRowCount, uint8_t *voDst, size_t vRowPitch) override
+            {
+                if (vFirstRow < 0 || vRowCount <= 0 || vFirstRow + vRowCount > m_Height) return false;
+                auto StartTime = std::chrono::steady_clock::now();
+                bool IsDecoded = AImageDecoder_setCrop(m_pDecoder, {0, vFirstRow, m_Width, vFirstRow + vRowCount}) == ANDROID_IMAGE_DECODER_SUCCESS &&
+                                 AImageDecoder_decodeImage(m_pDecoder, voDst, vRowPitch, vRowPitch * vRowCount) == ANDROID_IMAGE_DECODER_SUCCESS;
+                recordDecode(EImageDecoderBackend::AndroidImageDecoder, m_Format, getElapsedMs(StartTime), m_Width, vRowCount, IsDecoded);
+                if (!IsDecoded) LOG_ERROR(HIVE_LOGTAG, "AImageDecoder failed to decode rows %d..%d", vFirstRow, vFirstRow + vRowCount);
+                return IsDecoded;
+            }
+
+        private:
+            AImageDecoder* m_pDecoder = nullptr;
+            EImageFormat   m_Format   = EImageFormat::Unknown;
+            int            m_Width    = 0;
+            int            m_Height   = 0;
+        };
+#endif
+    }
+
+    bool CStbImageDecoder::decode(const uint8_t *vData, size_t vSize, SImageData &voImage)
+    {
+        if (vSize > INT_MAX)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Invalid image buffer of %zu bytes", vSize);
+            return false;
+        }
+
+        int Width = 0, Height = 0, FileChannels = 0;
+        constexpr int RequiredChannels = 4;
+        stbi_uc *pPixels = stbi_load_from_memory(vData, static_cast<int>(vSize), &Width, &Height, &FileChannels, RequiredChannels);
+        if (pPixels == nullptr)
+        {
+            // stbi_failure_reason() is a process wide global in this stb version, so it may belong to another worker.
+            LOG_ERROR(HIVE_LOGTAG, "stb_image failed to decode image: %s", stbi_failure_reason());
+            return false;
+        }
+
+        voImage.Width    = Width;
+        voImage.Height   = Height;
+        voImage.Channels = RequiredChannels;
+        voImage.Pixels.resize(voImage.getByteSize());
+        std::memcpy(voImage.Pixels.data(), pPixels, voImage.Pixels.size());
+        stbi_image_free(pPixels);
+        return true;
+    }
+
+#ifdef __ANDROID__
+    bool CAndroidImageDecoder::decode(const uint8_t *vData, size_t vSize, SImageData &voImage)
+    {
+        AImageDecoder *pDecoder = nullptr;
+        if (AImageDecoder_createFromBuffer(vData, vSize, &pDecoder) != ANDROID_IMAGE_DECODER_SUCCESS)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "AImageDecoder cannot read the image header");
+            return false;
+        }
+        // Straight alpha RGBA8, the same layout stb_image hands out
+        AImageDecoder_setAndroidBitmapFormat(pDecoder, ANDROID_BITMAP_FORMAT_RGBA_8888);
+        AImageDecoder_setUnpremultipliedRequired(pDecoder, true);
+
+        const AImageDecoderHeaderInfo *pHeader = AImageDecoder_getHeaderInfo(pDecoder);
+        voImage.Width    = AImageDecoderHeaderInfo_getWidth(pHeader);
+        voImage.Height   = AImageDecoderHeaderInfo_getHeight(pHeader);
+        voImage.Channels = 4;
+        voImage.Pixels.resize(voImage.getByteSize());
+        bool IsDecoded = voImage.getRowPitch() >= AImageDecoder_getMinimumStride(pDecoder) &&
+                         AImageDecoder_decodeImage(pDecoder, voImage.Pixels.data(), voImage.getRowPitch(), voImage.Pixels.size()) == ANDROID_IMAGE_DECODER_SUCCESS;
+        AImageDecoder_delete(pDecoder);
+        if (!IsDecoded) LOG_ERROR(HIVE_LOGTAG, "AImageDecoder failed to decode a %dx%d image", voImage.Width, voImage.Height);
+        return IsDecoded;
+    }
+#endif
+
+    EImageFormat detectImageFormat(const uint8_t *vData, size_t vSize)
+    {
+        static const uint8_t PngSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        if (vSize >= sizeof(PngSignature) && std::memcmp(vData, PngSignature, sizeof(PngSignature)) == 0) return EImageFormat::PNG;
+        if (vSize >= 3 && vData[0] == 0xFF && vData[1] == 0xD8 && vData[2] == 0xFF) return EImageFormat::JPEG;
+        if (vSize >= 12 && std::memcmp(vData, "RIFF", 4) == 0 && std::memcmp(vData + 8, "WEBP", 4) == 0) return EImageFormat::WebP;
+        return EImageFormat::Unknown;
+    }
+
+    const char *getImageFormatName(EImageFormat vFormat)
+    {
+        switch (vFormat)
+        {
+            case EImageFormat::PNG:  return "png";
+            case EImageFormat::JPEG: return "jpeg";
+            case EImageFormat::WebP: return "webp";
+            default:                 return "unknown";
+        }
+    }
+
+    IImageDecoder *getImageDecoder(EImageDecoderBackend vBackend)
+    {
+        static CStbImageDecoder s_StbDecoder;
+#ifdef __ANDROID__
+        static CAndroidImageDecoder s_AndroidDecoder;
+        if (vBackend == EImageDecoderBackend::AndroidImageDecoder) return &s_AndroidDecoder;
+#endif
+        if (vBackend == EImageDecoderBackend::StbImage) return &s_StbDecoder;
+        return nullptr;
+    }
+
+    void setPreferredImageDecoder(EImageFormat vFormat, EImageDecoderBackend vBackend)
+    {
+        if (vFormat == EImageFormat::Count || getImageDecoder(vBackend) == nullptr)
+        {
+            LOG_WARN(HIVE_LOGTAG, "Ignoring unavailable decoder backend for %s", getImageFormatName(vFormat));
+            return;
+        }
+        g_PreferredBackends[static_cast<size_t>(vFormat)] = vBackend;
+    }
+
+    EImageDecoderBackend resolveImageDecoder(EImageFormat vFormat, EImageDecoderBackend vRequested)
+    {
+        if (vRequested != EImageDecoderBackend::Auto && getImageDecoder(vRequested) != nullptr) return vRequested;
+        return g_PreferredBackends[static_cast<size_t>(vFormat)].load();
+    }
+
+    SImageDecoderStats getImageDecoderStats(EImageDecoderBackend vBackend, EImageFormat vFormat)
+    {
+        std::lock_guard<std::mutex> Lock(g_StatsMutex);
+        return g_Stats[static_cast<size_t>(vBackend)][static_cast<size_t>(vFormat)];
+    }
+
+    void logImageDecoderStats()
+    {
+        std::lock_guard<std::mutex> Lock(g_StatsMutex);
+        for (size_t Backend = 0; Backend < BackendCount; ++Backend)
+        {
+            for (size_t Format = 0; Format < FormatCount; ++Format)
+            {
+                const SImageDecoderStats &Stats = g_Stats[Backend][Format];
+                if (Stats.DecodeCount == 0) continue;
+                LOG_INFO(HIVE_LOGTAG, "%s %s: %llu decodes (%llu failed), %.2f ms avg, %.1f Mpix/s", getBackendName(static_cast<EImageDecoderBackend>(Backend)),
+                         getImageFormatName(static_cast<EImageFormat>(Format)), static_cast<unsigned long long>(Stats.DecodeCount),
+                         static_cast<unsigned long long>(Stats.FailureCount), Stats.TotalMs / Stats.DecodeCount,
+                         Stats.TotalMs > 0.0 ? Stats.PixelCount / (Stats.TotalMs * 1000.0) : 0.0);
+            }
+        }
+    }
+
+    bool IImageRegionDecoder::decodeRows(int vFirstRow, int vRowCount, SImageData &voRows)
+    {
+        if (vFirstRow < 0 || vRowCount <= 0 || vFirstRow + vRowCount > getHeight()) return false;
+        voRows.Width    = getWidth();
+        voRows.Height   = vRowCount;
+        voRows.Channels = 4;
+        voRows.Pixels.resize(voRows.getByteSize());
+        return decodeRowsInto(vFirstRow, vRowCount, voRows.Pixels.data(), voRows.getRowPitch());
+    }
+
+    std::unique_ptr<IImageRegionDecoder> createImageRegionDecoder(const uint8_t *vData, size_t vSize, [[maybe_unused]] EImageDecoderBackend vBackend)
+    {
+        if (vData == nullptr || vSize == 0 || vSize > INT_MAX) return nullptr;
+        const EImageFormat Format = detectImageFormat(vData, vSize);
+#ifdef __ANDROID__
+        if (resolveImageDecoder(Format, vBackend) == EImageDecoderBackend::AndroidImageDecoder)
+        {
+            AImageDecoder *pDecoder = nullptr;
+            if (AImageDecoder_createFromBuffer(vData, vSize, &pDecoder) != ANDROID_IMAGE_DECODER_SUCCESS) return nullptr;
+            AImageDecoder_setAndroidBitmapFormat(pDecoder, ANDROID_BITMAP_FORMAT_RGBA_8888);
+            AImageDecoder_setUnpremultipliedRequired(pDecoder, true);
+            return std::make_unique<CAndroidRegionDecoder>(pDecoder, Format);
+        }
+#endif
+        int Width = 0, Height = 0, FileChannels = 0;
+        if (!stbi_info_from_memory(vData, static_cast<int>(vSize), &Width, &Height, &FileChannels)) return nullptr;
+        return std::make_unique<CStbRegionDecoder>(vData, vSize, Format, Width, Height);
+    }
+
+    bool decodeImageFromMemory(const uint8_t *vData, size_t vSize, SImageData &voImage, EImageDecoderBackend vBackend)
+    {
+        if (vData == nullptr || vSize == 0)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Invalid image buffer of %zu bytes", vSize);
+            return false;
+        }
+
+        const EImageFormat         Format  = detectImageFormat(vData, vSize);
+        const EImageDecoderBackend Backend = resolveImageDecoder(Format, vBackend);
+        auto StartTime = std::chrono::steady_clock::now();
+        bool IsDecoded = getImageDecoder(Backend)->decode(vData, vSize, voImage);
+        recordDecode(Backend, Format, getElapsedMs(StartTime), voImage.Width, voImage.Height, IsDecoded);
+        return IsDecoded;
+    }
+}
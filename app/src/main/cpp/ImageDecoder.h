@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "ImageData.h"
+
+namespace hiveVG
+{
+    enum class EImageFormat
+    {
+        PNG,
+        JPEG,
+        WebP,
+        Unknown,
+        Count
+    };
+
+    enum class EImageDecoderBackend
+    {
+        Auto,                // whatever setPreferredImageDecoder() picked for the file format
+        AndroidImageDecoder, // only available on Android
+        StbImage,
+        Count
+    };
+
+    struct SImageDecoderStats
+    {
+        uint64_t DecodeCount  = 0;
+        uint64_t FailureCount = 0;
+        uint64_t PixelCount   = 0;
+        double   TotalMs      = 0.0;
+    };
+
+    /*!
+     * One way of turning an encoded PNG/JPG file held in memory into tightly packed, straight alpha RGBA8.
+     * All backends produce the same layout, so they can be swapped per asset without touching the upload path.
+     * Implementations are stateless and safe to call from several worker threads at once.
+     */
+    class IImageDecoder
+    {
+    public:
+        virtual ~IImageDecoder() = default;
+
+        virtual bool                      decode(const uint8_t *vData, size_t vSize, SImageData &voImage) = 0;
+        [[nodiscard]] virtual const char* getName() const = 0;
+    };
+
+    // Runs everywhere, including Linux benchmarks.
+    class CStbImageDecoder final : public IImageDecoder
+    {
+    public:
+        bool                      decode(const uint8_t *vData, size_t vSize, SImageData &voImage) override;
+        [[nodiscard]] const char* getName() const override { return "stb_image"; }
+    };
+
+#ifdef __ANDROID__
+    class CAndroidImageDecoder final : public IImageDecoder
+    {
+    public:
+        bool                      decode(const uint8_t *vData, size_t vSize, SImageData &voImage) override;
+        [[nodiscard]] const char* getName() const override { return "AImageDecoder"; }
+    };
+#endif
+
+    /*!
+     * Decodes horizontal slices of one encoded image, so a tall atlas can be shown before all of it is decoded.
+     * One instance per image and per thread. The encoded bytes must outlive it.
+     * AImageDecoder crops each slice with AImageDecoder_setCrop. For sequential formats such as PNG it still has to
+     * read the rows above the slice, so asking for ever taller slices keeps the total cost near one full decode.
+     * stb_image cannot stop early: its first slice decodes the whole image and the later ones copy from that.
+     * setTargetSize() shrinks the image as it is decoded, rows are then counted in the target size.
+     */
+    class IImageRegionDecoder
+    {
+    public:
+        virtual ~IImageRegionDecoder() = default;
+
+        [[nodiscard]] virtual int getWidth() const = 0;
+        [[nodiscard]] virtual int getHeight() const = 0;
+        // Before the first decodeRows() only, no larger than the source. AImageDecoder scales while decoding,
+        // stb_image decodes at source size and goes through downscaleImage().
+        virtual bool              setTargetSize(int vWidth, int vHeight) = 0;
+        // Before the first decode only: rows come out premultiplied as EAlphaConversion::Premultiply does it, which
+        // AImageDecoder does while decoding
+        virtual void              setPremultipliedOutput() = 0;
+        // Full width rows [vFirstRow, vFirstRow + vRowCount) as RGBA8, straight alpha unless premultiplied output was set
+        bool                      decodeRows(int vFirstRow, int vRowCount, SImageData &voRows);
+        // The same rows written vRowPitch bytes apart to voDst, e.g. a mapped pixel unpack buffer, and never read back
+        virtual bool              decodeRowsInto(int vFirstRow, int vRowCount, uint8_t *voDst, size_t vRowPitch) = 0;
+    };
+
+    EImageFormat          detectImageFormat(const uint8_t *vData, size_t vSize);
+    const char*           getImageFormatName(EImageFormat vFormat);
+    // nullptr for Auto and for backends this platform does not have
+    IImageDecoder*        getImageDecoder(EImageDecoderBackend vBackend);
+    // Runtime choice behind EImageDecoderBackend::Auto, e.g. after comparing the stats on a device class.
+    void                  setPreferredImageDecoder(EImageFormat vFormat, EImageDecoderBackend vBackend);
+    EImageDecoderBackend  resolveImageDecoder(EImageFormat vFormat, EImageDecoderBackend vRequested);
+    SImageDecoderStats    getImageDecoderStats(EImageDecoderBackend vBackend, EImageFormat vFormat);
+    void                  logImageDecoderStats();
+    // nullptr if the header cannot be read, slice timings are recorded like whole decodes
+    std::unique_ptr<IImageRegionDecoder> createImageRegionDecoder(const uint8_t *vData, size_t vSize, EImageDecoderBackend vBackend = EImageDecoderBackend::Auto);
+
+    /*!
+     * Decodes a PNG/JPG file held in memory into tightly packed RGBA8 and records the time against the backend and format.
+     * Safe to call from worker threads.
+     * @param vData encoded file bytes
+     * @param vSize size of vData in bytes
+     * @param voImage receives the decoded pixels
+     * @param vBackend decoder to use, Auto follows setPreferredImageDecoder()
+     * @return false if the bytes could not be decoded
+     */
+    bool decodeImageFromMemory(const uint8_t *vData, size_t vSize, SImageData &voImage, EImageDecoderBackend vBackend = EImageDecoderBackend::Auto);
+}
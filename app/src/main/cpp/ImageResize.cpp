@@ -0,0 +1,194 @@
+#include "ImageResize.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "MipChain.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HIVE_RESIZE_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HIVE_RESIZE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace hiveVG
+{
+    namespace
+    {
+        // Source coordinate and weight of the two taps along one axis, computed once per output row/column
+        struct STap
+        {
+            int   First  = 0;
+            int   Second = 0;
+            float Weight = 0.0f;   // of Second
+        };
+
+        std::vector<STap> computeTaps(int vSourceSize, int vTargetSize)
+        {
+            std::vector<STap> Taps(vTargetSize);
+            const float Scale = static_cast<float>(vSourceSize) / vTargetSize;
+            for (int i = 0; i < vTargetSize; ++i)
+            {
+                const float Center = std::max((i + 0.5f) * Scale - 0.5f, 0.0f);
+                Taps[i].First  = std::min(static_cast<int>(Center), vSourceSize - 1);
+                Taps[i].Second = std::min(Taps[i].First + 1, vSourceSize - 1);
+                Taps[i].Weight = Center - Taps[i].First;
+            }
+            return Taps;
+        }
+
+        inline uint8_t toByte(float vValue)
+        {
+            return static_cast<uint8_t>(std::min(std::max(vValue + 0.5f, 0.0f), 255.0f));
+        }
+
+        void resampleRowScalar(const uint8_t *vRow0, const uint8_t *vRow1, float vWeightY, const std::vector<STap> &vTapsX, uint8_t *voRow)
+        {
+            for (size_t x = 0; x < vTapsX.size(); ++x, voRow += 4)
+            {
+                const STap &Tap = vTapsX[x];
+                const uint8_t *Texels[4] = {vRow0 + Tap.First * 4, vRow0 + Tap.Second * 4, vRow1 + Tap.First * 4, vRow1 + Tap.Second * 4};
+                const float Weights[4] = {(1 - Tap.Weight) * (1 - vWeightY), Tap.Weight * (1 - vWeightY), (1 - Tap.Weight) * vWeightY, Tap.Weight * vWeightY};
+                float Color[3] = {0, 0, 0}, PlainColor[3] = {0, 0, 0}, Alpha = 0;
+                for (int i = 0; i < 4; ++i)
+                {
+                    const float AlphaWeight = Weights[i] * Texels[i][3];
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        Color[c] += AlphaWeight * Texels[i][c];
+                        PlainColor[c] += Weights[i] * Texels[i][c];
+                    }
+                    Alpha += AlphaWeight;
+                }
+                for (int c = 0; c < 3; ++c) voRow[c] = toByte(Alpha > 0.0f ? Color[c] / Alpha : PlainColor[c]);
+                voRow[3] = toByte(Alpha);
+            }
+        }
+
+#ifdef HIVE_RESIZE_SSE2
+        inline __m128 loadTexel(const uint8_t *vTexel)
+        {
+            const __m128i Bytes = _mm_cvtsi32_si128(*reinterpret_cast<const int32_t *>(vTexel));
+            return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(Bytes, _mm_setzero_si128()), _mm_setzero_si128()));
+        }
+
+        void resampleRowSSE2(const uint8_t *vRow0, const uint8_t *vRow1, float vWeightY, const std::vector<STap> &vTapsX, uint8_t *voRow)
+        {
+            const __m128 AlphaLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+            for (size_t x = 0; x < vTapsX.size(); ++x, voRow += 4)
+            {
+                const STap &Tap = vTapsX[x];
+                const __m128 T00 = loadTexel(vRow0 + Tap.First * 4), T01 = loadTexel(vRow0 + Tap.Second * 4);
+                const __m128 T10 = loadTexel(vRow1 + Tap.First * 4), T11 = loadTexel(vRow1 + Tap.Second * 4);
+                const __m128 W00 = _mm_set1_ps((1 - Tap.Weight) * (1 - vWeightY)), W01 = _mm_set1_ps(Tap.Weight * (1 - vWeightY));
+                const __m128 W10 = _mm_set1_ps((1 - Tap.Weight) * vWeightY), W11 = _mm_set1_ps(Tap.Weight * vWeightY);
+                // Alpha of each texel broadcast, times its bilinear weight
+                const __m128 A00 = _mm_mul_ps(W00, _mm_shuffle_ps(T00, T00, _MM_SHUFFLE(3, 3, 3, 3)));
+                const __m128 A01 = _mm_mul_ps(W01, _mm_shuffle_ps(T01, T01, _MM_SHUFFLE(3, 3, 3, 3)));
+                const __m128 A10 = _mm_mul_ps(W10, _mm_shuffle_ps(T10, T10, _MM_SHUFFLE(3, 3, 3, 3)));
+                const __m128 A11 = _mm_mul_ps(W11, _mm_shuffle_ps(T11, T11, _MM_SHUFFLE(3, 3, 3, 3)));
+                const __m128 Alpha = _mm_add_ps(_mm_add_ps(A00, A01), _mm_add_ps(A10, A11));
+                const __m128 Color = _mm_add_ps(_mm_add_ps(_mm_mul_ps(T00, A00), _mm_mul_ps(T01, A01)), _mm_add_ps(_mm_mul_ps(T10, A10), _mm_mul_ps(T11, A11)));
+                const __m128 Plain = _mm_add_ps(_mm_add_ps(_mm_mul_ps(T00, W00), _mm_mul_ps(T01, W01)), _mm_add_ps(_mm_mul_ps(T10, W10), _mm_mul_ps(T11, W11)));
+                // Fully transparent footprints keep their plain average, there is no visible color to weight by
+                const __m128 IsVisible = _mm_cmpgt_ps(Alpha, _mm_setzero_ps());
+                __m128 Result = _mm_or_ps(_mm_and_ps(IsVisible, _mm_div_ps(Color, _mm_max_ps(Alpha, _mm_set1_ps(1e-20f)))), _mm_andnot_ps(IsVisible, Plain));
+                Result = _mm_or_ps(_mm_andnot_ps(AlphaLane, Result), _mm_and_ps(AlphaLane, Alpha));
+                Result = _mm_min_ps(_mm_max_ps(_mm_add_ps(Result, _mm_set1_ps(0.5f)), _mm_setzero_ps()), _mm_set1_ps(255.0f));
+                const __m128i Words = _mm_packs_epi32(_mm_cvttps_epi32(Result), _mm_setzero_si128());
+                *reinterpret_cast<int32_t *>(voRow) = _mm_cvtsi128_si32(_mm_packus_epi16(Words, _mm_setzero_si128()));
+            }
+        }
+#endif
+
+#ifdef HIVE_RESIZE_NEON
+        inline float32x4_t loadTexel(const uint8_t *vTexel)
+        {
+            const uint8x8_t Bytes = vreinterpret_u8_u32(vld1_dup_u32(reinterpret_cast<const uint32_t *>(vTexel)));
+            return vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(Bytes))));
+        }
+
+        void resampleRowNEON(const uint8_t *vRow0, const uint8_t *vRow1, float vWeightY, const std::vector<STap> &vTapsX, uint8_t *voRow)
+        {
+            for (size_t x = 0; x < vTapsX.size(); ++x, voRow += 4)
+            {
+                const STap &Tap = vTapsX[x];
+                const float32x4_t T00 = loadTexel(vRow0 + Tap.First * 4), T01 = loadTexel(vRow0 + Tap.Second * 4);
+                const float32x4_t T10 = loadTexel(vRow1 + Tap.First * 4), T11 = loadTexel(vRow1 + Tap.Second * 4);
+                const float W00 = (1 - Tap.Weight) * (1 - vWeightY), W01 = Tap.Weight * (1 - vWeightY);
+                const float W10 = (1 - Tap.Weight) * vWeightY, W11 = Tap.Weight * vWeightY;
+                const float A00 = W00 * vgetq_lane_f32(T00, 3), A01 = W01 * vgetq_lane_f32(T01, 3);
+                const float A10 = W10 * vgetq_lane_f32(T10, 3), A11 = W11 * vgetq_lane_f32(T11, 3);
+                const float Alpha = A00 + A01 + A10 + A11;
+                float32x4_t Result;
+                if (Alpha > 0.0f)
+                {
+                    float32x4_t Color = vmulq_n_f32(T00, A00);
+                    Color = vaddq_f32(Color, vmulq_n_f32(T01, A01));
+                    Color = vaddq_f32(Color, vmulq_n_f32(T10, A10));
+                    Color = vaddq_f32(Color, vmulq_n_f32(T11, A11));
+                    Result = vmulq_n_f32(Color, 1.0f / Alpha);
+                }
+                else
+                {
+                    Result = vmulq_n_f32(T00, W00);
+                    Result = vaddq_f32(Result, vmulq_n_f32(T01, W01));
+                    Result = vaddq_f32(Result, vmulq_n_f32(T10, W10));
+                    Result = vaddq_f32(Result, vmulq_n_f32(T11, W11));
+                }
+                Result = vsetq_lane_f32(Alpha, Result, 3);
+                Result = vminq_f32(vmaxq_f32(vaddq_f32(Result, vdupq_n_f32(0.5f)), vdupq_n_f32(0.0f)), vdupq_n_f32(255.0f));
+                const uint16x4_t Words = vmovn_u32(vcvtq_u32_f32(Result));
+                const uint8x8_t Bytes = vmovn_u16(vcombine_u16(Words, Words));
+                vst1_lane_u32(reinterpret_cast<uint32_t *>(voRow), vreinterpret_u32_u8(Bytes), 0);
+            }
+        }
+#endif
+    }
+
+    SImageData resampleBilinear(const SImageData &vSource, int vWidth, int vHeight, EPixelKernel vKernel)
+    {
+        assert(vSource.Channels == 4 && vWidth > 0 && vHeight > 0);
+        using FRowKernel = void (*)(const uint8_t *, const uint8_t *, float, const std::vector<STap> &, uint8_t *);
+        FRowKernel RowKernel = resampleRowScalar;
+#ifdef HIVE_RESIZE_SSE2
+        if (vKernel == EPixelKernel::SSE2 || vKernel == EPixelKernel::AVX2) RowKernel = resampleRowSSE2;
+#endif
+#ifdef HIVE_RESIZE_NEON
+        if (vKernel == EPixelKernel::NEON) RowKernel = resampleRowNEON;
+#endif
+
+        SImageData Target;
+        Target.Width  = vWidth;
+        Target.Height = vHeight;
+        Target.Pixels.resize(Target.getByteSize());
+        const std::vector<STap> TapsX = computeTaps(vSource.Width, vWidth);
+        const std::vector<STap> TapsY = computeTaps(vSource.Height, vHeight);
+        for (int y = 0; y < vHeight; ++y)
+        {
+            RowKernel(vSource.Pixels.data() + vSource.getRowPitch() * TapsY[y].First, vSource.Pixels.data() + vSource.getRowPitch() * TapsY[y].Second,
+                      TapsY[y].Weight, TapsX, Target.Pixels.data() + Target.getRowPitch() * y);
+        }
+        return Target;
+    }
+
+    SImageData downscaleImage(const SImageData &vSource, int vWidth, int vHeight)
+    {
+        assert(vWidth <= vSource.Width && vHeight <= vSource.Height);
+        if (vWidth == vSource.Width && vHeight == vSource.Height) return vSource;
+
+        // Bilinear only reads 2x2 texels, so it must not be asked to shrink by 2 or more
+        SImageData Halved;
+        const SImageData *pCurrent = &vSource;
+        while (pCurrent->Width >= vWidth * 2 && pCurrent->Height >= vHeight * 2)
+        {
+            Halved = downsampleHalf(*pCurrent, EAlphaMode::Straight);
+            pCurrent = &Halved;
+        }
+        if (pCurrent->Width == vWidth && pCurrent->Height == vHeight) return *pCurrent;
+        return resampleBilinear(*pCurrent, vWidth, vHeight, getBestPixelKernel());
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "ImageData.h"
+#include "PixelConvert.h"
+
+namespace hiveVG
+{
+    /*!
+     * Shrinks straight alpha RGBA8 to vWidth x vHeight, neither may be larger than the source.
+     * Whole halvings go through the alpha weighted 2x2 box filter of the mip chain, the remaining factor below 2 is
+     * bilinear, again weighted by alpha so transparent texels do not darken the edges of what is visible.
+     */
+    SImageData downscaleImage(const SImageData &vSource, int vWidth, int vHeight);
+    // The bilinear step alone, vKernel picks the SIMD path (Scalar, SSE2 or NEON, AVX2 falls back to SSE2)
+    SImageData resampleBilinear(const SImageData &vSource, int vWidth, int vHeight, EPixelKernel vKernel);
+}
@@ -0,0 +1,163 @@
+#include "Ktx2Container.h"
+#include <algorithm>
+#include <cstring>
+
+namespace hiveVG
+{
+    namespace
+    {
+        constexpr uint8_t Ktx2Identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+        constexpr size_t  HeaderSize         = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+        constexpr size_t  LevelIndexEntrySize = 3 * 8;
+        constexpr uint8_t DfdFlagAlphaPremultiplied = 1;
+
+        constexpr SKtx2FormatInfo FormatTable[] = {
+            {147, GL_COMPRESSED_FORMAT::RGB8_ETC2,               ECompressionFamily::ETC2, 4, 4,  8, false, "ETC2_RGB8"},
+            {148, GL_COMPRESSED_FORMAT::SRGB8_ETC2,              ECompressionFamily::ETC2, 4, 4,  8, true,  "ETC2_SRGB8"},
+            {149, GL_COMPRESSED_FORMAT::RGB8_PUNCHTHROUGH_ETC2,  ECompressionFamily::ETC2, 4, 4,  8, false, "ETC2_RGB8A1"},
+            {150, GL_COMPRESSED_FORMAT::SRGB8_PUNCHTHROUGH_ETC2, ECompressionFamily::ETC2, 4, 4,  8, true,  "ETC2_SRGB8A1"},
+            {151, GL_COMPRESSED_FORMAT::RGBA8_ETC2_EAC,          ECompressionFamily::ETC2, 4, 4, 16, false, "ETC2_RGBA8"},
+            {152, GL_COMPRESSED_FORMAT::SRGB8_ALPHA8_ETC2_EAC,   ECompressionFamily::ETC2, 4, 4, 16, true,  "ETC2_SRGB8_ALPHA8"},
+            {153, GL_COMPRESSED_FORMAT::R11_EAC,                 ECompressionFamily::ETC2, 4, 4,  8, false, "EAC_R11"},
+            {154, GL_COMPRESSED_FORMAT::SIGNED_R11_EAC,          ECompressionFamily::ETC2, 4, 4,  8, false, "EAC_R11_SNORM"},
+            {155, GL_COMPRESSED_FORMAT::RG11_EAC,                ECompressionFamily::ETC2, 4, 4, 16, false, "EAC_RG11"},
+            {156, GL_COMPRESSED_FORMAT::SIGNED_RG11_EAC,         ECompressionFamily::ETC2, 4, 4, 16, false, "EAC_RG11_SNORM"},
+        };
+
+        // ASTC LDR block footprints in VkFormat order, each has a UNORM and an SRGB entry.
+        constexpr int AstcFootprints[][2] = {{4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+        constexpr uint32_t VkFormatAstc4x4Unorm = 157;
+        constexpr size_t   AstcFootprintCount   = sizeof(AstcFootprints) / sizeof(AstcFootprints[0]);
+
+        struct SAstcFormatTable
+        {
+            SKtx2FormatInfo Formats[AstcFootprintCount * 2];
+
+            SAstcFormatTable()
+            {
+                for (size_t i = 0; i < AstcFootprintCount; ++i)
+                {
+                    for (int IsSRGB = 0; IsSRGB < 2; ++IsSRGB)
+                    {
+                        SKtx2FormatInfo &Format = Formats[i * 2 + IsSRGB];
+                        Format.VkFormat         = VkFormatAstc4x4Unorm + static_cast<uint32_t>(i * 2 + IsSRGB);
+                        Format.GLInternalFormat = (IsSRGB ? GL_COMPRESSED_FORMAT::SRGB8_ALPHA8_ASTC_4x4 : GL_COMPRESSED_FORMAT::RGBA_ASTC_4x4) + static_cast<uint32_t>(i);
+                        Format.Family           = ECompressionFamily::ASTC;
+                        Format.BlockWidth       = AstcFootprints[i][0];
+                        Format.BlockHeight      = AstcFootprints[i][1];
+                        Format.BytesPerBlock    = 16;
+                        Format.IsSRGB           = IsSRGB != 0;
+                        Format.pName            = IsSRGB ? "ASTC_SRGB" : "ASTC";
+                    }
+                }
+            }
+        };
+
+        template<typename T>
+        T readLE(const uint8_t *vData)
+        {
+            T Value = 0;
+            for (size_t i = 0; i < sizeof(T); ++i)
+                Value |= static_cast<T>(vData[i]) << (8 * i);
+            return Value;
+        }
+
+        bool fail(std::string &voError, const char *vReason)
+        {
+            voError = vReason;
+            return false;
+        }
+    }
+
+    const SKtx2FormatInfo* findKtx2FormatInfo(uint32_t vVkFormat)
+    {
+        for (const auto &Format : FormatTable)
+        {
+            if (Format.VkFormat == vVkFormat) return &Format;
+        }
+        static const SAstcFormatTable AstcTable;
+        for (const auto &Format : AstcTable.Formats)
+        {
+            if (Format.VkFormat == vVkFormat) return &Format;
+        }
+        return nullptr;
+    }
+
+    size_t computeCompressedLevelSize(const SKtx2FormatInfo &vFormat, int vWidth, int vHeight)
+    {
+        const size_t BlocksX = (static_cast<size_t>(vWidth) + vFormat.BlockWidth - 1) / vFormat.BlockWidth;
+        const size_t BlocksY = (static_cast<size_t>(vHeight) + vFormat.BlockHeight - 1) / vFormat.BlockHeight;
+        return BlocksX * BlocksY * vFormat.BytesPerBlock;
+    }
+
+    bool parseKtx2(const uint8_t *vData, size_t vSize, SKtx2Texture &voTexture, std::string &voError)
+    {
+        if (vData == nullptr || vSize < HeaderSize) return fail(voError, "file is smaller than a KTX2 header");
+        if (std::memcmp(vData, Ktx2Identifier, sizeof(Ktx2Identifier)) != 0) return fail(voError, "missing KTX2 identifier");
+
+        const uint8_t *pHeader = vData + sizeof(Ktx2Identifier);
+        const uint32_t VkFormat         = readLE<uint32_t>(pHeader + 0);
+        const uint32_t PixelWidth       = readLE<uint32_t>(pHeader + 8);
+        const uint32_t PixelHeight      = readLE<uint32_t>(pHeader + 12);
+        const uint32_t PixelDepth       = readLE<uint32_t>(pHeader + 16);
+        const uint32_t LayerCount       = readLE<uint32_t>(pHeader + 20);
+        const uint32_t FaceCount        = readLE<uint32_t>(pHeader + 24);
+        const uint32_t LevelCount       = readLE<uint32_t>(pHeader + 28);
+        const uint32_t Supercompression = readLE<uint32_t>(pHeader + 32);
+        const uint32_t DfdByteOffset    = readLE<uint32_t>(pHeader + 36);
+        const uint32_t DfdByteLength    = readLE<uint32_t>(pHeader + 40);
+
+        const SKtx2FormatInfo *pFormat = findKtx2FormatInfo(VkFormat);
+        if (pFormat == nullptr) return fail(voError, "VkFormat is not an ETC2/EAC or ASTC block format");
+        if (PixelWidth == 0 || PixelHeight == 0 || PixelWidth > 16384 || PixelHeight > 16384) return fail(voError, "unsupported texture size");
+        if (PixelDepth > 1 || LayerCount > 1 || FaceCount != 1) return fail(voError, "only single 2D textures are supported");
+        if (LevelCount == 0) return fail(voError, "levelCount 0 asks for runtime mip generation, a prebuilt chain is required");
+        if (Supercompression != 0) return fail(voError, "supercompressed KTX2 files are not supported");
+
+        const uint32_t MaxLevelCount = 32 - static_cast<uint32_t>(__builtin_clz(std::max(PixelWidth, PixelHeight)));
+        if (LevelCount > MaxLevelCount) return fail(voError, "levelCount exceeds the full mip chain");
+        if (HeaderSize + LevelCount * LevelIndexEntrySize > vSize) return fail(voError, "truncated level index");
+
+        SKtx2Texture Texture;
+        Texture.pFormat = pFormat;
+        Texture.Width   = static_cast<int>(PixelWidth);
+        Texture.Height  = static_cast<int>(PixelHeight);
+        Texture.Levels.resize(LevelCount);
+        for (uint32_t i = 0; i < LevelCount; ++i)
+        {
+            const uint8_t *pEntry = vData + HeaderSize + i * LevelIndexEntrySize;
+            SKtx2Level &Level = Texture.Levels[i];
+            const uint64_t ByteOffset = readLE<uint64_t>(pEntry);
+            const uint64_t ByteLength = readLE<uint64_t>(pEntry + 8);
+            Level.Width  = std::max(Texture.Width >> i, 1);
+            Level.Height = std::max(Texture.Height >> i, 1);
+            if (ByteOffset > vSize || ByteLength > vSize - ByteOffset) return fail(voError, "level data lies outside the file");
+            if (ByteLength != computeCompressedLevelSize(*pFormat, Level.Width, Level.Height)) return fail(voError, "level size does not match its block count");
+            // lcm(block size, 4) is the block size itself for every format in the table
+            if (ByteOffset % pFormat->BytesPerBlock != 0) return fail(voError, "level data is not aligned to its block size");
+            Level.ByteOffset = static_cast<size_t>(ByteOffset);
+            Level.ByteLength = static_cast<size_t>(ByteLength);
+        }
+
+        // Basic data format descriptor: total size, block header, then the flags byte after the color model fields.
+        constexpr size_t DfdFlagsOffset = 4 + 4 + 4 + 3;
+        if (DfdByteLength > DfdFlagsOffset && DfdByteOffset <= vSize && DfdByteLength <= vSize - DfdByteOffset)
+            Texture.IsPremultiplied = (vData[DfdByteOffset + DfdFlagsOffset] & DfdFlagAlphaPremultiplied) != 0;
+
+        voTexture = std::move(Texture);
+        return true;
+    }
+
+    bool isKtx2Path(const std::string &vPath)
+    {
+        constexpr char Extension[] = ".ktx2";
+        constexpr size_t ExtensionLength = sizeof(Extension) - 1;
+        return vPath.size() > ExtensionLength && vPath.compare(vPath.size() - ExtensionLength, ExtensionLength, Extension) == 0;
+    }
+
+    std::string getKtx2FallbackPath(const std::string &vPath)
+    {
+        if (!isKtx2Path(vPath)) return vPath;
+        return vPath.substr(0, vPath.size() - 5) + ".png";
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hiveVG
+{
+    // GL enums are spelled out so the parser builds without GL headers on a Linux host.
+    namespace GL_COMPRESSED_FORMAT
+    {
+        constexpr uint32_t R11_EAC                 = 0x9270;
+        constexpr uint32_t SIGNED_R11_EAC          = 0x9271;
+        constexpr uint32_t RG11_EAC                = 0x9272;
+        constexpr uint32_t SIGNED_RG11_EAC         = 0x9273;
+        constexpr uint32_t RGB8_ETC2               = 0x9274;
+        constexpr uint32_t SRGB8_ETC2              = 0x9275;
+        constexpr uint32_t RGB8_PUNCHTHROUGH_ETC2  = 0x9276;
+        constexpr uint32_t SRGB8_PUNCHTHROUGH_ETC2 = 0x9277;
+        constexpr uint32_t RGBA8_ETC2_EAC          = 0x9278;
+        constexpr uint32_t SRGB8_ALPHA8_ETC2_EAC   = 0x9279;
+        constexpr uint32_t RGBA_ASTC_4x4           = 0x93B0;
+        constexpr uint32_t SRGB8_ALPHA8_ASTC_4x4   = 0x93D0;
+    }
+
+    enum class ECompressionFamily
+    {
+        ETC2,
+        ASTC
+    };
+
+    struct SKtx2FormatInfo
+    {
+        uint32_t           VkFormat         = 0;
+        uint32_t           GLInternalFormat = 0;
+        ECompressionFamily Family           = ECompressionFamily::ETC2;
+        int                BlockWidth       = 4;
+        int                BlockHeight      = 4;
+        int                BytesPerBlock    = 16;
+        bool               IsSRGB           = false;
+        const char*        pName            = "";
+    };
+
+    struct SKtx2Level
+    {
+        size_t ByteOffset = 0;
+        size_t ByteLength = 0;
+        int    Width      = 0;
+        int    Height     = 0;
+    };
+
+    struct SKtx2Texture
+    {
+        const SKtx2FormatInfo*  pFormat         = nullptr;
+        int                     Width           = 0;
+        int                     Height          = 0;
+        bool                    IsPremultiplied = false;
+        std::vector<SKtx2Level> Levels;
+    };
+
+    const SKtx2FormatInfo* findKtx2FormatInfo(uint32_t vVkFormat);
+    size_t                 computeCompressedLevelSize(const SKtx2FormatInfo &vFormat, int vWidth, int vHeight);
+
+    /*!
+     * Parses and validates a KTX2 container holding a single 2D ETC2/EAC or ASTC texture with its mip chain.
+     * Level offsets refer to vData, which has to stay alive while the levels are used.
+     * @return false with a reason in voError if the file is malformed or uses an unsupported feature
+     */
+    bool parseKtx2(const uint8_t *vData, size_t vSize, SKtx2Texture &voTexture, std::string &voError);
+    bool isKtx2Path(const std::string &vPath);
+    // Sibling PNG used when the device cannot sample the compressed format, "a/b.ktx2" -> "a/b.png".
+    std::string getKtx2FallbackPath(const std::string &vPath);
+}
@@ -0,0 +1,146 @@
+#include "Lz4Block.h"
+#include <cstring>
+#include <vector>
+
+namespace hiveVG
+{
+    namespace
+    {
+        constexpr size_t MinMatch       = 4;
+        constexpr size_t LastLiterals   = 5;    // the last 5 bytes of a block are always literals
+        constexpr size_t MatchSafeEnd   = 12;   // no match may start within the last 12 bytes
+        constexpr size_t MaxOffset      = 65535;
+        constexpr int    HashLog        = 16;
+
+        inline uint32_t read32(const uint8_t *vPtr)
+        {
+            uint32_t Value;
+            std::memcpy(&Value, vPtr, sizeof(Value));
+            return Value;
+        }
+
+        inline uint32_t hashSequence(uint32_t vSequence)
+        {
+            return (vSequence * 2654435761u) >> (32 - HashLog);
+        }
+
+        // Length continuation bytes after a 15 nibble
+        inline uint8_t *writeLength(uint8_t *vioDst, size_t vLength)
+        {
+            for (; vLength >= 255; vLength -= 255) *vioDst++ = 255;
+            *vioDst++ = static_cast<uint8_t>(vLength);
+            return vioDst;
+        }
+
+        inline bool readLength(const uint8_t *&vioSrc, const uint8_t *vSrcEnd, size_t &vioLength)
+        {
+            uint8_t Byte;
+            do
+            {
+                if (vioSrc >= vSrcEnd) return false;
+                Byte = *vioSrc++;
+                vioLength += Byte;
+            } while (Byte == 255);
+            return true;
+        }
+    }
+
+    size_t getLz4BlockBound(size_t vSize)
+    {
+        return vSize + vSize / 255 + 16;
+    }
+
+    size_t compressLz4Block(const uint8_t *vSrc, size_t vSrcSize, uint8_t *voDst, size_t vDstCapacity)
+    {
+        if (vDstCapacity < getLz4BlockBound(vSrcSize)) return 0;
+        std::vector<uint32_t> HashTable(size_t(1) << HashLog, 0);
+        const uint8_t *pAnchor = vSrc;
+        const uint8_t *pEnd    = vSrc + vSrcSize;
+        uint8_t *pDst = voDst;
+
+        if (vSrcSize > MatchSafeEnd)
+        {
+            const uint8_t *pMatchLimit = pEnd - LastLiterals;
+            const uint8_t *pSearchEnd  = pEnd - MatchSafeEnd;
+            const uint8_t *pCurrent    = vSrc + 1;
+            while (pCurrent < pSearchEnd)
+            {
+                const uint32_t Sequence = read32(pCurrent);
+                uint32_t &Slot = HashTable[hashSequence(Sequence)];
+                const uint8_t *pCandidate = vSrc + Slot;
+                Slot = static_cast<uint32_t>(pCurrent - vSrc);
+                if (pCandidate >= pCurrent || static_cast<size_t>(pCurrent - pCandidate) > MaxOffset || read32(pCandidate) != Sequence)
+                {
+                    ++pCurrent;
+                    continue;
+                }
+
+                const uint8_t *pMatchEnd = pCurrent + MinMatch;
+                const uint8_t *pFrom = pCandidate + MinMatch;
+                while (pMatchEnd < pMatchLimit && *pMatchEnd == *pFrom)
+                {
+                    ++pMatchEnd;
+                    ++pFrom;
+                }
+
+                const size_t LiteralLength = pCurrent - pAnchor;
+                const size_t MatchLength   = pMatchEnd - pCurrent - MinMatch;
+                uint8_t *pToken = pDst++;
+                *pToken = static_cast<uint8_t>((LiteralLength >= 15 ? 15 : LiteralLength) << 4);
+                if (LiteralLength >= 15) pDst = writeLength(pDst, LiteralLength - 15);
+                std::memcpy(pDst, pAnchor, LiteralLength);
+                pDst += LiteralLength;
+                const size_t Offset = pCurrent - pCandidate;
+                *pDst++ = static_cast<uint8_t>(Offset);
+                *pDst++ = static_cast<uint8_t>(Offset >> 8);
+                *pToken |= static_cast<uint8_t>(MatchLength >= 15 ? 15 : MatchLength);
+                if (MatchLength >= 15) pDst = writeLength(pDst, MatchLength - 15);
+
+                pCurrent = pAnchor = pMatchEnd;
+                // Keeps long runs findable from the middle of the match as well
+                if (pCurrent - 2 > vSrc) HashTable[hashSequence(read32(pCurrent - 2))] = static_cast<uint32_t>(pCurrent - 2 - vSrc);
+            }
+        }
+
+        const size_t LiteralLength = pEnd - pAnchor;
+        *pDst++ = static_cast<uint8_t>((LiteralLength >= 15 ? 15 : LiteralLength) << 4);
+        if (LiteralLength >= 15) pDst = writeLength(pDst, LiteralLength - 15);
+        std::memcpy(pDst, pAnchor, LiteralLength);
+        pDst += LiteralLength;
+        return pDst - voDst;
+    }
+
+    bool decompressLz4Block(const uint8_t *vSrc, size_t vSrcSize, uint8_t *voDst, size_t vDstSize)
+    {
+        const uint8_t *pSrc = vSrc, *pSrcEnd = vSrc + vSrcSize;
+        uint8_t *pDst = voDst, *pDstEnd = voDst + vDstSize;
+        while (pSrc < pSrcEnd)
+        {
+            const uint8_t Token = *pSrc++;
+            size_t LiteralLength = Token >> 4;
+            if (LiteralLength == 15 && !readLength(pSrc, pSrcEnd, LiteralLength)) return false;
+            if (LiteralLength > static_cast<size_t>(pSrcEnd - pSrc) || LiteralLength > static_cast<size_t>(pDstEnd - pDst)) return false;
+            std::memcpy(pDst, pSrc, LiteralLength);
+            pSrc += LiteralLength;
+            pDst += LiteralLength;
+            if (pSrc == pSrcEnd) break;   // the last sequence has no match
+
+            if (pSrcEnd - pSrc < 2) return false;
+            const size_t Offset = pSrc[0] | (pSrc[1] << 8);
+            pSrc += 2;
+            if (Offset == 0 || Offset > static_cast<size_t>(pDst - voDst)) return false;
+            size_t MatchLength = Token & 15;
+            if (MatchLength == 15 && !readLength(pSrc, pSrcEnd, MatchLength)) return false;
+            MatchLength += MinMatch;
+            if (MatchLength > static_cast<size_t>(pDstEnd - pDst)) return false;
+            // Overlapping copies repeat the last Offset bytes, so they go byte by byte
+            const uint8_t *pMatch = pDst - Offset;
+            if (Offset >= MatchLength)
+                std::memcpy(pDst, pMatch, MatchLength);
+            else
+                for (size_t i = 0; i < MatchLength; ++i) pDst[i] = pMatch[i];
+            pDst += MatchLength;
+        }
+        return pDst == pDstEnd;
+    }
+}
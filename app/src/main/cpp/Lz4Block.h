@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hiveVG
+{
+    /*!
+     * LZ4 block format (no frame header, no checksum), readable by any liblz4 LZ4_decompress_safe().
+     * The compressor is the plain greedy single hash table one: fast enough to run on a decode worker, and decoded
+     * textures are mostly runs of transparent or flat texels, where it already gets most of what LZ4 HC would.
+     */
+    // Worst case size of compressing vSize bytes
+    size_t getLz4BlockBound(size_t vSize);
+    // 0 if voDst is too small
+    size_t compressLz4Block(const uint8_t *vSrc, size_t vSrcSize, uint8_t *voDst, size_t vDstCapacity);
+    // False unless vSrc decodes to exactly vDstSize bytes without reading or writing out of bounds
+    bool   decompressLz4Block(const uint8_t *vSrc, size_t vSrcSize, uint8_t *voDst, size_t vDstSize);
+}
@@ -0,0 +1,72 @@
+#include "MipChain.h"
+#include <algorithm>
+#include <cassert>
+
+namespace hiveVG
+{
+    SImageData downsampleHalf(const SImageData &vSource, EAlphaMode vAlphaMode)
+    {
+        assert(vSource.Channels == 4);
+        SImageData Result;
+        Result.Width    = std::max(vSource.Width / 2, 1);
+        Result.Height   = std::max(vSource.Height / 2, 1);
+        Result.Channels = 4;
+        Result.Pixels.resize(Result.getByteSize());
+
+        const size_t SourcePitch = vSource.getRowPitch();
+        for (int y = 0; y < Result.Height; ++y)
+        {
+            const int Y0 = std::min(y * 2, vSource.Height - 1);
+            const int Y1 = std::min(y * 2 + 1, vSource.Height - 1);
+            for (int x = 0; x < Result.Width; ++x)
+            {
+                const int X0 = std::min(x * 2, vSource.Width - 1);
+                const int X1 = std::min(x * 2 + 1, vSource.Width - 1);
+                const uint8_t *pTexels[4] = {
+                    &vSource.Pixels[Y0 * SourcePitch + X0 * 4], &vSource.Pixels[Y0 * SourcePitch + X1 * 4],
+                    &vSource.Pixels[Y1 * SourcePitch + X0 * 4], &vSource.Pixels[Y1 * SourcePitch + X1 * 4]};
+                uint8_t *pDst = &Result.Pixels[(static_cast<size_t>(y) * Result.Width + x) * 4];
+
+                const uint32_t AlphaSum = pTexels[0][3] + pTexels[1][3] + pTexels[2][3] + pTexels[3][3];
+                pDst[3] = static_cast<uint8_t>((AlphaSum + 2) / 4);
+                for (int c = 0; c < 3; ++c)
+                {
+                    if (vAlphaMode == EAlphaMode::Straight && AlphaSum > 0)
+                    {
+                        const uint32_t WeightedSum = pTexels[0][c] * pTexels[0][3] + pTexels[1][c] * pTexels[1][3]
+                                                   + pTexels[2][c] * pTexels[2][3] + pTexels[3][c] * pTexels[3][3];
+                        pDst[c] = static_cast<uint8_t>((WeightedSum + AlphaSum / 2) / AlphaSum);
+                    }
+                    else
+                        pDst[c] = static_cast<uint8_t>((pTexels[0][c] + pTexels[1][c] + pTexels[2][c] + pTexels[3][c] + 2) / 4);
+                }
+            }
+        }
+        return Result;
+    }
+
+    std::vector<SImageData> generateSubLevels(const SImageData &vBase, EAlphaMode vAlphaMode, int vMaxLevelCount)
+    {
+        const int FullLevelCount = computeFullMipLevelCount(vBase.Width, vBase.Height);
+        const int LevelCount = vMaxLevelCount > 0 ? std::min(vMaxLevelCount, FullLevelCount) : FullLevelCount;
+        std::vector<SImageData> Levels;
+        Levels.reserve(LevelCount - 1);
+        for (int Level = 1; Level < LevelCount; ++Level)
+            Levels.push_back(downsampleHalf(Levels.empty() ? vBase : Levels.back(), vAlphaMode));
+        return Levels;
+    }
+
+    std::vector<SImageData> generateMipChain(const SImageData &vBase, EAlphaMode vAlphaMode, int vMaxLevelCount)
+    {
+        std::vector<SImageData> Chain = generateSubLevels(vBase, vAlphaMode, vMaxLevelCount);
+        Chain.insert(Chain.begin(), vBase);
+        return Chain;
+    }
+
+    int computeFullMipLevelCount(int vWidth, int vHeight)
+    {
+        int LevelCount = 1;
+        for (int Size = std::max(vWidth, vHeight); Size > 1; Size /= 2) ++LevelCount;
+        return LevelCount;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include "ImageData.h"
+
+namespace hiveVG
+{
+    enum class EAlphaMode
+    {
+        Straight,
+        Premultiplied
+    };
+
+    /*!
+     * 2x2 box filter of an RGBA8 image, odd edges reuse their last texel.
+     * Straight alpha is averaged with alpha weights, so fully transparent texels do not bleed their color
+     * into the visible ones. Premultiplied pixels are averaged as they are, which is already correct.
+     */
+    SImageData downsampleHalf(const SImageData &vSource, EAlphaMode vAlphaMode);
+
+    // Levels 1..n only, for callers that keep level 0 where it already is.
+    std::vector<SImageData> generateSubLevels(const SImageData &vBase, EAlphaMode vAlphaMode, int vMaxLevelCount = 0);
+    // Level 0 is vBase itself, vMaxLevelCount == 0 builds the full chain down to 1x1.
+    std::vector<SImageData> generateMipChain(const SImageData &vBase, EAlphaMode vAlphaMode, int vMaxLevelCount = 0);
+    int                     computeFullMipLevelCount(int vWidth, int vHeight);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace hiveVG
+{
+    /*!
+     * Motion vector atlases share the grid of the sequence atlas they belong to. Cell f holds the motion from frame f
+     * to frame f + 1 (the last cell wraps to frame 0), sampled at frame f's pixels.
+     * Red and green are x and y in frame UV units, [-MaxDisplacement, MaxDisplacement] mapped to [0, 1].
+     * Baked by tools/MotionBaker, interpolated sequence playback reads them.
+     */
+    namespace MOTION_VECTOR_FORMAT
+    {
+        constexpr float MaxDisplacement = 0.125f;
+
+        inline uint8_t encode(float vDisplacement)
+        {
+            const float Normalized = std::clamp(vDisplacement / MaxDisplacement, -1.0f, 1.0f) * 0.5f + 0.5f;
+            return static_cast<uint8_t>(std::lround(Normalized * 255.0f));
+        }
+
+        inline float decode(uint8_t vValue)
+        {
+            return (vValue / 255.0f * 2.0f - 1.0f) * MaxDisplacement;
+        }
+    }
+}
@@ -0,0 +1,219 @@
+#include "PixelConvert.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HIVE_PIXEL_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HIVE_PIXEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace hiveVG
+{
+    namespace
+    {
+        using FPremultiplyKernel = void (*)(uint8_t *vioPixels, size_t vPixelCount);
+
+        // round(c * a / 255) for every 8 bit c and a, without a division. The SIMD kernels use the same formula.
+        inline uint8_t mulDiv255(uint32_t vColor, uint32_t vAlpha)
+        {
+            const uint32_t Product = vColor * vAlpha + 128;
+            return static_cast<uint8_t>((Product + (Product >> 8)) >> 8);
+        }
+
+        const uint8_t *getSrgbToLinearTable()
+        {
+            static const auto s_Table = []() {
+                struct { uint8_t Values[256]; } Table{};
+                for (int i = 0; i < 256; ++i)
+                {
+                    const double Srgb   = i / 255.0;
+                    const double Linear = Srgb <= 0.04045 ? Srgb / 12.92 : std::pow((Srgb + 0.055) / 1.055, 2.4);
+                    Table.Values[i] = static_cast<uint8_t>(std::lround(Linear * 255.0));
+                }
+                return Table;
+            }();
+            return s_Table.Values;
+        }
+
+        void premultiplyScalar(uint8_t *vioPixels, size_t vPixelCount)
+        {
+            for (size_t i = 0; i < vPixelCount; ++i, vioPixels += 4)
+            {
+                const uint32_t Alpha = vioPixels[3];
+                vioPixels[0] = mulDiv255(vioPixels[0], Alpha);
+                vioPixels[1] = mulDiv255(vioPixels[1], Alpha);
+                vioPixels[2] = mulDiv255(vioPixels[2], Alpha);
+            }
+        }
+
+#ifdef HIVE_PIXEL_X86
+        // 8 pixels of 16 bit channels as the unpack leaves them, alpha in lanes 3 and 7.
+        inline __m128i premultiplyWords(__m128i vPixels)
+        {
+            const __m128i Alpha   = _mm_shufflehi_epi16(_mm_shufflelo_epi16(vPixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            const __m128i Product = _mm_add_epi16(_mm_mullo_epi16(vPixels, Alpha), _mm_set1_epi16(128));
+            return _mm_srli_epi16(_mm_add_epi16(Product, _mm_srli_epi16(Product, 8)), 8);
+        }
+
+        void premultiplySSE2(uint8_t *vioPixels, size_t vPixelCount)
+        {
+            const __m128i Zero      = _mm_setzero_si128();
+            const __m128i AlphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            size_t i = 0;
+            for (; i + 4 <= vPixelCount; i += 4)
+            {
+                auto *pBlock = reinterpret_cast<__m128i *>(vioPixels + i * 4);
+                const __m128i Source = _mm_loadu_si128(pBlock);
+                const __m128i Lo = premultiplyWords(_mm_unpacklo_epi8(Source, Zero));
+                const __m128i Hi = premultiplyWords(_mm_unpackhi_epi8(Source, Zero));
+                const __m128i Result = _mm_packus_epi16(Lo, Hi);
+                _mm_storeu_si128(pBlock, _mm_or_si128(_mm_andnot_si128(AlphaMask, Result), _mm_and_si128(AlphaMask, Source)));
+            }
+            premultiplyScalar(vioPixels + i * 4, vPixelCount - i);
+        }
+
+        __attribute__((target("avx2"))) void premultiplyAVX2(uint8_t *vioPixels, size_t vPixelCount)
+        {
+            const __m256i Zero      = _mm256_setzero_si256();
+            const __m256i AlphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+            const __m256i Rounding  = _mm256_set1_epi16(128);
+            size_t i = 0;
+            for (; i + 8 <= vPixelCount; i += 8)
+            {
+                auto *pBlock = reinterpret_cast<__m256i *>(vioPixels + i * 4);
+                const __m256i Source = _mm256_loadu_si256(pBlock);
+                // unpack and pack both work per 128 bit lane, so the pixel order survives the round trip
+                __m256i Lo = _mm256_unpacklo_epi8(Source, Zero);
+                __m256i Hi = _mm256_unpackhi_epi8(Source, Zero);
+                const __m256i AlphaLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(Lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                const __m256i AlphaHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(Hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                Lo = _mm256_add_epi16(_mm256_mullo_epi16(Lo, AlphaLo), Rounding);
+                Hi = _mm256_add_epi16(_mm256_mullo_epi16(Hi, AlphaHi), Rounding);
+                Lo = _mm256_srli_epi16(_mm256_add_epi16(Lo, _mm256_srli_epi16(Lo, 8)), 8);
+                Hi = _mm256_srli_epi16(_mm256_add_epi16(Hi, _mm256_srli_epi16(Hi, 8)), 8);
+                const __m256i Result = _mm256_packus_epi16(Lo, Hi);
+                _mm256_storeu_si256(pBlock, _mm256_or_si256(_mm256_andnot_si256(AlphaMask, Result), _mm256_and_si256(AlphaMask, Source)));
+            }
+            premultiplySSE2(vioPixels + i * 4, vPixelCount - i);
+        }
+#endif
+
+#ifdef HIVE_PIXEL_NEON
+        inline uint8x8_t premultiplyLane(uint8x8_t vColor, uint8x8_t vAlpha)
+        {
+            // (p + ((p + 128) >> 8) + 128) >> 8 with p = c * a, the scalar formula
+            const uint16x8_t Product = vmull_u8(vColor, vAlpha);
+            return vraddhn_u16(Product, vrshrq_n_u16(Product, 8));
+        }
+
+        void premultiplyNEON(uint8_t *vioPixels, size_t vPixelCount)
+        {
+            size_t i = 0;
+            for (; i + 16 <= vPixelCount; i += 16)
+            {
+                uint8_t *pBlock = vioPixels + i * 4;
+                uint8x16x4_t Pixels = vld4q_u8(pBlock);
+                for (int Channel = 0; Channel < 3; ++Channel)
+                {
+                    Pixels.val[Channel] = vcombine_u8(premultiplyLane(vget_low_u8(Pixels.val[Channel]), vget_low_u8(Pixels.val[3])),
+                                                      premultiplyLane(vget_high_u8(Pixels.val[Channel]), vget_high_u8(Pixels.val[3])));
+                }
+                vst4q_u8(pBlock, Pixels);
+            }
+            premultiplyScalar(vioPixels + i * 4, vPixelCount - i);
+        }
+#endif
+
+        FPremultiplyKernel getKernelFunction(EPixelKernel vKernel)
+        {
+            switch (vKernel)
+            {
+#ifdef HIVE_PIXEL_X86
+                case EPixelKernel::SSE2: return premultiplySSE2;
+                case EPixelKernel::AVX2: return premultiplyAVX2;
+#endif
+#ifdef HIVE_PIXEL_NEON
+                case EPixelKernel::NEON: return premultiplyNEON;
+#endif
+                default: return premultiplyScalar;
+            }
+        }
+    }
+
+    bool isPixelKernelAvailable(EPixelKernel vKernel)
+    {
+        switch (vKernel)
+        {
+            case EPixelKernel::Scalar: return true;
+#ifdef HIVE_PIXEL_X86
+            case EPixelKernel::SSE2: return __builtin_cpu_supports("sse2");
+            case EPixelKernel::AVX2: return __builtin_cpu_supports("avx2");
+#endif
+#ifdef HIVE_PIXEL_NEON
+            case EPixelKernel::NEON: return true;
+#endif
+            default: return false;
+        }
+    }
+
+    const char *getPixelKernelName(EPixelKernel vKernel)
+    {
+        switch (vKernel)
+        {
+            case EPixelKernel::Scalar: return "scalar";
+            case EPixelKernel::SSE2:   return "sse2";
+            case EPixelKernel::AVX2:   return "avx2";
+            case EPixelKernel::NEON:   return "neon";
+            default:                   return "unknown";
+        }
+    }
+
+    EPixelKernel getBestPixelKernel()
+    {
+        static const EPixelKernel s_BestKernel = []() {
+            for (EPixelKernel Kernel : {EPixelKernel::AVX2, EPixelKernel::NEON, EPixelKernel::SSE2})
+                if (isPixelKernelAvailable(Kernel)) return Kernel;
+            return EPixelKernel::Scalar;
+        }();
+        return s_BestKernel;
+    }
+
+    void premultiplyAlpha(uint8_t *vioPixels, size_t vPixelCount, EAlphaConversion vConversion, EPixelKernel vKernel)
+    {
+        if (vConversion == EAlphaConversion::None) return;
+        assert(isPixelKernelAvailable(vKernel));
+        const FPremultiplyKernel Kernel = getKernelFunction(vKernel);
+        if (vConversion == EAlphaConversion::Premultiply)
+        {
+            Kernel(vioPixels, vPixelCount);
+            return;
+        }
+
+        // The table lookup is a gather no kernel does well, it runs on chunks that are still in L1 when the kernel reads them
+        const uint8_t *pToLinear = getSrgbToLinearTable();
+        constexpr size_t ChunkPixels = 1024;
+        for (size_t First = 0; First < vPixelCount; First += ChunkPixels)
+        {
+            const size_t Count = std::min(ChunkPixels, vPixelCount - First);
+            uint8_t *pChunk = vioPixels + First * 4;
+            for (size_t i = 0; i < Count * 4; i += 4)
+            {
+                pChunk[i]     = pToLinear[pChunk[i]];
+                pChunk[i + 1] = pToLinear[pChunk[i + 1]];
+                pChunk[i + 2] = pToLinear[pChunk[i + 2]];
+            }
+            Kernel(pChunk, Count);
+        }
+    }
+
+    void premultiplyAlpha(SImageData &vioImage, EAlphaConversion vConversion)
+    {
+        assert(vioImage.Channels == 4);
+        premultiplyAlpha(vioImage.Pixels.data(), static_cast<size_t>(vioImage.Width) * vioImage.Height, vConversion, getBestPixelKernel());
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "ImageData.h"
+
+namespace hiveVG
+{
+    enum class EAlphaConversion
+    {
+        None,              // keep the straight alpha the decoders produce
+        Premultiply,       // for GL_ONE, GL_ONE_MINUS_SRC_ALPHA blending
+        PremultiplyLinear  // sRGB color decoded to linear first, then premultiplied
+    };
+
+    enum class EPixelKernel
+    {
+        Scalar,  // reference, every other kernel must match it bit for bit
+        SSE2,
+        AVX2,
+        NEON,
+        Count
+    };
+
+    [[nodiscard]] bool         isPixelKernelAvailable(EPixelKernel vKernel);
+    [[nodiscard]] const char*  getPixelKernelName(EPixelKernel vKernel);
+    // Widest kernel the running CPU supports, checked once.
+    [[nodiscard]] EPixelKernel getBestPixelKernel();
+
+    /*!
+     * One pass over RGBA8 pixels in place: color = round(color * alpha / 255), alpha is kept.
+     * With PremultiplyLinear the color goes through an 8 bit sRGB to linear table before the multiply.
+     * Every kernel gives exactly the scalar result, so the choice only changes speed.
+     * @param vioPixels tightly packed RGBA8
+     * @param vPixelCount number of pixels, not bytes
+     * @param vConversion None returns at once
+     * @param vKernel must be available on this CPU
+     */
+    void premultiplyAlpha(uint8_t *vioPixels, size_t vPixelCount, EAlphaConversion vConversion, EPixelKernel vKernel);
+    void premultiplyAlpha(SImageData &vioImage, EAlphaConversion vConversion);
+}
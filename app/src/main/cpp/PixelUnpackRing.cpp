@@ -0,0 +1,186 @@
+#include "PixelUnpackRing.h"
+#include <algorithm>
+#include "Common.h"
+
+namespace hiveVG
+{
+#define HIVE_LOGTAG hiveVG::TAG_KEYWORD::TEXTURE_ASSET_TAG
+    CPixelUnpackRing::CPixelUnpackRing(size_t vSlotCount, int vBandRows)
+    {
+        m_Slots.resize(std::max<size_t>(vSlotCount, 1));
+        for (auto &Slot : m_Slots)
+            glGenBuffers(1, &Slot.Buffer);
+        setBandRows(vBandRows);
+    }
+
+    CPixelUnpackRing::~CPixelUnpackRing()
+    {
+        for (auto &Slot : m_Slots)
+        {
+            if (Slot.Fence != nullptr) glDeleteSync(Slot.Fence);
+            glDeleteBuffers(1, &Slot.Buffer);
+        }
+        if (!m_ImageBuffers.empty()) glDeleteBuffers(static_cast<GLsizei>(m_ImageBuffers.size()), m_ImageBuffers.data());
+    }
+
+    void CPixelUnpackRing::setBandRows(int vBandRows)
+    {
+        m_BandRows = std::max(vBandRows, 1);
+    }
+
+    void CPixelUnpackRing::beginFrame()
+    {
+        m_Stats.BytesThisFrame = 0;
+        m_Stats.BandsThisFrame = 0;
+    }
+
+    bool CPixelUnpackRing::streamTexture(GLuint vTextureId, int vWidth, int vHeight, const FBandFiller &vFillBand)
+    {
+        const size_t RowPitch = static_cast<size_t>(vWidth) * 4;
+        // A texture taller than the ring takes several bands per slot, reusing a slot within it would wait for its own bands
+        const int BandCount    = (vHeight + m_BandRows - 1) / m_BandRows;
+        const int SlotBandRows = m_BandRows * ((BandCount + static_cast<int>(m_Slots.size()) - 1) / static_cast<int>(m_Slots.size()));
+        for (int SlotFirstRow = 0; SlotFirstRow < vHeight; SlotFirstRow += SlotBandRows)
+        {
+            const int SlotRowCount = std::min(SlotBandRows, vHeight - SlotFirstRow);
+            uint8_t *pDst = __mapNextSlot(RowPitch * SlotRowCount);
+            if (pDst == nullptr) return false;
+            bool IsFilled = true;
+            for (int FirstRow = SlotFirstRow; IsFilled && FirstRow < SlotFirstRow + SlotRowCount; FirstRow += m_BandRows)
+                IsFilled = vFillBand(pDst + RowPitch * (FirstRow - SlotFirstRow), RowPitch, FirstRow, std::min(m_BandRows, SlotFirstRow + SlotRowCount - FirstRow));
+            if (!__unmapCurrentSlot() || !IsFilled)
+            {
+                __unbindCurrentSlot();
+                return false;
+            }
+            for (int FirstRow = SlotFirstRow; FirstRow < SlotFirstRow + SlotRowCount; FirstRow += m_BandRows)
+                __uploadRows(vTextureId, vWidth, FirstRow, std::min(m_BandRows, SlotFirstRow + SlotRowCount - FirstRow), RowPitch * (FirstRow - SlotFirstRow));
+            __fenceCurrentSlot();
+        }
+        return true;
+    }
+
+    bool CPixelUnpackRing::streamWholeImage(GLuint vTextureId, int vWidth, int vHeight, const FBandFiller &vFillImage)
+    {
+        const size_t RowPitch = static_cast<size_t>(vWidth) * 4;
+        uint8_t *pDst = __mapNextSlot(RowPitch * vHeight);
+        if (pDst == nullptr) return false;
+        bool IsFilled = vFillImage(pDst, RowPitch, 0, vHeight);
+        if (!__unmapCurrentSlot() || !IsFilled)
+        {
+            __unbindCurrentSlot();
+            return false;
+        }
+        for (int FirstRow = 0; FirstRow < vHeight; FirstRow += m_BandRows)
+        {
+            const int RowCount = std::min(m_BandRows, vHeight - FirstRow);
+            __uploadRows(vTextureId, vWidth, FirstRow, RowCount, RowPitch * FirstRow);
+        }
+        __fenceCurrentSlot();
+        return true;
+    }
+
+    bool CPixelUnpackRing::mapImage(int vWidth, int vHeight, SMappedPixelImage &voImage)
+    {
+        voImage = {};
+        const size_t RowPitch = static_cast<size_t>(vWidth) * 4;
+        GLuint Buffer = 0;
+        glGenBuffers(1, &Buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, Buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(RowPitch * vHeight), nullptr, GL_STREAM_DRAW);
+        auto *pMapped = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(RowPitch * vHeight),
+                                                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        __unbindCurrentSlot();
+        if (pMapped == nullptr)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Failed to map %zu bytes of pixel unpack buffer for a %dx%d image", RowPitch * vHeight, vWidth, vHeight);
+            glDeleteBuffers(1, &Buffer);
+            return false;
+        }
+        m_ImageBuffers.push_back(Buffer);
+        voImage = {Buffer, pMapped, RowPitch, vWidth, vHeight};
+        return true;
+    }
+
+    bool CPixelUnpackRing::uploadImage(GLuint vTextureId, SMappedPixelImage &vioImage)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, vioImage.Buffer);
+        const bool IsIntact = __unmapCurrentSlot();
+        for (int FirstRow = 0; IsIntact && FirstRow < vioImage.Height; FirstRow += m_BandRows)
+            __uploadRows(vTextureId, vioImage.Width, FirstRow, std::min(m_BandRows, vioImage.Height - FirstRow), vioImage.RowPitch * FirstRow);
+        __unbindCurrentSlot();
+        // The driver keeps the storage until the uploads above have read it, no fence is needed
+        releaseImage(vioImage);
+        return IsIntact;
+    }
+
+    void CPixelUnpackRing::releaseImage(SMappedPixelImage &vioImage)
+    {
+        const auto Found = std::find(m_ImageBuffers.begin(), m_ImageBuffers.end(), vioImage.Buffer);
+        if (Found == m_ImageBuffers.end()) return;
+        // Deleting a mapped buffer unmaps it
+        glDeleteBuffers(1, &vioImage.Buffer);
+        m_ImageBuffers.erase(Found);
+        vioImage = {};
+    }
+
+    uint8_t *CPixelUnpackRing::__mapNextSlot(size_t vBytes)
+    {
+        m_CurrentSlot = (m_CurrentSlot + 1) % m_Slots.size();
+        SSlot &Slot = m_Slots[m_CurrentSlot];
+        if (Slot.Fence != nullptr)
+        {
+            // The GPU may still be reading the previous band of this slot.
+            if (glClientWaitSync(Slot.Fence, 0, 0) != GL_ALREADY_SIGNALED)
+            {
+                ++m_Stats.StallCount;
+                glClientWaitSync(Slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            }
+            glDeleteSync(Slot.Fence);
+            Slot.Fence = nullptr;
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, Slot.Buffer);
+        if (Slot.Capacity < vBytes)
+        {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(vBytes), nullptr, GL_STREAM_DRAW);
+            Slot.Capacity = vBytes;
+        }
+        auto *pMapped = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(vBytes), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (pMapped == nullptr)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Failed to map %zu bytes of pixel unpack buffer", vBytes);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        return pMapped;
+    }
+
+    bool CPixelUnpackRing::__unmapCurrentSlot()
+    {
+        GLboolean IsIntact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        if (IsIntact == GL_FALSE) LOG_ERROR(HIVE_LOGTAG, "Pixel unpack buffer contents were lost while mapped");
+        return IsIntact == GL_TRUE;
+    }
+
+    void CPixelUnpackRing::__uploadRows(GLuint vTextureId, int vWidth, int vFirstRow, int vRowCount, size_t vBufferOffset)
+    {
+        glBindTexture(GL_TEXTURE_2D, vTextureId);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, vFirstRow, vWidth, vRowCount, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void *>(vBufferOffset));
+        const size_t Bytes = static_cast<size_t>(vWidth) * 4 * vRowCount;
+        m_Stats.BytesThisFrame += Bytes;
+        m_Stats.TotalBytes     += Bytes;
+        ++m_Stats.BandsThisFrame;
+    }
+
+    void CPixelUnpackRing::__fenceCurrentSlot()
+    {
+        m_Slots[m_CurrentSlot].Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        __unbindCurrentSlot();
+    }
+
+    void CPixelUnpackRing::__unbindCurrentSlot()
+    {
+        // Left bound, every later client memory upload would be read as an offset into this buffer
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <GLES3/gl3.h>
+
+namespace hiveVG
+{
+    struct SPixelStreamStats
+    {
+        size_t   BytesThisFrame = 0;
+        size_t   BandsThisFrame = 0;
+        uint64_t TotalBytes     = 0;
+        size_t   StallCount     = 0;
+    };
+
+    // Whole image mapped by CPixelUnpackRing::mapImage(), pTexels may be written from any thread until it is uploaded
+    struct SMappedPixelImage
+    {
+        GLuint   Buffer   = 0;
+        uint8_t* pTexels  = nullptr;
+        size_t   RowPitch = 0;
+        int      Width    = 0;
+        int      Height   = 0;
+    };
+
+    /*!
+     * Ring of GL_PIXEL_UNPACK_BUFFERs used to stream RGBA8 texels into level 0 of a texture in row bands.
+     * Producers write straight into the mapped buffer, so the pixels never pass through an extra heap copy
+     * and glTexSubImage2D sources them from the PBO instead of making its own driver side staging copy.
+     */
+    class CPixelUnpackRing
+    {
+    public:
+        // Writes vRowCount rows starting at vFirstRow into vDst, rows are vRowPitch bytes apart.
+        using FBandFiller = std::function<bool(uint8_t *vDst, size_t vRowPitch, int vFirstRow, int vRowCount)>;
+
+        CPixelUnpackRing(size_t vSlotCount, int vBandRows);
+        ~CPixelUnpackRing();
+
+        CPixelUnpackRing(const CPixelUnpackRing &) = delete;
+        CPixelUnpackRing &operator=(const CPixelUnpackRing &) = delete;
+
+        // vFillBand is called once per band. Each slot is mapped at most once per texture, a texture with more bands than
+        // slots puts several into each, so only the bands of earlier textures can make it wait (StallCount).
+        bool streamTexture(GLuint vTextureId, int vWidth, int vHeight, const FBandFiller &vFillBand);
+        // For producers that can only write the whole image at once (AImageDecoder): one mapping, uploaded band by band.
+        bool streamWholeImage(GLuint vTextureId, int vWidth, int vHeight, const FBandFiller &vFillImage);
+        // For producers on other threads, e.g. a decode worker: a buffer of its own, not a ring slot, so streams go on
+        // while it is filled. uploadImage() sends it to level 0 in row bands, either call frees the buffer.
+        bool mapImage(int vWidth, int vHeight, SMappedPixelImage &voImage);
+        bool uploadImage(GLuint vTextureId, SMappedPixelImage &vioImage);
+        void releaseImage(SMappedPixelImage &vioImage);
+
+        void beginFrame();
+        void setBandRows(int vBandRows);
+        [[nodiscard]] int                      getBandRows() const { return m_BandRows; }
+        [[nodiscard]] const SPixelStreamStats &getStats() const { return m_Stats; }
+
+    private:
+        struct SSlot
+        {
+            GLuint Buffer   = 0;
+            size_t Capacity = 0;
+            GLsync Fence    = nullptr;
+        };
+
+        uint8_t *__mapNextSlot(size_t vBytes);
+        bool     __unmapCurrentSlot();
+        void     __uploadRows(GLuint vTextureId, int vWidth, int vFirstRow, int vRowCount, size_t vBufferOffset);
+        void     __fenceCurrentSlot();
+        // Every path out of a stream ends here, a mapped or filled slot included
+        void     __unbindCurrentSlot();
+
+        std::vector<SSlot>  m_Slots;
+        // Deleted with the ring if still mapped, e.g. when the loader filling them shut down
+        std::vector<GLuint> m_ImageBuffers;
+        size_t              m_CurrentSlot = 0;
+        int                 m_BandRows    = 64;
+        SPixelStreamStats   m_Stats;
+    };
+}
@@ -0,0 +1,73 @@
+#include "QualityTier.h"
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+
+namespace hiveVG
+{
+    const char *getQualityTierName(EQualityTier vTier)
+    {
+        switch (vTier)
+        {
+            case EQualityTier::Low:    return "Low";
+            case EQualityTier::Medium: return "Medium";
+            case EQualityTier::High:   return "High";
+            default:                   return "Source";
+        }
+    }
+
+    bool findQualityTier(const char *vName, EQualityTier &voTier)
+    {
+        for (EQualityTier Tier : {EQualityTier::Low, EQualityTier::Medium, EQualityTier::High, EQualityTier::Source})
+        {
+            if (std::strcmp(vName, getQualityTierName(Tier)) != 0) continue;
+            voTier = Tier;
+            return true;
+        }
+        return false;
+    }
+
+    float getQualityTierScale(EQualityTier vTier)
+    {
+        switch (vTier)
+        {
+            case EQualityTier::Low:    return 0.5f;
+            case EQualityTier::Medium: return 0.75f;
+            case EQualityTier::High:   return 1.0f;
+            default:                   return 0.0f;
+        }
+    }
+
+    EQualityTier selectQualityTier(int vSurfaceWidth, int vSurfaceHeight, uint64_t vPhysicalMemoryBytes)
+    {
+        constexpr uint64_t GiB = 1ull << 30;
+        constexpr int      MinHighSurfaceSide = 1000;
+        const int ShortSide = std::min(vSurfaceWidth, vSurfaceHeight);
+        const bool IsMemoryKnown = vPhysicalMemoryBytes > 0;
+        if ((IsMemoryKnown && vPhysicalMemoryBytes < 3 * GiB) || (ShortSide > 0 && ShortSide < MinHighSurfaceSide)) return EQualityTier::Low;
+        if (IsMemoryKnown && vPhysicalMemoryBytes < 6 * GiB) return EQualityTier::Medium;
+        return EQualityTier::High;
+    }
+
+    bool computeDecodeSize(const SDecodeTarget &vTarget, int vSourceWidth, int vSourceHeight, int vColumns, int vRows, int &voWidth, int &voHeight)
+    {
+        voWidth  = vSourceWidth;
+        voHeight = vSourceHeight;
+        if (!vTarget.isActive() || vColumns <= 0 || vRows <= 0) return false;
+
+        const int SourceCellWidth  = vSourceWidth / vColumns;
+        const int SourceCellHeight = vSourceHeight / vRows;
+        if (SourceCellWidth <= 0 || SourceCellHeight <= 0) return false;
+        const float TierScale = getQualityTierScale(vTarget.Tier);
+        const float Scale = std::max(TierScale * vTarget.SurfaceWidth / SourceCellWidth, TierScale * vTarget.SurfaceHeight / SourceCellHeight);
+        if (Scale >= 1.0f) return false;
+
+        constexpr int CellAlignment = 4;
+        const int CellWidth  = std::max(static_cast<int>(SourceCellWidth * Scale + 0.5f) / CellAlignment * CellAlignment, CellAlignment);
+        const int CellHeight = std::max(static_cast<int>(SourceCellHeight * Scale + 0.5f) / CellAlignment * CellAlignment, CellAlignment);
+        if (CellWidth >= SourceCellWidth || CellHeight >= SourceCellHeight) return false;
+        voWidth  = CellWidth * vColumns;
+        voHeight = CellHeight * vRows;
+        return true;
+    }
+}
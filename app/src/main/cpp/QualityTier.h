@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+namespace hiveVG
+{
+    // How much texture detail is kept relative to the pixels the surface can actually show.
+    enum class EQualityTier
+    {
+        Low,     // half the surface resolution
+        Medium,  // three quarters of it
+        High,    // one texel per surface pixel
+        Source   // never downscaled
+    };
+
+    /*!
+     * Size that textures covering the whole surface are decoded to. Textures are never scaled up, so on a surface
+     * at least as large as the artwork every tier decodes at source size.
+     */
+    struct SDecodeTarget
+    {
+        int          SurfaceWidth  = 0;
+        int          SurfaceHeight = 0;
+        EQualityTier Tier          = EQualityTier::Source;
+
+        [[nodiscard]] bool isActive() const { return Tier != EQualityTier::Source && SurfaceWidth > 0 && SurfaceHeight > 0; }
+    };
+
+    const char* getQualityTierName(EQualityTier vTier);
+    // The tier getQualityTierName() calls vName, false for anything else
+    bool        findQualityTier(const char *vName, EQualityTier &voTier);
+    // Fraction of the surface resolution the tier keeps, 0 for Source
+    float       getQualityTierScale(EQualityTier vTier);
+
+    /*!
+     * Tier for a device class: Low below 3 GiB of RAM or on a surface under 1000 pixels on its short side (720p class
+     * phones), Medium below 6 GiB, High otherwise. Source is never picked, it is for comparisons only. 0 for an unknown
+     * surface or memory size leaves that criterion out.
+     */
+    EQualityTier selectQualityTier(int vSurfaceWidth, int vSurfaceHeight, uint64_t vPhysicalMemoryBytes);
+
+    /*!
+     * Decode size of a vSourceWidth x vSourceHeight image made of vColumns x vRows cells that each cover the surface.
+     * The cells are scaled uniformly until they still cover the tier's share of the surface in both directions, and
+     * are kept a multiple of 4 texels so the atlas still splits evenly and a few mip levels stay exact.
+     * @return false if the image is kept at its source size
+     */
+    bool computeDecodeSize(const SDecodeTarget &vTarget, int vSourceWidth, int vSourceHeight, int vColumns, int vRows, int &voWidth, int &voHeight);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace hiveVG
+{
+    struct SResourceCacheStats
+    {
+        uint64_t HitCount      = 0;
+        uint64_t MissCount     = 0;
+        uint64_t EvictionCount = 0;
+        uint64_t EvictedBytes  = 0;
+        size_t   ResidentBytes = 0;
+        size_t   PinnedBytes   = 0;
+        size_t   EntryCount    = 0;
+    };
+
+    /*!
+     * Keyed cache of shared resources with LRU eviction under a byte budget.
+     * TResource must provide size_t getEstimatedBytes() const. An entry is only evicted while nobody but the
+     * cache holds it, so handles in use are never invalidated. Pending resources (e.g. textures still
+     * decoding) are cached as well, so a second request for the same key joins the load in flight.
+     * Pinned bytes stand for memory the cache does not hold but shares the budget with, e.g. render targets: they
+     * are never evicted, cached entries are evicted to make room for them.
+     * The policy itself knows nothing about GL, but evicting drops the last reference, so a cache of GL
+     * resources must only be acquired from and trimmed on the GL thread.
+     */
+    template<typename TKey, typename TResource, typename THash = std::hash<TKey>>
+    class CResourceCache
+    {
+    public:
+        using FCreateResource = std::function<std::shared_ptr<TResource>()>;
+
+        explicit CResourceCache(size_t vBudgetBytes) : m_BudgetBytes(vBudgetBytes) {}
+
+        std::shared_ptr<TResource> acquire(const TKey &vKey, const FCreateResource &vCreate)
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            auto Iter = m_Index.find(vKey);
+            if (Iter != m_Index.end())
+            {
+                ++m_Stats.HitCount;
+                m_Entries.splice(m_Entries.begin(), m_Entries, Iter->second);
+                return Iter->second->second;
+            }
+
+            ++m_Stats.MissCount;
+            std::shared_ptr<TResource> pResource = vCreate();
+            if (pResource == nullptr) return nullptr;
+            m_Entries.emplace_front(vKey, pResource);
+            m_Index.emplace(vKey, m_Entries.begin());
+            __trimLocked();
+            return pResource;
+        }
+
+        // Re-measures the entries (pending ones grow once uploaded) and evicts unreferenced entries LRU first.
+        void trim()
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            __trimLocked();
+        }
+
+        // Replaces what vName pinned before, 0 unpins it. Trims if that changed anything.
+        void setPinnedBytes(const std::string &vName, size_t vBytes)
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            auto Iter = m_PinnedBytes.find(vName);
+            if ((Iter == m_PinnedBytes.end() ? 0 : Iter->second) == vBytes) return;
+            if (vBytes == 0)
+                m_PinnedBytes.erase(Iter);
+            else
+                m_PinnedBytes[vName] = vBytes;
+            __trimLocked();
+        }
+
+        void setBudgetBytes(size_t vBudgetBytes)
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            m_BudgetBytes = vBudgetBytes;
+            __trimLocked();
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            m_Index.clear();
+            m_Entries.clear();
+            m_Stats.ResidentBytes = 0;
+            m_Stats.EntryCount    = 0;
+        }
+
+        [[nodiscard]] SResourceCacheStats getStats() const
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            return m_Stats;
+        }
+
+        [[nodiscard]] size_t getBudgetBytes() const { return m_BudgetBytes; }
+
+    private:
+        using FEntryList = std::list<std::pair<TKey, std::shared_ptr<TResource>>>;
+
+        void __trimLocked()
+        {
+            size_t ResidentBytes = 0;
+            for (const auto &Entry : m_Entries) ResidentBytes += Entry.second->getEstimatedBytes();
+            size_t PinnedBytes = 0;
+            for (const auto &Pinned : m_PinnedBytes) PinnedBytes += Pinned.second;
+
+            for (auto Iter = m_Entries.end(); Iter != m_Entries.begin() && ResidentBytes + PinnedBytes > m_BudgetBytes;)
+            {
+                --Iter;
+                if (Iter->second.use_count() > 1) continue;
+                const size_t Bytes = Iter->second->getEstimatedBytes();
+                ResidentBytes -= Bytes;
+                m_Stats.EvictedBytes += Bytes;
+                ++m_Stats.EvictionCount;
+                m_Index.erase(Iter->first);
+                Iter = m_Entries.erase(Iter);
+            }
+            m_Stats.ResidentBytes = ResidentBytes;
+            m_Stats.PinnedBytes   = PinnedBytes;
+            m_Stats.EntryCount    = m_Entries.size();
+        }
+
+        size_t                                                   m_BudgetBytes;
+        FEntryList                                               m_Entries;   // most recently used first
+        std::unordered_map<TKey, typename FEntryList::iterator, THash> m_Index;
+        std::unordered_map<std::string, size_t>                  m_PinnedBytes;
+        SResourceCacheStats                                      m_Stats;
+        mutable std::mutex                                       m_Mutex;
+    };
+}
@@ -0,0 +1,203 @@
+#include "SceneDescription.h"
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <sstream>
+#include "Common.h"
+
+namespace hiveVG
+{
+#define HIVE_LOGTAG hiveVG::TAG_KEYWORD::SCENE_TAG
+    namespace
+    {
+        bool parseKind(const std::string &vName, ESceneLayerKind &voKind)
+        {
+            if (vName == "image") voKind = ESceneLayerKind::Image;
+            else if (vName == "sequence") voKind = ESceneLayerKind::Sequence;
+            else return false;
+            return true;
+        }
+
+        bool parseBlendMode(const std::string &vName, ESceneBlendMode &voMode)
+        {
+            for (ESceneBlendMode Mode : {ESceneBlendMode::Opaque, ESceneBlendMode::Alpha, ESceneBlendMode::Premultiplied, ESceneBlendMode::Additive})
+            {
+                if (vName != getSceneBlendModeName(Mode)) continue;
+                voMode = Mode;
+                return true;
+            }
+            return false;
+        }
+
+        bool parseTier(const std::string &vName, EQualityTier &voTier)
+        {
+            return findQualityTier(vName.c_str(), voTier);
+        }
+
+        bool parseUpsampleFilter(const std::string &vName, ESceneUpsampleFilter &voFilter)
+        {
+            if (vName == "linear") voFilter = ESceneUpsampleFilter::Linear;
+            else if (vName == "edge") voFilter = ESceneUpsampleFilter::Edge;
+            else return false;
+            return true;
+        }
+
+        // "<fraction> [<tier>]", the tier caps the tiers it applies to
+        bool parseRenderScale(std::istringstream &vioLine, SSceneLayer &vioLayer)
+        {
+            float Scale = 0.0f;
+            if (!(vioLine >> Scale) || Scale <= 0.0f || Scale > 1.0f) return false;
+            EQualityTier MaxTier = EQualityTier::Source;
+            std::string TierName, Extra;
+            if ((vioLine >> TierName) && !parseTier(TierName, MaxTier)) return false;
+            if (vioLine >> Extra) return false;
+            for (int Tier = 0; Tier <= static_cast<int>(MaxTier); ++Tier) vioLayer.RenderScales[Tier] = Scale;
+            return true;
+        }
+
+        // The rest of vioLine must be exactly one integer per value
+        bool parseIntegers(std::istringstream &vioLine, std::initializer_list<int *> vValues)
+        {
+            for (int *pValue : vValues)
+                if (!(vioLine >> *pValue)) return false;
+            std::string Extra;
+            return !(vioLine >> Extra);
+        }
+
+        // The rest of vioLine must be exactly one word
+        bool parseWord(std::istringstream &vioLine, std::string &voWord)
+        {
+            std::string Extra;
+            return (vioLine >> voWord) && !(vioLine >> Extra);
+        }
+
+        bool parseLayerField(const std::string &vKey, std::istringstream &vioLine, SSceneLayer &vioLayer)
+        {
+            std::string Word;
+            if (vKey == "kind")    return parseWord(vioLine, Word) && parseKind(Word, vioLayer.Kind);
+            if (vKey == "texture") return parseWord(vioLine, vioLayer.TexturePath);
+            if (vKey == "motion")  return parseWord(vioLine, vioLayer.MotionPath);
+            if (vKey == "sprites") return parseWord(vioLine, vioLayer.SpritePath);
+            if (vKey == "hull")    return parseWord(vioLine, vioLayer.HullPath);
+            if (vKey == "grid")    return parseIntegers(vioLine, {&vioLayer.Rows, &vioLayer.Columns});
+            if (vKey == "fps")     return parseIntegers(vioLine, {&vioLayer.FramesPerSecond});
+            if (vKey == "phase")   return parseIntegers(vioLine, {&vioLayer.Phase});
+            if (vKey == "depth")   return parseIntegers(vioLine, {&vioLayer.Depth});
+            if (vKey == "blend")   return parseWord(vioLine, Word) && parseBlendMode(Word, vioLayer.BlendMode);
+            if (vKey == "tier")    return parseWord(vioLine, Word) && parseTier(Word, vioLayer.MinTier);
+            if (vKey == "scale")   return parseRenderScale(vioLine, vioLayer);
+            if (vKey == "upsample") return parseWord(vioLine, Word) && parseUpsampleFilter(Word, vioLayer.UpsampleFilter);
+            return false;
+        }
+
+        bool validateLayer(const SSceneLayer &vLayer)
+        {
+            if (vLayer.TexturePath.empty())
+            {
+                LOG_ERROR(HIVE_LOGTAG, "Layer %s has no texture", vLayer.Name.c_str());
+                return false;
+            }
+            if (vLayer.Kind == ESceneLayerKind::Sequence && (vLayer.Rows <= 0 || vLayer.Columns <= 0 || vLayer.FramesPerSecond <= 0 || vLayer.Phase < 0))
+            {
+                LOG_ERROR(HIVE_LOGTAG, "Sequence layer %s needs a positive grid and fps and a phase of at least 0", vLayer.Name.c_str());
+                return false;
+            }
+            // Images are drawn 1:1 already, a reduced copy of one costs a pass and saves nothing
+            if (vLayer.Kind == ESceneLayerKind::Image && std::any_of(std::begin(vLayer.RenderScales), std::end(vLayer.RenderScales), [](float vScale) { return vScale < 1.0f; }))
+            {
+                LOG_ERROR(HIVE_LOGTAG, "Layer %s is an image, only sequences are drawn at a reduced scale", vLayer.Name.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        // Shader first, it is the most expensive switch and image and sequence layers never share one
+        bool isDrawnBefore(const SSceneLayer &vLeft, const SSceneLayer &vRight)
+        {
+            if (vLeft.Depth != vRight.Depth) return vLeft.Depth < vRight.Depth;
+            if (vLeft.Kind != vRight.Kind) return vLeft.Kind < vRight.Kind;
+            if (vLeft.isSprite() != vRight.isSprite()) return vRight.isSprite();
+            if (vLeft.BlendMode != vRight.BlendMode) return vLeft.BlendMode < vRight.BlendMode;
+            return vLeft.isSprite() ? vLeft.SpritePath < vRight.SpritePath : vLeft.TexturePath < vRight.TexturePath;
+        }
+    }
+
+    bool parseSceneDescription(const char *vText, size_t vSize, SSceneDescription &voScene)
+    {
+        voScene.Layers.clear();
+        std::istringstream Text(std::string(vText, vSize));
+        std::string Line;
+        int LineNumber = 0;
+        while (std::getline(Text, Line))
+        {
+            ++LineNumber;
+            const size_t CommentStart = Line.find('#');
+            if (CommentStart != std::string::npos) Line.resize(CommentStart);
+            std::istringstream Fields(Line);
+            std::string Key;
+            if (!(Fields >> Key)) continue;
+
+            if (Key == "layer")
+            {
+                if (!voScene.Layers.empty() && !validateLayer(voScene.Layers.back())) return false;
+                voScene.Layers.emplace_back();
+                if (parseWord(Fields, voScene.Layers.back().Name)) continue;
+            }
+            else if (!voScene.Layers.empty() && parseLayerField(Key, Fields, voScene.Layers.back()))
+                continue;
+            LOG_ERROR(HIVE_LOGTAG, "Scene line %d is not understood: %s", LineNumber, Line.c_str());
+            return false;
+        }
+        return voScene.Layers.empty() || validateLayer(voScene.Layers.back());
+    }
+
+    std::vector<SSceneLayer> selectSceneLayers(const SSceneDescription &vScene, EQualityTier vTier)
+    {
+        std::vector<SSceneLayer> Layers;
+        for (const SSceneLayer &Layer : vScene.Layers)
+            if (Layer.MinTier <= vTier) Layers.push_back(Layer);
+        // Stable, so layers that tie on everything keep the file's order
+        std::stable_sort(Layers.begin(), Layers.end(), isDrawnBefore);
+        return Layers;
+    }
+
+    std::vector<SStaticLayerGroup> findStaticLayerGroups(const std::vector<SSceneLayer> &vLayers, size_t vMinLayerCount)
+    {
+        std::vector<SStaticLayerGroup> Groups;
+        size_t First = 0;
+        while (First < vLayers.size())
+        {
+            size_t End = First;
+            while (End < vLayers.size() && vLayers[End].Kind == ESceneLayerKind::Image) ++End;
+            if (End > First && End - First >= vMinLayerCount)
+                Groups.push_back({First, End - First, vLayers[First].BlendMode == ESceneBlendMode::Opaque});
+            First = std::max(End, First + 1);
+        }
+        return Groups;
+    }
+
+    int countSceneStateChanges(const std::vector<SSceneLayer> &vLayers)
+    {
+        int ChangeCount = 0;
+        for (size_t i = 0; i < vLayers.size(); ++i)
+        {
+            const SSceneLayer *pPrevious = i > 0 ? &vLayers[i - 1] : nullptr;
+            const SSceneLayer &Layer = vLayers[i];
+            if (pPrevious == nullptr || pPrevious->Kind != Layer.Kind || pPrevious->isSprite() != Layer.isSprite()) ++ChangeCount;
+            if (pPrevious == nullptr || pPrevious->BlendMode != Layer.BlendMode) ++ChangeCount;
+            if (pPrevious == nullptr || pPrevious->TexturePath != Layer.TexturePath || pPrevious->SpritePath != Layer.SpritePath) ++ChangeCount;
+        }
+        return ChangeCount;
+    }
+
+    const char *getSceneBlendModeName(ESceneBlendMode vMode)
+    {
+        switch (vMode)
+        {
+            case ESceneBlendMode::Opaque:        return "opaque";
+            case ESceneBlendMode::Premultiplied: return "premultiplied";
+            case ESceneBlendMode::Additive:      return "additive";
+            default:                             return "alpha";
+        }
+    }
+}
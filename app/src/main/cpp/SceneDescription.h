@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "QualityTier.h"
+
+namespace hiveVG
+{
+    enum class ESceneLayerKind
+    {
+        Image,      // one still texture
+        Sequence    // an atlas (or .hseq) of frames played at FramesPerSecond
+    };
+
+    enum class ESceneBlendMode
+    {
+        Opaque,         // blending off
+        Alpha,          // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA on straight alpha
+        Premultiplied,  // GL_ONE, GL_ONE_MINUS_SRC_ALPHA, the texture is premultiplied at load time
+        Additive        // GL_SRC_ALPHA, GL_ONE
+    };
+
+    // How a layer drawn at a reduced render scale is brought back to the surface's resolution
+    enum class ESceneUpsampleFilter
+    {
+        Linear,     // bilinear
+        Edge        // bilinear, sharpened towards the nearest texels where alpha changes, so small shapes keep their contrast
+    };
+
+    // One full screen layer of a scene file
+    struct SSceneLayer
+    {
+        std::string     Name;
+        ESceneLayerKind Kind            = ESceneLayerKind::Image;
+        std::string     TexturePath;
+        std::string     MotionPath;                     // sequences only, optional baked motion vectors
+        std::string     SpritePath;                     // sequences only, optional .hspr rect table drawn instead of TexturePath
+        std::string     HullPath;                       // sequences only, optional .hhul meshes drawn instead of the full screen quad
+        int             Rows            = 1;            // atlas grid of a sequence
+        int             Columns         = 1;
+        int             FramesPerSecond = 0;
+        int             Phase           = 0;            // frame the layer starts on, so layers sharing frames do not move in step
+        ESceneBlendMode BlendMode       = ESceneBlendMode::Alpha;
+        int             Depth           = 0;            // drawn back to front, layers of equal depth may swap places
+        EQualityTier    MinTier         = EQualityTier::Low;
+        float           RenderScales[4] = {1.0f, 1.0f, 1.0f, 1.0f};   // sequences only, by EQualityTier: share of the surface resolution drawn
+        ESceneUpsampleFilter UpsampleFilter = ESceneUpsampleFilter::Edge;
+
+        [[nodiscard]] int   getFrameCount() const { return Rows * Columns; }
+        [[nodiscard]] float getRenderScale(EQualityTier vTier) const { return RenderScales[static_cast<int>(vTier)]; }
+        // Drawn as tight quads from trimmed frames, see SpriteAtlas.h
+        [[nodiscard]] bool  isSprite() const { return Kind == ESceneLayerKind::Sequence && !SpritePath.empty(); }
+    };
+
+    struct SSceneDescription
+    {
+        std::vector<SSceneLayer> Layers;
+    };
+
+    // Consecutive image layers of a draw order: nothing between them moves, so they can be drawn once and reused
+    struct SStaticLayerGroup
+    {
+        size_t FirstLayer = 0;
+        size_t LayerCount = 0;
+        bool   IsOpaque   = false;   // the first layer is opaque, so the group covers everything drawn before it
+    };
+
+    /*!
+     * Reads a scene file: '#' starts a comment, "layer <name>" opens a layer and every following "<key> <values>"
+     * line sets one of its fields until the next layer line.
+     *   kind image|sequence      texture <asset path>     motion <asset path>      sprites <asset path>     hull <asset path>
+     *   grid <rows> <columns>    fps <frames per second>  phase <frame>            blend opaque|alpha|premultiplied|additive
+     *   depth <integer>          tier Low|Medium|High|Source (lowest quality tier the layer is drawn on)
+     *   scale <fraction> [<tier>]  (0, 1], the layer is drawn at this share of the surface resolution and upsampled, on
+     *                            <tier> and every lower one or on every tier without it. Later lines override earlier ones.
+     *   upsample linear|edge
+     * Unknown keys are errors, so a typo does not silently drop a setting.
+     * @return false with the offending line logged, voScene is then incomplete
+     */
+    bool parseSceneDescription(const char *vText, size_t vSize, SSceneDescription &voScene);
+
+    /*!
+     * The layers drawn on vTier in draw order: by depth, then within a depth by shader, blend mode and texture so
+     * consecutive layers share as much GL state as possible.
+     */
+    std::vector<SSceneLayer> selectSceneLayers(const SSceneDescription &vScene, EQualityTier vTier);
+
+    // The runs of at least vMinLayerCount image layers in vLayers, which are in draw order
+    std::vector<SStaticLayerGroup> findStaticLayerGroups(const std::vector<SSceneLayer> &vLayers, size_t vMinLayerCount);
+
+    // Program, blend and texture changes needed to draw vLayers in order, counting the first layer's as changes
+    int countSceneStateChanges(const std::vector<SSceneLayer> &vLayers);
+
+    const char* getSceneBlendModeName(ESceneBlendMode vMode);
+}
@@ -1,31 +1,115 @@
 #include "SequenceFrameRenderer.h"
 #include <game-activity/native_app_glue/android_native_app_glue.h>
 #include <GLES3/gl3.h>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <memory>
 #include <vector>
 #include <cassert>
+#include <thread>
+#include <sys/system_properties.h>
+#include <unistd.h>
 #include <android/imagedecoder.h>
 #include <android/asset_manager.h>
 #include "Common.h"
+#include "CompositeShader.h"
 #include "TextureAsset.h"
+#include "AssetSource.h"
+#include "AsyncTextureLoader.h"
+#include "MotionVectors.h"
+#include "DiskTextureCache.h"
+#include "GLStateCache.h"
+#include "FrameSequence.h"
+#include "ImageDecoder.h"
+#include "PixelUnpackRing.h"
+#include "SequenceTexture.h"
+#include "TextureCache.h"
+#include "TileOccupancy.h"
 #include "ShaderSource.h"
 #include "stb_image.h"
 
 namespace hiveVG
 {
 #define HIVE_LOGTAG hiveVG::TAG_KEYWORD::SeqFrame_RENDERER_TAG
+    namespace
+    {
+        // In EUniform order
+        constexpr const char *UniformNames[] = {"uvOffset", "uvScale", "nextUvOffset", "blendFactor", "motionStrength", "maxDisplacement", "layer",
+                                                "nextLayer", "motionCell", "tileScale", "quadRect", "spriteRect", "pageRect", "nextSpriteRect", "nextPageRect",
+                                                COMPOSITE_SHADER::CellsUniform, COMPOSITE_SHADER::PlaybackUniform, "edgeSharpness"};
+        // The composite shader starts from it, so it has to be the colour the framebuffer is cleared to
+        constexpr float ClearColor[4] = {0.2f, 0.3f, 0.2f, 0.0f};
+
+        // Debug settings, e.g. "adb shell setprop debug.hivevg.tier Low", see where each is read
+        constexpr const char *QualityTierProperty   = "debug.hivevg.tier";
+        constexpr const char *InterpolationProperty = "debug.hivevg.interpolate";
+        constexpr const char *CompositeProperty     = "debug.hivevg.composite";
+
+        // Empty when the property is not set
+        std::string readDebugProperty(const char *vName)
+        {
+            char Value[PROP_VALUE_MAX] = {};
+            __system_property_get(vName, Value);
+            return Value;
+        }
+
+        // 1/true or 0/false into voIsOn, false if the property is unset or anything else
+        bool readDebugSwitch(const char *vName, bool &voIsOn)
+        {
+            const std::string Value = readDebugProperty(vName);
+            if (Value == "1" || Value == "true") voIsOn = true;
+            else if (Value == "0" || Value == "false") voIsOn = false;
+            else return false;
+            return true;
+        }
+
+        SGLDispatch makeGLDispatch()
+        {
+            SGLDispatch Dispatch;
+            Dispatch.UseProgram         = glUseProgram;
+            Dispatch.BindVertexArray    = glBindVertexArray;
+            Dispatch.ActiveTexture      = glActiveTexture;
+            Dispatch.BindTexture        = glBindTexture;
+            Dispatch.Enable             = glEnable;
+            Dispatch.Disable            = glDisable;
+            Dispatch.BlendFunc          = glBlendFunc;
+            Dispatch.BlendFuncSeparate  = glBlendFuncSeparate;
+            Dispatch.GetUniformLocation = glGetUniformLocation;
+            return Dispatch;
+        }
+    }
+
     CSequenceFrameRenderer::CSequenceFrameRenderer(android_app *vApp) : m_pApp(vApp)
     {
-        m_initResources.clear();
         __initRenderer();
         __initAlgorithm();
         __createScreenVAO();
-        m_NearLastFrameTime = __getCurrentTime();
-        m_FarLastFrameTime  = __getCurrentTime();
+        __createTileVAO();
+        // Creating layers and vertex arrays bound things behind the cache's back
+        m_pStateCache->invalidate();
+        m_StartTime = __getCurrentTime();
+        m_LastFrameTime = m_StartTime;
+        for (SLayer &Layer : m_Layers) Layer.LastStepTime = m_StartTime;
     }
 
     CSequenceFrameRenderer::~CSequenceFrameRenderer()
     {
+        // Join the decode workers before anything they report back to goes away.
+        m_pTextureCache.reset();
+        m_pTextureLoader.reset();
+        for (SLayer &Layer : m_Layers)
+        {
+            glDeleteVertexArrays(1, &Layer.HullVAO);
+            glDeleteBuffers(1, &Layer.HullVBO);
+            __deleteOffscreenTarget(Layer.ReducedTarget);
+        }
+        m_Layers.clear();
+        for (SStaticGroup &Group : m_StaticGroups) __deleteOffscreenTarget(Group.Target);
+        m_StaticGroups.clear();
+        m_pUploadRing.reset();
+        m_pDiskCache.reset();
+        m_pAssetSource.reset();
         if (m_Display != EGL_NO_DISPLAY)
         {
             eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
@@ -43,7 +127,17 @@ namespace hiveVG
             m_Display = EGL_NO_DISPLAY;
         }
         glDeleteVertexArrays(1, &m_QuadVAOHandle);
-        glDeleteProgram(m_ProgramHandle);
+        glDeleteProgram(m_ImageProgram);
+        glDeleteProgram(m_SequenceProgram);
+        glDeleteProgram(m_SpriteProgram);
+        glDeleteProgram(m_TileSequenceProgram);
+        glDeleteProgram(m_TileDebugProgram);
+        glDeleteProgram(m_CompositeProgram);
+        glDeleteProgram(m_StaticGroupProgram);
+        glDeleteProgram(m_UpsampleProgram);
+        glDeleteVertexArrays(1, &m_TileVAOHandle);
+        glDeleteBuffers(1, &m_TileCornerVBO);
+        glDeleteBuffers(1, &m_TileInstanceVBO);
     }
 
     void CSequenceFrameRenderer::__initRenderer()
@@ -113,24 +207,312 @@ namespace hiveVG
 
     void CSequenceFrameRenderer::__initAlgorithm()
     {
-        GLuint NearSnowTextureHandle    = __loadTexture("Textures/nearSnow.png");
-        GLuint FarSnowTextureHandle     = __loadTexture("Textures/farSnow.png");
-        GLuint CartoonTextureHandle     = __loadTexture("Textures/houseWithSnow.png");
-        GLuint BackgroundTextureHandle  = __loadTexture("Textures/background.jpg");
+        // Textures decode on worker threads, layers are skipped until __updateTextureResources() has uploaded theirs.
+        const size_t DecodeWorkerCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 4);
+        m_pAssetSource   = std::make_unique<CApkAssetSource>(m_pApp->activity->assetManager);
+        m_pTextureLoader = std::make_unique<CAsyncTextureLoader>(m_pAssetSource.get(), DecodeWorkerCount);
+        // GameActivity only exposes the files directory, the cache directory is its sibling
+        if (m_pApp->activity->internalDataPath != nullptr)
+        {
+            const std::string FilesDirectory = m_pApp->activity->internalDataPath;
+            m_pDiskCache = std::make_unique<CDiskTextureCache>(FilesDirectory.substr(0, FilesDirectory.find_last_of('/')) + "/cache/textures", EDiskTextureCompression::None);
+            // No store is running yet, so this is the one safe point to trim
+            const size_t RemovedCount = m_pDiskCache->trim(m_DiskCacheBudgetBytes);
+            if (RemovedCount > 0) LOG_INFO(HIVE_LOGTAG, "Removed %zu files from the texture disk cache", RemovedCount);
+            m_pTextureLoader->setDiskCache(m_pDiskCache.get());
+        }
+        m_pUploadRing    = std::make_unique<CPixelUnpackRing>(m_UploadRingSlots, m_UploadBandRows);
+        m_pTextureLoader->setUploadRing(m_pUploadRing.get());
+        m_pTextureCache  = std::make_unique<CTextureCache>(m_pTextureLoader.get(), m_TextureBudgetBytes);
 
-        GLuint NearSnowShaderProgram    = __createProgram(SnowVertexShaderSource, SnowFragmentShaderSource);
-        GLuint FarSnowShaderProgram     = __createProgram(SnowVertexShaderSource, SnowFragmentShaderSource);
-        GLuint CartoonShaderProgram     = __createProgram(QuadVertexShaderSource, QuadFragmentShaderSource);
-        GLuint BackgroundShaderProgram  = __createProgram(QuadVertexShaderSource, QuadFragmentShaderSource);
+        // Every layer covers the window, so nothing gains from being decoded larger than it
+        SDecodeTarget DecodeTarget;
+        if (!eglQuerySurface(m_Display, m_Surface, EGL_WIDTH, &DecodeTarget.SurfaceWidth) || !eglQuerySurface(m_Display, m_Surface, EGL_HEIGHT, &DecodeTarget.SurfaceHeight))
+            DecodeTarget.SurfaceWidth = DecodeTarget.SurfaceHeight = 0;
+        const long PageCount = sysconf(_SC_PHYS_PAGES), PageSize = sysconf(_SC_PAGE_SIZE);
+        const uint64_t PhysicalMemoryBytes = PageCount > 0 && PageSize > 0 ? static_cast<uint64_t>(PageCount) * static_cast<uint64_t>(PageSize) : 0;
+        m_QualityTier = selectQualityTier(DecodeTarget.SurfaceWidth, DecodeTarget.SurfaceHeight, PhysicalMemoryBytes);
+        const std::string TierSetting = readDebugProperty(QualityTierProperty);
+        const bool IsTierSet = !TierSetting.empty() && findQualityTier(TierSetting.c_str(), m_QualityTier);
+        if (!TierSetting.empty() && !IsTierSet) LOG_WARN(HIVE_LOGTAG, "%s %s is not a quality tier, it is ignored", QualityTierProperty, TierSetting.c_str());
+        DecodeTarget.Tier = m_QualityTier;
+        m_pTextureLoader->setDecodeTarget(DecodeTarget);
+        LOG_INFO(HIVE_LOGTAG, "Quality tier %s (%.2f of the surface) for a %dx%d surface and %.1f GiB of RAM, %s%s", getQualityTierName(m_QualityTier),
+                 getQualityTierScale(m_QualityTier), DecodeTarget.SurfaceWidth, DecodeTarget.SurfaceHeight, PhysicalMemoryBytes / 1073741824.0,
+                 IsTierSet ? "set by " : "picked for the device class", IsTierSet ? QualityTierProperty : "");
 
-        m_initResources.push_back(NearSnowTextureHandle);
-        m_initResources.push_back(FarSnowTextureHandle);
-        m_initResources.push_back(CartoonTextureHandle);
-        m_initResources.push_back(BackgroundTextureHandle);
-        m_initResources.push_back(NearSnowShaderProgram);
-        m_initResources.push_back(FarSnowShaderProgram);
-        m_initResources.push_back(CartoonShaderProgram);
-        m_initResources.push_back(BackgroundShaderProgram);
+        SSceneDescription Scene;
+        if (!__loadScene(Scene)) LOG_ERROR(HIVE_LOGTAG, "Scene %s could not be loaded, nothing but the clear color is drawn", m_SceneAssetPath.c_str());
+        const std::vector<SSceneLayer> SceneLayers = selectSceneLayers(Scene, m_QualityTier);
+
+        static_assert(std::size(UniformNames) == UniformCount, "UniformNames must follow EUniform");
+        m_pStateCache = std::make_unique<CGLStateCache>(makeGLDispatch());
+        // One program per shader for every layer, so layers sorted by kind draw without program switches
+        m_ImageProgram    = __createProgram(QuadVertexShaderSource, QuadFragmentShaderSource);
+        m_SequenceProgram = __createProgram(SnowVertexShaderSource, m_IsSnowSequenceArray ? SnowArrayFragmentShaderSource : SnowFragmentShaderSource);
+        glUseProgram(m_ImageProgram);
+        glUniform1i(glGetUniformLocation(m_ImageProgram, "quadTexture"), 0);
+        glUseProgram(m_SequenceProgram);
+        glUniform1i(glGetUniformLocation(m_SequenceProgram, "motionVectors"), 1);
+        if (m_IsSnowSequenceArray && m_IsSnowTiled)
+        {
+            m_TileSequenceProgram = __createProgram(TileVertexShaderSource, SnowArrayFragmentShaderSource);
+            glUseProgram(m_TileSequenceProgram);
+            glUniform1i(glGetUniformLocation(m_TileSequenceProgram, "motionVectors"), 1);
+            if (m_IsTileDebugView) m_TileDebugProgram = __createProgram(TileVertexShaderSource, TileDebugFragmentShaderSource);
+        }
+        m_SpriteProgram = __createProgram(SpriteVertexShaderSource, SpriteFragmentShaderSource);
+        glUseProgram(m_SpriteProgram);
+        glUniform1i(glGetUniformLocation(m_SpriteProgram, "spritePage"), 0);
+        glUniform1i(glGetUniformLocation(m_SpriteProgram, "nextSpritePage"), 1);
+        for (GLuint Program : {m_ImageProgram, m_SequenceProgram, m_TileSequenceProgram, m_TileDebugProgram, m_SpriteProgram})
+            if (Program != 0) m_pStateCache->registerProgram(Program, UniformNames, UniformCount);
+
+        for (const SSceneLayer &Description : SceneLayers) __createLayer(Description);
+        __createStaticGroups();
+        if (std::any_of(m_Layers.begin(), m_Layers.end(), [](const SLayer &vLayer) { return vLayer.isReduced(); }))
+        {
+            m_UpsampleProgram = __createProgram(SnowVertexShaderSource, buildUpsampleShader().c_str());
+            if (m_UpsampleProgram != 0)
+            {
+                glUseProgram(m_UpsampleProgram);
+                glUniform1i(glGetUniformLocation(m_UpsampleProgram, "reducedLayer"), 0);
+                m_pStateCache->registerProgram(m_UpsampleProgram, UniformNames, UniformCount);
+            }
+            else
+                for (SLayer &Layer : m_Layers) Layer.RenderScale = 1.0f;
+        }
+        __createCompositeProgram();
+        LOG_INFO(HIVE_LOGTAG, "Scene %s: %zu of %zu layers on the %s tier, %d program, blend and texture changes per frame, sequences played %s",
+                 m_SceneAssetPath.c_str(), SceneLayers.size(), Scene.Layers.size(), getQualityTierName(m_QualityTier), countSceneStateChanges(SceneLayers),
+                 m_IsSnowInterpolated ? "interpolated" : "stepped");
+    }
+
+    bool CSequenceFrameRenderer::__loadScene(SSceneDescription &voScene) const
+    {
+        const std::unique_ptr<CAssetBuffer> pSceneFile = m_pAssetSource->open(m_SceneAssetPath);
+        if (pSceneFile == nullptr) return false;
+        return parseSceneDescription(reinterpret_cast<const char *>(pSceneFile->getData()), pSceneFile->getSize(), voScene);
+    }
+
+    bool CSequenceFrameRenderer::__loadSpriteAtlas(const SSceneLayer &vDescription, SSpriteAtlas &voAtlas) const
+    {
+        const std::unique_ptr<CAssetBuffer> pTableFile = m_pAssetSource->open(vDescription.SpritePath);
+        if (pTableFile == nullptr) return false;
+        std::string Error;
+        if (!parseSpriteAtlas(pTableFile->getData(), pTableFile->getSize(), voAtlas, Error))
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Sprite table %s is unusable: %s", vDescription.SpritePath.c_str(), Error.c_str());
+            return false;
+        }
+        if (voAtlas.getFrameCount() != vDescription.getFrameCount())
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Sprite table %s has %d frames, layer %s plays %d", vDescription.SpritePath.c_str(), voAtlas.getFrameCount(),
+                      vDescription.Name.c_str(), vDescription.getFrameCount());
+            return false;
+        }
+        return true;
+    }
+
+    bool CSequenceFrameRenderer::__loadHullMesh(const SSceneLayer &vDescription, SLayer &vioLayer) const
+    {
+        const std::unique_ptr<CAssetBuffer> pMeshFile = m_pAssetSource->open(vDescription.HullPath);
+        if (pMeshFile == nullptr) return false;
+        std::string Error;
+        if (!parseHullMesh(pMeshFile->getData(), pMeshFile->getSize(), vioLayer.Hull, Error))
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Hull mesh %s is unusable: %s", vDescription.HullPath.c_str(), Error.c_str());
+            return false;
+        }
+        if (vioLayer.Hull.getFrameCount() != vDescription.getFrameCount())
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Hull mesh %s has %d frames, layer %s plays %d", vDescription.HullPath.c_str(), vioLayer.Hull.getFrameCount(),
+                      vDescription.Name.c_str(), vDescription.getFrameCount());
+            vioLayer.Hull = SHullMesh();
+            return false;
+        }
+
+        // Same layout as the screen quad, so the sequence shaders draw either: clip space position, then frame UV
+        const SHullMesh &Hull = vioLayer.Hull;
+        std::vector<float> Vertices;
+        Vertices.reserve(Hull.Vertices.size() * 2);
+        for (size_t i = 0; i < Hull.Vertices.size(); i += 2)
+        {
+            const float U = static_cast<float>(Hull.Vertices[i]) / Hull.FrameWidth, V = static_cast<float>(Hull.Vertices[i + 1]) / Hull.FrameHeight;
+            Vertices.insert(Vertices.end(), {U * 2.0f - 1.0f, 1.0f - V * 2.0f, U, V});
+        }
+        glGenVertexArrays(1, &vioLayer.HullVAO);
+        glBindVertexArray(vioLayer.HullVAO);
+        glGenBuffers(1, &vioLayer.HullVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, vioLayer.HullVBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(Vertices.size() * sizeof(float)), Vertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+        return true;
+    }
+
+    void CSequenceFrameRenderer::__createLayer(const SSceneLayer &vDescription)
+    {
+        SLayer Layer;
+        Layer.Description = vDescription;
+        const bool IsSequence = vDescription.Kind == ESceneLayerKind::Sequence;
+        Layer.Program = IsSequence ? m_SequenceProgram : m_ImageProgram;
+        // Without a usable rect table the layer plays its texture as any other sequence
+        if (vDescription.isSprite() && !__loadSpriteAtlas(vDescription, Layer.Sprites)) Layer.Description.SpritePath.clear();
+
+        // Mips are built on the decode workers in alpha weighted space, an opaque image is the backdrop drawn 1:1 and gets none
+        const bool IsBackdrop = !IsSequence && vDescription.BlendMode == ESceneBlendMode::Opaque;
+        STextureLoadOptions Options = {IsBackdrop, IsBackdrop ? EMipMode::None : EMipMode::Precomputed};
+        Options.IsFitToSurface = true;
+        if (vDescription.BlendMode == ESceneBlendMode::Premultiplied) Options.AlphaConversion = EAlphaConversion::Premultiply;
+        if (IsSequence)
+        {
+            Options.ProgressiveRows = vDescription.Rows;
+            Options.AtlasColumns    = vDescription.Columns;
+            Layer.CurrentFrame      = vDescription.Phase % vDescription.getFrameCount();
+        }
+
+        if (Layer.Description.isSprite())
+        {
+            // Pages are sampled by rect, they are neither fit to the surface nor mipmapped, either would blur rects into each other
+            STextureLoadOptions PageOptions = {false, EMipMode::None};
+            PageOptions.AlphaConversion = Options.AlphaConversion;
+            for (int Page = 0; Page < static_cast<int>(Layer.Sprites.Pages.size()); ++Page)
+                Layer.SpritePages.push_back(m_pTextureCache->acquire(getSpritePagePath(vDescription.SpritePath, Page), PageOptions));
+            Layer.Program = m_SpriteProgram;
+            uint64_t TrimmedTexels = 0;
+            for (const SSpriteRect &Rect : Layer.Sprites.Frames) TrimmedTexels += static_cast<uint64_t>(Rect.Width) * Rect.Height;
+            LOG_INFO(HIVE_LOGTAG, "Layer %s: %d trimmed frames on %zu pages, quads cover %.1f%% of the frame on average", vDescription.Name.c_str(),
+                     Layer.Sprites.getFrameCount(), Layer.Sprites.Pages.size(),
+                     100.0 * TrimmedTexels / (static_cast<double>(Layer.Sprites.FrameWidth) * Layer.Sprites.FrameHeight * Layer.Sprites.getFrameCount()));
+        }
+        else if (IsSequence && m_IsSnowSequenceArray)
+        {
+            Layer.pSequence = m_pTextureLoader->loadSequenceAsync(vDescription.TexturePath, Options, vDescription.Rows, vDescription.Columns, m_SnowWindowFrames,
+                                                                  vDescription.FramesPerSecond);
+        }
+        else if (IsSequence)
+        {
+            // Sampled as one atlas, which is the .png next to a .hseq
+            Layer.pTexture = m_pTextureCache->acquire(getFrameSequenceFallbackPath(vDescription.TexturePath), Options);
+        }
+        else
+            Layer.pTexture = m_pTextureCache->acquire(vDescription.TexturePath, Options);
+        // Optional, without them the frames are cross faded. Loaded while playback is stepped too, so it can be switched back.
+        if (IsSequence && !Layer.Description.isSprite() && !vDescription.MotionPath.empty())
+            Layer.pMotionVectors = m_pTextureCache->acquire(vDescription.MotionPath, {false, EMipMode::None});
+
+        // Sprite quads are already tight, a hull only replaces the full screen quad
+        if (IsSequence && !Layer.Description.isSprite() && !vDescription.HullPath.empty() && __loadHullMesh(vDescription, Layer))
+            LOG_INFO(HIVE_LOGTAG, "Layer %s drawn from %zu hull triangles", vDescription.Name.c_str(), Layer.Hull.Vertices.size() / 6);
+        // A baked hull is tighter than tiles, they are the default for array frames without one
+        else if (Layer.pSequence != nullptr && m_TileSequenceProgram != 0)
+            Layer.Program = m_TileSequenceProgram;
+
+        if (m_IsLayerScaleApplied) Layer.RenderScale = vDescription.getRenderScale(m_QualityTier);
+        LOG_INFO(HIVE_LOGTAG, "Layer %s at depth %d: %s, blend %s%s, drawn at %.2f of the surface resolution", vDescription.Name.c_str(), vDescription.Depth,
+                 vDescription.TexturePath.c_str(), getSceneBlendModeName(vDescription.BlendMode), IsSequence ? ", a sequence" : "", Layer.RenderScale);
+        m_Layers.push_back(std::move(Layer));
+    }
+
+    void CSequenceFrameRenderer::__createStaticGroups()
+    {
+        if (!m_IsStaticLayerCached) return;
+        std::vector<SSceneLayer> Descriptions;
+        for (const SLayer &Layer : m_Layers) Descriptions.push_back(Layer.Description);
+        for (const SStaticLayerGroup &Layers : findStaticLayerGroups(Descriptions, m_MinStaticGroupLayers))
+        {
+            for (size_t i = Layers.FirstLayer; i < Layers.FirstLayer + Layers.LayerCount; ++i) m_Layers[i].StaticGroup = static_cast<int>(m_StaticGroups.size());
+            SStaticGroup Group;
+            Group.Layers = Layers;
+            m_StaticGroups.push_back(Group);
+            LOG_INFO(HIVE_LOGTAG, "Layers %s to %s drawn as one %s static group", Descriptions[Layers.FirstLayer].Name.c_str(),
+                     Descriptions[Layers.FirstLayer + Layers.LayerCount - 1].Name.c_str(), Layers.IsOpaque ? "opaque" : "blended");
+        }
+        if (m_StaticGroups.empty()) return;
+
+        m_StaticGroupProgram = __createProgram(StaticGroupVertexShaderSource, QuadFragmentShaderSource);
+        if (m_StaticGroupProgram == 0)
+        {
+            for (SLayer &Layer : m_Layers) Layer.StaticGroup = -1;
+            m_StaticGroups.clear();
+            return;
+        }
+        glUseProgram(m_StaticGroupProgram);
+        glUniform1i(glGetUniformLocation(m_StaticGroupProgram, "quadTexture"), 0);
+    }
+
+    void CSequenceFrameRenderer::__createCompositeProgram()
+    {
+        if (!m_IsSceneComposited || m_Layers.empty()) return;
+        std::vector<SCompositeLayer> CompositeLayers;
+        for (size_t i = 0; i < m_Layers.size(); ++i)
+        {
+            const SLayer &Layer = m_Layers[i];
+            // Sprite quads sample their pages by rect, which a full screen pass has no use for
+            if (!Layer.SpritePages.empty())
+            {
+                LOG_INFO(HIVE_LOGTAG, "Layer %s is drawn from sprite quads, the scene is drawn a pass per layer", Layer.Description.Name.c_str());
+                return;
+            }
+            SCompositeLayer CompositeLayer;
+            if (Layer.isReduced())
+            {
+                // Sampled from its reduced target, which holds the layer premultiplied
+                CompositeLayer.BlendMode     = Layer.Description.BlendMode == ESceneBlendMode::Opaque ? ESceneBlendMode::Opaque : ESceneBlendMode::Premultiplied;
+                CompositeLayer.IsUpsampled   = true;
+                CompositeLayer.EdgeSharpness = Layer.Description.UpsampleFilter == ESceneUpsampleFilter::Edge ? COMPOSITE_SHADER::EdgeSharpness : 0.0f;
+                CompositeLayers.push_back(CompositeLayer);
+                continue;
+            }
+            if (Layer.StaticGroup >= 0)
+            {
+                // Sampled from the group's texture as one layer, premultiplied unless the group is opaque
+                const SStaticLayerGroup &Group = m_StaticGroups[Layer.StaticGroup].Layers;
+                CompositeLayer.BlendMode = Group.IsOpaque ? ESceneBlendMode::Opaque : ESceneBlendMode::Premultiplied;
+                CompositeLayers.push_back(CompositeLayer);
+                i += Group.LayerCount - 1;
+                continue;
+            }
+            CompositeLayer.Kind      = Layer.Description.Kind;
+            CompositeLayer.BlendMode = Layer.Description.BlendMode;
+            if (Layer.Description.Kind == ESceneLayerKind::Sequence)
+            {
+                CompositeLayer.IsArray    = Layer.pSequence != nullptr;
+                CompositeLayer.HasMotion  = Layer.pMotionVectors != nullptr;
+                CompositeLayer.CellWidth  = 1.0f / Layer.Description.Columns;
+                CompositeLayer.CellHeight = 1.0f / Layer.Description.Rows;
+            }
+            CompositeLayers.push_back(CompositeLayer);
+        }
+
+        GLint MaxTextureUnits = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &MaxTextureUnits);
+        SCompositeShader Shader;
+        if (!buildCompositeShader(CompositeLayers, ClearColor, MaxTextureUnits, Shader))
+        {
+            LOG_ERROR(HIVE_LOGTAG, "The composite shader needs %d texture units, %d are available, the scene is drawn a pass per layer",
+                      Shader.TextureUnitCount, MaxTextureUnits);
+            return;
+        }
+        m_CompositeProgram = __createProgram(SnowVertexShaderSource, Shader.FragmentSource.c_str());
+        if (m_CompositeProgram == 0) return;
+        glUseProgram(m_CompositeProgram);
+        for (int i = 0; i < static_cast<int>(CompositeLayers.size()); ++i)
+        {
+            glUniform1i(glGetUniformLocation(m_CompositeProgram, getCompositeSamplerName(i, false).c_str()), Shader.TextureUnits[i]);
+            if (Shader.MotionUnits[i] >= 0) glUniform1i(glGetUniformLocation(m_CompositeProgram, getCompositeSamplerName(i, true).c_str()), Shader.MotionUnits[i]);
+        }
+        m_pStateCache->registerProgram(m_CompositeProgram, UniformNames, UniformCount);
+        m_CompositeTextureUnits = std::move(Shader.TextureUnits);
+        m_CompositeMotionUnits  = std::move(Shader.MotionUnits);
+        m_CompositeCells.assign(CompositeLayers.size() * 4, 0.0f);
+        m_CompositePlayback.assign(CompositeLayers.size() * 4, 0.0f);
+        LOG_INFO(HIVE_LOGTAG, "Scene composited in one pass from %zu layers and static groups on %d texture units: %d framebuffer bytes per pixel instead of %d",
+                 CompositeLayers.size(), Shader.TextureUnitCount, 4, computeFramebufferBytesPerPixel(CompositeLayers));
     }
 
     GLuint CSequenceFrameRenderer::__compileShader(GLenum vType, const char *vShaderCode)
@@ -177,6 +559,51 @@ namespace hiveVG
         return 0;
     }
 
+    void CSequenceFrameRenderer::__applyBlendMode(ESceneBlendMode vMode)
+    {
+        m_pStateCache->setEnabled(GL_BLEND, vMode != ESceneBlendMode::Opaque);
+        if (vMode == ESceneBlendMode::Opaque) return;
+        if (vMode == ESceneBlendMode::Premultiplied) m_pStateCache->setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        else if (vMode == ESceneBlendMode::Additive) m_pStateCache->setBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        else m_pStateCache->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    void CSequenceFrameRenderer::__applyOffscreenBlendMode(ESceneBlendMode vMode)
+    {
+        // Into a cleared, transparent target: colour blends as the mode blends it on screen and alpha accumulates as
+        // coverage, so what the target ends up with is premultiplied unless its first layer is opaque
+        m_pStateCache->setEnabled(GL_BLEND, vMode != ESceneBlendMode::Opaque);
+        if (vMode == ESceneBlendMode::Opaque) return;
+        if (vMode == ESceneBlendMode::Premultiplied) m_pStateCache->setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        else if (vMode == ESceneBlendMode::Additive) m_pStateCache->setBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ZERO, GL_ONE);
+        else m_pStateCache->setBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    GLint CSequenceFrameRenderer::__getUniform(GLuint vProgram, EUniform vUniform) const
+    {
+        return m_pStateCache->getUniformLocation(vProgram, vUniform);
+    }
+
+    void CSequenceFrameRenderer::__createTileVAO()
+    {
+        // Triangle strip corners of one tile, in tiles
+        const float Corners[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+        glGenVertexArrays(1, &m_TileVAOHandle);
+        glBindVertexArray(m_TileVAOHandle);
+        glGenBuffers(1, &m_TileCornerVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_TileCornerVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Corners), Corners, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // Column and row of each instance, refilled by every tiled draw
+        glGenBuffers(1, &m_TileInstanceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_TileInstanceVBO);
+        glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_FALSE, 2 * sizeof(uint16_t), (void*)0);
+        glEnableVertexAttribArray(2);
+        glVertexAttribDivisor(2, 1);
+        glBindVertexArray(0);
+    }
+
     GLuint CSequenceFrameRenderer::__createProgram(const char* vVertexShaderCode, const char* vFragmentShaderCode)
     {
         GLuint VertShaderHandle = __compileShader(GL_VERTEX_SHADER, vVertexShaderCode);
@@ -197,17 +624,36 @@ namespace hiveVG
         return m_ProgramHandle;
     }
 
-    GLuint CSequenceFrameRenderer::__loadTexture(const std::string& vTexturePath)
+    void CSequenceFrameRenderer::__updateTextureResources()
     {
-        auto TextureHandle = CTextureAsset::loadAsset(m_pApp->activity->assetManager, vTexturePath);
-        if (TextureHandle == nullptr)
+        // A frame per sequence and per frame at most, starting at the one on screen so the window fills ahead of playback
+        for (SLayer &Layer : m_Layers)
+            if (Layer.pSequence != nullptr) Layer.pSequence->update(Layer.CurrentFrame, 1);
+        // Allocated outside the texture cache but from the same VRAM, so they count against its budget
+        size_t SequenceBytes = 0, TargetBytes = 0;
+        for (const SLayer &Layer : m_Layers)
         {
-            LOG_ERROR(HIVE_LOGTAG, "Failed to load texture");
-            return 0;
+            if (Layer.pSequence != nullptr) SequenceBytes += Layer.pSequence->getEstimatedBytes();
+            TargetBytes += static_cast<size_t>(Layer.ReducedTarget.Width) * Layer.ReducedTarget.Height * 4;
+        }
+        for (const SStaticGroup &Group : m_StaticGroups) TargetBytes += static_cast<size_t>(Group.Target.Width) * Group.Target.Height * 4;
+        m_pTextureCache->setPinnedBytes("sequence windows", SequenceBytes);
+        m_pTextureCache->setPinnedBytes("offscreen targets", TargetBytes);
+        if (!m_pTextureLoader->hasPendingLoads()) return;
+        // One upload per frame, so the first frames are not stalled behind every texture at once.
+        m_pUploadRing->beginFrame();
+        if (m_pTextureLoader->processCompletedUploads(1) == 0) return;
+        const auto &StreamStats = m_pUploadRing->getStats();
+        LOG_INFO(HIVE_LOGTAG, "Streamed %zu bytes in %zu bands this frame (%llu bytes total, %zu stalls)", StreamStats.BytesThisFrame,
+                 StreamStats.BandsThisFrame, static_cast<unsigned long long>(StreamStats.TotalBytes), StreamStats.StallCount);
+        // Uploaded textures now report their size, which may push the cache over budget
+        m_pTextureCache->trim();
+        if (!m_pTextureLoader->hasPendingLoads())
+        {
+            m_pTextureCache->logStats();
+            if (m_pDiskCache != nullptr) m_pDiskCache->logStats();
+            logImageDecoderStats();
         }
-        LOG_INFO(HIVE_LOGTAG, "Load Texture Successfully into TextureID %d", TextureHandle->getTextureID());
-        m_pTextureHandles.push_back(TextureHandle);
-        return TextureHandle->getTextureID();
     }
 
     void CSequenceFrameRenderer::__createScreenVAO()
@@ -245,6 +691,7 @@ namespace hiveVG
 
     void CSequenceFrameRenderer::render()
     {
+        __updateTextureResources();
         glUseProgram(m_ProgramHandle);
 
         glClearColor(0.0f,1.0f,1.0f,1.0f);
@@ -254,74 +701,550 @@ namespace hiveVG
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, m_pTextureHandles[0]->getTextureID());
+        glBindTexture(GL_TEXTURE_2D, !m_Layers.empty() && m_Layers[0].pTexture != nullptr ? m_Layers[0].pTexture->getTextureID() : 0);
         __checkGLError();
         glBindVertexArray(m_QuadVAOHandle);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
         auto SwapResult = eglSwapBuffers(m_Display, m_Surface);
         assert(SwapResult == EGL_TRUE);
+        // Bound around the state cache
+        m_pStateCache->invalidate();
+    }
+
+    bool CSequenceFrameRenderer::__isFrameResident(const SLayer &vLayer, int vFrame) const
+    {
+        if (!vLayer.SpritePages.empty())
+        {
+            const SSpriteRect &Rect = vLayer.Sprites.Frames[vFrame];
+            return Rect.isEmpty() || vLayer.SpritePages[Rect.Page]->isReady();
+        }
+        if (vLayer.pSequence != nullptr) return vLayer.pSequence->isFrameResident(vFrame);
+        // Atlas frames are there once their whole atlas row is uploaded
+        const auto &pTexture = vLayer.pTexture;
+        if (pTexture == nullptr || !pTexture->isReady()) return false;
+        return static_cast<int64_t>(pTexture->getResidentRows()) * vLayer.Description.Rows / pTexture->getHeight() > vFrame / vLayer.Description.Columns;
     }
 
-    void CSequenceFrameRenderer::renderBlendingSnow(const int vRow, const int vColumn)
+    CSequenceFrameRenderer::SSequencePlayback CSequenceFrameRenderer::__advanceSequence(SLayer &vioLayer, double vCurrentTime)
     {
-        double CurrentTime = __getCurrentTime();
-        double DeltaTime = CurrentTime - m_NearLastFrameTime;
-        if(DeltaTime >= 1.0 / m_FramePerSecond)
+        const int FrameCount = vioLayer.Description.getFrameCount();
+        const double FramePeriod = 1.0 / vioLayer.Description.FramesPerSecond;
+        const double DeltaTime = vCurrentTime - vioLayer.LastStepTime;
+        // Hold the current frame until the next one is resident
+        if (DeltaTime >= FramePeriod)
         {
-            m_NearLastFrameTime = CurrentTime;
-            m_NearCurrentFrame = (m_NearCurrentFrame + 1) % (vRow * vColumn);
+            const int NextFrame = (vioLayer.CurrentFrame + 1) % FrameCount;
+            if (vioLayer.pSequence != nullptr) vioLayer.pSequence->recordFrameDue(NextFrame);
+            if (__isFrameResident(vioLayer, NextFrame))
+            {
+                // Interpolated playback keeps the step phase, so the blend factor sweeps evenly whatever the refresh rate.
+                // After a stall it restarts from now instead of racing to catch up.
+                vioLayer.LastStepTime = (m_IsSnowInterpolated && DeltaTime < 2.0 * FramePeriod) ? vioLayer.LastStepTime + FramePeriod : vCurrentTime;
+                vioLayer.CurrentFrame = NextFrame;
+                if (NextFrame == 0)
+                {
+                    __logStreamStats(vioLayer);
+                    __logCoverageStats(vioLayer);
+                }
+            }
         }
 
-        glClearColor(0.2f,0.3f,0.2f, 0.0f);
+        SSequencePlayback Playback;
+        Playback.Frame     = vioLayer.CurrentFrame;
+        Playback.NextFrame = (vioLayer.CurrentFrame + 1) % FrameCount;
+        if (m_IsSnowInterpolated && __isFrameResident(vioLayer, Playback.NextFrame))
+            Playback.BlendFactor = static_cast<float>(std::clamp((vCurrentTime - vioLayer.LastStepTime) * vioLayer.Description.FramesPerSecond, 0.0, 1.0));
+        return Playback;
+    }
+
+    void CSequenceFrameRenderer::setSnowInterpolated(bool vIsInterpolated)
+    {
+        if (vIsInterpolated == m_IsSnowInterpolated) return;
+        m_IsSnowInterpolated = vIsInterpolated;
+        LOG_INFO(HIVE_LOGTAG, "Sequences now played %s", m_IsSnowInterpolated ? "interpolated" : "stepped");
+    }
+
+    void CSequenceFrameRenderer::setSceneComposited(bool vIsComposited)
+    {
+        if (vIsComposited == m_IsSceneComposited) return;
+        // What was measured so far belongs to the other setting
+        __logFrameModeStats();
+        m_IsSceneComposited = vIsComposited;
+        if (m_IsSceneComposited && m_CompositeProgram == 0)
+        {
+            __createCompositeProgram();
+            // Linking set its samplers behind the cache's back
+            m_pStateCache->invalidate();
+        }
+        else if (!m_IsSceneComposited)
+        {
+            glDeleteProgram(m_CompositeProgram);
+            m_CompositeProgram = 0;
+            m_pStateCache->invalidate();
+        }
+        LOG_INFO(HIVE_LOGTAG, "Scene now drawn %s", m_CompositeProgram != 0 ? "in one composite pass" : "a pass per layer");
+    }
+
+    void CSequenceFrameRenderer::__pollDebugSettings()
+    {
+        bool IsOn = false;
+        if (readDebugSwitch(InterpolationProperty, IsOn)) setSnowInterpolated(IsOn);
+        if (readDebugSwitch(CompositeProperty, IsOn)) setSceneComposited(IsOn);
+    }
+
+    void CSequenceFrameRenderer::__logFrameModeStats()
+    {
+        constexpr const char *ModeNames[] = {"A pass per layer", "Composite"};
+        for (size_t Mode = 0; Mode < std::size(m_FrameModeStats); ++Mode)
+        {
+            SFrameModeStats &Stats = m_FrameModeStats[Mode];
+            if (Stats.FrameCount == 0) continue;
+            LOG_INFO(HIVE_LOGTAG, "%s: %d frames %.2f ms apart, %.2f ms on the CPU, %.1f GL state calls issued and %.1f elided per frame, %d static group rebuilds so far",
+                     ModeNames[Mode], Stats.FrameCount, Stats.IntervalSum * 1000.0 / Stats.FrameCount, Stats.CpuSum * 1000.0 / Stats.FrameCount,
+                     static_cast<double>(Stats.IssuedCount) / Stats.FrameCount, static_cast<double>(Stats.ElidedCount) / Stats.FrameCount, m_StaticRebuildCount);
+            Stats = {};
+        }
+    }
+
+    void CSequenceFrameRenderer::renderScene()
+    {
+        const double FrameStartTime = __getCurrentTime();
+        if (m_SceneFrameCount % m_SettingsPollInterval == 0) __pollDebugSettings();
+        __updateTextureResources();
+
+        const double CurrentTime = __getCurrentTime();
+        bool IsEveryLayerReady = true;
+        for (SLayer &Layer : m_Layers)
+            if (!__prepareLayer(Layer, CurrentTime)) IsEveryLayerReady = false;
+        // Before the screen is cleared, stale groups and the reduced layers are drawn into their own framebuffers
+        EGLint SurfaceWidth = 0, SurfaceHeight = 0;
+        eglQuerySurface(m_Display, m_Surface, EGL_WIDTH, &SurfaceWidth);
+        eglQuerySurface(m_Display, m_Surface, EGL_HEIGHT, &SurfaceHeight);
+        for (SStaticGroup &Group : m_StaticGroups) __updateStaticGroup(Group, SurfaceWidth, SurfaceHeight);
+        // Uploads bound textures on whatever unit was active
+        m_pStateCache->invalidateTextureBindings();
+        m_pStateCache->bindVertexArray(m_QuadVAOHandle);
+        for (SLayer &Layer : m_Layers)
+            if (Layer.IsReady && Layer.isReduced()) __drawReducedLayer(Layer, SurfaceWidth, SurfaceHeight);
+
+        glClearColor(ClearColor[0], ClearColor[1], ClearColor[2], ClearColor[3]);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        //background
-        glUseProgram(m_initResources[7]);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, m_initResources[3]);
-        glBindVertexArray(m_QuadVAOHandle);
+        // While textures stream in, layers show up one by one as their passes can be drawn
+        const bool AreGroupsCached = std::all_of(m_StaticGroups.begin(), m_StaticGroups.end(), [](const SStaticGroup &vGroup) { return vGroup.isCached(); });
+        const bool IsComposited = m_CompositeProgram != 0 && IsEveryLayerReady && AreGroupsCached;
+        if (IsComposited)
+            __drawComposite();
+        else
+        {
+            // Layers are sorted by state, the cache drops whatever a layer sets the same as the one before
+            for (size_t i = 0; i < m_Layers.size(); ++i)
+            {
+                SLayer &Layer = m_Layers[i];
+                if (Layer.StaticGroup >= 0 && m_StaticGroups[Layer.StaticGroup].isCached())
+                {
+                    const SStaticGroup &Group = m_StaticGroups[Layer.StaticGroup];
+                    __drawStaticGroup(Group);
+                    i += Group.Layers.LayerCount - 1;
+                }
+                else if (Layer.IsReady && Layer.isReduced())
+                    __drawUpsampledLayer(Layer);
+                else if (Layer.IsReady)
+                    __drawLayer(Layer, false);
+            }
+        }
+
+        // Counted by what was drawn, a composited scene draws a pass per layer while textures stream in
+        const SGLStateStats StateStats = m_pStateCache->endFrame();
+        SFrameModeStats &ModeStats = m_FrameModeStats[IsComposited ? 1 : 0];
+        ++ModeStats.FrameCount;
+        ModeStats.IntervalSum += FrameStartTime - m_LastFrameTime;
+        ModeStats.CpuSum      += __getCurrentTime() - FrameStartTime;
+        ModeStats.IssuedCount += StateStats.IssuedCount;
+        ModeStats.ElidedCount += StateStats.ElidedCount;
+        m_LastFrameTime = FrameStartTime;
+        if (++m_SceneFrameCount % m_StateStatsInterval == 0) __logFrameModeStats();
+
+        auto SwapResult = eglSwapBuffers(m_Display, m_Surface);
+        assert(SwapResult == EGL_TRUE);
+    }
+
+    bool CSequenceFrameRenderer::__prepareLayer(SLayer &vioLayer, double vCurrentTime)
+    {
+        if (vioLayer.Description.Kind != ESceneLayerKind::Sequence)
+        {
+            vioLayer.IsReady = vioLayer.pTexture != nullptr && vioLayer.pTexture->isReady();
+            return vioLayer.IsReady;
+        }
+        vioLayer.Playback = __advanceSequence(vioLayer, vCurrentTime);
+        vioLayer.IsReady = __isFrameResident(vioLayer, vioLayer.Playback.Frame);
+        if (vioLayer.IsReady && !m_IsFirstFrameLogged)
+        {
+            m_IsFirstFrameLogged = true;
+            LOG_INFO(HIVE_LOGTAG, "First animated frame %.1f ms after start", (vCurrentTime - m_StartTime) * 1000.0);
+        }
+        return vioLayer.IsReady;
+    }
+
+    void CSequenceFrameRenderer::__drawLayer(SLayer &vioLayer, bool vIsOffscreen)
+    {
+        m_pStateCache->useProgram(vioLayer.Program);
+        if (vIsOffscreen) __applyOffscreenBlendMode(vioLayer.Description.BlendMode);
+        else __applyBlendMode(vioLayer.Description.BlendMode);
+        if (!vioLayer.SpritePages.empty())
+        {
+            __drawSpriteLayer(vioLayer, vioLayer.Playback);
+            return;
+        }
+        if (vioLayer.Description.Kind == ESceneLayerKind::Sequence)
+        {
+            bool IsTiled = false;
+            const double Rasterized = __drawSequenceLayer(vioLayer, vioLayer.Playback, IsTiled);
+            if (vioLayer.HullVAO != 0 || IsTiled)
+            {
+                vioLayer.RasterizedArea += Rasterized;
+                if (vioLayer.HullVAO != 0)
+                    vioLayer.VisibleArea += static_cast<double>(vioLayer.Hull.Frames[vioLayer.Playback.Frame].VisibleTexels) / (vioLayer.Hull.FrameWidth * vioLayer.Hull.FrameHeight);
+                ++vioLayer.CoverageDrawCount;
+            }
+            return;
+        }
+        m_pStateCache->bindTexture(0, GL_TEXTURE_2D, vioLayer.pTexture->getTextureID());
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
 
-        //farsnow
-        int  Row = m_NearCurrentFrame / vColumn;
-        int  Col = m_NearCurrentFrame % vColumn;
-        float U0 = Col / (float)vColumn;
-        float V0 = Row / (float)vRow;
-        float U1 = (Col + 1) / (float)vColumn;
-        float V1 = (Row + 1) / (float)vRow;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-        glUseProgram(m_initResources[5]);
-        glUniform2f(glGetUniformLocation(m_initResources[5], "uvOffset"), U0, V0);
-        glUniform2f(glGetUniformLocation(m_initResources[5], "uvScale"), U1 - U0, V1 - V0);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, m_initResources[1]);
-        glBindVertexArray(m_QuadVAOHandle);
+    void CSequenceFrameRenderer::__drawComposite()
+    {
+        // Each layer's row of the uniform arrays carries what __drawSequenceLayer() sets as separate uniforms.
+        // A static group takes one row for all its layers.
+        size_t Row = 0;
+        for (size_t i = 0; i < m_Layers.size(); ++i, ++Row)
+        {
+            const SLayer &Layer = m_Layers[i];
+            const int Unit = m_CompositeTextureUnits[Row];
+            if (Layer.StaticGroup >= 0)
+            {
+                const SStaticGroup &Group = m_StaticGroups[Layer.StaticGroup];
+                m_pStateCache->bindTexture(Unit, GL_TEXTURE_2D, Group.Target.Texture);
+                i += Group.Layers.LayerCount - 1;
+                continue;
+            }
+            if (Layer.isReduced())
+            {
+                m_pStateCache->bindTexture(Unit, GL_TEXTURE_2D, Layer.ReducedTarget.Texture);
+                continue;
+            }
+            if (Layer.Description.Kind != ESceneLayerKind::Sequence)
+            {
+                m_pStateCache->bindTexture(Unit, GL_TEXTURE_2D, Layer.pTexture->getTextureID());
+                continue;
+            }
+            const SSequencePlayback &Playback = Layer.Playback;
+            const int Columns = Layer.Description.Columns;
+            const float CellWidth = 1.0f / Columns, CellHeight = 1.0f / Layer.Description.Rows;
+            const float Cell[4] = {(Playback.Frame % Columns) * CellWidth, (Playback.Frame / Columns) * CellHeight,
+                                   (Playback.NextFrame % Columns) * CellWidth, (Playback.NextFrame / Columns) * CellHeight};
+            std::copy(std::begin(Cell), std::end(Cell), m_CompositeCells.begin() + Row * 4);
+            const auto &pMotionVectors = Layer.pMotionVectors;
+            const bool HasMotion = Playback.BlendFactor > 0.0f && pMotionVectors != nullptr && pMotionVectors->isReady();
+            float *pPlayback = &m_CompositePlayback[Row * 4];
+            pPlayback[2] = Playback.BlendFactor;
+            pPlayback[3] = HasMotion ? 1.0f : 0.0f;
+            if (HasMotion) m_pStateCache->bindTexture(m_CompositeMotionUnits[Row], GL_TEXTURE_2D, pMotionVectors->getTextureID());
+            if (Layer.pSequence != nullptr)
+            {
+                pPlayback[0] = static_cast<float>(Layer.pSequence->getLayer(Playback.Frame));
+                pPlayback[1] = static_cast<float>(std::max(Layer.pSequence->getLayer(Playback.NextFrame), 0));
+                m_pStateCache->bindTexture(Unit, GL_TEXTURE_2D_ARRAY, Layer.pSequence->getTextureID());
+            }
+            else
+                m_pStateCache->bindTexture(Unit, GL_TEXTURE_2D, Layer.pTexture->getTextureID());
+        }
+
+        m_pStateCache->useProgram(m_CompositeProgram);
+        // The shader blends, the framebuffer only takes its result
+        __applyBlendMode(ESceneBlendMode::Opaque);
+        const GLsizei RowCount = static_cast<GLsizei>(Row);
+        glUniform4fv(__getUniform(m_CompositeProgram, CompositeCells), RowCount, m_CompositeCells.data());
+        glUniform4fv(__getUniform(m_CompositeProgram, CompositePlayback), RowCount, m_CompositePlayback.data());
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
 
-        //cartoon
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glUseProgram(m_initResources[6]);
-        glUniform1i(glGetUniformLocation(m_initResources[6], "quadTexture"), 0);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, m_initResources[2]);
+    void CSequenceFrameRenderer::__updateStaticGroup(SStaticGroup &vioGroup, int vSurfaceWidth, int vSurfaceHeight)
+    {
+        if (vioGroup.IsFailed) return;
+        const size_t FirstLayer = vioGroup.Layers.FirstLayer, LayerCount = vioGroup.Layers.LayerCount;
+        SOffscreenTarget &Target = vioGroup.Target;
+        bool IsCurrent = vioGroup.isCached() && Target.Width == vSurfaceWidth && Target.Height == vSurfaceHeight;
+        for (size_t i = 0; i < LayerCount; ++i)
+        {
+            const SLayer &Layer = m_Layers[FirstLayer + i];
+            // Its layers are drawn one by one until every texture is in
+            if (!Layer.IsReady)
+            {
+                vioGroup.SourceTextures.clear();
+                return;
+            }
+            IsCurrent = IsCurrent && vioGroup.SourceTextures[i] == Layer.pTexture->getTextureID();
+        }
+        if (IsCurrent) return;
+
+        vioGroup.SourceTextures.clear();
+        // Drawn 1:1 to the surface, so without filtering
+        if ((Target.Width != vSurfaceWidth || Target.Height != vSurfaceHeight) && !__allocateOffscreenTarget(Target, vSurfaceWidth, vSurfaceHeight, GL_NEAREST))
+        {
+            LOG_ERROR(HIVE_LOGTAG, "The static group of layer %s has no complete %dx%d framebuffer, its layers are drawn one by one",
+                      m_Layers[FirstLayer].Description.Name.c_str(), vSurfaceWidth, vSurfaceHeight);
+            vioGroup.IsFailed = true;
+            m_pStateCache->invalidate();
+            return;
+        }
+        // Around the state cache, it is invalidated once the group is drawn
+        glBindFramebuffer(GL_FRAMEBUFFER, Target.Framebuffer);
+        glViewport(0, 0, vSurfaceWidth, vSurfaceHeight);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glUseProgram(m_StaticGroupProgram);
         glBindVertexArray(m_QuadVAOHandle);
+        glActiveTexture(GL_TEXTURE0);
+        for (size_t i = FirstLayer; i < FirstLayer + LayerCount; ++i)
+        {
+            const SLayer &Layer = m_Layers[i];
+            __applyOffscreenBlendMode(Layer.Description.BlendMode);
+            glBindTexture(GL_TEXTURE_2D, Layer.pTexture->getTextureID());
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            vioGroup.SourceTextures.push_back(Layer.pTexture->getTextureID());
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, vSurfaceWidth, vSurfaceHeight);
+        m_pStateCache->invalidate();
+
+        ++m_StaticRebuildCount;
+        LOG_INFO(HIVE_LOGTAG, "Static group of layer %s drawn at %dx%d, %d static group rebuilds so far", m_Layers[FirstLayer].Description.Name.c_str(),
+                 vSurfaceWidth, vSurfaceHeight, m_StaticRebuildCount);
+    }
+
+    void CSequenceFrameRenderer::__drawReducedLayer(SLayer &vioLayer, int vSurfaceWidth, int vSurfaceHeight)
+    {
+        SOffscreenTarget &Target = vioLayer.ReducedTarget;
+        const int Width = std::max(1, static_cast<int>(std::lround(vSurfaceWidth * vioLayer.RenderScale)));
+        const int Height = std::max(1, static_cast<int>(std::lround(vSurfaceHeight * vioLayer.RenderScale)));
+        if (Target.Width != Width || Target.Height != Height)
+        {
+            // Bilinear for the linear upsample, the edge filter fetches texels itself
+            const bool IsAllocated = __allocateOffscreenTarget(Target, Width, Height, GL_LINEAR);
+            m_pStateCache->invalidateTextureBindings();
+            if (!IsAllocated)
+            {
+                LOG_ERROR(HIVE_LOGTAG, "Layer %s has no complete %dx%d framebuffer, it is drawn at full resolution and the scene a pass per layer",
+                          vioLayer.Description.Name.c_str(), Width, Height);
+                __deleteOffscreenTarget(Target);
+                vioLayer.RenderScale = 1.0f;
+                // The composite samples the target, it cannot draw the layer any more
+                glDeleteProgram(m_CompositeProgram);
+                m_CompositeProgram = 0;
+                return;
+            }
+            LOG_INFO(HIVE_LOGTAG, "Layer %s drawn at %dx%d for a %dx%d surface", vioLayer.Description.Name.c_str(), Width, Height, vSurfaceWidth, vSurfaceHeight);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, Target.Framebuffer);
+        glViewport(0, 0, Width, Height);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        __drawLayer(vioLayer, true);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, vSurfaceWidth, vSurfaceHeight);
+    }
+
+    void CSequenceFrameRenderer::__drawUpsampledLayer(const SLayer &vLayer)
+    {
+        m_pStateCache->useProgram(m_UpsampleProgram);
+        // The target holds the layer premultiplied, see __applyOffscreenBlendMode()
+        __applyBlendMode(vLayer.Description.BlendMode == ESceneBlendMode::Opaque ? ESceneBlendMode::Opaque : ESceneBlendMode::Premultiplied);
+        glUniform1f(__getUniform(m_UpsampleProgram, EdgeSharpness),
+                    vLayer.Description.UpsampleFilter == ESceneUpsampleFilter::Edge ? COMPOSITE_SHADER::EdgeSharpness : 0.0f);
+        m_pStateCache->bindTexture(0, GL_TEXTURE_2D, vLayer.ReducedTarget.Texture);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
 
-        //nearSnow
-        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-        glUseProgram(m_initResources[4]);
-        glUniform2f(glGetUniformLocation(m_initResources[4], "uvOffset"), U0, V0);
-        glUniform2f(glGetUniformLocation(m_initResources[4], "uvScale"), U1 - U0, V1 - V0);
-//        glUniform1i(glGetUniformLocation(m_initResources[4], "snowTexture"), 0);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, m_initResources[0]);
-        glBindVertexArray(m_QuadVAOHandle);
+    bool CSequenceFrameRenderer::__allocateOffscreenTarget(SOffscreenTarget &vioTarget, int vWidth, int vHeight, GLint vFilter)
+    {
+        __deleteOffscreenTarget(vioTarget);
+        if (vWidth <= 0 || vHeight <= 0) return false;
+
+        glGenTextures(1, &vioTarget.Texture);
+        glBindTexture(GL_TEXTURE_2D, vioTarget.Texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, vWidth, vHeight);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, vFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, vFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glGenFramebuffers(1, &vioTarget.Framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, vioTarget.Framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, vioTarget.Texture, 0);
+        const bool IsComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        vioTarget.Width  = vWidth;
+        vioTarget.Height = vHeight;
+        return IsComplete;
+    }
+
+    void CSequenceFrameRenderer::__deleteOffscreenTarget(SOffscreenTarget &vioTarget)
+    {
+        glDeleteFramebuffers(1, &vioTarget.Framebuffer);
+        glDeleteTextures(1, &vioTarget.Texture);
+        vioTarget = SOffscreenTarget();
+    }
+
+    void CSequenceFrameRenderer::__drawStaticGroup(const SStaticGroup &vGroup)
+    {
+        m_pStateCache->useProgram(m_ImageProgram);
+        // The group texture holds its layers already blended, premultiplied unless the group is opaque
+        __applyBlendMode(vGroup.Layers.IsOpaque ? ESceneBlendMode::Opaque : ESceneBlendMode::Premultiplied);
+        m_pStateCache->bindTexture(0, GL_TEXTURE_2D, vGroup.Target.Texture);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
 
-        auto SwapResult = eglSwapBuffers(m_Display, m_Surface);
-        assert(SwapResult == EGL_TRUE);
+    void CSequenceFrameRenderer::__logStreamStats(const SLayer &vLayer) const
+    {
+        SSequenceStreamStats Stats;
+        if (vLayer.pSequence == nullptr || !vLayer.pSequence->getStreamStats(Stats)) return;
+        LOG_INFO(HIVE_LOGTAG, "Streamed %s: %llu hits, %llu misses, %llu late, %llu skipped, %llu decoded in %.1f ms (%.2f ms per frame)",
+                 vLayer.Description.Name.c_str(), static_cast<unsigned long long>(Stats.HitCount), static_cast<unsigned long long>(Stats.MissCount),
+                 static_cast<unsigned long long>(Stats.LateCount), static_cast<unsigned long long>(Stats.SkipCount),
+                 static_cast<unsigned long long>(Stats.DecodedCount), Stats.DecodeMs, Stats.DecodedCount ? Stats.DecodeMs / Stats.DecodedCount : 0.0);
+    }
+
+    void CSequenceFrameRenderer::__logCoverageStats(SLayer &vioLayer)
+    {
+        if (vioLayer.CoverageDrawCount == 0) return;
+        // Against the full screen quad's 100%
+        const double Rasterized = 100.0 * vioLayer.RasterizedArea / vioLayer.CoverageDrawCount;
+        if (vioLayer.HullVAO != 0)
+            LOG_INFO(HIVE_LOGTAG, "Hull %s: %d draws rasterised %.1f%% of the screen for %.1f%% visible", vioLayer.Description.Name.c_str(),
+                     vioLayer.CoverageDrawCount, Rasterized, 100.0 * vioLayer.VisibleArea / vioLayer.CoverageDrawCount);
+        else
+            LOG_INFO(HIVE_LOGTAG, "Tiles %s: %d draws rasterised %.1f%% of the screen", vioLayer.Description.Name.c_str(), vioLayer.CoverageDrawCount, Rasterized);
+        vioLayer.RasterizedArea    = 0.0;
+        vioLayer.VisibleArea       = 0.0;
+        vioLayer.CoverageDrawCount = 0;
+    }
+
+    double CSequenceFrameRenderer::__drawSequenceLayer(const SLayer &vLayer, const SSequencePlayback &vPlayback, bool &voIsTiled)
+    {
+        const GLuint Program = vLayer.Program;
+        const int Rows = vLayer.Description.Rows, Columns = vLayer.Description.Columns;
+        const float CellWidth = 1.0f / Columns, CellHeight = 1.0f / Rows;
+        const float U0 = (vPlayback.Frame % Columns) * CellWidth, V0 = (vPlayback.Frame / Columns) * CellHeight;
+        const float NextU0 = (vPlayback.NextFrame % Columns) * CellWidth, NextV0 = (vPlayback.NextFrame / Columns) * CellHeight;
+        const auto &pMotionVectors = vLayer.pMotionVectors;
+        const bool HasMotion = vPlayback.BlendFactor > 0.0f && pMotionVectors != nullptr && pMotionVectors->isReady();
+        glUniform1f(__getUniform(Program, BlendFactor), vPlayback.BlendFactor);
+        glUniform1f(__getUniform(Program, MotionStrength), HasMotion ? 1.0f : 0.0f);
+        if (HasMotion)
+        {
+            glUniform1f(__getUniform(Program, MaxDisplacement), MOTION_VECTOR_FORMAT::MaxDisplacement);
+            m_pStateCache->bindTexture(1, GL_TEXTURE_2D, pMotionVectors->getTextureID());
+        }
+        if (vLayer.pSequence != nullptr)
+        {
+            glUniform1f(__getUniform(Program, Layer), static_cast<float>(vLayer.pSequence->getLayer(vPlayback.Frame)));
+            glUniform1f(__getUniform(Program, NextLayer), static_cast<float>(std::max(vLayer.pSequence->getLayer(vPlayback.NextFrame), 0)));
+            glUniform4f(__getUniform(Program, MotionCell), U0, V0, CellWidth, CellHeight);
+            m_pStateCache->bindTexture(0, GL_TEXTURE_2D_ARRAY, vLayer.pSequence->getTextureID());
+        }
+        else
+        {
+            glUniform2f(__getUniform(Program, UvOffset), U0, V0);
+            glUniform2f(__getUniform(Program, UvScale), CellWidth, CellHeight);
+            glUniform2f(__getUniform(Program, NextUvOffset), NextU0, NextV0);
+            m_pStateCache->bindTexture(0, GL_TEXTURE_2D, vLayer.pTexture->getTextureID());
+        }
+        voIsTiled = Program == m_TileSequenceProgram;
+        if (voIsTiled) return __drawSequenceTiles(vLayer, vPlayback, HasMotion);
+        // Hulls are dilated by a few texels, warped lookups reach up to MOTION_VECTOR_FORMAT::MaxDisplacement of the frame
+        if (vLayer.HullVAO == 0 || HasMotion)
+        {
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            return 1.0;
+        }
+        // Unwarped, the frame's hull covers it and the frame it fades to, nothing is drawn when both are empty
+        const SHullFrame &Frame = vLayer.Hull.Frames[vPlayback.Frame];
+        if (Frame.VertexCount == 0) return 0.0;
+        m_pStateCache->bindVertexArray(vLayer.HullVAO);
+        glDrawArrays(GL_TRIANGLES, static_cast<GLint>(Frame.FirstVertex), static_cast<GLsizei>(Frame.VertexCount));
+        m_pStateCache->bindVertexArray(m_QuadVAOHandle);
+        return computeHullArea(vLayer.Hull, vPlayback.Frame) / (static_cast<double>(vLayer.Hull.FrameWidth) * vLayer.Hull.FrameHeight);
+    }
+
+    double CSequenceFrameRenderer::__drawSequenceTiles(const SLayer &vLayer, const SSequencePlayback &vPlayback, bool vHasMotion)
+    {
+        // Tiles of the frame and, while fading, of the next one. Warped lookups reach past the tile they are drawn in,
+        // the ring of tiles around the occupied ones covers steps of up to a tile.
+        const STileOccupancy *pOccupancy = vLayer.pSequence->getOccupancy(vPlayback.Frame);
+        const STileOccupancy *pNextOccupancy = vPlayback.BlendFactor > 0.0f ? vLayer.pSequence->getOccupancy(vPlayback.NextFrame) : nullptr;
+        if (pOccupancy == nullptr || pOccupancy->isEmpty()) return 0.0;
+        m_TileInstances.clear();
+        collectOccupiedTiles({pOccupancy, pNextOccupancy}, vHasMotion ? 1 : 0, m_TileInstances);
+        const GLsizei TileCount = static_cast<GLsizei>(m_TileInstances.size() / 2);
+        if (TileCount == 0) return 0.0;
+
+        const float TileScaleX = static_cast<float>(pOccupancy->TileSize) / pOccupancy->Width, TileScaleY = static_cast<float>(pOccupancy->TileSize) / pOccupancy->Height;
+        glUniform2f(__getUniform(vLayer.Program, TileScale), TileScaleX, TileScaleY);
+        m_pStateCache->bindVertexArray(m_TileVAOHandle);
+        // Orphaned every draw, the driver hands out fresh storage instead of waiting for the previous layer's draw
+        glBindBuffer(GL_ARRAY_BUFFER, m_TileInstanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_TileInstances.size() * sizeof(uint16_t)), m_TileInstances.data(), GL_STREAM_DRAW);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, TileCount);
+        if (m_IsTileDebugView)
+        {
+            m_pStateCache->useProgram(m_TileDebugProgram);
+            glUniform2f(__getUniform(m_TileDebugProgram, TileScale), TileScaleX, TileScaleY);
+            __applyBlendMode(ESceneBlendMode::Alpha);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, TileCount);
+        }
+        m_pStateCache->bindVertexArray(m_QuadVAOHandle);
+        // Edge tiles are cut by the frame, counted whole as the rasteriser nearly does with them
+        return static_cast<double>(TileCount) / (static_cast<double>(pOccupancy->Columns) * pOccupancy->Rows);
+    }
+
+    void CSequenceFrameRenderer::__drawSpriteLayer(const SLayer &vLayer, const SSequencePlayback &vPlayback)
+    {
+        const SSpriteAtlas &Sprites = vLayer.Sprites;
+        const SSpriteRect &Current = Sprites.Frames[vPlayback.Frame];
+        const SSpriteRect &Next = Sprites.Frames[vPlayback.NextFrame];
+        const bool IsBlending = vPlayback.BlendFactor > 0.0f && !Next.isEmpty();
+        if (Current.isEmpty() && !IsBlending) return;
+
+        // The quad covers the texels of both frames being shown, in frame UV
+        const float FrameWidth = static_cast<float>(Sprites.FrameWidth), FrameHeight = static_cast<float>(Sprites.FrameHeight);
+        float MinX = 1.0f, MinY = 1.0f, MaxX = 0.0f, MaxY = 0.0f;
+        const GLuint Program = vLayer.Program;
+        const auto setRects = [&](const SSpriteRect &vRect, EUniform vSpriteUniform, EUniform vPageUniform, int vTextureUnit) {
+            if (vRect.isEmpty())
+            {
+                // Entirely outside the frame, so the shader reads it as transparent
+                glUniform4f(__getUniform(Program, vSpriteUniform), 2.0f, 2.0f, 1.0f, 1.0f);
+                return;
+            }
+            const float X = vRect.OffsetX / FrameWidth, Y = vRect.OffsetY / FrameHeight, Width = vRect.Width / FrameWidth, Height = vRect.Height / FrameHeight;
+            MinX = std::min(MinX, X);
+            MinY = std::min(MinY, Y);
+            MaxX = std::max(MaxX, X + Width);
+            MaxY = std::max(MaxY, Y + Height);
+            const SSpritePageSize &Page = Sprites.Pages[vRect.Page];
+            glUniform4f(__getUniform(Program, vSpriteUniform), X, Y, Width, Height);
+            glUniform4f(__getUniform(Program, vPageUniform), static_cast<float>(vRect.X) / Page.Width, static_cast<float>(vRect.Y) / Page.Height,
+                        static_cast<float>(vRect.Width) / Page.Width, static_cast<float>(vRect.Height) / Page.Height);
+            m_pStateCache->bindTexture(vTextureUnit, GL_TEXTURE_2D, vLayer.SpritePages[vRect.Page]->getTextureID());
+        };
+        setRects(Current, SpriteRect, PageRect, 0);
+        if (IsBlending) setRects(Next, NextSpriteRect, NextPageRect, 1);
+        glUniform1f(__getUniform(Program, BlendFactor), IsBlending ? vPlayback.BlendFactor : 0.0f);
+        glUniform4f(__getUniform(Program, QuadRect), MinX, MinY, MaxX - MinX, MaxY - MinY);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
     }
 
     double CSequenceFrameRenderer::__getCurrentTime()
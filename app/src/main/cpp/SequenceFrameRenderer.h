@@ -1,15 +1,30 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <EGL/egl.h>
 #include <GLES3/gl3.h>
+#include "HullMesh.h"
+#include "QualityTier.h"
+#include "SceneDescription.h"
+#include "SpriteAtlas.h"
 
 struct android_app;
 
 class CTextureAsset;
+struct STextureLoadOptions;
 namespace hiveVG
 {
+    class CAsyncTextureLoader;
+    class CGLStateCache;
+    class CDiskTextureCache;
+    class CPixelUnpackRing;
+    class CTextureCache;
+    class IAssetSource;
+    class CSequenceTexture;
+
     class CSequenceFrameRenderer
     {
     public:
@@ -17,16 +32,121 @@ namespace hiveVG
         virtual ~CSequenceFrameRenderer();
 
         void render();
-        void renderBlendingSnow(const int vRow, const int vColumn);
+        // Draws the layers of m_SceneAssetPath kept for m_QualityTier
+        void renderScene();
+        // Runtime switches, also set from "adb shell setprop debug.hivevg.<name>" properties, see __pollDebugSettings()
+        void setSnowInterpolated(bool vIsInterpolated);
+        void setSceneComposited(bool vIsComposited);
 
     private:
+        // Uniforms set while drawing, resolved once per program by the state cache. Samplers are set once at link time.
+        enum EUniform : size_t
+        {
+            UvOffset, UvScale, NextUvOffset, BlendFactor, MotionStrength, MaxDisplacement, Layer, NextLayer, MotionCell, TileScale,
+            QuadRect, SpriteRect, PageRect, NextSpriteRect, NextPageRect, CompositeCells, CompositePlayback, EdgeSharpness, UniformCount
+        };
+
+        // What a sequence pass samples: the frame on screen, the one after it and how far playback is between the two
+        struct SSequencePlayback
+        {
+            int   Frame       = 0;
+            int   NextFrame   = 0;
+            float BlendFactor = 0.0f;   // 0 shows Frame alone
+        };
+
+        // A texture with a framebuffer drawing into it
+        struct SOffscreenTarget
+        {
+            GLuint Framebuffer = 0;
+            GLuint Texture     = 0;
+            int    Width       = 0;
+            int    Height      = 0;
+        };
+
+        // A scene layer with its GL resources and, for sequences, its own playback clock
+        struct SLayer
+        {
+            SSceneLayer                       Description;
+            GLuint                            Program      = 0;
+            std::shared_ptr<CTextureAsset>    pTexture;         // images and atlas sequences
+            std::shared_ptr<CSequenceTexture> pSequence;        // sequences played from texture array layers
+            std::shared_ptr<CTextureAsset>    pMotionVectors;
+            SSpriteAtlas                      Sprites;          // rect table of a sprite layer, no frames otherwise
+            std::vector<std::shared_ptr<CTextureAsset>> SpritePages;
+            SHullMesh                         Hull;             // frame meshes of a hull layer, drawn from HullVAO instead of the screen quad
+            GLuint                            HullVAO      = 0;
+            GLuint                            HullVBO      = 0;
+            double                            RasterizedArea = 0.0;   // shares of the frame summed over the draws since the last coverage stats
+            double                            VisibleArea  = 0.0;     // hull layers only, tiles do not know it
+            int                               CoverageDrawCount = 0;
+            int                               CurrentFrame = 0;
+            double                            LastStepTime = 0.0;
+            SSequencePlayback                 Playback;             // this frame's, sequences only
+            bool                              IsReady      = false; // this frame's texture or frame is resident
+            int                               StaticGroup  = -1;    // index into m_StaticGroups, -1 for a layer drawn on its own
+            float                             RenderScale  = 1.0f;  // share of the surface resolution it is drawn at into ReducedTarget
+            SOffscreenTarget                  ReducedTarget;
+
+            [[nodiscard]] bool isReduced() const { return RenderScale < 1.0f; }
+        };
+
+        // Frames drawn one way since the stats were last logged, so composite and a pass per layer can be compared
+        struct SFrameModeStats
+        {
+            int      FrameCount  = 0;
+            double   IntervalSum = 0.0;   // seconds since the frame before, swap and vsync waits included
+            double   CpuSum      = 0.0;   // seconds spent in renderScene() before the swap
+            uint64_t IssuedCount = 0;     // GL state calls
+            uint64_t ElidedCount = 0;
+        };
+
+        // A static layer group with the offscreen texture it is drawn into once and then drawn from
+        struct SStaticGroup
+        {
+            SStaticLayerGroup   Layers;
+            SOffscreenTarget    Target;             // the size of the surface it was drawn for
+            std::vector<GLuint> SourceTextures;     // of its layers when the texture was drawn, empty while it is stale
+            bool                IsFailed    = false;   // the framebuffer was incomplete, its layers are drawn one by one
+
+            [[nodiscard]] bool isCached() const { return !SourceTextures.empty(); }
+        };
+
         void            __initRenderer();
         void            __initAlgorithm();
-        GLuint          __loadTexture(const std::string& vTexturePath);
+        // Every m_SettingsPollInterval frames: debug.hivevg.interpolate 0|1 and debug.hivevg.composite 0|1
+        void            __pollDebugSettings();
+        bool            __loadScene(SSceneDescription &voScene) const;
+        void            __createLayer(const SSceneLayer &vDescription);
+        bool            __loadSpriteAtlas(const SSceneLayer &vDescription, SSpriteAtlas &voAtlas) const;
+        bool            __loadHullMesh(const SSceneLayer &vDescription, SLayer &vioLayer) const;
+        void            __createStaticGroups();
+        void            __createCompositeProgram();
+        void            __updateTextureResources();
+        bool            __isFrameResident(const SLayer &vLayer, int vFrame) const;
+        SSequencePlayback __advanceSequence(SLayer &vioLayer, double vCurrentTime);
+        void            __logStreamStats(const SLayer &vLayer) const;
+        void            __logFrameModeStats();
+        static void     __logCoverageStats(SLayer &vioLayer);
+        bool            __prepareLayer(SLayer &vioLayer, double vCurrentTime);
+        void            __drawLayer(SLayer &vioLayer, bool vIsOffscreen);
+        void            __drawComposite();
+        void            __updateStaticGroup(SStaticGroup &vioGroup, int vSurfaceWidth, int vSurfaceHeight);
+        void            __drawStaticGroup(const SStaticGroup &vGroup);
+        void            __drawReducedLayer(SLayer &vioLayer, int vSurfaceWidth, int vSurfaceHeight);
+        void            __drawUpsampledLayer(const SLayer &vLayer);
+        static bool     __allocateOffscreenTarget(SOffscreenTarget &vioTarget, int vWidth, int vHeight, GLint vFilter);
+        static void     __deleteOffscreenTarget(SOffscreenTarget &vioTarget);
+        double          __drawSequenceLayer(const SLayer &vLayer, const SSequencePlayback &vPlayback, bool &voIsTiled);
+        double          __drawSequenceTiles(const SLayer &vLayer, const SSequencePlayback &vPlayback, bool vHasMotion);
+        void            __drawSpriteLayer(const SLayer &vLayer, const SSequencePlayback &vPlayback);
         static GLuint   __compileShader(GLenum vType, const char *vShaderCode);
         static GLuint   __linkProgram(GLuint vVertShaderHandle, GLuint vFragShaderHandle);
         void            __createScreenVAO();
+        void            __createTileVAO();
         GLuint          __createProgram(const char* vVertexShaderCode, const char* vFragmentShaderCode);
+        void            __applyBlendMode(ESceneBlendMode vMode);
+        void            __applyOffscreenBlendMode(ESceneBlendMode vMode);
+        [[nodiscard]] GLint __getUniform(GLuint vProgram, EUniform vUniform) const;
         static double   __getCurrentTime();
         static bool     __checkGLError();
 
@@ -36,14 +156,78 @@ namespace hiveVG
         EGLDisplay                      m_Display           = EGL_NO_DISPLAY;
         EGLSurface                      m_Surface           = EGL_NO_SURFACE;
         EGLContext                      m_Context           = EGL_NO_CONTEXT;
-        std::vector<GLuint>             m_initResources;
-        double                          m_NearLastFrameTime = 0.0;
-        double                          m_FarLastFrameTime  = 0.0;
-        int                             m_NearCurrentFrame  = 0;
-        int                             m_FarCurrentFrame   = 0;
-        const int                       m_FramePerSecond    = 48;
-
-        std::vector<std::shared_ptr<CTextureAsset> > m_pTextureHandles;
+        GLuint                          m_ImageProgram      = 0;
+        GLuint                          m_SequenceProgram   = 0;
+        GLuint                          m_SpriteProgram     = 0;
+        GLuint                          m_TileSequenceProgram = 0;
+        GLuint                          m_TileDebugProgram  = 0;
+        GLuint                          m_TileVAOHandle     = 0;
+        GLuint                          m_TileCornerVBO     = 0;
+        GLuint                          m_TileInstanceVBO   = 0;
+        std::vector<uint16_t>           m_TileInstances;    // column, row pairs of the tiles drawn by the current draw
+        GLuint                          m_StaticGroupProgram = 0;  // draws layers into a static group's texture
+        std::vector<SStaticGroup>       m_StaticGroups;
+        int                             m_StaticRebuildCount = 0;
+        GLuint                          m_UpsampleProgram   = 0;   // draws a reduced layer's target over the surface
+        GLuint                          m_CompositeProgram  = 0;
+        std::vector<int>                m_CompositeTextureUnits;   // per layer or static group, see SCompositeShader
+        std::vector<int>                m_CompositeMotionUnits;
+        std::vector<float>              m_CompositeCells;          // per layer vec4s of the composite's uniform arrays
+        std::vector<float>              m_CompositePlayback;
+        // Layers, textures, grids and frame rates, see SceneDescription.h
+        const std::string               m_SceneAssetPath    = "Scenes/snow.scene";
+        // Snow frames as texture array layers with a sliding window, instead of sampling atlas cells. They are decoded
+        // just ahead of playback, so only the window is ever in memory, see CSequenceTexture.
+        const bool                      m_IsSnowSequenceArray = true;
+        const int                       m_SnowWindowFrames  = 32;
+        // Blend towards the next snow frame by the time since the last step instead of stepping at the layer's fps,
+        // warped by baked motion vectors where the scene gives a layer a "motion" atlas. Off is plain stepped playback.
+        // Switchable at runtime to compare the two, see setSnowInterpolated().
+        bool                            m_IsSnowInterpolated = true;
+        // Array snow without a hull drawn as one instanced quad per occupied tile of the frame, see TileOccupancy.h,
+        // instead of a full screen quad. The debug view outlines the tiles each layer drew.
+        const bool                      m_IsSnowTiled       = true;
+        const bool                      m_IsTileDebugView   = false;
+        // Every layer sampled and blended by one generated fragment shader (see CompositeShader.h), so each pixel is
+        // written once instead of read and written per layer. Off, or with a sprite layer in the scene, each layer is its
+        // own blended pass, which is also what is drawn until every layer's texture is resident. Switchable at runtime to
+        // compare the two, see setSceneComposited(). The program is only built while it is on.
+        bool                            m_IsSceneComposited = true;
+        // Runs of at least m_MinStaticGroupLayers image layers drawn once into a texture of the surface's size, then drawn
+        // from it in one pass until the surface is resized or a layer's texture changes. Off draws every layer on its own.
+        const bool                      m_IsStaticLayerCached = true;
+        const size_t                    m_MinStaticGroupLayers = 2;
+        // Sequences whose scene "scale" for m_QualityTier is below 1 are drawn into a target of that share of the surface,
+        // then upsampled over it by their "upsample" filter. Off draws them at full resolution whatever the scene says.
+        const bool                      m_IsLayerScaleApplied = true;
+        double                          m_StartTime         = 0.0;
+        bool                            m_IsFirstFrameLogged = false;
+        // Textures taller than slots x band rows put several bands into each slot, see CPixelUnpackRing::streamTexture()
+        const int                       m_UploadBandRows    = 128;
+        const size_t                    m_UploadRingSlots   = 3;
+        // Cached textures, sequence windows and offscreen targets together, the latter two pinned in the texture cache
+        const size_t                    m_TextureBudgetBytes = 256u << 20;
+        // Full screen layers are decoded no larger than this share of the window, see computeDecodeSize(), and the scene's
+        // layers and render scales are chosen for it. Picked for the device class when the window is created, see
+        // selectQualityTier(), unless "adb shell setprop debug.hivevg.tier Low|Medium|High|Source" names one.
+        EQualityTier                    m_QualityTier       = EQualityTier::High;
+        // Decoded textures kept raw in the app cache directory across launches, so a warm start maps and uploads them.
+        // Trimmed to this size at startup.
+        const size_t                    m_DiskCacheBudgetBytes = 512u << 20;
+
+        // GL state of the scene draws is set through it, see GLStateCache.h. Counts are logged every this many frames.
+        std::unique_ptr<CGLStateCache>               m_pStateCache;
+        const int                                    m_StateStatsInterval = 600;
+        const int                                    m_SettingsPollInterval = 60;
+        int                                          m_SceneFrameCount    = 0;
+        SFrameModeStats                              m_FrameModeStats[2];   // a pass per layer, composite
+        double                                       m_LastFrameTime      = 0.0;
+        std::vector<SLayer>                          m_Layers;       // in draw order
+        std::unique_ptr<IAssetSource>                m_pAssetSource;
+        std::unique_ptr<CDiskTextureCache>           m_pDiskCache;
+        std::unique_ptr<CAsyncTextureLoader>         m_pTextureLoader;
+        std::unique_ptr<CPixelUnpackRing>            m_pUploadRing;
+        std::unique_ptr<CTextureCache>               m_pTextureCache;
     };
 
 } // hiveVG
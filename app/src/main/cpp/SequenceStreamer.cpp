@@ -0,0 +1,254 @@
+#include "SequenceStreamer.h"
+#include <algorithm>
+#include <chrono>
+#include "Common.h"
+#include "ImageResize.h"
+
+namespace hiveVG
+{
+#define HIVE_LOGTAG hiveVG::TAG_KEYWORD::TEXTURE_LOADER_TAG
+    namespace
+    {
+        // Decoded frames waiting for the GL thread. The lookahead lives in the ring layers, the GL thread uploads a frame
+        // or so per tick, so a short queue is enough and bounds the CPU side to QueueDepth + 1 frames.
+        constexpr int QueueDepth = 4;
+
+        int64_t getSteadyTimeNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    bool buildSequenceFrame(CFrameSequenceDecoder &vioDecoder, int vFrame, const SSequenceStreamFormat &vFormat, SSequenceFrame &voFrame)
+    {
+        if (!vioDecoder.decodeFrame(vFrame)) return false;
+        const SImageData &Decoded = vioDecoder.getFrame();
+        // Assigning into a recycled image reuses its pixel storage
+        if (vFormat.FrameWidth != Decoded.Width || vFormat.FrameHeight != Decoded.Height)
+            voFrame.Image = downscaleImage(Decoded, vFormat.FrameWidth, vFormat.FrameHeight);
+        else
+            voFrame.Image = Decoded;
+        premultiplyAlpha(voFrame.Image, vFormat.AlphaConversion);
+        buildTileOccupancy(voFrame.Image, voFrame.Occupancy);
+        if (vFormat.LevelCount > 1) voFrame.MipLevels = generateSubLevels(voFrame.Image, vFormat.MipAlphaMode, vFormat.LevelCount);
+        return true;
+    }
+
+    CFrameSequenceSource::CFrameSequenceSource(std::unique_ptr<CAssetBuffer> vSequenceFile, SFrameSequence vSequence, const SSequenceStreamFormat &vFormat)
+        : m_pSequenceFile(std::move(vSequenceFile)), m_Sequence(std::move(vSequence)), m_Format(vFormat), m_Decoder(m_pSequenceFile->getData(), m_Sequence)
+    {
+    }
+
+    CStreamedAtlas::CStreamedAtlas(int vWidth, int vHeight, int vFrameRowCount) : m_FrameRowCount(vFrameRowCount)
+    {
+        m_Decoded.Width  = vWidth;
+        m_Decoded.Height = vHeight;
+        m_Decoded.Pixels.resize(m_Decoded.getByteSize());
+        m_pTexels     = m_Decoded.Pixels.data();
+        m_Pitch       = m_Decoded.getRowPitch();
+        m_FrameHeight = vHeight / std::max(vFrameRowCount, 1);
+    }
+
+    CStreamedAtlas::CStreamedAtlas(SCachedTexture vMapped, int vFrameRowCount)
+        : m_FrameRowCount(vFrameRowCount), m_Mapped(std::move(vMapped)), m_ReadyFrameRowCount(vFrameRowCount)
+    {
+        m_pTexels     = m_Mapped.getLevelData(0);
+        m_Pitch       = static_cast<size_t>(m_Mapped.getWidth()) * 4;
+        m_FrameHeight = m_Mapped.getHeight() / std::max(vFrameRowCount, 1);
+    }
+
+    bool CStreamedAtlas::addFrameRows(int vFirstFrameRow, const SImageData &vSlice)
+    {
+        const int FrameRowCount = vSlice.Height / std::max(m_FrameHeight, 1);
+        if (vSlice.getRowPitch() != m_Pitch || vSlice.Height != FrameRowCount * m_FrameHeight || vFirstFrameRow != m_ReadyFrameRowCount ||
+            vFirstFrameRow + FrameRowCount > m_FrameRowCount || m_Decoded.Pixels.empty())
+        {
+            markFailed();
+            return false;
+        }
+        // Readers never touch rows past m_ReadyFrameRowCount, so only publishing them needs the lock
+        std::copy_n(vSlice.Pixels.data(), vSlice.getByteSize(), m_Decoded.Pixels.data() + m_Pitch * vFirstFrameRow * m_FrameHeight);
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            m_ReadyFrameRowCount = vFirstFrameRow + FrameRowCount;
+        }
+        m_RowArrived.notify_all();
+        return true;
+    }
+
+    void CStreamedAtlas::markFailed()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            m_IsFailed = true;
+        }
+        m_RowArrived.notify_all();
+    }
+
+    void CStreamedAtlas::replaceWithMapping(SCachedTexture vMapped)
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        if (m_ReadyFrameRowCount != m_FrameRowCount || static_cast<size_t>(vMapped.getWidth()) * 4 != m_Pitch || vMapped.getHeight() != m_Decoded.Height) return;
+        m_Mapped  = std::move(vMapped);
+        m_pTexels = m_Mapped.getLevelData(0);
+        m_Decoded = {};
+    }
+
+    void CStreamedAtlas::stop()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            m_IsStopped = true;
+        }
+        m_RowArrived.notify_all();
+    }
+
+    bool CStreamedAtlas::readFrameRow(int vFrameRow, const std::function<void(const uint8_t *, size_t)> &vRead) const
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_RowArrived.wait(Lock, [&]() { return vFrameRow < m_ReadyFrameRowCount || m_IsFailed || m_IsStopped; });
+        if (vFrameRow >= m_ReadyFrameRowCount || m_IsStopped) return false;
+        // Held while reading, so replaceWithMapping() cannot free the texels underneath
+        vRead(m_pTexels + m_Pitch * vFrameRow * m_FrameHeight, m_Pitch);
+        return true;
+    }
+
+    CAtlasFrameSource::CAtlasFrameSource(std::shared_ptr<CStreamedAtlas> vAtlas, int vRows, int vColumns, const SSequenceStreamFormat &vFormat)
+        : m_pAtlas(std::move(vAtlas)), m_Rows(vRows), m_Columns(vColumns), m_Format(vFormat)
+    {
+    }
+
+    bool CAtlasFrameSource::buildFrame(int vFrame, SSequenceFrame &voFrame)
+    {
+        if (vFrame < 0 || vFrame >= getFrameCount()) return false;
+        SImageData &Image = voFrame.Image;
+        Image.Width    = m_Format.FrameWidth;
+        Image.Height   = m_Format.FrameHeight;
+        Image.Channels = 4;
+        Image.Pixels.resize(Image.getByteSize());
+        const bool IsCopied = m_pAtlas->readFrameRow(vFrame / m_Columns, [&](const uint8_t *vFrameRow, size_t vPitch) {
+            const uint8_t *pCell = vFrameRow + static_cast<size_t>(vFrame % m_Columns) * Image.getRowPitch();
+            for (int y = 0; y < Image.Height; ++y)
+                std::copy_n(pCell + vPitch * y, Image.getRowPitch(), Image.Pixels.data() + Image.getRowPitch() * y);
+        });
+        if (!IsCopied) return false;
+        buildTileOccupancy(Image, voFrame.Occupancy);
+        if (m_Format.LevelCount > 1) voFrame.MipLevels = generateSubLevels(Image, m_Format.MipAlphaMode, m_Format.LevelCount);
+        return true;
+    }
+
+    CSequenceStreamer::CSequenceStreamer(std::unique_ptr<ISequenceFrameSource> vSource, int vLookahead, int vFramesPerSecond)
+        : m_pSource(std::move(vSource)), m_Lookahead(std::clamp(vLookahead, 1, m_pSource->getFrameCount())), m_FramesPerSecond(std::max(vFramesPerSecond, 1)),
+          m_DecodedQueue(std::min(m_Lookahead, QueueDepth)), m_RecycleQueue(m_DecodedQueue.getCapacity() + 1),
+          m_DecodeThread(&CSequenceStreamer::__decodeLoop, this)
+    {
+    }
+
+    CSequenceStreamer::~CSequenceStreamer()
+    {
+        m_IsStopping = true;
+        // Wakes the decode thread if its source waits for data, e.g. an atlas row still being decoded
+        m_pSource->stop();
+        if (m_DecodeThread.joinable()) m_DecodeThread.join();
+    }
+
+    void CSequenceStreamer::setPlaybackFrame(int vFrame)
+    {
+        const int Advance = (vFrame - m_PlaybackFrame + getFrameCount()) % getFrameCount();
+        m_PlaybackFrame = vFrame;
+        m_PlaybackTimeNs.store(getSteadyTimeNs(), std::memory_order_relaxed);
+        m_PlaybackPosition.store(m_PlaybackPosition.load(std::memory_order_relaxed) + Advance, std::memory_order_release);
+    }
+
+    bool CSequenceStreamer::popFrame(int vWindowSize, SStreamedFrame &voFrame)
+    {
+        const int64_t Playback = m_PlaybackPosition.load(std::memory_order_relaxed);
+        while (m_HeldFrame.pFrame != nullptr || m_DecodedQueue.tryPop(m_HeldFrame))
+        {
+            if (m_HeldFrame.Position >= Playback + vWindowSize) return false;
+            if (m_HeldFrame.Position >= Playback)
+            {
+                voFrame = std::move(m_HeldFrame);
+                m_HeldFrame = {};
+                return true;
+            }
+            ++m_LateCount;
+            recycleFrame(std::move(m_HeldFrame.pFrame));
+            m_HeldFrame = {};
+        }
+        return false;
+    }
+
+    void CSequenceStreamer::recycleFrame(std::unique_ptr<SSequenceFrame> vFrame)
+    {
+        // The recycle queue holds every buffer in flight, so this only fails for foreign frames, those are freed
+        if (vFrame != nullptr) m_RecycleQueue.tryPush(std::move(vFrame));
+    }
+
+    SSequenceStreamStats CSequenceStreamer::getStats() const
+    {
+        SSequenceStreamStats Stats;
+        Stats.HitCount     = m_HitCount;
+        Stats.MissCount    = m_MissCount;
+        Stats.LateCount    = m_LateCount;
+        Stats.SkipCount    = m_SkipCount.load();
+        Stats.DecodedCount = m_DecodedCount.load();
+        Stats.DecodeMs     = m_DecodeNs.load() / 1e6;
+        return Stats;
+    }
+
+    int64_t CSequenceStreamer::__predictPlaybackPosition() const
+    {
+        const int64_t Position = m_PlaybackPosition.load(std::memory_order_acquire);
+        const int64_t TimeNs   = m_PlaybackTimeNs.load(std::memory_order_relaxed);
+        if (TimeNs == 0) return Position;
+        // At most two frames of extrapolation, a stalled or paused GL thread is not playing on
+        const int64_t ElapsedFrames = (getSteadyTimeNs() - TimeNs) * m_FramesPerSecond / 1000000000;
+        return Position + std::clamp<int64_t>(ElapsedFrames, 0, 2);
+    }
+
+    void CSequenceStreamer::__decodeLoop()
+    {
+        const auto IdleWait = std::chrono::microseconds(1000000 / m_FramesPerSecond / 4);
+        int64_t NextPosition = 0;
+        // One more buffer than the queue holds, the GL thread keeps one while it uploads
+        size_t AllocatedFrameCount = 0;
+        while (!m_IsStopping)
+        {
+            const int64_t Playback = __predictPlaybackPosition();
+            if (NextPosition < Playback)
+            {
+                m_SkipCount += static_cast<uint64_t>(Playback - NextPosition);
+                NextPosition = Playback;
+            }
+            std::unique_ptr<SSequenceFrame> pFrame;
+            if (NextPosition >= Playback + m_Lookahead || (!m_RecycleQueue.tryPop(pFrame) && AllocatedFrameCount > m_DecodedQueue.getCapacity()))
+            {
+                std::this_thread::sleep_for(IdleWait);
+                continue;
+            }
+            if (pFrame == nullptr)
+            {
+                pFrame = std::make_unique<SSequenceFrame>();
+                ++AllocatedFrameCount;
+            }
+
+            const int Frame = static_cast<int>(NextPosition % getFrameCount());
+            const int64_t StartNs = getSteadyTimeNs();
+            if (!m_pSource->buildFrame(Frame, *pFrame))
+            {
+                if (!m_IsStopping) LOG_ERROR(HIVE_LOGTAG, "Frame %d of the streamed sequence is corrupt, streaming stopped", Frame);
+                return;
+            }
+            m_DecodeNs += getSteadyTimeNs() - StartNs;
+            ++m_DecodedCount;
+
+            SStreamedFrame Streamed;
+            Streamed.Position = NextPosition++;
+            Streamed.Frame    = Frame;
+            Streamed.pFrame   = std::move(pFrame);
+            // Buffers are bounded by the recycle logic above, so the queue has room unless the GL thread holds a frame back
+            while (!m_DecodedQueue.tryPush(std::move(Streamed)) && !m_IsStopping) std::this_thread::sleep_for(IdleWait);
+        }
+    }
+}
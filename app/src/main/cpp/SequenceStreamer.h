@@ -0,0 +1,205 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "AssetSource.h"
+#include "DiskTextureCache.h"
+#include "FrameSequence.h"
+#include "ImageData.h"
+#include "MipChain.h"
+#include "PixelConvert.h"
+#include "SpscQueue.h"
+#include "TileOccupancy.h"
+
+namespace hiveVG
+{
+    // One decoded frame of a sequence, vMipLevels holds its own levels 1..n.
+    struct SSequenceFrame
+    {
+        SImageData              Image;
+        std::vector<SImageData> MipLevels;
+        STileOccupancy          Occupancy;   // of Image, so the renderer draws only the tiles that can show
+    };
+
+    struct SStreamedFrame
+    {
+        int64_t                         Position = -1;   // frames since playback started, loops included
+        int                             Frame    = -1;   // Position % frame count
+        std::unique_ptr<SSequenceFrame> pFrame;
+    };
+
+    // How every streamed frame is turned into upload data, the same steps the whole sequence loader applies
+    struct SSequenceStreamFormat
+    {
+        int              FrameWidth      = 0;   // smaller than the file's frames to downscale them
+        int              FrameHeight     = 0;
+        int              LevelCount      = 1;
+        EAlphaConversion AlphaConversion = EAlphaConversion::None;
+        EAlphaMode       MipAlphaMode    = EAlphaMode::Straight;
+    };
+
+    struct SSequenceStreamStats
+    {
+        uint64_t HitCount     = 0;   // frames that were resident when they were due
+        uint64_t MissCount    = 0;   // frames that were due but not resident, playback held the previous one
+        uint64_t LateCount    = 0;   // frames that reached the GL thread after playback had passed them
+        uint64_t SkipCount    = 0;   // frames the decoder jumped over to catch up with playback
+        uint64_t DecodedCount = 0;
+        double   DecodeMs     = 0.0;
+    };
+
+    // Decodes vFrame and converts it to vFormat into voFrame, reusing its buffers, and scans its tile occupancy
+    bool buildSequenceFrame(CFrameSequenceDecoder &vioDecoder, int vFrame, const SSequenceStreamFormat &vFormat, SSequenceFrame &voFrame);
+
+    // Where a streamer's frames come from. Any frame may be asked for again once playback loops back to it.
+    class ISequenceFrameSource
+    {
+    public:
+        virtual ~ISequenceFrameSource() = default;
+
+        // Into voFrame, reusing its buffers, tile occupancy and mip levels included
+        virtual bool              buildFrame(int vFrame, SSequenceFrame &voFrame) = 0;
+        [[nodiscard]] virtual int getFrameCount() const = 0;
+        // Any thread: a buildFrame() waiting for its data gives up and returns false, so the streamer can stop
+        virtual void              stop() {}
+    };
+
+    // Frames of a .hseq file, rebuilt from its keyframes and deltas whenever they are asked for
+    class CFrameSequenceSource final : public ISequenceFrameSource
+    {
+    public:
+        // vSequence records refer into vSequenceFile, the source keeps both
+        CFrameSequenceSource(std::unique_ptr<CAssetBuffer> vSequenceFile, SFrameSequence vSequence, const SSequenceStreamFormat &vFormat);
+
+        bool              buildFrame(int vFrame, SSequenceFrame &voFrame) override { return buildSequenceFrame(m_Decoder, vFrame, m_Format, voFrame); }
+        [[nodiscard]] int getFrameCount() const override { return m_Sequence.getFrameCount(); }
+
+    private:
+        std::unique_ptr<CAssetBuffer> m_pSequenceFile;
+        const SFrameSequence          m_Sequence;
+        const SSequenceStreamFormat   m_Format;
+        CFrameSequenceDecoder         m_Decoder;
+    };
+
+    /*!
+     * A grid atlas that CAtlasFrameSource re-slices frames from. A loader worker decodes it frame row by frame row while
+     * playback already runs from the rows that arrived, a reader only waits for a row that has not. Once complete the
+     * heap atlas can be swapped for its disk cache mapping, whose pages belong to the file. A cache hit is complete at once.
+     */
+    class CStreamedAtlas
+    {
+    public:
+        // Empty, vFrameRowCount rows of frames to be added by addFrameRows()
+        CStreamedAtlas(int vWidth, int vHeight, int vFrameRowCount);
+        CStreamedAtlas(SCachedTexture vMapped, int vFrameRowCount);
+
+        CStreamedAtlas(const CStreamedAtlas &) = delete;
+        CStreamedAtlas &operator=(const CStreamedAtlas &) = delete;
+
+        // Worker: vSlice holds whole frame rows at the atlas' width, the first of them is vFirstFrameRow. Rows arrive in order.
+        bool addFrameRows(int vFirstFrameRow, const SImageData &vSlice);
+        // Worker: the frame rows still missing never arrive
+        void markFailed();
+        // Worker, once complete: the heap atlas every row was decoded into, e.g. to store it in the disk cache
+        [[nodiscard]] const SImageData& getDecodedImage() const { return m_Decoded; }
+        // Worker, once complete: reads move to vMapped, which holds the same texels, and the heap atlas is freed
+        void replaceWithMapping(SCachedTexture vMapped);
+        // Any thread: readers waiting for a row return false, for the streamer to stop
+        void stop();
+        // Waits for vFrameRow, then calls vRead with the atlas' texels and row pitch, valid during the call. False if the row
+        // never arrives or stop() was called.
+        bool readFrameRow(int vFrameRow, const std::function<void(const uint8_t *, size_t)> &vRead) const;
+
+    private:
+        const int                       m_FrameRowCount;
+        SImageData                      m_Decoded;
+        SCachedTexture                  m_Mapped;
+        const uint8_t*                  m_pTexels            = nullptr;   // into whichever of the two holds the atlas
+        size_t                          m_Pitch              = 0;
+        int                             m_FrameHeight        = 0;
+        int                             m_ReadyFrameRowCount = 0;
+        bool                            m_IsFailed           = false;
+        bool                            m_IsStopped          = false;
+        mutable std::mutex              m_Mutex;
+        mutable std::condition_variable m_RowArrived;
+    };
+
+    // Frames cut from a vRows x vColumns grid atlas whose texels are already scaled and converted, so a frame costs a
+    // copy of its cell, its occupancy scan and its mips. Only the atlas stays in memory, see CStreamedAtlas.
+    class CAtlasFrameSource final : public ISequenceFrameSource
+    {
+    public:
+        // vFormat gives the cell size and levels, its AlphaConversion is ignored
+        CAtlasFrameSource(std::shared_ptr<CStreamedAtlas> vAtlas, int vRows, int vColumns, const SSequenceStreamFormat &vFormat);
+
+        bool              buildFrame(int vFrame, SSequenceFrame &voFrame) override;
+        [[nodiscard]] int getFrameCount() const override { return m_Rows * m_Columns; }
+        void              stop() override { m_pAtlas->stop(); }
+
+    private:
+        std::shared_ptr<CStreamedAtlas> m_pAtlas;
+        const int                       m_Rows;
+        const int                       m_Columns;
+        const SSequenceStreamFormat     m_Format;
+    };
+
+    /*!
+     * Streams a sequence through a fixed set of frames: a decoder thread predicts the playback position from the
+     * last frame the GL thread reported and the frame rate, and keeps building up to vLookahead frames ahead of it into
+     * a lock free SPSC queue. Frame buffers travel back through a second queue once uploaded, so memory stays constant
+     * however long the sequence is. If the decoder falls behind it skips ahead instead of decoding frames already past.
+     * Everything but the constructor and destructor is called from the GL thread.
+     */
+    class CSequenceStreamer
+    {
+    public:
+        CSequenceStreamer(std::unique_ptr<ISequenceFrameSource> vSource, int vLookahead, int vFramesPerSecond);
+        ~CSequenceStreamer();
+
+        CSequenceStreamer(const CSequenceStreamer &) = delete;
+        CSequenceStreamer &operator=(const CSequenceStreamer &) = delete;
+
+        // The frame on screen, the decoder extrapolates from it until the next call. Playback only moves forward and
+        // never by a whole loop between two calls.
+        void   setPlaybackFrame(int vFrame);
+        // Next queued frame at most vWindowSize - 1 frames ahead of playback. Frames already behind playback are dropped
+        // and counted as late, a frame too far ahead is held back until playback gets close enough.
+        bool   popFrame(int vWindowSize, SStreamedFrame &voFrame);
+        // Hands an uploaded frame's buffers back to the decoder
+        void   recycleFrame(std::unique_ptr<SSequenceFrame> vFrame);
+        // Playback reached vFrame's display time, vIsResident tells whether it could be shown
+        void   recordFrameDue(bool vIsResident) { ++(vIsResident ? m_HitCount : m_MissCount); }
+        [[nodiscard]] SSequenceStreamStats getStats() const;
+        [[nodiscard]] int  getFrameCount() const { return m_pSource->getFrameCount(); }
+
+    private:
+        void    __decodeLoop();
+        int64_t __predictPlaybackPosition() const;
+
+        std::unique_ptr<ISequenceFrameSource>           m_pSource;   // decode thread only
+        const int                                       m_Lookahead;
+        const int                                       m_FramesPerSecond;
+        CSpscQueue<SStreamedFrame>                      m_DecodedQueue;
+        CSpscQueue<std::unique_ptr<SSequenceFrame>>     m_RecycleQueue;
+        // Published by the GL thread. Read as a pair without a lock, a torn read only shifts the prediction by a frame
+        std::atomic<int64_t>                            m_PlaybackPosition{0};
+        std::atomic<int64_t>                            m_PlaybackTimeNs{0};
+        std::atomic<uint64_t>                           m_SkipCount{0};
+        std::atomic<uint64_t>                           m_DecodedCount{0};
+        std::atomic<int64_t>                            m_DecodeNs{0};
+        // GL thread only
+        int                                             m_PlaybackFrame = 0;
+        SStreamedFrame                                  m_HeldFrame;
+        uint64_t                                        m_HitCount  = 0;
+        uint64_t                                        m_MissCount = 0;
+        uint64_t                                        m_LateCount = 0;
+        std::atomic<bool>                               m_IsStopping{false};
+        // Declared last, it starts decoding as soon as it is constructed
+        std::thread                                     m_DecodeThread;
+    };
+}
@@ -0,0 +1,154 @@
+#include "SequenceTexture.h"
+#include <algorithm>
+#include <cassert>
+#include "Common.h"
+#include "TextureAsset.h"
+
+namespace hiveVG
+{
+#define HIVE_LOGTAG hiveVG::TAG_KEYWORD::TEXTURE_LOADER_TAG
+    CSequenceTexture::CSequenceTexture(int vFrameCount, int vWindowSize)
+        : m_FrameCount(vFrameCount), m_WindowSize(std::clamp(vWindowSize, 1, vFrameCount)), m_LayerFrames(m_WindowSize, -1), m_LayerOccupancy(m_WindowSize)
+    {
+        assert(vFrameCount > 0);
+    }
+
+    CSequenceTexture::~CSequenceTexture()
+    {
+        if (m_TextureID != 0) glDeleteTextures(1, &m_TextureID);
+    }
+
+    int CSequenceTexture::update(int vFirstFrame, int vMaxUploads)
+    {
+        if (m_IsFailed || (m_TextureID == 0 && !__allocateStorage())) return 0;
+
+        CSequenceStreamer *pStreamer = __getStreamer();
+        if (pStreamer == nullptr) return 0;
+        pStreamer->setPlaybackFrame(vFirstFrame);
+        // A window as long as the sequence holds every frame after the first loop, the streamer then just idles with its
+        // queue full
+        const bool IsEveryFrameHeld = m_WindowSize == m_FrameCount && std::find(m_LayerFrames.begin(), m_LayerFrames.end(), -1) == m_LayerFrames.end();
+        int UploadCount = 0;
+        SStreamedFrame Streamed;
+        while (!IsEveryFrameHeld && UploadCount < vMaxUploads && pStreamer->popFrame(m_WindowSize, Streamed))
+        {
+            // Frames take the ring layer of their playback position, the layer of frame f is not fixed
+            const int Layer = static_cast<int>(Streamed.Position % m_WindowSize);
+            const bool IsUploaded = m_LayerFrames[Layer] == Streamed.Frame || __uploadFrame(Streamed.Frame, Layer, *Streamed.pFrame);
+            pStreamer->recycleFrame(std::move(Streamed.pFrame));
+            if (!IsUploaded) break;
+            ++UploadCount;
+        }
+        return UploadCount;
+    }
+
+    int CSequenceTexture::getLayer(int vFrame) const
+    {
+        const int Layer = vFrame % m_WindowSize;
+        if (m_LayerFrames[Layer] == vFrame) return Layer;
+        // Streamed frames land in the layer of their playback position, which drifts once the frame count is not a
+        // multiple of the window
+        const auto Iterator = std::find(m_LayerFrames.begin(), m_LayerFrames.end(), vFrame);
+        return Iterator != m_LayerFrames.end() ? static_cast<int>(Iterator - m_LayerFrames.begin()) : -1;
+    }
+
+    const STileOccupancy *CSequenceTexture::getOccupancy(int vFrame) const
+    {
+        const int Layer = getLayer(vFrame);
+        return Layer >= 0 ? &m_LayerOccupancy[Layer] : nullptr;
+    }
+
+    void CSequenceTexture::recordFrameDue(int vFrame)
+    {
+        if (CSequenceStreamer *pStreamer = __getStreamer()) pStreamer->recordFrameDue(isFrameResident(vFrame));
+    }
+
+    bool CSequenceTexture::getStreamStats(SSequenceStreamStats &voStats) const
+    {
+        const CSequenceStreamer *pStreamer = __getStreamer();
+        if (pStreamer == nullptr) return false;
+        voStats = pStreamer->getStats();
+        return true;
+    }
+
+    void CSequenceTexture::__setLayout(int vFrameWidth, int vFrameHeight, int vLevelCount)
+    {
+        std::lock_guard<std::mutex> Lock(m_FrameMutex);
+        m_FrameWidth  = vFrameWidth;
+        m_FrameHeight = vFrameHeight;
+        m_LevelCount  = vLevelCount;
+    }
+
+    void CSequenceTexture::__attachStreamer(std::unique_ptr<CSequenceStreamer> vStreamer)
+    {
+        std::lock_guard<std::mutex> Lock(m_FrameMutex);
+        m_pStreamer = std::move(vStreamer);
+    }
+
+    CSequenceStreamer *CSequenceTexture::__getStreamer() const
+    {
+        std::lock_guard<std::mutex> Lock(m_FrameMutex);
+        return m_pStreamer.get();
+    }
+
+    bool CSequenceTexture::__allocateStorage()
+    {
+        int FrameWidth, FrameHeight, LevelCount;
+        {
+            std::lock_guard<std::mutex> Lock(m_FrameMutex);
+            FrameWidth  = m_FrameWidth;
+            FrameHeight = m_FrameHeight;
+            LevelCount  = m_LevelCount;
+        }
+        if (LevelCount == 0) return false;
+
+        clearStaleGLErrors();
+        glGenTextures(1, &m_TextureID);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_TextureID);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, LevelCount, GL_RGBA8, FrameWidth, FrameHeight, m_WindowSize);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, LevelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GLenum Error = glGetError();
+        if (Error != GL_NO_ERROR)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Allocating %d layers of %dx%d failed with GL error 0x%x", m_WindowSize, FrameWidth, FrameHeight, Error);
+            glDeleteTextures(1, &m_TextureID);
+            m_TextureID = 0;
+            m_IsFailed  = true;
+            return false;
+        }
+
+        m_EstimatedBytes = 0;
+        for (int Level = 0; Level < LevelCount; ++Level)
+            m_EstimatedBytes += static_cast<size_t>(std::max(FrameWidth >> Level, 1)) * std::max(FrameHeight >> Level, 1) * 4 * m_WindowSize;
+        LOG_INFO(HIVE_LOGTAG, "Sequence of %d frames holds %d layers of %dx%d (%d levels, %.1f MiB)", m_FrameCount, m_WindowSize, FrameWidth, FrameHeight,
+                 LevelCount, m_EstimatedBytes / 1048576.0);
+        return true;
+    }
+
+    bool CSequenceTexture::__uploadFrame(int vFrame, int vLayer, const SSequenceFrame &vDecodedFrame)
+    {
+        clearStaleGLErrors();
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_TextureID);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, vLayer, vDecodedFrame.Image.Width, vDecodedFrame.Image.Height, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                        vDecodedFrame.Image.Pixels.data());
+        for (size_t Level = 1; Level <= vDecodedFrame.MipLevels.size(); ++Level)
+        {
+            const SImageData &Mip = vDecodedFrame.MipLevels[Level - 1];
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(Level), 0, 0, vLayer, Mip.Width, Mip.Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, Mip.Pixels.data());
+        }
+
+        GLenum Error = glGetError();
+        if (Error != GL_NO_ERROR)
+        {
+            LOG_ERROR(HIVE_LOGTAG, "Uploading frame %d failed with GL error 0x%x", vFrame, Error);
+            m_IsFailed = true;
+            return false;
+        }
+        m_LayerFrames[vLayer]    = vFrame;
+        m_LayerOccupancy[vLayer] = vDecodedFrame.Occupancy;
+        return true;
+    }
+}
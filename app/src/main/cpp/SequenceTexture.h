@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <GLES3/gl3.h>
+#include "SequenceStreamer.h"
+
+namespace hiveVG
+{
+    class CAsyncTextureLoader;
+
+    /*!
+     * Frame sequence backed by a GL_TEXTURE_2D_ARRAY, one layer per frame and a full mip chain per layer, so minified
+     * frames never bleed into their atlas neighbours. Only a window of getWindowSize() layers is allocated: frame f
+     * lives in layer p % getWindowSize() of its playback position p and replaces whatever frame was there before.
+     * No decoded frames are kept: the async loader attaches a CSequenceStreamer that builds them just ahead of playback,
+     * from a .hseq file or by re-slicing the atlas, and update() uploads them on the GL thread. CPU memory is the
+     * streamer's few frame buffers however long the sequence is.
+     */
+    class CSequenceTexture
+    {
+    public:
+        CSequenceTexture(int vFrameCount, int vWindowSize);
+        ~CSequenceTexture();
+
+        CSequenceTexture(const CSequenceTexture &) = delete;
+        CSequenceTexture &operator=(const CSequenceTexture &) = delete;
+
+        // GL thread: uploads streamed frames of [vFirstFrame, vFirstFrame + window) that are not resident yet, at most vMaxUploads
+        int    update(int vFirstFrame, int vMaxUploads);
+        // Layer to sample for vFrame, -1 while it is not resident
+        [[nodiscard]] int    getLayer(int vFrame) const;
+        [[nodiscard]] bool   isFrameResident(int vFrame) const { return getLayer(vFrame) >= 0; }
+        // Tile occupancy of vFrame as it was uploaded, null while it is not resident
+        [[nodiscard]] const STileOccupancy* getOccupancy(int vFrame) const;
+        [[nodiscard]] GLuint getTextureID() const { return m_TextureID; }
+        [[nodiscard]] int    getFrameCount() const { return m_FrameCount; }
+        [[nodiscard]] int    getWindowSize() const { return m_WindowSize; }
+        [[nodiscard]] bool   isFailed() const { return m_IsFailed.load(); }
+        [[nodiscard]] size_t getEstimatedBytes() const { return m_EstimatedBytes; }
+        // Call when vFrame's display time comes, it counts as a hit if it is resident by then
+        void   recordFrameDue(int vFrame);
+        // False until the loader attached the streamer
+        bool   getStreamStats(SSequenceStreamStats &voStats) const;
+
+    private:
+        friend class CAsyncTextureLoader;
+
+        // Worker side, before the streamer is attached
+        void   __setLayout(int vFrameWidth, int vFrameHeight, int vLevelCount);
+        void   __markFailed() { m_IsFailed = true; }
+        void   __attachStreamer(std::unique_ptr<CSequenceStreamer> vStreamer);
+        CSequenceStreamer* __getStreamer() const;
+        bool   __allocateStorage();
+        bool   __uploadFrame(int vFrame, int vLayer, const SSequenceFrame &vDecodedFrame);
+
+        const int                                          m_FrameCount;
+        const int                                          m_WindowSize;
+        GLuint                                             m_TextureID      = 0;
+        size_t                                             m_EstimatedBytes = 0;
+        std::vector<int>                                   m_LayerFrames;    // frame held by each layer, -1 if none
+        std::vector<STileOccupancy>                        m_LayerOccupancy; // of the frame held by each layer
+        mutable std::mutex                                 m_FrameMutex;
+        int                                                m_FrameWidth     = 0;
+        int                                                m_FrameHeight    = 0;
+        int                                                m_LevelCount     = 0;
+        std::atomic<bool>                                  m_IsFailed{false};
+        // Set once by the loader's worker, guarded by m_FrameMutex until then
+        std::unique_ptr<CSequenceStreamer>                 m_pStreamer;
+    };
+}
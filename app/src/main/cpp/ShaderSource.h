@@ -14,6 +14,8 @@ namespace hiveVG
         }
         )vertex";
 
+    // blendFactor > 0 mixes in the next frame, warped along the motion vectors when motionStrength is 1 (see MotionVectors.h).
+    // The motion atlas has the colour atlas grid, so frame cells are addressed by the same uvOffset / uvScale.
     const char SnowFragmentShaderSource[] = R"fragment(#version 300 es
         precision mediump float;
         out vec4 FragColor;
@@ -21,18 +23,144 @@ namespace hiveVG
         in vec2 TexCoord;
         uniform vec2 uvOffset;
         uniform vec2 uvScale;
+        uniform vec2 nextUvOffset;
+        uniform float blendFactor;
+        uniform float motionStrength;
+        uniform float maxDisplacement;
         uniform sampler2D snowTexture;
+        uniform sampler2D motionVectors;
 
         void main()
         {
-            vec2 FinalUV = (TexCoord * uvScale) + uvOffset;
-            vec4 SnowColor = texture(snowTexture, FinalUV);
+            vec2 Motion = vec2(0.0);
+            if (motionStrength > 0.0)
+                Motion = (texture(motionVectors, TexCoord * uvScale + uvOffset).rg * 2.0 - 1.0) * maxDisplacement * motionStrength;
+            // Warped lookups stay inside their cell, the neighbouring frames must not bleed in
+            vec2 CurrentUV = clamp(TexCoord - blendFactor * Motion, 0.0, 1.0) * uvScale + uvOffset;
+            vec4 SnowColor = texture(snowTexture, CurrentUV);
+            if (blendFactor > 0.0)
+            {
+                vec2 NextUV = clamp(TexCoord + (1.0 - blendFactor) * Motion, 0.0, 1.0) * uvScale + nextUvOffset;
+                SnowColor = mix(SnowColor, texture(snowTexture, NextUV), blendFactor);
+            }
             if(SnowColor.a < 0.1)
                 discard;
             FragColor = SnowColor;
         }
         )fragment";
 
+    // Sequence frames live in the layers of a GL_TEXTURE_2D_ARRAY, the frame is picked by layer instead of an atlas cell.
+    // Interpolation works as in SnowFragmentShaderSource, motionCell locates the frame's cell in the motion atlas.
+    const char SnowArrayFragmentShaderSource[] = R"fragment(#version 300 es
+        precision mediump float;
+        precision mediump sampler2DArray;
+        out vec4 FragColor;
+
+        in vec2 TexCoord;
+        uniform float layer;
+        uniform float nextLayer;
+        uniform float blendFactor;
+        uniform float motionStrength;
+        uniform float maxDisplacement;
+        uniform vec4 motionCell;
+        uniform sampler2DArray snowFrames;
+        uniform sampler2D motionVectors;
+
+        void main()
+        {
+            vec2 Motion = vec2(0.0);
+            if (motionStrength > 0.0)
+                Motion = (texture(motionVectors, TexCoord * motionCell.zw + motionCell.xy).rg * 2.0 - 1.0) * maxDisplacement * motionStrength;
+            vec4 SnowColor = texture(snowFrames, vec3(TexCoord - blendFactor * Motion, layer));
+            if (blendFactor > 0.0)
+                SnowColor = mix(SnowColor, texture(snowFrames, vec3(TexCoord + (1.0 - blendFactor) * Motion, nextLayer)), blendFactor);
+            if(SnowColor.a < 0.1)
+                discard;
+            FragColor = SnowColor;
+        }
+        )fragment";
+
+    // Trimmed sequence frames (see SpriteAtlas.h): the quad covers only quadRect of the frame, in frame UV with y down
+    const char SpriteVertexShaderSource[] = R"vertex(#version 300 es
+        layout (location = 0) in vec2 aPos;
+        layout (location = 1) in vec2 aTexCoord;
+
+        out vec2 FrameUV;
+        uniform vec4 quadRect;
+
+        void main()
+        {
+            FrameUV = quadRect.xy + aTexCoord * quadRect.zw;
+            gl_Position = vec4(FrameUV.x * 2.0 - 1.0, 1.0 - FrameUV.y * 2.0, 0.0, 1.0);
+        }
+        )vertex";
+
+    // spriteRect is where a frame's trimmed texels sit in the frame, pageRect where they sit in their page, both as
+    // UV offset and size. Outside spriteRect the frame is transparent. Cross fades to the next frame like the snow shaders.
+    const char SpriteFragmentShaderSource[] = R"fragment(#version 300 es
+        precision mediump float;
+        out vec4 FragColor;
+
+        in vec2 FrameUV;
+        uniform vec4 spriteRect;
+        uniform vec4 pageRect;
+        uniform vec4 nextSpriteRect;
+        uniform vec4 nextPageRect;
+        uniform float blendFactor;
+        uniform sampler2D spritePage;
+        uniform sampler2D nextSpritePage;
+
+        vec4 sampleSprite(sampler2D vPage, vec4 vSpriteRect, vec4 vPageRect)
+        {
+            vec2 Local = (FrameUV - vSpriteRect.xy) / vSpriteRect.zw;
+            if (any(lessThan(Local, vec2(0.0))) || any(greaterThan(Local, vec2(1.0))))
+                return vec4(0.0);
+            return texture(vPage, vPageRect.xy + Local * vPageRect.zw);
+        }
+
+        void main()
+        {
+            vec4 SpriteColor = sampleSprite(spritePage, spriteRect, pageRect);
+            if (blendFactor > 0.0)
+                SpriteColor = mix(SpriteColor, sampleSprite(nextSpritePage, nextSpriteRect, nextPageRect), blendFactor);
+            if(SpriteColor.a < 0.1)
+                discard;
+            FragColor = SpriteColor;
+        }
+        )fragment";
+
+    // Sequence frames drawn as instanced tiles (see TileOccupancy.h): aCorner is the unit quad corner, aTile the tile's
+    // column and row. TexCoord is frame UV as the full screen quad gives it, so the snow fragment shaders are reused.
+    const char TileVertexShaderSource[] = R"vertex(#version 300 es
+        layout (location = 0) in vec2 aCorner;
+        layout (location = 2) in vec2 aTile;
+
+        out vec2 TexCoord;
+        uniform vec2 tileScale;
+
+        void main()
+        {
+            TexCoord = min((aTile + aCorner) * tileScale, vec2(1.0));
+            gl_Position = vec4(TexCoord.x * 2.0 - 1.0, 1.0 - TexCoord.y * 2.0, 0.0, 1.0);
+        }
+        )vertex";
+
+    // Debug view of the drawn tiles: a translucent fill with a brighter outline per tile
+    const char TileDebugFragmentShaderSource[] = R"fragment(#version 300 es
+        precision mediump float;
+        out vec4 FragColor;
+
+        in vec2 TexCoord;
+        uniform vec2 tileScale;
+
+        void main()
+        {
+            vec2 InTile = fract(TexCoord / tileScale);
+            bool IsEdge = any(lessThan(InTile, vec2(0.04))) || any(greaterThan(InTile, vec2(0.96)));
+            FragColor = IsEdge ? vec4(0.0, 1.0, 0.3, 0.8) : vec4(0.0, 1.0, 0.3, 0.15);
+        }
+        )fragment";
+
     const char QuadVertexShaderSource[] = R"vertex(#version 300 es
         layout (location = 0) in vec2 aPos;
         layout (location = 1) in vec2 aTexCoord;
@@ -49,6 +177,21 @@ namespace hiveVG
         }
         )vertex";
 
+    // Draws a layer into a static group's texture upside down, so the texture's rows run top down like those of an
+    // uploaded image and QuadVertexShaderSource's TexCoord samples it the right way up
+    const char StaticGroupVertexShaderSource[] = R"vertex(#version 300 es
+        layout (location = 0) in vec2 aPos;
+        layout (location = 1) in vec2 aTexCoord;
+
+        out vec2 TexCoord;
+
+        void main()
+        {
+            gl_Position = vec4(aPos.x, -aPos.y, 0.0, 1.0);
+            TexCoord = aTexCoord;
+        }
+        )vertex";
+
     const char QuadFragmentShaderSource[] = R"fragment(#version 300 es
         precision mediump float;
         out vec4 FragColor;
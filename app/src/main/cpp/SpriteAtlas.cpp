@@ -0,0 +1,116 @@
+#include "SpriteAtlas.h"
+#include <cstring>
+
+namespace hiveVG
+{
+    namespace
+    {
+        template<typename T>
+        T readLE(const uint8_t *vData)
+        {
+            T Value = 0;
+            for (size_t i = 0; i < sizeof(T); ++i) Value |= static_cast<T>(vData[i]) << (8 * i);
+            return Value;
+        }
+
+        template<typename T>
+        void appendLE(std::vector<uint8_t> &vioBytes, T vValue)
+        {
+            for (size_t i = 0; i < sizeof(T); ++i) vioBytes.push_back(static_cast<uint8_t>(static_cast<uint64_t>(vValue) >> (8 * i)));
+        }
+    }
+
+    bool parseSpriteAtlas(const uint8_t *vData, size_t vSize, SSpriteAtlas &voAtlas, std::string &voError)
+    {
+        using namespace SPRITE_ATLAS_FORMAT;
+        if (vData == nullptr || vSize < HeaderSize || std::memcmp(vData, Magic, sizeof(Magic)) != 0)
+        {
+            voError = "not a sprite rect table";
+            return false;
+        }
+        const uint32_t FileVersion = readLE<uint32_t>(vData + 8);
+        const uint32_t FrameWidth  = readLE<uint32_t>(vData + 12);
+        const uint32_t FrameHeight = readLE<uint32_t>(vData + 16);
+        const uint32_t FrameCount  = readLE<uint32_t>(vData + 20);
+        const uint32_t PageCount   = readLE<uint32_t>(vData + 24);
+        if (FileVersion != Version)
+        {
+            voError = "unsupported version " + std::to_string(FileVersion);
+            return false;
+        }
+        if (FrameWidth == 0 || FrameHeight == 0 || FrameWidth > 65535 || FrameHeight > 65535 || FrameCount == 0 || PageCount > 4096)
+        {
+            voError = "invalid frame size, frame count or page count";
+            return false;
+        }
+        if (vSize != HeaderSize + PageCount * PageRecordSize + static_cast<size_t>(FrameCount) * FrameRecordSize)
+        {
+            voError = "size does not match " + std::to_string(PageCount) + " pages and " + std::to_string(FrameCount) + " frames";
+            return false;
+        }
+
+        voAtlas.FrameWidth  = static_cast<int>(FrameWidth);
+        voAtlas.FrameHeight = static_cast<int>(FrameHeight);
+        voAtlas.Pages.resize(PageCount);
+        const uint8_t *pRecord = vData + HeaderSize;
+        for (SSpritePageSize &Page : voAtlas.Pages)
+        {
+            Page.Width  = static_cast<int>(readLE<uint32_t>(pRecord));
+            Page.Height = static_cast<int>(readLE<uint32_t>(pRecord + 4));
+            pRecord += PageRecordSize;
+            if (Page.Width <= 0 || Page.Height <= 0 || Page.Width > 16384 || Page.Height > 16384)
+            {
+                voError = "invalid page size";
+                return false;
+            }
+        }
+        voAtlas.Frames.resize(FrameCount);
+        for (uint32_t i = 0; i < FrameCount; ++i, pRecord += FrameRecordSize)
+        {
+            SSpriteRect &Rect = voAtlas.Frames[i];
+            Rect.Page    = readLE<uint16_t>(pRecord);
+            Rect.X       = readLE<uint16_t>(pRecord + 2);
+            Rect.Y       = readLE<uint16_t>(pRecord + 4);
+            Rect.Width   = readLE<uint16_t>(pRecord + 6);
+            Rect.Height  = readLE<uint16_t>(pRecord + 8);
+            Rect.OffsetX = readLE<uint16_t>(pRecord + 10);
+            Rect.OffsetY = readLE<uint16_t>(pRecord + 12);
+            if (Rect.isEmpty()) continue;
+            const bool IsInPage = Rect.Page < static_cast<int>(PageCount) && Rect.X + Rect.Width <= voAtlas.Pages[Rect.Page].Width &&
+                                  Rect.Y + Rect.Height <= voAtlas.Pages[Rect.Page].Height;
+            if (!IsInPage || Rect.OffsetX + Rect.Width > voAtlas.FrameWidth || Rect.OffsetY + Rect.Height > voAtlas.FrameHeight)
+            {
+                voError = "rect of frame " + std::to_string(i) + " is outside its page or frame";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> serializeSpriteAtlas(const SSpriteAtlas &vAtlas)
+    {
+        using namespace SPRITE_ATLAS_FORMAT;
+        std::vector<uint8_t> Bytes(Magic, Magic + sizeof(Magic));
+        Bytes.reserve(HeaderSize + vAtlas.Pages.size() * PageRecordSize + vAtlas.Frames.size() * FrameRecordSize);
+        for (uint32_t Value : {Version, static_cast<uint32_t>(vAtlas.FrameWidth), static_cast<uint32_t>(vAtlas.FrameHeight),
+                               static_cast<uint32_t>(vAtlas.Frames.size()), static_cast<uint32_t>(vAtlas.Pages.size())})
+            appendLE(Bytes, Value);
+        for (const SSpritePageSize &Page : vAtlas.Pages)
+        {
+            appendLE(Bytes, static_cast<uint32_t>(Page.Width));
+            appendLE(Bytes, static_cast<uint32_t>(Page.Height));
+        }
+        for (const SSpriteRect &Rect : vAtlas.Frames)
+            for (int Value : {Rect.Page, Rect.X, Rect.Y, Rect.Width, Rect.Height, Rect.OffsetX, Rect.OffsetY, 0})
+                appendLE(Bytes, static_cast<uint16_t>(Value));
+        return Bytes;
+    }
+
+    std::string getSpritePagePath(const std::string &vTablePath, int vPage)
+    {
+        const size_t Extension = vTablePath.rfind('.');
+        const size_t Directory = vTablePath.rfind('/');
+        const bool HasExtension = Extension != std::string::npos && (Directory == std::string::npos || Extension > Directory);
+        return (HasExtension ? vTablePath.substr(0, Extension) : vTablePath) + "_" + std::to_string(vPage) + ".png";
+    }
+}
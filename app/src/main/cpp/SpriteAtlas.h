@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hiveVG
+{
+    /*!
+     * .hspr rect table of a trimmed sprite atlas, all fields little endian:
+     *   header  Magic "HIVESPR\n", then u32 FormatVersion, FrameWidth, FrameHeight, FrameCount, PageCount
+     *   pages   PageCount records of u32 Width, Height
+     *   frames  FrameCount records of u16 Page, X, Y, Width, Height, OffsetX, OffsetY, Reserved
+     * A frame's opaque part is the Width x Height rect at (X, Y) of its page, and sits at (OffsetX, OffsetY) of the
+     * FrameWidth x FrameHeight frame; everything else of the frame is transparent. Fully transparent frames have an
+     * empty rect. Page p is the straight alpha RGBA image next to the table, see getSpritePagePath().
+     * Written by tools/SpritePacker.
+     */
+    namespace SPRITE_ATLAS_FORMAT
+    {
+        constexpr char     Magic[8]        = {'H', 'I', 'V', 'E', 'S', 'P', 'R', '\n'};
+        constexpr uint32_t Version         = 1;
+        constexpr size_t   HeaderSize      = 8 + 5 * 4;
+        constexpr size_t   PageRecordSize  = 2 * 4;
+        constexpr size_t   FrameRecordSize = 8 * 2;
+    }
+
+    struct SSpriteRect
+    {
+        int Page    = 0;
+        int X       = 0;   // in the page
+        int Y       = 0;
+        int Width   = 0;
+        int Height  = 0;
+        int OffsetX = 0;   // in the frame
+        int OffsetY = 0;
+
+        [[nodiscard]] bool isEmpty() const { return Width == 0 || Height == 0; }
+    };
+
+    struct SSpritePageSize
+    {
+        int Width  = 0;
+        int Height = 0;
+    };
+
+    struct SSpriteAtlas
+    {
+        int                          FrameWidth  = 0;
+        int                          FrameHeight = 0;
+        std::vector<SSpritePageSize> Pages;
+        std::vector<SSpriteRect>     Frames;
+
+        [[nodiscard]] int getFrameCount() const { return static_cast<int>(Frames.size()); }
+    };
+
+    /*!
+     * Validates the header and every rect against its page and frame.
+     * @return false with a reason in voError if the file is malformed
+     */
+    bool parseSpriteAtlas(const uint8_t *vData, size_t vSize, SSpriteAtlas &voAtlas, std::string &voError);
+    std::vector<uint8_t> serializeSpriteAtlas(const SSpriteAtlas &vAtlas);
+    // Image of page vPage, "a/b.hspr" -> "a/b_0.png" for page 0
+    std::string getSpritePagePath(const std::string &vTablePath, int vPage);
+}
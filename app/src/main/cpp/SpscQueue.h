@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace hiveVG
+{
+    /*!
+     * Bounded lock free queue for exactly one producer thread and one consumer thread.
+     * The capacity is rounded up to a power of two. Head and tail only ever grow, each is written by one side and
+     * read with acquire by the other, and they sit on their own cache lines so the two threads do not false share.
+     */
+    template<typename T>
+    class CSpscQueue
+    {
+    public:
+        explicit CSpscQueue(size_t vCapacity)
+        {
+            size_t Capacity = 1;
+            while (Capacity < vCapacity) Capacity *= 2;
+            m_Slots.resize(Capacity);
+            m_Mask = Capacity - 1;
+        }
+
+        CSpscQueue(const CSpscQueue &) = delete;
+        CSpscQueue &operator=(const CSpscQueue &) = delete;
+
+        // Producer only, false (and vValue untouched) when full
+        bool tryPush(T &&vValue)
+        {
+            const size_t Tail = m_Tail.load(std::memory_order_relaxed);
+            if (Tail - m_Head.load(std::memory_order_acquire) == m_Slots.size()) return false;
+            m_Slots[Tail & m_Mask] = std::move(vValue);
+            m_Tail.store(Tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only, false when empty
+        bool tryPop(T &voValue)
+        {
+            const size_t Head = m_Head.load(std::memory_order_relaxed);
+            if (Head == m_Tail.load(std::memory_order_acquire)) return false;
+            voValue = std::move(m_Slots[Head & m_Mask]);
+            m_Head.store(Head + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] size_t getCapacity() const { return m_Slots.size(); }
+        // Exact only on the consumer or producer thread while the other side is idle
+        [[nodiscard]] size_t getSizeApprox() const { return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire); }
+
+    private:
+        std::vector<T>                  m_Slots;
+        size_t                          m_Mask = 0;
+        alignas(64) std::atomic<size_t> m_Head{0};   // next slot to pop, written by the consumer
+        alignas(64) std::atomic<size_t> m_Tail{0};   // next slot to push, written by the producer
+    };
+}
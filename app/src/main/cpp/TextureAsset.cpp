@@ -1,24 +1,52 @@
 #include "TextureAsset.h"
+#include "AssetSource.h"
 #include "Common.h"
+#include "DiskTextureCache.h"
+#include "ImageData.h"
+#include "Ktx2Container.h"
+#include "MipChain.h"
+#include "PixelConvert.h"
+#include "PixelUnpackRing.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
 #include <cassert>
 #include <iostream>
 #include <android/imagedecoder.h>
 
 std::shared_ptr<CTextureAsset>
-CTextureAsset::loadAsset(AAssetManager *vAssetManager, const std::string &vAssetPath) {
-    // Get the image from asset manager
-    auto pPicAsset = AAssetManager_open(
-            vAssetManager,
-            vAssetPath.c_str(),
-            AASSET_MODE_BUFFER);
+CTextureAsset::loadAsset(hiveVG::IAssetSource *vAssetSource, const std::string &vAssetPath, const STextureLoadOptions &vOptions, hiveVG::CPixelUnpackRing *vUploadRing) {
+    if (hiveVG::isKtx2Path(vAssetPath)) {
+        auto pCompressed = __loadKtx2Asset(vAssetSource, vAssetPath, vOptions);
+        if (pCompressed != nullptr) return pCompressed;
+        auto FallbackPath = hiveVG::getKtx2FallbackPath(vAssetPath);
+        LOG_WARN(hiveVG::TAG_KEYWORD::TEXTURE_ASSET_TAG, "Falling back from %s to %s", vAssetPath.c_str(), FallbackPath.c_str());
+        return loadAsset(vAssetSource, FallbackPath, vOptions, vUploadRing);
+    }
+
+    // Get the image bytes, mapped from the APK when the entry is stored uncompressed
+    auto pPicBuffer = vAssetSource->open(vAssetPath);
+    if (pPicBuffer == nullptr) return nullptr;
+
+    const auto format = hiveVG::detectImageFormat(pPicBuffer->getData(), pPicBuffer->getSize());
+    if (hiveVG::resolveImageDecoder(format, vOptions.Decoder) != hiveVG::EImageDecoderBackend::AndroidImageDecoder) {
+        // Other backends cannot write into the PBO, decode on the heap and upload from there
+        hiveVG::SImageData Image;
+        if (!hiveVG::decodeImageFromMemory(pPicBuffer->getData(), pPicBuffer->getSize(), Image, vOptions.Decoder)) return nullptr;
+        hiveVG::premultiplyAlpha(Image, vOptions.AlphaConversion);
+        return createFromImage(Image, vOptions, vUploadRing);
+    }
 
     // Make a decoder to turn it into a texture
     AImageDecoder *pAndroidDecoder = nullptr;
-    auto result = AImageDecoder_createFromAAsset(pPicAsset, &pAndroidDecoder);
+    auto result = AImageDecoder_createFromBuffer(pPicBuffer->getData(), pPicBuffer->getSize(), &pAndroidDecoder);
     assert(result == ANDROID_IMAGE_DECODER_SUCCESS);
 
     // make sure we get 8 bits per channel out. RGBA order.
     AImageDecoder_setAndroidBitmapFormat(pAndroidDecoder, ANDROID_BITMAP_FORMAT_RGBA_8888);
+    // the decoder premultiplies for free, but not in linear space
+    const bool isDecoderPremultiplied = vOptions.AlphaConversion == hiveVG::EAlphaConversion::Premultiply;
+    AImageDecoder_setUnpremultipliedRequired(pAndroidDecoder, !isDecoderPremultiplied);
 
     // Get the image header, to help set everything up
     const AImageDecoderHeaderInfo *pAndroidHeader = nullptr;
@@ -28,53 +56,290 @@ CTextureAsset::loadAsset(AAssetManager *vAssetManager, const std::string &vAsset
     auto width = AImageDecoderHeaderInfo_getWidth(pAndroidHeader);
     auto height = AImageDecoderHeaderInfo_getHeight(pAndroidHeader);
     auto stride = AImageDecoder_getMinimumStride(pAndroidDecoder);
-    // Get the bitmap data of the image
-    auto upAndroidImageData = std::make_unique<std::vector<uint8_t>>(height * stride);
+
+    if (vUploadRing != nullptr && vOptions.MipMode != EMipMode::Precomputed && vOptions.AlphaConversion != hiveVG::EAlphaConversion::PremultiplyLinear) {
+        // Decode straight into the mapped PBO, no heap copy and no driver staging copy
+        const GLsizei levelCount = __getLevelCount(width, height, vOptions);
+        GLuint TextureId = __allocateTexture(width, height, levelCount);
+        bool isStreamed = vUploadRing->streamWholeImage(TextureId, width, height,
+                [pAndroidDecoder, stride](uint8_t *vDst, size_t vRowPitch, int, int vRowCount) {
+                    assert(vRowPitch >= stride);
+                    return AImageDecoder_decodeImage(pAndroidDecoder, vDst, vRowPitch, vRowPitch * vRowCount) == ANDROID_IMAGE_DECODER_SUCCESS;
+                });
+        // cleanup helpers
+        AImageDecoder_delete(pAndroidDecoder);
+        pPicBuffer.reset();
+
+        if (!isStreamed || !__finishTexture(TextureId, vOptions)) {
+            glDeleteTextures(1, &TextureId);
+            return nullptr;
+        }
+        return std::shared_ptr<CTextureAsset>(new CTextureAsset(TextureId, width, height, __computeRgba8Bytes(width, height, levelCount)));
+    }
+
+    // Get the bitmap data of the image, precomputed mips need it on the CPU anyway
+    hiveVG::SImageData Image;
+    Image.Width = width;
+    Image.Height = height;
+    Image.Pixels.resize(height * stride);
+    assert(stride == Image.getRowPitch());
     auto decodeResult = AImageDecoder_decodeImage(
             pAndroidDecoder,
-            upAndroidImageData->data(),
+            Image.Pixels.data(),
             stride,
-            upAndroidImageData->size());
+            Image.Pixels.size());
     assert(decodeResult == ANDROID_IMAGE_DECODER_SUCCESS);
 
+    // cleanup helpers
+    AImageDecoder_delete(pAndroidDecoder);
+    pPicBuffer.reset();
+
+    if (!isDecoderPremultiplied) hiveVG::premultiplyAlpha(Image, vOptions.AlphaConversion);
+    return createFromImage(Image, vOptions, vUploadRing);
+}
+
+std::shared_ptr<CTextureAsset>
+CTextureAsset::__loadKtx2Asset(hiveVG::IAssetSource *vAssetSource, const std::string &vAssetPath, const STextureLoadOptions &vOptions) {
+    auto pBuffer = vAssetSource->open(vAssetPath);
+    if (pBuffer == nullptr) return nullptr;
+
+    std::shared_ptr<CTextureAsset> pTexture;
+    const auto *pData = pBuffer->getData();
+    hiveVG::SKtx2Texture Ktx2;
+    std::string Error;
+    if (!hiveVG::parseKtx2(pData, pBuffer->getSize(), Ktx2, Error)) {
+        LOG_ERROR(hiveVG::TAG_KEYWORD::TEXTURE_ASSET_TAG, "Invalid KTX2 %s: %s", vAssetPath.c_str(), Error.c_str());
+    } else if (!isCompressedFormatSupported(Ktx2.pFormat->GLInternalFormat)) {
+        LOG_WARN(hiveVG::TAG_KEYWORD::TEXTURE_ASSET_TAG, "%s uses %s which this device cannot sample", vAssetPath.c_str(), Ktx2.pFormat->pName);
+    } else {
+        pTexture.reset(new CTextureAsset());
+        if (!pTexture->__uploadKtx2(pData, Ktx2, vOptions)) pTexture.reset();
+    }
+    return pTexture;
+}
+
+bool CTextureAsset::isCompressedFormatSupported(uint32_t vGLInternalFormat) {
+    const uint32_t AstcFirst = hiveVG::GL_COMPRESSED_FORMAT::RGBA_ASTC_4x4;
+    const uint32_t AstcLast = hiveVG::GL_COMPRESSED_FORMAT::SRGB8_ALPHA8_ASTC_4x4 + 13;
+    if (vGLInternalFormat < AstcFirst || vGLInternalFormat > AstcLast) {
+        return vGLInternalFormat >= hiveVG::GL_COMPRESSED_FORMAT::R11_EAC && vGLInternalFormat <= hiveVG::GL_COMPRESSED_FORMAT::SRGB8_ALPHA8_ETC2_EAC;
+    }
+
+    static std::once_flag s_queryOnce;
+    static bool s_hasAstcLdr = false;
+    std::call_once(s_queryOnce, []() {
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount; ++i) {
+            auto pExtension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+            if (pExtension != nullptr && std::strcmp(pExtension, "GL_KHR_texture_compression_astc_ldr") == 0) s_hasAstcLdr = true;
+        }
+        LOG_INFO(hiveVG::TAG_KEYWORD::TEXTURE_ASSET_TAG, "ASTC LDR textures are %s", s_hasAstcLdr ? "supported" : "not supported");
+    });
+    return s_hasAstcLdr;
+}
+
+bool CTextureAsset::__uploadKtx2(const uint8_t *vData, const hiveVG::SKtx2Texture &vKtx2, const STextureLoadOptions &vOptions) {
+    assert(m_state == ETextureState::Pending);
+    // Screen aligned textures only ever sample level 0, the rest of the chain is not worth the VRAM
+    const auto levelCount = vOptions.IsScreenAligned ? 1 : static_cast<GLsizei>(vKtx2.Levels.size());
+    clearStaleGLErrors();
+    glGenTextures(1, &m_textureID);
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    glTexStorage2D(GL_TEXTURE_2D, levelCount, vKtx2.pFormat->GLInternalFormat, vKtx2.Width, vKtx2.Height);
+    __setSamplingParameters(levelCount);
+
+    for (GLint level = 0; level < levelCount; ++level) {
+        const auto &Level = vKtx2.Levels[level];
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, Level.Width, Level.Height, vKtx2.pFormat->GLInternalFormat,
+                                  static_cast<GLsizei>(Level.ByteLength), vData + Level.ByteOffset);
+    }
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        LOG_ERROR(hiveVG::TAG_KEYWORD::TEXTURE_ASSET_TAG, "Compressed upload failed with GL error 0x%x", error);
+        glDeleteTextures(1, &m_textureID);
+        m_textureID = 0;
+        m_state = ETextureState::Failed;
+        return false;
+    }
+    m_estimatedBytes = 0;
+    for (GLint level = 0; level < levelCount; ++level) m_estimatedBytes += vKtx2.Levels[level].ByteLength;
+    m_width = static_cast<GLsizei>(vKtx2.Width);
+    m_height = m_residentRows = static_cast<GLsizei>(vKtx2.Height);
+    m_state = ETextureState::Ready;
+    return true;
+}
+
+std::shared_ptr<CTextureAsset> CTextureAsset::createFromImage(const hiveVG::SImageData &vImage, const STextureLoadOptions &vOptions, hiveVG::CPixelUnpackRing *vUploadRing) {
+    std::vector<hiveVG::SImageData> MipLevels;
+    if (vOptions.MipMode == EMipMode::Precomputed && !vOptions.IsScreenAligned)
+        MipLevels = hiveVG::generateSubLevels(vImage, getMipAlphaMode(vOptions));
+
+    std::shared_ptr<CTextureAsset> pTexture(new CTextureAsset());
+    if (!pTexture->__uploadImage(vImage, MipLevels, vOptions, vUploadRing)) return nullptr;
+    return pTexture;
+}
+
+bool CTextureAsset::__uploadImage(const hiveVG::SImageData &vImage, const std::vector<hiveVG::SImageData> &vMipLevels,
+                                  const STextureLoadOptions &vOptions, hiveVG::CPixelUnpackRing *vUploadRing) {
+    if (!vImage.isValid()) {
+        m_state = ETextureState::Failed;
+        return false;
+    }
+    std::vector<const uint8_t *> levels = {vImage.Pixels.data()};
+    for (const auto &Mip : vMipLevels) levels.push_back(Mip.Pixels.data());
+    return __uploadLevels(levels, vImage.Width, vImage.Height, vOptions, vUploadRing);
+}
+
+bool CTextureAsset::__uploadCached(const hiveVG::SCachedTexture &vCached, const STextureLoadOptions &vOptions, hiveVG::CPixelUnpackRing *vUploadRing) {
+    std::vector<const uint8_t *> levels;
+    for (size_t level = 0; level < vCached.Levels.size(); ++level) levels.push_back(vCached.getLevelData(level));
+    return __uploadLevels(levels, vCached.getWidth(), vCached.getHeight(), vOptions, vUploadRing);
+}
+
+bool CTextureAsset::__uploadLevels(const std::vector<const uint8_t *> &vLevels, GLsizei vWidth, GLsizei vHeight, const STextureLoadOptions &vOptions,
+                                   hiveVG::CPixelUnpackRing *vUploadRing) {
+    assert(m_state == ETextureState::Pending);
+    m_state = ETextureState::Failed;
+    if (vLevels.empty() || vWidth <= 0 || vHeight <= 0) return false;
+
+    // Precomputed chains may be shorter than the full chain, storage is sized to what is actually uploaded
+    GLsizei levelCount = __getLevelCount(vWidth, vHeight, vOptions);
+    if (vOptions.MipMode == EMipMode::Precomputed) levelCount = std::min<GLsizei>(levelCount, static_cast<GLsizei>(vLevels.size()));
+    m_textureID = __allocateTexture(vWidth, vHeight, levelCount);
+
+    bool isUploaded = true;
+    const uint8_t *pBase = vLevels[0];
+    const size_t basePitch = static_cast<size_t>(vWidth) * 4;
+    if (vUploadRing == nullptr) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, vWidth, vHeight, GL_RGBA, GL_UNSIGNED_BYTE, pBase);
+    } else {
+        isUploaded = vUploadRing->streamTexture(m_textureID, vWidth, vHeight,
+                [pBase, basePitch](uint8_t *vDst, size_t vRowPitch, int vFirstRow, int vRowCount) {
+                    std::memcpy(vDst, pBase + basePitch * vFirstRow, vRowPitch * vRowCount);
+                    return true;
+                });
+        glBindTexture(GL_TEXTURE_2D, m_textureID);
+    }
+    if (vOptions.MipMode == EMipMode::Precomputed) {
+        for (GLsizei level = 1; level < levelCount; ++level) {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, std::max(vWidth >> level, 1), std::max(vHeight >> level, 1), GL_RGBA, GL_UNSIGNED_BYTE, vLevels[level]);
+        }
+    }
+
+    if (!isUploaded || !__finishTexture(m_textureID, vOptions)) {
+        glDeleteTextures(1, &m_textureID);
+        m_textureID = 0;
+        return false;
+    }
+    m_estimatedBytes = __computeRgba8Bytes(vWidth, vHeight, levelCount);
+    m_width = vWidth;
+    m_height = m_residentRows = vHeight;
+    m_state = ETextureState::Ready;
+    return true;
+}
+
+bool CTextureAsset::__uploadMapped(hiveVG::SMappedPixelImage &vioImage, const STextureLoadOptions &vOptions, hiveVG::CPixelUnpackRing &vioUploadRing) {
+    assert(m_state == ETextureState::Pending);
+    m_state = ETextureState::Failed;
+    const GLsizei width = vioImage.Width, height = vioImage.Height;
+    const GLsizei levelCount = __getLevelCount(width, height, vOptions);
+    m_textureID = __allocateTexture(width, height, levelCount);
+    if (!vioUploadRing.uploadImage(m_textureID, vioImage) || !__finishTexture(m_textureID, vOptions)) {
+        glDeleteTextures(1, &m_textureID);
+        m_textureID = 0;
+        return false;
+    }
+    m_estimatedBytes = __computeRgba8Bytes(width, height, levelCount);
+    m_width = width;
+    m_height = m_residentRows = height;
+    m_state = ETextureState::Ready;
+    return true;
+}
+
+bool CTextureAsset::__allocateRows(GLsizei vWidth, GLsizei vHeight, GLsizei vLevelCount) {
+    assert(m_state == ETextureState::Pending && m_textureID == 0);
+    clearStaleGLErrors();
+    m_textureID = __allocateTexture(vWidth, vHeight, vLevelCount);
+    m_estimatedBytes = __computeRgba8Bytes(vWidth, vHeight, vLevelCount);
+    m_width = vWidth;
+    m_height = vHeight;
+    m_residentRows = 0;
+    return glGetError() == GL_NO_ERROR;
+}
+
+bool CTextureAsset::__uploadRows(const hiveVG::SImageData &vRows, GLint vFirstRow, const std::vector<hiveVG::SImageData> &vMipLevels) {
+    assert(m_textureID != 0 && vRows.Width == m_width && vFirstRow == m_residentRows);
+    clearStaleGLErrors();
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, vFirstRow, vRows.Width, vRows.Height, GL_RGBA, GL_UNSIGNED_BYTE, vRows.Pixels.data());
+    // The rows start and end on a multiple of 2^level, so their mips are exactly that slice of the full chain
+    for (size_t level = 1; level <= vMipLevels.size(); ++level) {
+        const auto &Mip = vMipLevels[level - 1];
+        glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, vFirstRow >> level, Mip.Width, Mip.Height, GL_RGBA, GL_UNSIGNED_BYTE, Mip.Pixels.data());
+    }
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        LOG_ERROR(hiveVG::TAG_KEYWORD::TEXTURE_ASSET_TAG, "Row upload failed with GL error 0x%x", error);
+        glDeleteTextures(1, &m_textureID);
+        m_textureID = 0;
+        m_state = ETextureState::Failed;
+        return false;
+    }
+    m_residentRows = vFirstRow + vRows.Height;
+    m_state = ETextureState::Ready;
+    return true;
+}
+
+size_t CTextureAsset::__computeRgba8Bytes(GLsizei vWidth, GLsizei vHeight, GLsizei vLevelCount) {
+    size_t bytes = 0;
+    for (GLsizei level = 0; level < vLevelCount; ++level)
+        bytes += static_cast<size_t>(std::max(vWidth >> level, 1)) * std::max(vHeight >> level, 1) * 4;
+    return bytes;
+}
+
+GLsizei CTextureAsset::__getLevelCount(GLsizei vWidth, GLsizei vHeight, const STextureLoadOptions &vOptions) {
+    if (vOptions.IsScreenAligned || vOptions.MipMode == EMipMode::None) return 1;
+    return hiveVG::computeFullMipLevelCount(vWidth, vHeight);
+}
+
+GLuint CTextureAsset::__allocateTexture(GLsizei vWidth, GLsizei vHeight, GLsizei vLevelCount) {
     // Get an opengl texture
     GLuint TextureId;
     glGenTextures(1, &TextureId);
     glBindTexture(GL_TEXTURE_2D, TextureId);
 
+    // Immutable storage with an explicit level count, the texels are uploaded level by level afterwards
+    glTexStorage2D(GL_TEXTURE_2D, vLevelCount, GL_RGBA8, vWidth, vHeight);
+    __setSamplingParameters(vLevelCount);
+    return TextureId;
+}
+
+void CTextureAsset::__setSamplingParameters(GLsizei vLevelCount) {
     // Clamp to the edge, you'll get odd results alpha blending if you don't
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, vLevelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+bool CTextureAsset::__finishTexture(GLuint vTextureId, const STextureLoadOptions &vOptions) {
+    glBindTexture(GL_TEXTURE_2D, vTextureId);
+    if (vOptions.MipMode == EMipMode::RuntimeGenerate && !vOptions.IsScreenAligned) {
+        // generate mip levels on the GPU, only kept for assets that have no precomputed chain
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
 
-    // Load the texture into VRAM
-    glTexImage2D(
-            GL_TEXTURE_2D, // target
-            0, // mip level
-            GL_RGBA, // internal format, often advisable to use BGR
-            width, // width of the texture
-            height, // height of the texture
-            0, // border (always 0)
-            GL_RGBA, // format
-            GL_UNSIGNED_BYTE, // type
-            upAndroidImageData->data() // Data to upload
-    );
-    // generate mip levels. Not really needed for 2D, but good to do
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    bool isValid = (glIsTexture(TextureId) == GL_TRUE);
+    bool isValid = (glIsTexture(vTextureId) == GL_TRUE);
     if (!isValid)
     {
-        LOG_ERROR(hiveVG::TAG_KEYWORD::SeqFrame_RENDERER_TAG, "Texture type error");
-        return nullptr;
+        LOG_ERROR(hiveVG::TAG_KEYWORD::TEXTURE_ASSET_TAG, "Texture type error");
+        return false;
     }
-    // cleanup helpers
-    AImageDecoder_delete(pAndroidDecoder);
-    AAsset_close(pPicAsset);
-
-    return std::shared_ptr<CTextureAsset>(new CTextureAsset(TextureId));
+    return true;
 }
 
 CTextureAsset::~CTextureAsset() {
@@ -83,4 +348,6 @@ CTextureAsset::~CTextureAsset() {
     m_textureID = 0;
 }
 
-CTextureAsset::CTextureAsset(GLuint TextureId) : m_textureID(TextureId) {}
+CTextureAsset::CTextureAsset(GLuint TextureId, GLsizei vWidth, GLsizei vHeight, size_t vEstimatedBytes)
+        : m_textureID(TextureId), m_state(ETextureState::Ready), m_estimatedBytes(vEstimatedBytes),
+          m_width(vWidth), m_height(vHeight), m_residentRows(vHeight) {}
@@ -2,23 +2,139 @@
 #include <memory>
 #include <string>
 #include <vector>
-#include <android/asset_manager.h>
 #include <GLES3/gl3.h>
+#include "ImageDecoder.h"
+#include "MipChain.h"
+#include "PixelConvert.h"
+
+namespace hiveVG
+{
+    struct SCachedTexture;
+    struct SImageData;
+    struct SKtx2Texture;
+    struct SMappedPixelImage;
+    class CAsyncTextureLoader;
+    class CPixelUnpackRing;
+    class IAssetSource;
+}
+
+enum class ETextureState {
+    Pending,
+    Ready,
+    Failed
+};
+
+enum class EMipMode {
+    RuntimeGenerate,   // glGenerateMipmap after the upload
+    Precomputed,       // levels built on the CPU (or taken from the KTX2 chain) and uploaded as they are
+    None
+};
+
+struct STextureLoadOptions {
+    // Drawn 1:1 to the screen, gets a single level: no mip memory and no mip work at load time
+    bool IsScreenAligned = false;
+    EMipMode MipMode = EMipMode::RuntimeGenerate;
+    // PNG/JPG only, KTX2 blocks are never decoded
+    hiveVG::EImageDecoderBackend Decoder = hiveVG::EImageDecoderBackend::Auto;
+    // Applied right after decode, precomputed mips are then built from the converted pixels
+    hiveVG::EAlphaConversion AlphaConversion = hiveVG::EAlphaConversion::None;
+    // > 0: an atlas of that many frame rows, decoded and uploaded a few rows at a time by the async loader.
+    // The texture turns ready with the first row, getResidentRows() tells how much of it holds pixels.
+    int ProgressiveRows = 0;
+    // Covers the whole surface (one frame of it for atlases), so the async loader may decode it down to the size
+    // CAsyncTextureLoader::setDecodeTarget() asks for. AtlasColumns x max(ProgressiveRows, 1) frames are assumed.
+    bool IsFitToSurface = false;
+    int AtlasColumns = 1;
+
+    bool operator==(const STextureLoadOptions &vOther) const {
+        return IsScreenAligned == vOther.IsScreenAligned && MipMode == vOther.MipMode && Decoder == vOther.Decoder &&
+               AlphaConversion == vOther.AlphaConversion && ProgressiveRows == vOther.ProgressiveRows &&
+               IsFitToSurface == vOther.IsFitToSurface && AtlasColumns == vOther.AtlasColumns;
+    }
+};
+
+// Mips of premultiplied pixels are plain averages, straight ones need alpha weights
+inline hiveVG::EAlphaMode getMipAlphaMode(const STextureLoadOptions &vOptions) {
+    return vOptions.AlphaConversion == hiveVG::EAlphaConversion::None ? hiveVG::EAlphaMode::Straight : hiveVG::EAlphaMode::Premultiplied;
+}
+
+// GL errors stay set until they are read, so one left by unrelated calls would be taken for the next checked call's.
+// Bounded, a lost context may report GL_CONTEXT_LOST on every read.
+inline void clearStaleGLErrors() {
+    for (int i = 0; i < 16 && glGetError() != GL_NO_ERROR; ++i) {}
+}
 
 class CTextureAsset {
 public:
     /*!
      * Loads a texture asset from the assets/ directory
-     * @param vAssetManager Asset manager to use
+     * A .ktx2 path holding ETC2/EAC or ASTC blocks is uploaded compressed with its mip chain, when the device
+     * cannot sample that format the sibling .png is loaded instead.
+     * @param vAssetSource Where the path is resolved, mapped assets are decoded in place
      * @param vAssetPath The path to the asset
+     * @param vOptions Level count and mip source, storage is always immutable (glTexStorage2D)
+     * @param vUploadRing If set, the image is decoded straight into a mapped PBO and uploaded in row bands
      * @return a shared pointer to a texture asset, resources will be reclaimed when it's cleaned up
      */
-    static std::shared_ptr<CTextureAsset> loadAsset(AAssetManager *vAssetManager, const std::string &vAssetPath);
+    static std::shared_ptr<CTextureAsset> loadAsset(hiveVG::IAssetSource *vAssetSource, const std::string &vAssetPath, const STextureLoadOptions &vOptions = {},
+                                                    hiveVG::CPixelUnpackRing *vUploadRing = nullptr);
+    /*!
+     * Uploads pixels that were already decoded, e.g. by a worker thread. Must run on the GL thread.
+     * @param vImage RGBA8 pixels, already converted as vOptions.AlphaConversion asks
+     * @param vOptions Level count and mip source, precomputed mips are generated here on the calling thread
+     * @param vUploadRing If set, the pixels are streamed through the PBO ring in row bands
+     * @return a ready texture asset, or nullptr if the upload failed
+     */
+    static std::shared_ptr<CTextureAsset> createFromImage(const hiveVG::SImageData &vImage, const STextureLoadOptions &vOptions = {},
+                                                          hiveVG::CPixelUnpackRing *vUploadRing = nullptr);
+    /*!
+     * Whether the current context can sample a compressed internal format. ETC2/EAC is core in GLES 3.0,
+     * ASTC needs GL_KHR_texture_compression_astc_ldr. Must run on the GL thread.
+     */
+    static bool isCompressedFormatSupported(uint32_t vGLInternalFormat);
     ~CTextureAsset();
     [[nodiscard]] constexpr GLuint getTextureID() const { return m_textureID; }
+    [[nodiscard]] constexpr ETextureState getState() const { return m_state; }
+    [[nodiscard]] constexpr bool isReady() const { return m_state == ETextureState::Ready; }
+    // VRAM taken by all allocated levels, 0 while pending
+    [[nodiscard]] constexpr size_t getEstimatedBytes() const { return m_estimatedBytes; }
+    [[nodiscard]] constexpr GLsizei getWidth() const { return m_width; }
+    [[nodiscard]] constexpr GLsizei getHeight() const { return m_height; }
+    // Rows [0, getResidentRows()) hold pixels in every level, only less than getHeight() while a progressive load runs
+    [[nodiscard]] constexpr GLsizei getResidentRows() const { return m_residentRows; }
 
 private:
-    inline explicit CTextureAsset(GLuint vTextureId);
+    friend class hiveVG::CAsyncTextureLoader;
+
+    // Pending asset handed out by the async loader, it becomes ready once __uploadImage() runs.
+    CTextureAsset() = default;
+    inline CTextureAsset(GLuint vTextureId, GLsizei vWidth, GLsizei vHeight, size_t vEstimatedBytes);
+
+    // vMipLevels holds levels 1..n when vOptions.MipMode is Precomputed
+    bool __uploadImage(const hiveVG::SImageData &vImage, const std::vector<hiveVG::SImageData> &vMipLevels,
+                       const STextureLoadOptions &vOptions, hiveVG::CPixelUnpackRing *vUploadRing);
+    // RGBA8 levels straight from a disk cache entry, usually its mapping
+    bool __uploadCached(const hiveVG::SCachedTexture &vCached, const STextureLoadOptions &vOptions, hiveVG::CPixelUnpackRing *vUploadRing);
+    // vLevels[0] is the base level, levels 1..n are only read when vOptions.MipMode is Precomputed
+    bool __uploadLevels(const std::vector<const uint8_t *> &vLevels, GLsizei vWidth, GLsizei vHeight, const STextureLoadOptions &vOptions,
+                        hiveVG::CPixelUnpackRing *vUploadRing);
+    // Level 0 a worker decoded into a buffer vUploadRing mapped, further levels are generated if vOptions ask for them
+    bool __uploadMapped(hiveVG::SMappedPixelImage &vioImage, const STextureLoadOptions &vOptions, hiveVG::CPixelUnpackRing &vioUploadRing);
+    // Progressive loads: storage for the whole atlas first, then rows top to bottom. vMipLevels holds levels 1..n of the rows.
+    bool __allocateRows(GLsizei vWidth, GLsizei vHeight, GLsizei vLevelCount);
+    bool __uploadRows(const hiveVG::SImageData &vRows, GLint vFirstRow, const std::vector<hiveVG::SImageData> &vMipLevels);
+    bool __uploadKtx2(const uint8_t *vData, const hiveVG::SKtx2Texture &vKtx2, const STextureLoadOptions &vOptions);
+    static std::shared_ptr<CTextureAsset> __loadKtx2Asset(hiveVG::IAssetSource *vAssetSource, const std::string &vAssetPath, const STextureLoadOptions &vOptions);
+    static GLsizei __getLevelCount(GLsizei vWidth, GLsizei vHeight, const STextureLoadOptions &vOptions);
+    static GLuint __allocateTexture(GLsizei vWidth, GLsizei vHeight, GLsizei vLevelCount);
+    static void __setSamplingParameters(GLsizei vLevelCount);
+    static size_t __computeRgba8Bytes(GLsizei vWidth, GLsizei vHeight, GLsizei vLevelCount);
+    static bool __finishTexture(GLuint vTextureId, const STextureLoadOptions &vOptions);
 
-    GLuint m_textureID;
-};
\ No newline at end of file
+    GLuint m_textureID = 0;
+    ETextureState m_state = ETextureState::Pending;
+    size_t m_estimatedBytes = 0;
+    GLsizei m_width = 0;
+    GLsizei m_height = 0;
+    GLsizei m_residentRows = 0;
+};
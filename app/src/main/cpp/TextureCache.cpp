@@ -0,0 +1,38 @@
+#include "TextureCache.h"
+#include "AsyncTextureLoader.h"
+#include "Common.h"
+
+namespace hiveVG
+{
+#define HIVE_LOGTAG hiveVG::TAG_KEYWORD::TEXTURE_CACHE_TAG
+    size_t STextureKeyHash::operator()(const STextureKey &vKey) const
+    {
+        size_t Hash = std::hash<std::string>()(vKey.AssetPath);
+        const auto Combine = [&Hash](size_t vValue) { Hash ^= vValue + 0x9e3779b97f4a7c15ull + (Hash << 6) + (Hash >> 2); };
+        Combine(vKey.Options.IsScreenAligned);
+        Combine(static_cast<size_t>(vKey.Options.MipMode));
+        Combine(static_cast<size_t>(vKey.Options.Decoder));
+        Combine(static_cast<size_t>(vKey.Options.AlphaConversion));
+        Combine(static_cast<size_t>(vKey.Options.ProgressiveRows));
+        Combine(vKey.Options.IsFitToSurface);
+        Combine(static_cast<size_t>(vKey.Options.AtlasColumns));
+        return Hash;
+    }
+
+    CTextureCache::CTextureCache(CAsyncTextureLoader *vLoader, size_t vBudgetBytes) : m_pLoader(vLoader), m_Cache(vBudgetBytes)
+    {
+    }
+
+    std::shared_ptr<CTextureAsset> CTextureCache::acquire(const std::string &vAssetPath, const STextureLoadOptions &vOptions)
+    {
+        return m_Cache.acquire({vAssetPath, vOptions}, [this, &vAssetPath, &vOptions]() { return m_pLoader->loadAsync(vAssetPath, vOptions); });
+    }
+
+    void CTextureCache::logStats() const
+    {
+        const SResourceCacheStats Stats = m_Cache.getStats();
+        LOG_INFO(HIVE_LOGTAG, "%zu textures, %.1f MiB + %.1f MiB pinned of %.1f MiB, %llu hits, %llu misses, %llu evictions (%.1f MiB)", Stats.EntryCount,
+                 Stats.ResidentBytes / 1048576.0, Stats.PinnedBytes / 1048576.0, m_Cache.getBudgetBytes() / 1048576.0, static_cast<unsigned long long>(Stats.HitCount),
+                 static_cast<unsigned long long>(Stats.MissCount), static_cast<unsigned long long>(Stats.EvictionCount), Stats.EvictedBytes / 1048576.0);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "ResourceCache.h"
+#include "TextureAsset.h"
+
+namespace hiveVG
+{
+    class CAsyncTextureLoader;
+
+    struct STextureKey
+    {
+        std::string         AssetPath;
+        STextureLoadOptions Options;
+
+        bool operator==(const STextureKey &vOther) const { return AssetPath == vOther.AssetPath && Options == vOther.Options; }
+    };
+
+    struct STextureKeyHash
+    {
+        size_t operator()(const STextureKey &vKey) const;
+    };
+
+    // Textures shared by asset path and load options, loaded through the async loader on a miss.
+    class CTextureCache
+    {
+    public:
+        CTextureCache(CAsyncTextureLoader *vLoader, size_t vBudgetBytes);
+
+        std::shared_ptr<CTextureAsset> acquire(const std::string &vAssetPath, const STextureLoadOptions &vOptions);
+        void                           trim() { m_Cache.trim(); }
+        // GL memory outside the cache that shares its budget, e.g. sequence windows and render targets
+        void                           setPinnedBytes(const std::string &vName, size_t vBytes) { m_Cache.setPinnedBytes(vName, vBytes); }
+        void                           logStats() const;
+        [[nodiscard]] SResourceCacheStats getStats() const { return m_Cache.getStats(); }
+
+    private:
+        CAsyncTextureLoader*                                               m_pLoader = nullptr;
+        CResourceCache<STextureKey, CTextureAsset, STextureKeyHash>        m_Cache;
+    };
+}
@@ -0,0 +1,54 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace hiveVG
+{
+    CThreadPool::CThreadPool(size_t vThreadCount)
+    {
+        vThreadCount = std::max<size_t>(vThreadCount, 1);
+        m_Workers.reserve(vThreadCount);
+        for (size_t i = 0; i < vThreadCount; ++i)
+            m_Workers.emplace_back(&CThreadPool::__workerLoop, this);
+    }
+
+    CThreadPool::~CThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(m_TaskMutex);
+            m_IsStopping = true;
+            // Queued work is dropped, only tasks already running are waited for.
+            m_Tasks.clear();
+        }
+        m_TaskCondition.notify_all();
+        for (auto &Worker : m_Workers)
+        {
+            if (Worker.joinable()) Worker.join();
+        }
+    }
+
+    void CThreadPool::submit(std::function<void()> vTask)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(m_TaskMutex);
+            if (m_IsStopping) return;
+            m_Tasks.push_back(std::move(vTask));
+        }
+        m_TaskCondition.notify_one();
+    }
+
+    void CThreadPool::__workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> Task;
+            {
+                std::unique_lock<std::mutex> Lock(m_TaskMutex);
+                m_TaskCondition.wait(Lock, [this] { return m_IsStopping || !m_Tasks.empty(); });
+                if (m_IsStopping) return;
+                Task = std::move(m_Tasks.front());
+                m_Tasks.pop_front();
+            }
+            Task();
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hiveVG
+{
+    class CThreadPool
+    {
+    public:
+        explicit CThreadPool(size_t vThreadCount);
+        ~CThreadPool();
+
+        CThreadPool(const CThreadPool &) = delete;
+        CThreadPool &operator=(const CThreadPool &) = delete;
+
+        void   submit(std::function<void()> vTask);
+        [[nodiscard]] size_t getThreadCount() const { return m_Workers.size(); }
+
+    private:
+        void   __workerLoop();
+
+        std::vector<std::thread>          m_Workers;
+        std::deque<std::function<void()>> m_Tasks;
+        std::mutex                        m_TaskMutex;
+        std::condition_variable           m_TaskCondition;
+        bool                              m_IsStopping = false;
+    };
+}
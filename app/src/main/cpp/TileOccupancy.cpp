@@ -0,0 +1,154 @@
+#include "TileOccupancy.h"
+#include <algorithm>
+#include <cassert>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HIVE_PIXEL_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HIVE_PIXEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace hiveVG
+{
+    namespace
+    {
+        // Whether any of vPixelCount RGBA8 pixels has an alpha above vThreshold
+        using FAlphaScanKernel = bool (*)(const uint8_t *vPixels, size_t vPixelCount, uint8_t vThreshold);
+
+        bool hasAlphaAboveScalar(const uint8_t *vPixels, size_t vPixelCount, uint8_t vThreshold)
+        {
+            for (size_t i = 0; i < vPixelCount; ++i)
+                if (vPixels[i * 4 + 3] > vThreshold) return true;
+            return false;
+        }
+
+#ifdef HIVE_PIXEL_X86
+        // Alpha bytes minus the threshold, saturated: non zero exactly where an alpha is above it
+        bool hasAlphaAboveSSE2(const uint8_t *vPixels, size_t vPixelCount, uint8_t vThreshold)
+        {
+            const __m128i AlphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            __m128i Maximum = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 4 <= vPixelCount; i += 4)
+                Maximum = _mm_max_epu8(Maximum, _mm_loadu_si128(reinterpret_cast<const __m128i *>(vPixels + i * 4)));
+            const __m128i Above = _mm_subs_epu8(_mm_and_si128(Maximum, AlphaMask), _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(vThreshold) << 24)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(Above, _mm_setzero_si128())) != 0xFFFF) return true;
+            return hasAlphaAboveScalar(vPixels + i * 4, vPixelCount - i, vThreshold);
+        }
+
+        __attribute__((target("avx2"))) bool hasAlphaAboveAVX2(const uint8_t *vPixels, size_t vPixelCount, uint8_t vThreshold)
+        {
+            const __m256i AlphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+            __m256i Maximum = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 8 <= vPixelCount; i += 8)
+                Maximum = _mm256_max_epu8(Maximum, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(vPixels + i * 4)));
+            const __m256i Above = _mm256_subs_epu8(_mm256_and_si256(Maximum, AlphaMask), _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(vThreshold) << 24)));
+            if (!_mm256_testz_si256(Above, Above)) return true;
+            return hasAlphaAboveSSE2(vPixels + i * 4, vPixelCount - i, vThreshold);
+        }
+#endif
+
+#ifdef HIVE_PIXEL_NEON
+        bool hasAlphaAboveNEON(const uint8_t *vPixels, size_t vPixelCount, uint8_t vThreshold)
+        {
+            uint8x16_t Maximum = vdupq_n_u8(0);
+            size_t i = 0;
+            for (; i + 16 <= vPixelCount; i += 16)
+                Maximum = vmaxq_u8(Maximum, vld4q_u8(vPixels + i * 4).val[3]);
+            // Pairwise maxima fold the 16 lanes into lane 0, vmaxvq_u8 is AArch64 only
+            uint8x8_t Folded = vmax_u8(vget_low_u8(Maximum), vget_high_u8(Maximum));
+            Folded = vpmax_u8(Folded, Folded);
+            Folded = vpmax_u8(Folded, Folded);
+            Folded = vpmax_u8(Folded, Folded);
+            if (vget_lane_u8(Folded, 0) > vThreshold) return true;
+            return hasAlphaAboveScalar(vPixels + i * 4, vPixelCount - i, vThreshold);
+        }
+#endif
+
+        FAlphaScanKernel getKernelFunction(EPixelKernel vKernel)
+        {
+            switch (vKernel)
+            {
+#ifdef HIVE_PIXEL_X86
+                case EPixelKernel::SSE2: return hasAlphaAboveSSE2;
+                case EPixelKernel::AVX2: return hasAlphaAboveAVX2;
+#endif
+#ifdef HIVE_PIXEL_NEON
+                case EPixelKernel::NEON: return hasAlphaAboveNEON;
+#endif
+                default: return hasAlphaAboveScalar;
+            }
+        }
+    }
+
+    int STileOccupancy::getOccupiedCount() const
+    {
+        int Count = 0;
+        for (uint64_t Word : Bits) Count += __builtin_popcountll(Word);
+        return Count;
+    }
+
+    void buildTileOccupancy(const SImageData &vImage, int vTileSize, uint8_t vAlphaThreshold, int vMargin, EPixelKernel vKernel, STileOccupancy &voOccupancy)
+    {
+        assert(vTileSize > 0 && isPixelKernelAvailable(vKernel));
+        const FAlphaScanKernel Kernel = getKernelFunction(vKernel);
+        voOccupancy.Width    = vImage.Width;
+        voOccupancy.Height   = vImage.Height;
+        voOccupancy.TileSize = vTileSize;
+        voOccupancy.Columns  = (vImage.Width + vTileSize - 1) / vTileSize;
+        voOccupancy.Rows     = (vImage.Height + vTileSize - 1) / vTileSize;
+        voOccupancy.Bits.assign((static_cast<size_t>(voOccupancy.Columns) * voOccupancy.Rows + 63) / 64, 0);
+        for (int Row = 0; Row < voOccupancy.Rows; ++Row)
+        {
+            const int Top = std::max(Row * vTileSize - vMargin, 0), Bottom = std::min((Row + 1) * vTileSize + vMargin, vImage.Height);
+            for (int Column = 0; Column < voOccupancy.Columns; ++Column)
+            {
+                const int Left = std::max(Column * vTileSize - vMargin, 0), Right = std::min((Column + 1) * vTileSize + vMargin, vImage.Width);
+                for (int y = Top; y < Bottom; ++y)
+                {
+                    if (!Kernel(vImage.Pixels.data() + vImage.getRowPitch() * y + static_cast<size_t>(Left) * 4, Right - Left, vAlphaThreshold)) continue;
+                    const size_t Index = static_cast<size_t>(Row) * voOccupancy.Columns + Column;
+                    voOccupancy.Bits[Index / 64] |= uint64_t{1} << (Index % 64);
+                    break;
+                }
+            }
+        }
+    }
+
+    void buildTileOccupancy(const SImageData &vImage, STileOccupancy &voOccupancy)
+    {
+        buildTileOccupancy(vImage, TILE_OCCUPANCY::TileSize, TILE_OCCUPANCY::AlphaThreshold, TILE_OCCUPANCY::Margin, getBestPixelKernel(), voOccupancy);
+    }
+
+    void collectOccupiedTiles(std::initializer_list<const STileOccupancy *> vMasks, int vGrowth, std::vector<uint16_t> &voTiles)
+    {
+        const STileOccupancy *pLayout = nullptr;
+        for (const STileOccupancy *pMask : vMasks)
+            if (pMask != nullptr && !pMask->isEmpty()) pLayout = pMask;
+        if (pLayout == nullptr) return;
+
+        for (int Row = 0; Row < pLayout->Rows; ++Row)
+        {
+            const int FirstRow = std::max(Row - vGrowth, 0), LastRow = std::min(Row + vGrowth, pLayout->Rows - 1);
+            for (int Column = 0; Column < pLayout->Columns; ++Column)
+            {
+                const int FirstColumn = std::max(Column - vGrowth, 0), LastColumn = std::min(Column + vGrowth, pLayout->Columns - 1);
+                bool IsOccupied = false;
+                for (const STileOccupancy *pMask : vMasks)
+                {
+                    if (pMask == nullptr || pMask->isEmpty()) continue;
+                    assert(pMask->Columns == pLayout->Columns && pMask->Rows == pLayout->Rows);
+                    for (int y = FirstRow; y <= LastRow && !IsOccupied; ++y)
+                        for (int x = FirstColumn; x <= LastColumn && !IsOccupied; ++x) IsOccupied = pMask->isOccupied(x, y);
+                }
+                if (!IsOccupied) continue;
+                voTiles.push_back(static_cast<uint16_t>(Column));
+                voTiles.push_back(static_cast<uint16_t>(Row));
+            }
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+#include "ImageData.h"
+#include "PixelConvert.h"
+
+namespace hiveVG
+{
+    namespace TILE_OCCUPANCY
+    {
+        constexpr int     TileSize       = 32;   // texels of the decoded frame, which is fitted to the surface
+        constexpr uint8_t AlphaThreshold = 0;    // a tile with any larger alpha is drawn
+        constexpr int     Margin         = 2;    // texels scanned past each tile edge, bilinear and mip taps reach that far
+    }
+
+    // One bit per TileSize x TileSize tile of a frame, set if the tile has a texel that can show
+    struct STileOccupancy
+    {
+        int                   Width    = 0;    // of the frame, in texels
+        int                   Height   = 0;
+        int                   TileSize = 0;
+        int                   Columns  = 0;
+        int                   Rows     = 0;
+        std::vector<uint64_t> Bits;            // row major
+
+        [[nodiscard]] bool isOccupied(int vColumn, int vRow) const
+        {
+            const size_t Index = static_cast<size_t>(vRow) * Columns + vColumn;
+            return (Bits[Index / 64] >> (Index % 64)) & 1u;
+        }
+        [[nodiscard]] int  getOccupiedCount() const;
+        [[nodiscard]] bool isEmpty() const { return Bits.empty(); }
+    };
+
+    /*!
+     * Scans the alpha of RGBA8 vImage tile by tile, each tile from vMargin texels before to vMargin texels past its
+     * edges, stopping at the first texel above vAlphaThreshold. Every kernel gives the scalar result.
+     * @param vKernel must be available on this CPU
+     */
+    void buildTileOccupancy(const SImageData &vImage, int vTileSize, uint8_t vAlphaThreshold, int vMargin, EPixelKernel vKernel, STileOccupancy &voOccupancy);
+    // With the TILE_OCCUPANCY defaults and the best kernel, what sequence frames get at decode time
+    void buildTileOccupancy(const SImageData &vImage, STileOccupancy &voOccupancy);
+
+    /*!
+     * Appends the column, row pairs of the tiles occupied in any of vMasks, grown by vGrowth tiles in every direction.
+     * vMasks must share their layout, null entries are skipped.
+     */
+    void collectOccupiedTiles(std::initializer_list<const STileOccupancy *> vMasks, int vGrowth, std::vector<uint16_t> &voTiles);
+}
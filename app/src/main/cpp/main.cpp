@@ -58,7 +58,6 @@ extern "C"
         // Set filters for touch events in your application
         android_app_set_motion_event_filter(vApp, motion_event_filter_func);
 
-        int ROWS = 8, COLS = 16;
         do
         {
             // Process all pending events before running game logic.
@@ -95,7 +94,7 @@ extern "C"
             if (vApp->userData)
             {
                 auto *pSeqFrameRenderer = reinterpret_cast<hiveVG::CSequenceFrameRenderer*>(vApp->userData);
-                pSeqFrameRenderer->renderBlendingSnow(ROWS,COLS);
+                pSeqFrameRenderer->renderScene();
             }
         } while (!vApp->destroyRequested);
     }
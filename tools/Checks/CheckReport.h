@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdio>
+
+namespace hiveVG::tools
+{
+    // Counts the expectations of a host check and prints the failed ones. main() returns finish(), so ctest sees the result.
+    class CCheckReport
+    {
+    public:
+        explicit CCheckReport(const char *vName) : m_pName(vName) {}
+
+        bool expect(bool vCondition, const char *vWhat)
+        {
+            ++m_CheckCount;
+            if (!vCondition)
+            {
+                ++m_FailCount;
+                std::fprintf(stderr, "%s: FAILED %s\n", m_pName, vWhat);
+            }
+            return vCondition;
+        }
+
+        [[nodiscard]] bool isPassing() const { return m_FailCount == 0; }
+
+        int finish() const
+        {
+            if (m_FailCount == 0) std::printf("%s: %d checks passed\n", m_pName, m_CheckCount);
+            else std::printf("%s: %d of %d checks failed\n", m_pName, m_FailCount, m_CheckCount);
+            return m_FailCount == 0 ? 0 : 1;
+        }
+
+    private:
+        const char *m_pName      = nullptr;
+        int         m_CheckCount = 0;
+        int         m_FailCount  = 0;
+    };
+}
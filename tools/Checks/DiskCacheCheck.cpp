@@ -0,0 +1,121 @@
+// Host check of CDiskTextureCache in a temporary directory, on a generated premultiplied texture and its mip chain.
+// Usage: diskCacheCheck
+// Checks, raw and LZ4 compressed, that an empty cache misses, a stored entry loads back level for level, another key
+// misses, and that an entry of another format version, with a damaged key or truncated is rejected and deleted.
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "DiskTextureCache.h"
+#include "MipChain.h"
+#include "PixelConvert.h"
+#include "CheckReport.h"
+
+namespace
+{
+    // Noise alpha with a smooth color ramp, so LZ4 finds some but not every byte repeated
+    hiveVG::SImageData makeTexture(int vWidth, int vHeight)
+    {
+        std::mt19937 Random(7);
+        std::uniform_int_distribution<int> Alpha(0, 255);
+        hiveVG::SImageData Image;
+        Image.Width  = vWidth;
+        Image.Height = vHeight;
+        Image.Pixels.resize(Image.getByteSize());
+        for (int Y = 0; Y < vHeight; ++Y)
+        {
+            for (int X = 0; X < vWidth; ++X)
+            {
+                uint8_t *pPixel = &Image.Pixels[(static_cast<size_t>(Y) * vWidth + X) * 4];
+                pPixel[0] = static_cast<uint8_t>(X * 255 / vWidth);
+                pPixel[1] = static_cast<uint8_t>(Y * 255 / vHeight);
+                pPixel[2] = 200;
+                pPixel[3] = static_cast<uint8_t>(Alpha(Random));
+            }
+        }
+        hiveVG::premultiplyAlpha(Image, hiveVG::EAlphaConversion::Premultiply);
+        return Image;
+    }
+
+    bool isSameAsCached(const hiveVG::SImageData &vBase, const std::vector<hiveVG::SImageData> &vMipLevels, const hiveVG::SCachedTexture &vCached)
+    {
+        if (vCached.Levels.size() != vMipLevels.size() + 1) return false;
+        for (size_t Level = 0; Level < vCached.Levels.size(); ++Level)
+        {
+            const hiveVG::SImageData &Expected = Level == 0 ? vBase : vMipLevels[Level - 1];
+            if (vCached.getLevelSize(Level) != Expected.getByteSize() || std::memcmp(vCached.getLevelData(Level), Expected.Pixels.data(), Expected.getByteSize()) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // Overwrites vSize bytes at vOffset of an entry, or cuts it to vOffset bytes when vBytes is null
+    bool damageFile(const std::string &vPath, long vOffset, const void *vBytes, size_t vSize)
+    {
+        if (vBytes == nullptr) return truncate(vPath.c_str(), vOffset) == 0;
+        FILE *pFile = std::fopen(vPath.c_str(), "r+b");
+        if (pFile == nullptr) return false;
+        const bool IsWritten = std::fseek(pFile, vOffset, SEEK_SET) == 0 && std::fwrite(vBytes, 1, vSize, pFile) == vSize;
+        return std::fclose(pFile) == 0 && IsWritten;
+    }
+
+    bool isFilePresent(const std::string &vPath)
+    {
+        struct stat FileStat{};
+        return stat(vPath.c_str(), &FileStat) == 0;
+    }
+
+    void checkDiskCache(const std::string &vDirectory, hiveVG::EDiskTextureCompression vCompression, hiveVG::tools::CCheckReport &vioReport)
+    {
+        const std::string Name = vCompression == hiveVG::EDiskTextureCompression::LZ4 ? "lz4: " : "raw: ";
+        const auto expect = [&](bool vCondition, const char *vWhat) { vioReport.expect(vCondition, (Name + vWhat).c_str()); };
+
+        const hiveVG::SImageData Image = makeTexture(96, 80);
+        const std::vector<hiveVG::SImageData> MipLevels = hiveVG::generateSubLevels(Image, hiveVG::EAlphaMode::Premultiplied);
+        const std::string Key = "Textures/check.png|" + std::to_string(hiveVG::CDiskTextureCache::hashBytes(Image.Pixels.data(), Image.Pixels.size()));
+        hiveVG::CDiskTextureCache Cache(vDirectory, vCompression);
+        Cache.clear();
+
+        hiveVG::SCachedTexture Cached;
+        expect(!Cache.load(Key, Cached), "an empty cache reports a hit");
+        expect(Cache.store(Key, Image, MipLevels), "store failed");
+        hiveVG::SCachedTexture Warm;
+        expect(Cache.load(Key, Warm) && isSameAsCached(Image, MipLevels, Warm), "a load does not return the stored levels");
+        expect(!Cache.load(Key + "|other settings", Cached), "a different key hits");
+
+        // Damaged entries are rejected and deleted, so the next load is a plain miss
+        const std::string Path = Cache.getEntryPath(Key);
+        const uint32_t OtherVersion = hiveVG::CDiskTextureCache::FormatVersion + 1;
+        const uint8_t  FlippedByte  = 0x5A;
+        expect(damageFile(Path, 8, &OtherVersion, sizeof(OtherVersion)) && !Cache.load(Key, Cached), "an entry of another version is accepted");
+        expect(!isFilePresent(Path), "a rejected entry is kept");
+        expect(Cache.store(Key, Image, MipLevels) && damageFile(Path, 60, &FlippedByte, 1) && !Cache.load(Key, Cached), "a damaged key is accepted");
+        expect(Cache.store(Key, Image, MipLevels) && damageFile(Path, 4096, nullptr, 0) && !Cache.load(Key, Cached), "a truncated entry is accepted");
+        expect(Cache.getStats().RejectCount == 3, "rejections are miscounted");
+        expect(Cache.store(Key, Image, MipLevels) && Cache.load(Key, Warm) && isSameAsCached(Image, MipLevels, Warm), "store after rejection failed");
+
+        Cache.clear();
+        expect(!isFilePresent(Path), "clear leaves entries behind");
+    }
+}
+
+int main()
+{
+    char Directory[] = "/tmp/diskCacheCheck.XXXXXX";
+    if (mkdtemp(Directory) == nullptr)
+    {
+        std::fprintf(stderr, "Cannot create a temporary directory: %s\n", std::strerror(errno));
+        return 1;
+    }
+    hiveVG::tools::CCheckReport Report("disk cache");
+    for (auto Compression : {hiveVG::EDiskTextureCompression::None, hiveVG::EDiskTextureCompression::LZ4})
+        checkDiskCache(Directory, Compression, Report);
+    rmdir(Directory);
+    return Report.finish();
+}
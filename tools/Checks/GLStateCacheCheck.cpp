@@ -0,0 +1,172 @@
+// Host check of CGLStateCache: replays the snow scene's per frame state calls through the cache into a recording GL stub.
+// Usage: glStateCacheCheck
+// Checks that every draw sees the GL state the uncached calls give, that uniform locations are looked up once and that
+// the issued and elided call counts add up, and prints those counts per frame.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "GLStateCache.h"
+#include "CheckReport.h"
+
+namespace
+{
+    // GL state as the recording stub models it, what a draw issued at that point would see
+    struct SRecordedGLState
+    {
+        uint32_t Program = 0, VertexArray = 0, ActiveUnit = 0, BlendSource = 1, BlendDestination = 0, BlendSourceAlpha = 1, BlendDestinationAlpha = 0;
+        bool     IsBlendEnabled = false;
+        std::vector<std::pair<uint64_t, uint32_t>> Bindings;   // (unit << 32 | target) -> texture, sorted
+
+        bool operator==(const SRecordedGLState &vOther) const
+        {
+            return Program == vOther.Program && VertexArray == vOther.VertexArray && BlendSource == vOther.BlendSource &&
+                   BlendDestination == vOther.BlendDestination && BlendSourceAlpha == vOther.BlendSourceAlpha &&
+                   BlendDestinationAlpha == vOther.BlendDestinationAlpha && IsBlendEnabled == vOther.IsBlendEnabled && Bindings == vOther.Bindings;
+        }
+    };
+
+    SRecordedGLState s_RecordedGL;
+    uint32_t         s_RecordedCallCount = 0;
+
+    namespace GL_STUB
+    {
+        constexpr uint32_t Blend = 0x0BE2, Texture2D = 0x0DE1, Texture2DArray = 0x8C1A, Texture0 = 0x84C0;
+        constexpr uint32_t One = 1, SrcAlpha = 0x0302, OneMinusSrcAlpha = 0x0303;
+
+        void useProgram(uint32_t vProgram) { ++s_RecordedCallCount; s_RecordedGL.Program = vProgram; }
+        void bindVertexArray(uint32_t vArray) { ++s_RecordedCallCount; s_RecordedGL.VertexArray = vArray; }
+        void activeTexture(uint32_t vUnit) { ++s_RecordedCallCount; s_RecordedGL.ActiveUnit = vUnit - Texture0; }
+        void enable(uint32_t vCapability) { ++s_RecordedCallCount; s_RecordedGL.IsBlendEnabled |= vCapability == Blend; }
+        void disable(uint32_t vCapability) { ++s_RecordedCallCount; s_RecordedGL.IsBlendEnabled &= vCapability != Blend; }
+        void blendFuncSeparate(uint32_t vSourceRGB, uint32_t vDestinationRGB, uint32_t vSourceAlpha, uint32_t vDestinationAlpha)
+        {
+            ++s_RecordedCallCount;
+            s_RecordedGL.BlendSource           = vSourceRGB;
+            s_RecordedGL.BlendDestination      = vDestinationRGB;
+            s_RecordedGL.BlendSourceAlpha      = vSourceAlpha;
+            s_RecordedGL.BlendDestinationAlpha = vDestinationAlpha;
+        }
+        void blendFunc(uint32_t vSource, uint32_t vDestination)
+        {
+            blendFuncSeparate(vSource, vDestination, vSource, vDestination);
+        }
+        void bindTexture(uint32_t vTarget, uint32_t vTexture)
+        {
+            ++s_RecordedCallCount;
+            const uint64_t Key = static_cast<uint64_t>(s_RecordedGL.ActiveUnit) << 32 | vTarget;
+            auto &Bindings = s_RecordedGL.Bindings;
+            auto Iterator = std::lower_bound(Bindings.begin(), Bindings.end(), std::make_pair(Key, 0u),
+                                             [](const auto &vLeft, const auto &vRight) { return vLeft.first < vRight.first; });
+            if (Iterator != Bindings.end() && Iterator->first == Key) Iterator->second = vTexture;
+            else Bindings.insert(Iterator, {Key, vTexture});
+        }
+        // Locations are made up from the name, so a lookup can be told apart from a stale one
+        int32_t getUniformLocation(uint32_t vProgram, const char *vName) { ++s_RecordedCallCount; return static_cast<int32_t>(vProgram * 100 + std::strlen(vName)); }
+    }
+
+    // renderScene's state calls for the snow scene: background image, far snow, house image, near snow. Tiled snow
+    // binds its motion vectors to unit 1 and its frames to unit 0, and switches to the tile vertex array and back.
+    // The state before each draw is recorded into voDrawStates.
+    template<typename TState>
+    void replaySnowFrame(TState &vioState, int vFrame, std::vector<SRecordedGLState> &voDrawStates)
+    {
+        using namespace GL_STUB;
+        constexpr uint32_t QuadArray = 1, TileArray = 2, ImageProgram = 3, TileProgram = 4;
+        vioState.invalidateTextureBindings();
+        vioState.bindVertexArray(QuadArray);
+        const auto drawSnow = [&](uint32_t vFrames, uint32_t vMotion) {
+            vioState.useProgram(TileProgram);
+            vioState.setEnabled(Blend, true);
+            vioState.setBlendFunc(One, OneMinusSrcAlpha);
+            vioState.bindTexture(1, Texture2D, vMotion);
+            vioState.bindTexture(0, Texture2DArray, vFrames);
+            vioState.bindVertexArray(TileArray);
+            voDrawStates.push_back(s_RecordedGL);
+            vioState.bindVertexArray(QuadArray);
+        };
+        vioState.useProgram(ImageProgram);
+        vioState.setEnabled(Blend, false);
+        vioState.bindTexture(0, Texture2D, 10);
+        voDrawStates.push_back(s_RecordedGL);
+        drawSnow(20, 21);
+        vioState.useProgram(ImageProgram);
+        vioState.setEnabled(Blend, true);
+        vioState.setBlendFunc(SrcAlpha, OneMinusSrcAlpha);
+        // The house texture is replaced every other frame, as a texture cache reload would
+        vioState.bindTexture(0, Texture2D, 11 + vFrame % 2);
+        voDrawStates.push_back(s_RecordedGL);
+        drawSnow(22, 23);
+    }
+
+    // Every call straight to the stub, what the renderer did before the cache
+    struct SUncachedGLState
+    {
+        void invalidateTextureBindings() {}
+        void useProgram(uint32_t vProgram) { GL_STUB::useProgram(vProgram); }
+        void bindVertexArray(uint32_t vArray) { GL_STUB::bindVertexArray(vArray); }
+        void setEnabled(uint32_t vCapability, bool vIsEnabled) { (vIsEnabled ? GL_STUB::enable : GL_STUB::disable)(vCapability); }
+        void setBlendFunc(uint32_t vSource, uint32_t vDestination) { GL_STUB::blendFunc(vSource, vDestination); }
+        void bindTexture(int vUnit, uint32_t vTarget, uint32_t vTexture)
+        {
+            GL_STUB::activeTexture(GL_STUB::Texture0 + vUnit);
+            GL_STUB::bindTexture(vTarget, vTexture);
+        }
+    };
+
+    void checkGLStateCache(hiveVG::tools::CCheckReport &vioReport)
+    {
+        constexpr int FrameCount = 4;
+        std::vector<SRecordedGLState> UncachedStates, CachedStates;
+        SUncachedGLState Uncached;
+        s_RecordedGL = SRecordedGLState();
+        s_RecordedCallCount = 0;
+        for (int Frame = 0; Frame < FrameCount; ++Frame) replaySnowFrame(Uncached, Frame, UncachedStates);
+        const uint32_t UncachedCallCount = s_RecordedCallCount;
+
+        hiveVG::SGLDispatch Dispatch;
+        Dispatch.UseProgram         = GL_STUB::useProgram;
+        Dispatch.BindVertexArray    = GL_STUB::bindVertexArray;
+        Dispatch.ActiveTexture      = GL_STUB::activeTexture;
+        Dispatch.BindTexture        = GL_STUB::bindTexture;
+        Dispatch.Enable             = GL_STUB::enable;
+        Dispatch.Disable            = GL_STUB::disable;
+        Dispatch.BlendFunc          = GL_STUB::blendFunc;
+        Dispatch.BlendFuncSeparate  = GL_STUB::blendFuncSeparate;
+        Dispatch.GetUniformLocation = GL_STUB::getUniformLocation;
+        hiveVG::CGLStateCache Cache(Dispatch);
+        s_RecordedGL = SRecordedGLState();
+        s_RecordedCallCount = 0;
+
+        // Locations are looked up once, reading them back reaches no GL
+        const char *const UniformNames[] = {"blendFactor", "layer", "tileScale"};
+        Cache.registerProgram(4, UniformNames, std::size(UniformNames));
+        const bool IsLookupOnce = s_RecordedCallCount == std::size(UniformNames) && Cache.getUniformLocation(4, 1) == 405 &&
+                                  Cache.getUniformLocation(4, 2) == 409 && s_RecordedCallCount == std::size(UniformNames);
+        s_RecordedCallCount = 0;
+
+        bool IsCountExact = true;
+        for (int Frame = 0; Frame < FrameCount; ++Frame)
+        {
+            const uint32_t CallsBefore = s_RecordedCallCount;
+            replaySnowFrame(Cache, Frame, CachedStates);
+            const hiveVG::SGLStateStats Stats = Cache.endFrame();
+            IsCountExact = IsCountExact && Stats.IssuedCount == s_RecordedCallCount - CallsBefore &&
+                           Stats.IssuedCount + Stats.ElidedCount == UncachedCallCount / FrameCount;
+            std::printf("gl state frame %d: %2u issued, %2u elided of %u uncached calls\n", Frame, Stats.IssuedCount, Stats.ElidedCount, UncachedCallCount / FrameCount);
+        }
+        vioReport.expect(CachedStates == UncachedStates, "a draw sees other GL state than the uncached calls give");
+        vioReport.expect(IsLookupOnce, "uniform locations are looked up more than once");
+        vioReport.expect(IsCountExact, "issued and elided call counts do not add up");
+    }
+}
+
+int main()
+{
+    hiveVG::tools::CCheckReport Report("gl state cache");
+    checkGLStateCache(Report);
+    return Report.finish();
+}
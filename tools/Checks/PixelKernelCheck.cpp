@@ -0,0 +1,133 @@
+// Host check of the SIMD pixel kernels against the scalar one, on generated images so it needs no input files.
+// Usage: pixelKernelCheck
+// Checks that every kernel the CPU runs premultiplies (plain and linear) and scans tile occupancy bit for bit like
+// the scalar kernel, and that occupancy marks the tiles a texel can show in, margin included.
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ImageData.h"
+#include "PixelConvert.h"
+#include "TileOccupancy.h"
+#include "CheckReport.h"
+
+namespace
+{
+    // Every (color, alpha) pair once, plus a few pixels so each kernel also runs its scalar tail.
+    hiveVG::SImageData makeExhaustiveImage()
+    {
+        hiveVG::SImageData Image;
+        Image.Width  = 256 * 256 + 3;
+        Image.Height = 1;
+        Image.Pixels.resize(Image.getByteSize());
+        for (int i = 0; i < Image.Width; ++i)
+        {
+            uint8_t *pPixel = Image.Pixels.data() + i * 4;
+            pPixel[0] = static_cast<uint8_t>(i);
+            pPixel[1] = static_cast<uint8_t>(255 - i);
+            pPixel[2] = static_cast<uint8_t>(i * 7);
+            pPixel[3] = static_cast<uint8_t>(i >> 8);
+        }
+        return Image;
+    }
+
+    // Random RGBA8, each texel visible (alpha 1 to 255) with vVisibleShare, fully transparent otherwise
+    hiveVG::SImageData makeNoiseImage(int vWidth, int vHeight, double vVisibleShare, uint32_t vSeed)
+    {
+        std::mt19937 Random(vSeed);
+        std::uniform_int_distribution<int> Byte(0, 255), Alpha(1, 255);
+        std::bernoulli_distribution IsVisible(vVisibleShare);
+        hiveVG::SImageData Image;
+        Image.Width  = vWidth;
+        Image.Height = vHeight;
+        Image.Pixels.resize(Image.getByteSize());
+        for (size_t i = 0; i < Image.Pixels.size(); i += 4)
+        {
+            for (int Channel = 0; Channel < 3; ++Channel) Image.Pixels[i + Channel] = static_cast<uint8_t>(Byte(Random));
+            Image.Pixels[i + 3] = IsVisible(Random) ? static_cast<uint8_t>(Alpha(Random)) : 0;
+        }
+        return Image;
+    }
+
+    template<typename TCheck>
+    void forEachFastKernel(TCheck &&vCheck)
+    {
+        for (int Kernel = 0; Kernel < static_cast<int>(hiveVG::EPixelKernel::Count); ++Kernel)
+        {
+            const auto PixelKernel = static_cast<hiveVG::EPixelKernel>(Kernel);
+            if (PixelKernel != hiveVG::EPixelKernel::Scalar && hiveVG::isPixelKernelAvailable(PixelKernel)) vCheck(PixelKernel);
+        }
+    }
+
+    void checkPremultiply(hiveVG::tools::CCheckReport &vioReport)
+    {
+        const std::vector<hiveVG::SImageData> Images = {makeExhaustiveImage(), makeNoiseImage(1021, 7, 0.8, 1)};
+        for (auto Conversion : {hiveVG::EAlphaConversion::Premultiply, hiveVG::EAlphaConversion::PremultiplyLinear})
+        {
+            const char *pConversionName = Conversion == hiveVG::EAlphaConversion::Premultiply ? "premultiply" : "linear premultiply";
+            std::vector<hiveVG::SImageData> References = Images;
+            for (auto &Reference : References)
+                hiveVG::premultiplyAlpha(Reference.Pixels.data(), Reference.Pixels.size() / 4, Conversion, hiveVG::EPixelKernel::Scalar);
+
+            forEachFastKernel([&](hiveVG::EPixelKernel vKernel) {
+                bool IsExact = true;
+                for (size_t i = 0; i < Images.size(); ++i)
+                {
+                    std::vector<uint8_t> Pixels = Images[i].Pixels;
+                    hiveVG::premultiplyAlpha(Pixels.data(), Pixels.size() / 4, Conversion, vKernel);
+                    IsExact = IsExact && Pixels == References[i].Pixels;
+                }
+                vioReport.expect(IsExact, (std::string(pConversionName) + " of the " + hiveVG::getPixelKernelName(vKernel) + " kernel differs from the scalar one").c_str());
+            });
+        }
+    }
+
+    void checkTileOccupancy(hiveVG::tools::CCheckReport &vioReport)
+    {
+        using namespace hiveVG::TILE_OCCUPANCY;
+        // Sizes on and off the tile grid, from empty over sparse to full frames
+        std::vector<hiveVG::SImageData> Frames;
+        uint32_t Seed = 2;
+        for (auto [Width, Height] : {std::pair{32, 32}, std::pair{100, 70}, std::pair{257, 129}, std::pair{640, 360}})
+            for (double VisibleShare : {0.0, 0.0005, 0.01, 1.0})
+                Frames.push_back(makeNoiseImage(Width, Height, VisibleShare, Seed++));
+
+        std::vector<hiveVG::STileOccupancy> References(Frames.size());
+        for (size_t i = 0; i < Frames.size(); ++i)
+        {
+            hiveVG::STileOccupancy &Reference = References[i];
+            hiveVG::buildTileOccupancy(Frames[i], TileSize, AlphaThreshold, Margin, hiveVG::EPixelKernel::Scalar, Reference);
+            vioReport.expect(Reference.Columns == (Frames[i].Width + TileSize - 1) / TileSize && Reference.Rows == (Frames[i].Height + TileSize - 1) / TileSize,
+                             "the occupancy grid does not cover the frame");
+        }
+        vioReport.expect(References[0].getOccupiedCount() == 0, "an empty frame has occupied tiles");
+        vioReport.expect(References[3].getOccupiedCount() == References[3].Columns * References[3].Rows, "a full frame has empty tiles");
+
+        forEachFastKernel([&](hiveVG::EPixelKernel vKernel) {
+            bool IsExact = true;
+            hiveVG::STileOccupancy Occupancy;
+            for (size_t i = 0; i < Frames.size(); ++i)
+            {
+                hiveVG::buildTileOccupancy(Frames[i], TileSize, AlphaThreshold, Margin, vKernel, Occupancy);
+                IsExact = IsExact && Occupancy.Bits == References[i].Bits;
+            }
+            vioReport.expect(IsExact, (std::string("occupancy of the ") + hiveVG::getPixelKernelName(vKernel) + " kernel differs from the scalar one").c_str());
+        });
+
+        // One barely visible texel just past the first tile column shows in both tiles it is within the margin of
+        hiveVG::SImageData Frame = makeNoiseImage(100, 70, 0.0, 0);
+        Frame.Pixels[(static_cast<size_t>(5) * Frame.Width + TileSize + Margin - 1) * 4 + 3] = AlphaThreshold + 1;
+        hiveVG::STileOccupancy Occupancy;
+        hiveVG::buildTileOccupancy(Frame, TileSize, AlphaThreshold, Margin, hiveVG::EPixelKernel::Scalar, Occupancy);
+        vioReport.expect(Occupancy.getOccupiedCount() == 2 && Occupancy.isOccupied(0, 0) && Occupancy.isOccupied(1, 0), "a texel within the margin is not drawn by both tiles");
+    }
+}
+
+int main()
+{
+    hiveVG::tools::CCheckReport Report("pixel kernels");
+    checkPremultiply(Report);
+    checkTileOccupancy(Report);
+    return Report.finish();
+}
@@ -0,0 +1,209 @@
+// Host check of CResourceCache, the policy behind CTextureCache, with a fake resource of a given size.
+// Usage: resourceCacheCheck
+// Checks hits and misses, that concurrent requests for one key create it once, that entries past the budget are evicted
+// least recently used first, that entries somebody still holds are never evicted, and that pinned bytes share the budget.
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ResourceCache.h"
+#include "CheckReport.h"
+
+namespace
+{
+    // A texture stand-in, Bytes changes the way a pending texture grows once uploaded
+    struct SFakeResource
+    {
+        size_t Bytes = 0;
+
+        [[nodiscard]] size_t getEstimatedBytes() const { return Bytes; }
+    };
+
+    using CFakeCache = hiveVG::CResourceCache<std::string, SFakeResource>;
+
+    constexpr size_t EntryBytes = 100;
+
+    // Acquires vKey, counting in vioCreateCount whether it had to be created
+    std::shared_ptr<SFakeResource> acquireCounted(CFakeCache &vioCache, const std::string &vKey, int &vioCreateCount, size_t vBytes = EntryBytes)
+    {
+        return vioCache.acquire(vKey, [&]() {
+            ++vioCreateCount;
+            return std::make_shared<SFakeResource>(SFakeResource{vBytes});
+        });
+    }
+
+    void checkHitsAndMisses(hiveVG::tools::CCheckReport &vioReport)
+    {
+        CFakeCache Cache(EntryBytes * 4);
+        int CreateCount = 0;
+        auto pFirst  = acquireCounted(Cache, "a", CreateCount);
+        auto pSecond = acquireCounted(Cache, "a", CreateCount);
+        acquireCounted(Cache, "b", CreateCount);
+        hiveVG::SResourceCacheStats Stats = Cache.getStats();
+        vioReport.expect(pFirst != nullptr && pFirst == pSecond && CreateCount == 2, "a second acquire does not return the cached entry");
+        vioReport.expect(Stats.HitCount == 1 && Stats.MissCount == 2, "hits and misses are miscounted");
+        vioReport.expect(Stats.EntryCount == 2 && Stats.ResidentBytes == EntryBytes * 2, "resident entries or bytes are miscounted");
+
+        // A failed load is not cached, the next request tries again
+        const auto failToCreate = []() { return std::shared_ptr<SFakeResource>(); };
+        vioReport.expect(Cache.acquire("missing", failToCreate) == nullptr, "a failed create returns an entry");
+        Stats = Cache.getStats();
+        vioReport.expect(Stats.MissCount == 3 && Stats.EntryCount == 2, "a failed create is cached");
+        acquireCounted(Cache, "missing", CreateCount);
+        vioReport.expect(CreateCount == 3, "a failed create is not retried");
+
+        Cache.clear();
+        Stats = Cache.getStats();
+        vioReport.expect(Stats.EntryCount == 0 && Stats.ResidentBytes == 0, "clear leaves entries behind");
+        vioReport.expect(acquireCounted(Cache, "a", CreateCount) != pFirst && CreateCount == 4, "an entry survives clear");
+    }
+
+    // Every thread asks for the same key at once while the first create is still running
+    void checkConcurrentRequests(hiveVG::tools::CCheckReport &vioReport)
+    {
+        constexpr int ThreadCount = 8;
+        CFakeCache Cache(EntryBytes * 4);
+        std::atomic<int> CreateCount{0};
+        std::vector<std::shared_ptr<SFakeResource>> Results(ThreadCount);
+        std::mutex StartMutex;
+        std::condition_variable StartCondition;
+        bool IsStarted = false;
+        std::vector<std::thread> Threads;
+        for (int i = 0; i < ThreadCount; ++i)
+        {
+            Threads.emplace_back([&, i]() {
+                {
+                    std::unique_lock<std::mutex> Lock(StartMutex);
+                    StartCondition.wait(Lock, [&]() { return IsStarted; });
+                }
+                Results[i] = Cache.acquire("shared", [&]() {
+                    ++CreateCount;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    return std::make_shared<SFakeResource>(SFakeResource{EntryBytes});
+                });
+            });
+        }
+        {
+            std::lock_guard<std::mutex> Lock(StartMutex);
+            IsStarted = true;
+        }
+        StartCondition.notify_all();
+        for (auto &Thread : Threads) Thread.join();
+
+        bool IsSameEntry = Results[0] != nullptr;
+        for (const auto &pResult : Results) IsSameEntry = IsSameEntry && pResult == Results[0];
+        const hiveVG::SResourceCacheStats Stats = Cache.getStats();
+        vioReport.expect(CreateCount == 1, "concurrent requests for one key create it more than once");
+        vioReport.expect(IsSameEntry, "concurrent requests for one key get different entries");
+        vioReport.expect(Stats.MissCount == 1 && Stats.HitCount == ThreadCount - 1 && Stats.EntryCount == 1, "concurrent requests are miscounted");
+    }
+
+    void checkLruEviction(hiveVG::tools::CCheckReport &vioReport)
+    {
+        CFakeCache Cache(EntryBytes * 3);
+        int CreateCount = 0;
+        acquireCounted(Cache, "a", CreateCount);
+        acquireCounted(Cache, "b", CreateCount);
+        acquireCounted(Cache, "c", CreateCount);
+        // a is used again, so b is now the least recently used
+        acquireCounted(Cache, "a", CreateCount);
+        acquireCounted(Cache, "d", CreateCount);
+        hiveVG::SResourceCacheStats Stats = Cache.getStats();
+        vioReport.expect(Stats.EvictionCount == 1 && Stats.EvictedBytes == EntryBytes, "going past the budget does not evict exactly one entry");
+        vioReport.expect(Stats.EntryCount == 3 && Stats.ResidentBytes <= Cache.getBudgetBytes(), "the cache stays over its budget");
+
+        CreateCount = 0;
+        for (const char *pKey : {"a", "c", "d"}) acquireCounted(Cache, pKey, CreateCount);
+        vioReport.expect(CreateCount == 0, "a recently used entry was evicted");
+        acquireCounted(Cache, "b", CreateCount);
+        vioReport.expect(CreateCount == 1, "the least recently used entry was kept");
+
+        // b pushed a out, lowering the budget then evicts c, the least recently used of b, d and c
+        Cache.setBudgetBytes(EntryBytes * 2);
+        CreateCount = 0;
+        for (const char *pKey : {"d", "b"}) acquireCounted(Cache, pKey, CreateCount);
+        vioReport.expect(CreateCount == 0 && Cache.getStats().EntryCount == 2, "a lower budget evicts the wrong entries");
+
+        // Pending entries are re-measured on trim, as textures are once uploaded
+        CFakeCache PendingCache(EntryBytes);
+        auto pFirst  = acquireCounted(PendingCache, "first", CreateCount, 0);
+        auto pSecond = acquireCounted(PendingCache, "second", CreateCount, 0);
+        pFirst->Bytes = pSecond->Bytes = EntryBytes;
+        pFirst.reset();
+        pSecond.reset();
+        PendingCache.trim();
+        Stats = PendingCache.getStats();
+        CreateCount = 0;
+        acquireCounted(PendingCache, "second", CreateCount);
+        vioReport.expect(Stats.EvictionCount == 1 && Stats.ResidentBytes == EntryBytes && CreateCount == 0, "trim does not re-measure grown entries");
+    }
+
+    void checkReferencedEntries(hiveVG::tools::CCheckReport &vioReport)
+    {
+        CFakeCache Cache(EntryBytes * 2);
+        int CreateCount = 0;
+        auto pX = acquireCounted(Cache, "x", CreateCount);
+        auto pY = acquireCounted(Cache, "y", CreateCount);
+        auto pZ = acquireCounted(Cache, "z", CreateCount);
+        hiveVG::SResourceCacheStats Stats = Cache.getStats();
+        vioReport.expect(Stats.EvictionCount == 0 && Stats.EntryCount == 3 && Stats.ResidentBytes == EntryBytes * 3, "a held entry was evicted past the budget");
+
+        Cache.setBudgetBytes(0);
+        vioReport.expect(Cache.getStats().EvictionCount == 0, "a held entry was evicted on a zero budget");
+
+        // Only the released one goes, even though the others are less recently used
+        pY.reset();
+        Cache.trim();
+        Stats = Cache.getStats();
+        CreateCount = 0;
+        vioReport.expect(Stats.EvictionCount == 1 && Stats.EntryCount == 2, "releasing an entry does not make it evictable");
+        vioReport.expect(acquireCounted(Cache, "x", CreateCount) == pX && acquireCounted(Cache, "z", CreateCount) == pZ && CreateCount == 0,
+                         "a held entry was replaced");
+
+        pX.reset();
+        pZ.reset();
+        Cache.trim();
+        Stats = Cache.getStats();
+        vioReport.expect(Stats.EntryCount == 0 && Stats.ResidentBytes == 0, "released entries are kept on a zero budget");
+    }
+    void checkPinnedBytes(hiveVG::tools::CCheckReport &vioReport)
+    {
+        CFakeCache Cache(EntryBytes * 3);
+        int CreateCount = 0;
+        for (const char *pKey : {"a", "b", "c"}) acquireCounted(Cache, pKey, CreateCount);
+
+        // Room for one entry next to the pinned bytes, a and b go least recently used first
+        Cache.setPinnedBytes("targets", EntryBytes * 2);
+        hiveVG::SResourceCacheStats Stats = Cache.getStats();
+        vioReport.expect(Stats.EvictionCount == 2 && Stats.EntryCount == 1 && Stats.PinnedBytes == EntryBytes * 2, "pinned bytes do not make room in the budget");
+        CreateCount = 0;
+        acquireCounted(Cache, "c", CreateCount);
+        vioReport.expect(CreateCount == 0, "the most recently used entry was evicted for pinned bytes");
+
+        // Names add up, pinning past the budget leaves only held entries, unpinning gives the room back
+        auto pHeld = acquireCounted(Cache, "held", CreateCount);
+        Cache.setPinnedBytes("windows", EntryBytes * 2);
+        Stats = Cache.getStats();
+        vioReport.expect(Stats.PinnedBytes == EntryBytes * 4 && Stats.EntryCount == 1, "pinned bytes of several names are not summed");
+        Cache.setPinnedBytes("targets", 0);
+        Cache.setPinnedBytes("windows", 0);
+        acquireCounted(Cache, "d", CreateCount);
+        Stats = Cache.getStats();
+        vioReport.expect(Stats.PinnedBytes == 0 && Stats.EntryCount == 2 && Stats.ResidentBytes == EntryBytes * 2, "unpinned bytes still take up the budget");
+    }
+}
+
+int main()
+{
+    hiveVG::tools::CCheckReport Report("resource cache");
+    checkHitsAndMisses(Report);
+    checkConcurrentRequests(Report);
+    checkLruEviction(Report);
+    checkReferencedEntries(Report);
+    checkPinnedBytes(Report);
+    return Report.finish();
+}
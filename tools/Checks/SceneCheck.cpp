@@ -0,0 +1,101 @@
+// Host check of the scene description: the app's snow scene and a few scene files the parser must refuse.
+// Usage: sceneCheck
+// Checks that snow.scene parses, that every tier draws its layers in depth order with no more state changes than file
+// order and as one composite pass, and that every image and baked file the scene names is in the assets.
+// textureBench --scene prints what each tier builds.
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "CompositeShader.h"
+#include "FrameSequence.h"
+#include "SceneDescription.h"
+#include "CheckReport.h"
+#include "../Common/SceneComposite.h"
+#include "../Common/ToolUtils.h"
+
+namespace
+{
+    bool parseScene(const char *vText, hiveVG::SSceneDescription &voScene)
+    {
+        return hiveVG::parseSceneDescription(vText, std::strlen(vText), voScene);
+    }
+
+    bool isAssetPresent(const std::string &vAssetPath)
+    {
+        struct stat FileStat{};
+        return stat((std::string(HIVE_ASSET_DIR) + "/" + vAssetPath).c_str(), &FileStat) == 0;
+    }
+
+    void checkSnowScene(hiveVG::tools::CCheckReport &vioReport)
+    {
+        constexpr size_t MinStaticGroupLayers = 2;   // as the renderer groups them
+        std::vector<uint8_t> Bytes;
+        hiveVG::SSceneDescription Scene;
+        if (!vioReport.expect(hiveVG::tools::readFileBytes(std::string(HIVE_ASSET_DIR) + "/Scenes/snow.scene", Bytes) &&
+                              hiveVG::parseSceneDescription(reinterpret_cast<const char *>(Bytes.data()), Bytes.size(), Scene) && !Scene.Layers.empty(),
+                              "snow.scene does not parse"))
+            return;
+
+        // Sequence atlases are built outside the tree, what the scene bakes from them has to ship with it
+        for (const auto &Layer : Scene.Layers)
+        {
+            std::vector<std::string> Paths = {Layer.MotionPath, Layer.SpritePath, Layer.HullPath};
+            if (Layer.Kind == hiveVG::ESceneLayerKind::Image || hiveVG::isFrameSequencePath(Layer.TexturePath)) Paths.push_back(Layer.TexturePath);
+            for (const std::string &Path : Paths)
+                vioReport.expect(Path.empty() || isAssetPresent(Path), ("layer " + Layer.Name + " names missing asset " + Path).c_str());
+        }
+
+        for (hiveVG::EQualityTier Tier : {hiveVG::EQualityTier::Low, hiveVG::EQualityTier::Medium, hiveVG::EQualityTier::High, hiveVG::EQualityTier::Source})
+        {
+            const std::string TierName = hiveVG::getQualityTierName(Tier);
+            const std::vector<hiveVG::SSceneLayer> Layers = hiveVG::selectSceneLayers(Scene, Tier);
+            std::vector<hiveVG::SSceneLayer> FileOrder;
+            for (const auto &Layer : Scene.Layers)
+                if (Layer.MinTier <= Tier) FileOrder.push_back(Layer);
+            bool IsDepthOrdered = Layers.size() == FileOrder.size();
+            for (size_t i = 1; i < Layers.size(); ++i) IsDepthOrdered = IsDepthOrdered && Layers[i - 1].Depth <= Layers[i].Depth;
+            vioReport.expect(IsDepthOrdered, (TierName + " does not draw its layers back to front").c_str());
+            std::stable_sort(FileOrder.begin(), FileOrder.end(), [](const auto &vLeft, const auto &vRight) { return vLeft.Depth < vRight.Depth; });
+            vioReport.expect(hiveVG::countSceneStateChanges(Layers) <= hiveVG::countSceneStateChanges(FileOrder),
+                             (TierName + " draw order changes more state than file order").c_str());
+
+            std::vector<hiveVG::SCompositeLayer> CompositeLayers;
+            hiveVG::SCompositeShader CompositeShader;
+            const bool IsComposited = hiveVG::tools::buildSceneComposite(Layers, hiveVG::findStaticLayerGroups(Layers, MinStaticGroupLayers), Tier, CompositeLayers,
+                                                                          CompositeShader);
+            vioReport.expect(IsComposited && !CompositeShader.FragmentSource.empty(), (TierName + " does not build a composite pass").c_str());
+        }
+    }
+
+    void checkSceneParser(hiveVG::tools::CCheckReport &vioReport)
+    {
+        hiveVG::SSceneDescription Scene;
+        const char *pSnow = "layer snow\n kind sequence\n texture Textures/snow.png # trailing comment\n grid 4 8\n fps 24\n scale 0.5\n scale 0.25 Medium\n";
+        vioReport.expect(parseScene(pSnow, Scene) && Scene.Layers.size() == 1 && Scene.Layers[0].getFrameCount() == 32, "a sequence layer does not parse");
+        const float Expected[4] = {0.25f, 0.25f, 0.5f, 0.5f};
+        vioReport.expect(Scene.Layers.size() == 1 && std::equal(Expected, Expected + 4, Scene.Layers[0].RenderScales), "a later scale line does not override lower tiers");
+
+        const char *const Refused[] = {
+            "texture Textures/a.png\n",                                           // before any layer
+            "layer a\n kind image\n texture Textures/a.png\n colour red\n",       // unknown key
+            "layer a\n kind image\n texture Textures/a.png\n tier Ultra\n",       // unknown tier
+            "layer a\n kind image\n texture Textures/a.png\n scale 0.5\n",        // only sequences are reduced
+            "layer a\n kind sequence\n texture Textures/a.png\n grid 4 4\n",      // no fps
+            "layer a\n kind sequence\n texture Textures/a.png\n grid 4 4\n fps 24\n scale 1.5\n",
+            "layer a\n kind image\n",                                             // no texture
+        };
+        for (const char *pText : Refused)
+            vioReport.expect(!parseScene(pText, Scene), (std::string("the parser accepts: ") + pText).c_str());
+    }
+}
+
+int main()
+{
+    hiveVG::tools::CCheckReport Report("scene");
+    checkSnowScene(Report);
+    checkSceneParser(Report);
+    return Report.finish();
+}
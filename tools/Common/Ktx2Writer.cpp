@@ -0,0 +1,120 @@
+#include "Ktx2Writer.h"
+#include <cstring>
+
+namespace hiveVG::tools
+{
+    namespace
+    {
+        constexpr uint8_t Ktx2Identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+        constexpr uint8_t DfdModelEtc2       = 161;
+        constexpr uint8_t DfdPrimariesBt709  = 1;
+        constexpr uint8_t DfdTransferLinear  = 1;
+        constexpr uint8_t DfdChannelEtc2Red   = 0;
+        constexpr uint8_t DfdChannelEtc2Green = 1;
+        constexpr uint8_t DfdChannelEtc2Color = 2;
+        constexpr uint8_t DfdChannelEtc2Alpha = 15;
+
+        void appendLE(std::vector<uint8_t> &voBytes, uint64_t vValue, size_t vByteCount)
+        {
+            for (size_t i = 0; i < vByteCount; ++i)
+                voBytes.push_back(static_cast<uint8_t>(vValue >> (8 * i)));
+        }
+
+        void patchLE(std::vector<uint8_t> &voBytes, size_t vOffset, uint64_t vValue, size_t vByteCount)
+        {
+            for (size_t i = 0; i < vByteCount; ++i)
+                voBytes[vOffset + i] = static_cast<uint8_t>(vValue >> (8 * i));
+        }
+
+        void appendSample(std::vector<uint8_t> &voDfd, uint16_t vBitOffset, uint8_t vBitLength, uint8_t vChannel)
+        {
+            appendLE(voDfd, vBitOffset, 2);
+            voDfd.push_back(static_cast<uint8_t>(vBitLength - 1));
+            voDfd.push_back(vChannel);
+            appendLE(voDfd, 0, 4);             // sample position
+            appendLE(voDfd, 0, 4);             // sampleLower
+            appendLE(voDfd, 0xFFFFFFFFu, 4);   // sampleUpper
+        }
+    }
+
+    std::vector<uint8_t> makeEtc2Dfd(bool vHasAlpha, bool vIsSingleChannel, bool vIsPremultiplied)
+    {
+        const uint32_t SampleCount = vHasAlpha ? 2 : 1;
+        const uint32_t BlockSize   = 24 + 16 * SampleCount;
+        std::vector<uint8_t> Dfd;
+        appendLE(Dfd, 4 + BlockSize, 4);                     // dfdTotalSize
+        appendLE(Dfd, 0, 4);                                 // vendorId = Khronos, descriptorType = basic
+        appendLE(Dfd, 2, 2);                                 // versionNumber
+        appendLE(Dfd, BlockSize, 2);
+        Dfd.push_back(DfdModelEtc2);
+        Dfd.push_back(DfdPrimariesBt709);
+        Dfd.push_back(DfdTransferLinear);
+        Dfd.push_back(vIsPremultiplied ? 1 : 0);             // KHR_DF_FLAG_ALPHA_PREMULTIPLIED
+        Dfd.insert(Dfd.end(), {3, 3, 0, 0});                 // 4x4 texel block, stored minus one
+        Dfd.insert(Dfd.end(), {static_cast<uint8_t>(vHasAlpha ? 16 : 8), 0, 0, 0, 0, 0, 0, 0});
+        if (vHasAlpha)
+        {
+            appendSample(Dfd, 0, 64, DfdChannelEtc2Alpha);
+            appendSample(Dfd, 64, 64, DfdChannelEtc2Color);
+        }
+        else
+            appendSample(Dfd, 0, 64, vIsSingleChannel ? DfdChannelEtc2Red : DfdChannelEtc2Color);
+        return Dfd;
+    }
+
+    std::vector<uint8_t> makeEacRg11Dfd()
+    {
+        constexpr uint32_t BlockSize = 24 + 16 * 2;
+        std::vector<uint8_t> Dfd;
+        appendLE(Dfd, 4 + BlockSize, 4);
+        appendLE(Dfd, 0, 4);
+        appendLE(Dfd, 2, 2);
+        appendLE(Dfd, BlockSize, 2);
+        Dfd.push_back(DfdModelEtc2);
+        Dfd.push_back(DfdPrimariesBt709);
+        Dfd.push_back(DfdTransferLinear);
+        Dfd.push_back(0);
+        Dfd.insert(Dfd.end(), {3, 3, 0, 0});
+        Dfd.insert(Dfd.end(), {16, 0, 0, 0, 0, 0, 0, 0});
+        appendSample(Dfd, 0, 64, DfdChannelEtc2Red);
+        appendSample(Dfd, 64, 64, DfdChannelEtc2Green);
+        return Dfd;
+    }
+
+    std::vector<uint8_t> writeKtx2(const SKtx2WriteDesc &vDesc)
+    {
+        const size_t LevelCount = vDesc.Levels.size();
+        std::vector<uint8_t> File(Ktx2Identifier, Ktx2Identifier + sizeof(Ktx2Identifier));
+        appendLE(File, vDesc.VkFormat, 4);
+        appendLE(File, vDesc.TypeSize, 4);
+        appendLE(File, static_cast<uint32_t>(vDesc.Width), 4);
+        appendLE(File, static_cast<uint32_t>(vDesc.Height), 4);
+        appendLE(File, 0, 4);                                // pixelDepth
+        appendLE(File, 0, 4);                                // layerCount
+        appendLE(File, 1, 4);                                // faceCount
+        appendLE(File, LevelCount, 4);
+        appendLE(File, 0, 4);                                // supercompressionScheme
+
+        const size_t IndexOffset = File.size();
+        File.resize(File.size() + 4 * 4 + 2 * 8, 0);         // dfd/kvd/sgd offsets, patched below
+        const size_t LevelIndexOffset = File.size();
+        File.resize(File.size() + LevelCount * 3 * 8, 0);
+
+        const size_t DfdOffset = File.size();
+        File.insert(File.end(), vDesc.Dfd.begin(), vDesc.Dfd.end());
+        patchLE(File, IndexOffset + 0, DfdOffset, 4);
+        patchLE(File, IndexOffset + 4, vDesc.Dfd.size(), 4);
+
+        for (size_t i = LevelCount; i-- > 0;)
+        {
+            const auto &Level = vDesc.Levels[i];
+            while (File.size() % vDesc.LevelAlignment != 0) File.push_back(0);
+            const size_t EntryOffset = LevelIndexOffset + i * 3 * 8;
+            patchLE(File, EntryOffset + 0, File.size(), 8);
+            patchLE(File, EntryOffset + 8, Level.size(), 8);
+            patchLE(File, EntryOffset + 16, Level.size(), 8);
+            File.insert(File.end(), Level.begin(), Level.end());
+        }
+        return File;
+    }
+}
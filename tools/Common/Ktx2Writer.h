@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hiveVG::tools
+{
+    struct SKtx2WriteDesc
+    {
+        uint32_t                          VkFormat       = 0;
+        uint32_t                          TypeSize       = 1;
+        int                               Width          = 0;
+        int                               Height         = 0;
+        size_t                            LevelAlignment = 16;
+        std::vector<uint8_t>              Dfd;
+        std::vector<std::vector<uint8_t>> Levels;   // level 0 first
+    };
+
+    // Basic data format descriptor for the ETC2/EAC block formats written by the encoder.
+    std::vector<uint8_t> makeEtc2Dfd(bool vHasAlpha, bool vIsSingleChannel, bool vIsPremultiplied);
+    // Same for EAC RG11, an R11 block followed by a G11 block.
+    std::vector<uint8_t> makeEacRg11Dfd();
+    // Serializes a KTX2 file, level data is stored smallest level first as the spec recommends.
+    std::vector<uint8_t> writeKtx2(const SKtx2WriteDesc &vDesc);
+}
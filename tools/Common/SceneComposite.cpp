@@ -0,0 +1,48 @@
+#include "SceneComposite.h"
+
+namespace hiveVG::tools
+{
+    bool buildSceneComposite(const std::vector<SSceneLayer> &vLayers, const std::vector<SStaticLayerGroup> &vGroups, EQualityTier vTier,
+                             std::vector<SCompositeLayer> &voLayers, SCompositeShader &voShader)
+    {
+        // What the renderer clears to and the texture units GLES 3.0 guarantees a fragment shader
+        constexpr float ClearColor[4] = {0.2f, 0.3f, 0.2f, 0.0f};
+        constexpr int   MinTextureUnits = 16;
+        voLayers.clear();
+        bool HasSprites = false;
+        auto pGroup = vGroups.begin();
+        for (size_t i = 0; i < vLayers.size(); ++i)
+        {
+            const auto &Layer = vLayers[i];
+            HasSprites = HasSprites || Layer.isSprite();
+            SCompositeLayer CompositeLayer;
+            if (pGroup != vGroups.end() && pGroup->FirstLayer == i)
+            {
+                CompositeLayer.BlendMode = pGroup->IsOpaque ? ESceneBlendMode::Opaque : ESceneBlendMode::Premultiplied;
+                voLayers.push_back(CompositeLayer);
+                i += pGroup->LayerCount - 1;
+                ++pGroup;
+                continue;
+            }
+            if (Layer.getRenderScale(vTier) < 1.0f)
+            {
+                CompositeLayer.BlendMode     = Layer.BlendMode == ESceneBlendMode::Opaque ? ESceneBlendMode::Opaque : ESceneBlendMode::Premultiplied;
+                CompositeLayer.IsUpsampled   = true;
+                CompositeLayer.EdgeSharpness = Layer.UpsampleFilter == ESceneUpsampleFilter::Edge ? COMPOSITE_SHADER::EdgeSharpness : 0.0f;
+                voLayers.push_back(CompositeLayer);
+                continue;
+            }
+            CompositeLayer.Kind      = Layer.Kind;
+            CompositeLayer.BlendMode = Layer.BlendMode;
+            if (Layer.Kind == ESceneLayerKind::Sequence)
+            {
+                CompositeLayer.IsArray    = true;
+                CompositeLayer.HasMotion  = !Layer.MotionPath.empty();
+                CompositeLayer.CellWidth  = 1.0f / Layer.Columns;
+                CompositeLayer.CellHeight = 1.0f / Layer.Rows;
+            }
+            voLayers.push_back(CompositeLayer);
+        }
+        return !HasSprites && buildCompositeShader(voLayers, ClearColor, MinTextureUnits, voShader);
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+#include "CompositeShader.h"
+#include "QualityTier.h"
+#include "SceneDescription.h"
+
+namespace hiveVG::tools
+{
+    /*!
+     * The composite the renderer builds on vTier from vLayers with array sequences, each of vGroups sampled as one layer
+     * and layers with a render scale below 1 from their reduced targets. voLayers is filled either way, false if a
+     * sprite layer keeps the scene a pass per layer.
+     */
+    bool buildSceneComposite(const std::vector<SSceneLayer> &vLayers, const std::vector<SStaticLayerGroup> &vGroups, EQualityTier vTier,
+                             std::vector<SCompositeLayer> &voLayers, SCompositeShader &voShader);
+}
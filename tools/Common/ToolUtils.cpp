@@ -0,0 +1,151 @@
+#include "ToolUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace hiveVG::tools
+{
+    namespace
+    {
+        void appendBE32(std::vector<uint8_t> &vioBytes, uint32_t vValue)
+        {
+            for (int Shift = 24; Shift >= 0; Shift -= 8) vioBytes.push_back(static_cast<uint8_t>(vValue >> Shift));
+        }
+
+        uint32_t computeCrc32(const uint8_t *vData, size_t vSize)
+        {
+            static const std::vector<uint32_t> Table = []() {
+                std::vector<uint32_t> Entries(256);
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    uint32_t Value = i;
+                    for (int Bit = 0; Bit < 8; ++Bit) Value = (Value & 1) ? 0xEDB88320u ^ (Value >> 1) : Value >> 1;
+                    Entries[i] = Value;
+                }
+                return Entries;
+            }();
+            uint32_t Crc = 0xFFFFFFFFu;
+            for (size_t i = 0; i < vSize; ++i) Crc = Table[(Crc ^ vData[i]) & 0xFF] ^ (Crc >> 8);
+            return Crc ^ 0xFFFFFFFFu;
+        }
+
+        void appendPngChunk(std::vector<uint8_t> &vioPng, const char *vType, const std::vector<uint8_t> &vData)
+        {
+            appendBE32(vioPng, static_cast<uint32_t>(vData.size()));
+            const size_t TypeStart = vioPng.size();
+            vioPng.insert(vioPng.end(), vType, vType + 4);
+            vioPng.insert(vioPng.end(), vData.begin(), vData.end());
+            appendBE32(vioPng, computeCrc32(vioPng.data() + TypeStart, vioPng.size() - TypeStart));
+        }
+    }
+
+    bool readFileBytes(const std::string &vPath, std::vector<uint8_t> &voBytes)
+    {
+        std::ifstream File(vPath, std::ios::binary);
+        if (!File) return false;
+        voBytes.assign(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+        return !voBytes.empty();
+    }
+
+    bool writeFileBytes(const std::string &vPath, const std::vector<uint8_t> &vBytes)
+    {
+        std::ofstream File(vPath, std::ios::binary | std::ios::trunc);
+        if (!File) return false;
+        File.write(reinterpret_cast<const char *>(vBytes.data()), static_cast<std::streamsize>(vBytes.size()));
+        return static_cast<bool>(File);
+    }
+
+    double elapsedMs(std::chrono::steady_clock::time_point vStart)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - vStart).count();
+    }
+
+    bool parseGrid(const char *vText, int &voRows, int &voColumns)
+    {
+        return std::sscanf(vText, "%dx%d", &voRows, &voColumns) == 2 && voRows > 0 && voColumns > 0;
+    }
+
+    size_t defaultThreadCount()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    void parallelFor(size_t vCount, size_t vThreadCount, const std::function<void(size_t)> &vTask)
+    {
+        std::atomic<size_t> NextIndex{0};
+        const auto Worker = [&]() {
+            for (size_t i = NextIndex++; i < vCount; i = NextIndex++) vTask(i);
+        };
+        std::vector<std::thread> Threads;
+        for (size_t i = 1; i < std::min(vThreadCount, vCount); ++i) Threads.emplace_back(Worker);
+        Worker();
+        for (auto &Thread : Threads) Thread.join();
+    }
+
+    std::vector<SImageData> sliceGridFrames(const SImageData &vAtlas, int vRows, int vColumns)
+    {
+        const int FrameWidth = vAtlas.Width / vColumns, FrameHeight = vAtlas.Height / vRows;
+        std::vector<SImageData> Frames(static_cast<size_t>(vRows) * vColumns);
+        for (int Row = 0; Row < vRows; ++Row)
+        {
+            for (int Column = 0; Column < vColumns; ++Column)
+            {
+                SImageData &Frame = Frames[static_cast<size_t>(Row) * vColumns + Column];
+                Frame.Width  = FrameWidth;
+                Frame.Height = FrameHeight;
+                Frame.Pixels.resize(Frame.getByteSize());
+                for (int y = 0; y < FrameHeight; ++y)
+                    std::memcpy(Frame.Pixels.data() + Frame.getRowPitch() * y,
+                                vAtlas.Pixels.data() + vAtlas.getRowPitch() * (Row * FrameHeight + y) + static_cast<size_t>(Column) * Frame.getRowPitch(),
+                                Frame.getRowPitch());
+            }
+        }
+        return Frames;
+    }
+
+    std::vector<uint8_t> encodePngStored(const SImageData &vImage)
+    {
+        // Scanlines with filter type 0, wrapped in a zlib stream of stored blocks of at most 65535 bytes
+        std::vector<uint8_t> Raw;
+        Raw.reserve(static_cast<size_t>(vImage.Height) * (vImage.getRowPitch() + 1));
+        for (int y = 0; y < vImage.Height; ++y)
+        {
+            Raw.push_back(0);
+            const uint8_t *pRow = vImage.Pixels.data() + vImage.getRowPitch() * y;
+            Raw.insert(Raw.end(), pRow, pRow + vImage.getRowPitch());
+        }
+        std::vector<uint8_t> Zlib = {0x78, 0x01};
+        for (size_t Offset = 0; Offset < Raw.size(); Offset += 65535)
+        {
+            const size_t Length = std::min<size_t>(Raw.size() - Offset, 65535);
+            Zlib.push_back(Offset + Length == Raw.size() ? 1 : 0);
+            for (uint16_t Value : {static_cast<uint16_t>(Length), static_cast<uint16_t>(~Length)})
+            {
+                Zlib.push_back(static_cast<uint8_t>(Value));
+                Zlib.push_back(static_cast<uint8_t>(Value >> 8));
+            }
+            Zlib.insert(Zlib.end(), Raw.begin() + static_cast<std::ptrdiff_t>(Offset), Raw.begin() + static_cast<std::ptrdiff_t>(Offset + Length));
+        }
+        uint32_t A = 1, B = 0;
+        for (uint8_t Byte : Raw)
+        {
+            A = (A + Byte) % 65521;
+            B = (B + A) % 65521;
+        }
+        appendBE32(Zlib, (B << 16) | A);
+
+        std::vector<uint8_t> Header;
+        appendBE32(Header, static_cast<uint32_t>(vImage.Width));
+        appendBE32(Header, static_cast<uint32_t>(vImage.Height));
+        Header.insert(Header.end(), {8, 6, 0, 0, 0});   // 8 bit RGBA, deflate, adaptive filters, no interlace
+        std::vector<uint8_t> Png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        appendPngChunk(Png, "IHDR", Header);
+        appendPngChunk(Png, "IDAT", Zlib);
+        appendPngChunk(Png, "IEND", {});
+        return Png;
+    }
+}
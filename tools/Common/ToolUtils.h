@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ImageData.h"
+
+namespace hiveVG::tools
+{
+    bool   readFileBytes(const std::string &vPath, std::vector<uint8_t> &voBytes);
+    bool   writeFileBytes(const std::string &vPath, const std::vector<uint8_t> &vBytes);
+    double elapsedMs(std::chrono::steady_clock::time_point vStart);
+    // Parses "8x16" style grid arguments into rows and columns.
+    bool   parseGrid(const char *vText, int &voRows, int &voColumns);
+    size_t defaultThreadCount();
+    // Cuts a vRows x vColumns grid atlas into its frames in row major order, the order the runtime plays them in.
+    std::vector<SImageData> sliceGridFrames(const SImageData &vAtlas, int vRows, int vColumns);
+    // RGBA8 PNG with stored (uncompressed) deflate blocks, the APK's zip compression does the squeezing.
+    std::vector<uint8_t> encodePngStored(const SImageData &vImage);
+    // Runs vTask(i) for i in [0, vCount) on vThreadCount threads pulling indices from a shared counter.
+    void   parallelFor(size_t vCount, size_t vThreadCount, const std::function<void(size_t)> &vTask);
+}
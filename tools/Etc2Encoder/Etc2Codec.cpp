@@ -0,0 +1,464 @@
+#include "Etc2Codec.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace hiveVG::tools
+{
+    namespace
+    {
+        // ETC1 intensity modifiers, selector order is +a, +b, -a, -b.
+        constexpr int EtcModifierTable[8][4] = {
+            {2, 8, -2, -8}, {5, 17, -5, -17}, {9, 29, -9, -29}, {13, 42, -13, -42},
+            {18, 60, -18, -60}, {24, 80, -24, -80}, {33, 106, -33, -106}, {47, 183, -47, -183}};
+
+        constexpr int EacModifierTable[16][8] = {
+            {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+            {-2, -4, -6, -13, 1, 3, 5, 12}, {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10},
+            {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10}, {-2, -6, -8, -10, 1, 5, 7, 9},
+            {-2, -5, -8, -10, 1, 4, 7, 9}, {-2, -4, -8, -10, 1, 3, 7, 9}, {-2, -5, -7, -10, 1, 4, 6, 9},
+            {-3, -4, -7, -10, 2, 3, 6, 9}, {-1, -2, -3, -10, 0, 1, 2, 9}, {-4, -6, -8, -9, 3, 5, 7, 8},
+            {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+        struct SSubblock
+        {
+            alignas(16) int16_t R[8];
+            alignas(16) int16_t G[8];
+            alignas(16) int16_t B[8];
+            int Positions[8];          // ETC pixel position x * 4 + y
+            float Average[3];
+        };
+
+        struct SSubblockFit
+        {
+            int      Base[3]  = {0, 0, 0};   // quantized, 4 or 5 bits
+            int      Table    = 0;
+            uint32_t Error    = UINT32_MAX;
+        };
+
+        int clamp255(int vValue) { return std::clamp(vValue, 0, 255); }
+        int expand4(int vValue) { return (vValue << 4) | vValue; }
+        int expand5(int vValue) { return (vValue << 3) | (vValue >> 2); }
+
+        void gatherSubblocks(const uint8_t vTexels[64], bool vIsFlipped, SSubblock voSubblocks[2])
+        {
+            int Counts[2] = {0, 0};
+            float Sums[2][3] = {};
+            for (int y = 0; y < 4; ++y)
+            {
+                for (int x = 0; x < 4; ++x)
+                {
+                    const int Subblock = vIsFlipped ? y / 2 : x / 2;
+                    const uint8_t *pTexel = &vTexels[(y * 4 + x) * 4];
+                    SSubblock &Target = voSubblocks[Subblock];
+                    const int Slot = Counts[Subblock]++;
+                    Target.R[Slot] = pTexel[0];
+                    Target.G[Slot] = pTexel[1];
+                    Target.B[Slot] = pTexel[2];
+                    Target.Positions[Slot] = x * 4 + y;
+                    for (int c = 0; c < 3; ++c) Sums[Subblock][c] += pTexel[c];
+                }
+            }
+            for (int s = 0; s < 2; ++s)
+                for (int c = 0; c < 3; ++c) voSubblocks[s].Average[c] = Sums[s][c] / 8.0f;
+        }
+
+        [[maybe_unused]] uint32_t evaluateTableScalar(const SSubblock &vSubblock, const int vColor[3], int vTable)
+        {
+            uint32_t Error = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                uint32_t Best = UINT32_MAX;
+                for (int m = 0; m < 4; ++m)
+                {
+                    const int Modifier = EtcModifierTable[vTable][m];
+                    const int dR = vSubblock.R[i] - clamp255(vColor[0] + Modifier);
+                    const int dG = vSubblock.G[i] - clamp255(vColor[1] + Modifier);
+                    const int dB = vSubblock.B[i] - clamp255(vColor[2] + Modifier);
+                    Best = std::min(Best, static_cast<uint32_t>(dR * dR + dG * dG + dB * dB));
+                }
+                Error += Best;
+            }
+            return Error;
+        }
+
+#if defined(__SSE2__)
+        uint32_t evaluateTableSSE2(const SSubblock &vSubblock, const int vColor[3], int vTable)
+        {
+            const __m128i R = _mm_load_si128(reinterpret_cast<const __m128i *>(vSubblock.R));
+            const __m128i G = _mm_load_si128(reinterpret_cast<const __m128i *>(vSubblock.G));
+            const __m128i B = _mm_load_si128(reinterpret_cast<const __m128i *>(vSubblock.B));
+            const __m128i Zero = _mm_setzero_si128();
+            __m128i BestLo = _mm_set1_epi32(INT_MAX);
+            __m128i BestHi = BestLo;
+            for (int m = 0; m < 4; ++m)
+            {
+                const int Modifier = EtcModifierTable[vTable][m];
+                const __m128i dR = _mm_sub_epi16(R, _mm_set1_epi16(static_cast<int16_t>(clamp255(vColor[0] + Modifier))));
+                const __m128i dG = _mm_sub_epi16(G, _mm_set1_epi16(static_cast<int16_t>(clamp255(vColor[1] + Modifier))));
+                const __m128i dB = _mm_sub_epi16(B, _mm_set1_epi16(static_cast<int16_t>(clamp255(vColor[2] + Modifier))));
+                // madd on (dR, dG) pairs gives dR^2 + dG^2 per texel in 32 bits, (dB, 0) pairs give dB^2.
+                const __m128i RGLo = _mm_unpacklo_epi16(dR, dG), RGHi = _mm_unpackhi_epi16(dR, dG);
+                const __m128i BLo  = _mm_unpacklo_epi16(dB, Zero), BHi = _mm_unpackhi_epi16(dB, Zero);
+                const __m128i ErrLo = _mm_add_epi32(_mm_madd_epi16(RGLo, RGLo), _mm_madd_epi16(BLo, BLo));
+                const __m128i ErrHi = _mm_add_epi32(_mm_madd_epi16(RGHi, RGHi), _mm_madd_epi16(BHi, BHi));
+                const __m128i IsLowerLo = _mm_cmplt_epi32(ErrLo, BestLo);
+                const __m128i IsLowerHi = _mm_cmplt_epi32(ErrHi, BestHi);
+                BestLo = _mm_or_si128(_mm_and_si128(IsLowerLo, ErrLo), _mm_andnot_si128(IsLowerLo, BestLo));
+                BestHi = _mm_or_si128(_mm_and_si128(IsLowerHi, ErrHi), _mm_andnot_si128(IsLowerHi, BestHi));
+            }
+            __m128i Sum = _mm_add_epi32(BestLo, BestHi);
+            Sum = _mm_add_epi32(Sum, _mm_shuffle_epi32(Sum, _MM_SHUFFLE(1, 0, 3, 2)));
+            Sum = _mm_add_epi32(Sum, _mm_shuffle_epi32(Sum, _MM_SHUFFLE(2, 3, 0, 1)));
+            return static_cast<uint32_t>(_mm_cvtsi128_si32(Sum));
+        }
+#endif
+
+        uint32_t evaluateTable(const SSubblock &vSubblock, const int vColor[3], int vTable)
+        {
+#if defined(__SSE2__)
+            return evaluateTableSSE2(vSubblock, vColor, vTable);
+#else
+            return evaluateTableScalar(vSubblock, vColor, vTable);
+#endif
+        }
+
+        // Best table for one quantized base color, vBits is 4 (individual) or 5 (differential).
+        SSubblockFit fitBaseColor(const SSubblock &vSubblock, const int vBase[3], int vBits)
+        {
+            SSubblockFit Fit;
+            std::copy(vBase, vBase + 3, Fit.Base);
+            int Color[3];
+            for (int c = 0; c < 3; ++c) Color[c] = vBits == 4 ? expand4(vBase[c]) : expand5(vBase[c]);
+            for (int Table = 0; Table < 8; ++Table)
+            {
+                const uint32_t Error = evaluateTable(vSubblock, Color, Table);
+                if (Error < Fit.Error)
+                {
+                    Fit.Error = Error;
+                    Fit.Table = Table;
+                }
+            }
+            return Fit;
+        }
+
+        // Quantized base colors to try for a subblock: the rounded average, plus its +-1 neighbourhood for Normal effort.
+        std::vector<SSubblockFit> fitCandidates(const SSubblock &vSubblock, int vBits, EEtcEffort vEffort)
+        {
+            const int MaxValue = (1 << vBits) - 1;
+            int Rounded[3];
+            for (int c = 0; c < 3; ++c)
+                Rounded[c] = std::clamp(static_cast<int>(std::lround(vSubblock.Average[c] * MaxValue / 255.0f)), 0, MaxValue);
+
+            std::vector<SSubblockFit> Fits;
+            const int Radius = vEffort == EEtcEffort::Normal ? 1 : 0;
+            for (int dR = -Radius; dR <= Radius; ++dR)
+                for (int dG = -Radius; dG <= Radius; ++dG)
+                    for (int dB = -Radius; dB <= Radius; ++dB)
+                    {
+                        const int Base[3] = {Rounded[0] + dR, Rounded[1] + dG, Rounded[2] + dB};
+                        if (std::any_of(Base, Base + 3, [MaxValue](int v) { return v < 0 || v > MaxValue; })) continue;
+                        Fits.push_back(fitBaseColor(vSubblock, Base, vBits));
+                    }
+            return Fits;
+        }
+
+        struct SBlockChoice
+        {
+            bool         IsFlipped      = false;
+            bool         IsDifferential = false;
+            SSubblockFit Fits[2];
+            uint32_t     Error          = UINT32_MAX;
+        };
+
+        uint32_t computeSelectors(const SSubblock &vSubblock, const int vColor[3], int vTable, uint32_t &vioMsb, uint32_t &vioLsb)
+        {
+            uint32_t Error = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                uint32_t Best = UINT32_MAX;
+                int BestSelector = 0;
+                for (int m = 0; m < 4; ++m)
+                {
+                    const int Modifier = EtcModifierTable[vTable][m];
+                    const int dR = vSubblock.R[i] - clamp255(vColor[0] + Modifier);
+                    const int dG = vSubblock.G[i] - clamp255(vColor[1] + Modifier);
+                    const int dB = vSubblock.B[i] - clamp255(vColor[2] + Modifier);
+                    const uint32_t Error = static_cast<uint32_t>(dR * dR + dG * dG + dB * dB);
+                    if (Error < Best)
+                    {
+                        Best = Error;
+                        BestSelector = m;
+                    }
+                }
+                vioMsb |= static_cast<uint32_t>(BestSelector >> 1) << vSubblock.Positions[i];
+                vioLsb |= static_cast<uint32_t>(BestSelector & 1) << vSubblock.Positions[i];
+                Error += Best;
+            }
+            return Error;
+        }
+
+        void writeBigEndian64(uint64_t vValue, uint8_t voBytes[8])
+        {
+            for (int i = 0; i < 8; ++i) voBytes[i] = static_cast<uint8_t>(vValue >> (56 - 8 * i));
+        }
+
+        uint64_t readBigEndian64(const uint8_t vBytes[8])
+        {
+            uint64_t Value = 0;
+            for (int i = 0; i < 8; ++i) Value = (Value << 8) | vBytes[i];
+            return Value;
+        }
+
+        int decodeEacValue(int vBase, int vMultiplier, int vModifier, bool vIsR11)
+        {
+            if (vIsR11)
+                return std::clamp(vBase * 8 + 4 + vModifier * vMultiplier * 8, 0, 2047);
+            return clamp255(vBase + vModifier * vMultiplier);
+        }
+    }
+
+    void encodeEtc1RgbBlock(const uint8_t vTexels[64], EEtcEffort vEffort, uint8_t voBlock[8])
+    {
+        SBlockChoice Best;
+        for (int Flip = 0; Flip < 2; ++Flip)
+        {
+            SSubblock Subblocks[2];
+            gatherSubblocks(vTexels, Flip != 0, Subblocks);
+
+            for (int Mode = 0; Mode < 2; ++Mode)
+            {
+                const int Bits = Mode == 0 ? 4 : 5;
+                std::vector<SSubblockFit> Candidates[2] = {fitCandidates(Subblocks[0], Bits, vEffort), fitCandidates(Subblocks[1], Bits, vEffort)};
+                if (Mode == 0)
+                {
+                    // Individual mode: two independent 444 colors.
+                    const auto ByError = [](const SSubblockFit &vLhs, const SSubblockFit &vRhs) { return vLhs.Error < vRhs.Error; };
+                    const SSubblockFit &First = *std::min_element(Candidates[0].begin(), Candidates[0].end(), ByError);
+                    const SSubblockFit &Second = *std::min_element(Candidates[1].begin(), Candidates[1].end(), ByError);
+                    const uint32_t Error = First.Error + Second.Error;
+                    if (Error < Best.Error) Best = {Flip != 0, false, {First, Second}, Error};
+                    continue;
+                }
+
+                // Differential mode: 555 base plus a 333 signed delta. The delta must stay in range,
+                // otherwise an ETC2 decoder would read the block as T, H or planar mode.
+                for (const auto &First : Candidates[0])
+                {
+                    for (const auto &Second : Candidates[1])
+                    {
+                        bool IsRepresentable = true;
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            const int Delta = Second.Base[c] - First.Base[c];
+                            IsRepresentable = IsRepresentable && Delta >= -4 && Delta <= 3;
+                        }
+                        const uint32_t Error = First.Error + Second.Error;
+                        if (IsRepresentable && Error < Best.Error) Best = {Flip != 0, true, {First, Second}, Error};
+                    }
+                }
+            }
+        }
+
+        SSubblock Subblocks[2];
+        gatherSubblocks(vTexels, Best.IsFlipped, Subblocks);
+        uint32_t Msb = 0, Lsb = 0;
+        uint64_t Bits = 0;
+        for (int s = 0; s < 2; ++s)
+        {
+            int Color[3];
+            for (int c = 0; c < 3; ++c)
+                Color[c] = Best.IsDifferential ? expand5(Best.Fits[s].Base[c]) : expand4(Best.Fits[s].Base[c]);
+            computeSelectors(Subblocks[s], Color, Best.Fits[s].Table, Msb, Lsb);
+        }
+
+        const SSubblockFit &First = Best.Fits[0], &Second = Best.Fits[1];
+        if (Best.IsDifferential)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                const int Shift = 59 - c * 8;
+                Bits |= static_cast<uint64_t>(First.Base[c]) << Shift;
+                Bits |= static_cast<uint64_t>((Second.Base[c] - First.Base[c]) & 7) << (Shift - 3);
+            }
+            Bits |= 1ull << 33;
+        }
+        else
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                const int Shift = 60 - c * 8;
+                Bits |= static_cast<uint64_t>(First.Base[c]) << Shift;
+                Bits |= static_cast<uint64_t>(Second.Base[c]) << (Shift - 4);
+            }
+        }
+        Bits |= static_cast<uint64_t>(First.Table) << 37;
+        Bits |= static_cast<uint64_t>(Second.Table) << 34;
+        Bits |= static_cast<uint64_t>(Best.IsFlipped ? 1 : 0) << 32;
+        Bits |= static_cast<uint64_t>(Msb) << 16;
+        Bits |= Lsb;
+        writeBigEndian64(Bits, voBlock);
+    }
+
+    void encodeEacBlock(const uint8_t vValues[16], bool vIsR11, uint8_t voBlock[8])
+    {
+        // Targets live in the decoded domain, 8 bits for alpha and 11 bits for R11.
+        float Targets[16];
+        float Min = 1e9f, Max = -1e9f;
+        for (int i = 0; i < 16; ++i)
+        {
+            Targets[i] = vIsR11 ? vValues[i] * 2047.0f / 255.0f : vValues[i];
+            Min = std::min(Min, Targets[i]);
+            Max = std::max(Max, Targets[i]);
+        }
+        const float Scale = vIsR11 ? 8.0f : 1.0f;
+
+        float BestError = 1e30f;
+        int BestBase = 0, BestMultiplier = 1, BestTable = 0;
+        for (int Table = 0; Table < 16; ++Table)
+        {
+            const int TableMin = EacModifierTable[Table][3], TableMax = EacModifierTable[Table][7];
+            const float Span = static_cast<float>(TableMax - TableMin);
+            const int IdealMultiplier = std::clamp(static_cast<int>(std::lround((Max - Min) / (Span * Scale))), 1, 15);
+            for (int Multiplier = std::max(IdealMultiplier - 1, 1); Multiplier <= std::min(IdealMultiplier + 1, 15); ++Multiplier)
+            {
+                const float Center = (Min + Max) * 0.5f - (TableMin + TableMax) * 0.5f * Multiplier * Scale;
+                const int IdealBase = static_cast<int>(std::lround(vIsR11 ? (Center - 4.0f) / 8.0f : Center));
+                for (int Base = std::max(IdealBase - 1, 0); Base <= std::min(IdealBase + 1, 255); ++Base)
+                {
+                    float Error = 0.0f;
+                    for (int i = 0; i < 16 && Error < BestError; ++i)
+                    {
+                        float PixelBest = 1e30f;
+                        for (int m = 0; m < 8; ++m)
+                        {
+                            const float Delta = decodeEacValue(Base, Multiplier, EacModifierTable[Table][m], vIsR11) - Targets[i];
+                            PixelBest = std::min(PixelBest, Delta * Delta);
+                        }
+                        Error += PixelBest;
+                    }
+                    if (Error < BestError)
+                    {
+                        BestError = Error;
+                        BestBase = Base;
+                        BestMultiplier = Multiplier;
+                        BestTable = Table;
+                    }
+                }
+            }
+        }
+
+        uint64_t Bits = static_cast<uint64_t>(BestBase) << 56 | static_cast<uint64_t>(BestMultiplier) << 52 | static_cast<uint64_t>(BestTable) << 48;
+        for (int y = 0; y < 4; ++y)
+        {
+            for (int x = 0; x < 4; ++x)
+            {
+                const float Target = Targets[y * 4 + x];
+                int BestIndex = 0;
+                float PixelBest = 1e30f;
+                for (int m = 0; m < 8; ++m)
+                {
+                    const float Delta = decodeEacValue(BestBase, BestMultiplier, EacModifierTable[BestTable][m], vIsR11) - Target;
+                    if (Delta * Delta < PixelBest)
+                    {
+                        PixelBest = Delta * Delta;
+                        BestIndex = m;
+                    }
+                }
+                Bits |= static_cast<uint64_t>(BestIndex) << (45 - 3 * (x * 4 + y));
+            }
+        }
+        writeBigEndian64(Bits, voBlock);
+    }
+
+    void encodeEtc2Rgba8Block(const uint8_t vTexels[64], EEtcEffort vEffort, uint8_t voBlock[16])
+    {
+        uint8_t Alpha[16];
+        for (int i = 0; i < 16; ++i) Alpha[i] = vTexels[i * 4 + 3];
+        encodeEacBlock(Alpha, false, voBlock);
+        encodeEtc1RgbBlock(vTexels, vEffort, voBlock + 8);
+    }
+
+    void decodeEtc1RgbBlock(const uint8_t vBlock[8], uint8_t voTexels[64])
+    {
+        const uint64_t Bits = readBigEndian64(vBlock);
+        const bool IsDifferential = (Bits >> 33) & 1;
+        const bool IsFlipped = (Bits >> 32) & 1;
+        int Colors[2][3];
+        for (int c = 0; c < 3; ++c)
+        {
+            if (IsDifferential)
+            {
+                const int Shift = 59 - c * 8;
+                const int Base = static_cast<int>((Bits >> Shift) & 31);
+                int Delta = static_cast<int>((Bits >> (Shift - 3)) & 7);
+                if (Delta >= 4) Delta -= 8;
+                if (Base + Delta < 0 || Base + Delta > 31)
+                {
+                    // T, H or planar block, never written by this encoder.
+                    for (int i = 0; i < 16; ++i) { voTexels[i * 4] = 255; voTexels[i * 4 + 1] = 0; voTexels[i * 4 + 2] = 255; }
+                    return;
+                }
+                Colors[0][c] = expand5(Base);
+                Colors[1][c] = expand5(Base + Delta);
+            }
+            else
+            {
+                const int Shift = 60 - c * 8;
+                Colors[0][c] = expand4(static_cast<int>((Bits >> Shift) & 15));
+                Colors[1][c] = expand4(static_cast<int>((Bits >> (Shift - 4)) & 15));
+            }
+        }
+        const int Tables[2] = {static_cast<int>((Bits >> 37) & 7), static_cast<int>((Bits >> 34) & 7)};
+        for (int y = 0; y < 4; ++y)
+        {
+            for (int x = 0; x < 4; ++x)
+            {
+                const int Subblock = IsFlipped ? y / 2 : x / 2;
+                const int Position = x * 4 + y;
+                const int Selector = static_cast<int>(((Bits >> (16 + Position)) & 1) << 1 | ((Bits >> Position) & 1));
+                const int Modifier = EtcModifierTable[Tables[Subblock]][Selector];
+                for (int c = 0; c < 3; ++c)
+                    voTexels[(y * 4 + x) * 4 + c] = static_cast<uint8_t>(clamp255(Colors[Subblock][c] + Modifier));
+            }
+        }
+    }
+
+    void decodeEacBlock(const uint8_t vBlock[8], bool vIsR11, uint8_t voValues[16])
+    {
+        const uint64_t Bits = readBigEndian64(vBlock);
+        const int Base = static_cast<int>(Bits >> 56);
+        const int Multiplier = static_cast<int>((Bits >> 52) & 15);
+        const int Table = static_cast<int>((Bits >> 48) & 15);
+        for (int y = 0; y < 4; ++y)
+        {
+            for (int x = 0; x < 4; ++x)
+            {
+                const int Index = static_cast<int>((Bits >> (45 - 3 * (x * 4 + y))) & 7);
+                const int Value = decodeEacValue(Base, Multiplier, EacModifierTable[Table][Index], vIsR11);
+                voValues[y * 4 + x] = static_cast<uint8_t>(vIsR11 ? (Value * 255 + 1023) / 2047 : Value);
+            }
+        }
+    }
+
+    void decodeEtc2Rgba8Block(const uint8_t vBlock[16], uint8_t voTexels[64])
+    {
+        uint8_t Alpha[16];
+        decodeEacBlock(vBlock, false, Alpha);
+        decodeEtc1RgbBlock(vBlock + 8, voTexels);
+        for (int i = 0; i < 16; ++i) voTexels[i * 4 + 3] = Alpha[i];
+    }
+
+    const char *getEtcSearchKernelName()
+    {
+#if defined(__SSE2__)
+        return "SSE2";
+#else
+        return "scalar";
+#endif
+    }
+}
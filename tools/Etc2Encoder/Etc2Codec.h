@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace hiveVG::tools
+{
+    enum class EEtcEffort
+    {
+        Fast,     // rounded subblock averages only
+        Normal    // also searches the +-1 neighbourhood of every quantized base color
+    };
+
+    // A 4x4 block is passed as 16 RGBA8 texels in row-major order.
+    void encodeEtc2Rgba8Block(const uint8_t vTexels[64], EEtcEffort vEffort, uint8_t voBlock[16]);
+    void encodeEtc1RgbBlock(const uint8_t vTexels[64], EEtcEffort vEffort, uint8_t voBlock[8]);
+    // Encodes 16 8-bit values into an EAC block, vIsR11 selects EAC R11 rather than the RGBA8 alpha half.
+    void encodeEacBlock(const uint8_t vValues[16], bool vIsR11, uint8_t voBlock[8]);
+
+    // Decoders for the subset the encoder emits (ETC1 individual/differential colors, EAC), used for PSNR.
+    void decodeEtc1RgbBlock(const uint8_t vBlock[8], uint8_t voTexels[64]);
+    void decodeEacBlock(const uint8_t vBlock[8], bool vIsR11, uint8_t voValues[16]);
+    void decodeEtc2Rgba8Block(const uint8_t vBlock[16], uint8_t voTexels[64]);
+
+    // Name of the block search kernel compiled in, for the report.
+    const char *getEtcSearchKernelName();
+}
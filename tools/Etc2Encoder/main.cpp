@@ -0,0 +1,246 @@
+// Offline ETC2 RGBA8 / EAC R11 encoder for sequence atlases, writes KTX2 files read by CTextureAsset.
+// Usage: etc2Encoder <input.png|jpg> <output.ktx2> [--format rgba8|r11] [--channel r|a] [--premultiply]
+//                    [--mips] [--grid RxC] [--effort fast|normal] [--threads N]
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Etc2Codec.h"
+#include "ImageDecoder.h"
+#include "MipChain.h"
+#include "../Common/Ktx2Writer.h"
+#include "../Common/ToolUtils.h"
+
+namespace
+{
+    constexpr uint32_t VkFormatEtc2Rgba8 = 151;
+    constexpr uint32_t VkFormatEacR11    = 153;
+
+    struct SEncoderOptions
+    {
+        std::string            InputPath;
+        std::string            OutputPath;
+        bool                   IsR11          = false;
+        int                    SourceChannel  = 3;
+        bool                   IsPremultiplied = false;
+        bool                   HasMips        = false;
+        int                    GridRows       = 1;
+        int                    GridColumns    = 1;
+        hiveVG::tools::EEtcEffort Effort      = hiveVG::tools::EEtcEffort::Normal;
+        size_t                 ThreadCount    = hiveVG::tools::defaultThreadCount();
+    };
+
+    bool parseOptions(int vArgc, char **vArgv, SEncoderOptions &voOptions)
+    {
+        std::vector<std::string> Positionals;
+        for (int i = 1; i < vArgc; ++i)
+        {
+            const char *pArg = vArgv[i];
+            const bool HasValue = i + 1 < vArgc;
+            if (std::strcmp(pArg, "--format") == 0 && HasValue) voOptions.IsR11 = std::strcmp(vArgv[++i], "r11") == 0;
+            else if (std::strcmp(pArg, "--channel") == 0 && HasValue) voOptions.SourceChannel = std::strcmp(vArgv[++i], "r") == 0 ? 0 : 3;
+            else if (std::strcmp(pArg, "--premultiply") == 0) voOptions.IsPremultiplied = true;
+            else if (std::strcmp(pArg, "--mips") == 0) voOptions.HasMips = true;
+            else if (std::strcmp(pArg, "--grid") == 0 && HasValue)
+            {
+                if (!hiveVG::tools::parseGrid(vArgv[++i], voOptions.GridRows, voOptions.GridColumns)) return false;
+            }
+            else if (std::strcmp(pArg, "--effort") == 0 && HasValue)
+                voOptions.Effort = std::strcmp(vArgv[++i], "fast") == 0 ? hiveVG::tools::EEtcEffort::Fast : hiveVG::tools::EEtcEffort::Normal;
+            else if (std::strcmp(pArg, "--threads") == 0 && HasValue) voOptions.ThreadCount = std::strtoul(vArgv[++i], nullptr, 10);
+            else Positionals.emplace_back(pArg);
+        }
+        if (Positionals.size() != 2) return false;
+        voOptions.InputPath  = Positionals[0];
+        voOptions.OutputPath = Positionals[1];
+        return true;
+    }
+
+    void premultiplyAlpha(hiveVG::SImageData &vioImage)
+    {
+        for (size_t i = 0; i < vioImage.Pixels.size(); i += 4)
+        {
+            const uint32_t Alpha = vioImage.Pixels[i + 3];
+            for (int c = 0; c < 3; ++c)
+                vioImage.Pixels[i + c] = static_cast<uint8_t>((vioImage.Pixels[i + c] * Alpha + 127) / 255);
+        }
+    }
+
+    // Copies a 4x4 block, texels past the image edge repeat the last row/column.
+    void fetchBlock(const hiveVG::SImageData &vImage, int vBlockX, int vBlockY, uint8_t voTexels[64])
+    {
+        for (int y = 0; y < 4; ++y)
+        {
+            const int SourceY = std::min(vBlockY * 4 + y, vImage.Height - 1);
+            for (int x = 0; x < 4; ++x)
+            {
+                const int SourceX = std::min(vBlockX * 4 + x, vImage.Width - 1);
+                std::memcpy(&voTexels[(y * 4 + x) * 4], &vImage.Pixels[(static_cast<size_t>(SourceY) * vImage.Width + SourceX) * 4], 4);
+            }
+        }
+    }
+
+    std::vector<uint8_t> encodeLevel(const hiveVG::SImageData &vImage, const SEncoderOptions &vOptions)
+    {
+        const int BlocksX = (vImage.Width + 3) / 4, BlocksY = (vImage.Height + 3) / 4;
+        const size_t BlockBytes = vOptions.IsR11 ? 8 : 16;
+        std::vector<uint8_t> Blocks(static_cast<size_t>(BlocksX) * BlocksY * BlockBytes);
+        hiveVG::tools::parallelFor(static_cast<size_t>(BlocksY), vOptions.ThreadCount, [&](size_t vBlockY) {
+            uint8_t Texels[64];
+            for (int BlockX = 0; BlockX < BlocksX; ++BlockX)
+            {
+                fetchBlock(vImage, BlockX, static_cast<int>(vBlockY), Texels);
+                uint8_t *pBlock = &Blocks[(vBlockY * BlocksX + BlockX) * BlockBytes];
+                if (vOptions.IsR11)
+                {
+                    uint8_t Values[16];
+                    for (int i = 0; i < 16; ++i) Values[i] = Texels[i * 4 + vOptions.SourceChannel];
+                    hiveVG::tools::encodeEacBlock(Values, true, pBlock);
+                }
+                else
+                    hiveVG::tools::encodeEtc2Rgba8Block(Texels, vOptions.Effort, pBlock);
+            }
+        });
+        return Blocks;
+    }
+
+    hiveVG::SImageData decodeLevel(const std::vector<uint8_t> &vBlocks, int vWidth, int vHeight, const SEncoderOptions &vOptions)
+    {
+        hiveVG::SImageData Image;
+        Image.Width  = vWidth;
+        Image.Height = vHeight;
+        Image.Pixels.assign(Image.getByteSize(), 0);
+        const int BlocksX = (vWidth + 3) / 4, BlocksY = (vHeight + 3) / 4;
+        const size_t BlockBytes = vOptions.IsR11 ? 8 : 16;
+        for (int BlockY = 0; BlockY < BlocksY; ++BlockY)
+        {
+            for (int BlockX = 0; BlockX < BlocksX; ++BlockX)
+            {
+                const uint8_t *pBlock = &vBlocks[(static_cast<size_t>(BlockY) * BlocksX + BlockX) * BlockBytes];
+                uint8_t Texels[64] = {};
+                if (vOptions.IsR11)
+                {
+                    uint8_t Values[16];
+                    hiveVG::tools::decodeEacBlock(pBlock, true, Values);
+                    for (int i = 0; i < 16; ++i) Texels[i * 4 + vOptions.SourceChannel] = Values[i];
+                }
+                else
+                    hiveVG::tools::decodeEtc2Rgba8Block(pBlock, Texels);
+                for (int y = 0; y < 4 && BlockY * 4 + y < vHeight; ++y)
+                    for (int x = 0; x < 4 && BlockX * 4 + x < vWidth; ++x)
+                        std::memcpy(&Image.Pixels[(static_cast<size_t>(BlockY * 4 + y) * vWidth + BlockX * 4 + x) * 4], &Texels[(y * 4 + x) * 4], 4);
+            }
+        }
+        return Image;
+    }
+
+    double computePsnr(double vSquaredError, size_t vSampleCount)
+    {
+        if (vSampleCount == 0 || vSquaredError <= 0.0) return 99.0;
+        return 10.0 * std::log10(255.0 * 255.0 * vSampleCount / vSquaredError);
+    }
+
+    // PSNR of every frame cell of the atlas grid, color and alpha reported separately.
+    void reportFramePsnr(const hiveVG::SImageData &vSource, const hiveVG::SImageData &vDecoded, const SEncoderOptions &vOptions)
+    {
+        const int FrameWidth = vSource.Width / vOptions.GridColumns, FrameHeight = vSource.Height / vOptions.GridRows;
+        double WorstPsnr = 99.0, PsnrSum = 0.0;
+        for (int Row = 0; Row < vOptions.GridRows; ++Row)
+        {
+            for (int Column = 0; Column < vOptions.GridColumns; ++Column)
+            {
+                double ColorError = 0.0, AlphaError = 0.0;
+                for (int y = Row * FrameHeight; y < (Row + 1) * FrameHeight; ++y)
+                {
+                    for (int x = Column * FrameWidth; x < (Column + 1) * FrameWidth; ++x)
+                    {
+                        const size_t Offset = (static_cast<size_t>(y) * vSource.Width + x) * 4;
+                        for (int c = 0; c < 4; ++c)
+                        {
+                            if (vOptions.IsR11 && c != vOptions.SourceChannel) continue;
+                            const double Delta = static_cast<double>(vSource.Pixels[Offset + c]) - vDecoded.Pixels[Offset + c];
+                            (c == 3 ? AlphaError : ColorError) += Delta * Delta;
+                        }
+                    }
+                }
+                const size_t PixelCount = static_cast<size_t>(FrameWidth) * FrameHeight;
+                const int Frame = Row * vOptions.GridColumns + Column;
+                double FramePsnr;
+                if (vOptions.IsR11)
+                {
+                    FramePsnr = computePsnr(ColorError + AlphaError, PixelCount);
+                    std::printf("frame %4d  PSNR %6.2f dB\n", Frame, FramePsnr);
+                }
+                else
+                {
+                    const double ColorPsnr = computePsnr(ColorError, PixelCount * 3), AlphaPsnr = computePsnr(AlphaError, PixelCount);
+                    FramePsnr = std::min(ColorPsnr, AlphaPsnr);
+                    std::printf("frame %4d  PSNR rgb %6.2f dB  alpha %6.2f dB\n", Frame, ColorPsnr, AlphaPsnr);
+                }
+                WorstPsnr = std::min(WorstPsnr, FramePsnr);
+                PsnrSum += FramePsnr;
+            }
+        }
+        const int FrameCount = vOptions.GridRows * vOptions.GridColumns;
+        std::printf("%d frames, mean PSNR %.2f dB, worst %.2f dB\n", FrameCount, PsnrSum / FrameCount, WorstPsnr);
+    }
+}
+
+int main(int vArgc, char **vArgv)
+{
+    SEncoderOptions Options;
+    if (!parseOptions(vArgc, vArgv, Options))
+    {
+        std::fprintf(stderr, "Usage: %s <input.png|jpg> <output.ktx2> [--format rgba8|r11] [--channel r|a] [--premultiply]\n"
+                             "       [--mips] [--grid RxC] [--effort fast|normal] [--threads N]\n", vArgv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> FileBytes;
+    hiveVG::SImageData Source;
+    if (!hiveVG::tools::readFileBytes(Options.InputPath, FileBytes) || !hiveVG::decodeImageFromMemory(FileBytes.data(), FileBytes.size(), Source))
+    {
+        std::fprintf(stderr, "Cannot decode %s\n", Options.InputPath.c_str());
+        return 1;
+    }
+    if (Options.IsPremultiplied) premultiplyAlpha(Source);
+
+    auto StartTime = std::chrono::steady_clock::now();
+    const auto AlphaMode = Options.IsPremultiplied ? hiveVG::EAlphaMode::Premultiplied : hiveVG::EAlphaMode::Straight;
+    std::vector<hiveVG::SImageData> Levels = hiveVG::generateMipChain(Source, AlphaMode, Options.HasMips ? 0 : 1);
+    const double MipMs = hiveVG::tools::elapsedMs(StartTime);
+
+    StartTime = std::chrono::steady_clock::now();
+    hiveVG::tools::SKtx2WriteDesc Desc;
+    Desc.VkFormat       = Options.IsR11 ? VkFormatEacR11 : VkFormatEtc2Rgba8;
+    Desc.Width          = Source.Width;
+    Desc.Height         = Source.Height;
+    Desc.LevelAlignment = Options.IsR11 ? 8 : 16;
+    Desc.Dfd            = hiveVG::tools::makeEtc2Dfd(!Options.IsR11, Options.IsR11, Options.IsPremultiplied);
+    size_t RawBytes = 0, EncodedBytes = 0;
+    for (const auto &Level : Levels)
+    {
+        Desc.Levels.push_back(encodeLevel(Level, Options));
+        RawBytes     += Level.getByteSize();
+        EncodedBytes += Desc.Levels.back().size();
+    }
+    const double EncodeMs = hiveVG::tools::elapsedMs(StartTime);
+
+    if (!hiveVG::tools::writeFileBytes(Options.OutputPath, hiveVG::tools::writeKtx2(Desc)))
+    {
+        std::fprintf(stderr, "Cannot write %s\n", Options.OutputPath.c_str());
+        return 1;
+    }
+
+    hiveVG::SImageData Decoded = decodeLevel(Desc.Levels[0], Source.Width, Source.Height, Options);
+    reportFramePsnr(Source, Decoded, Options);
+    std::printf("%s %dx%d, %zu levels, %s search on %zu threads: mips %.1f ms, encode %.1f ms\n",
+                Options.IsR11 ? "EAC_R11" : "ETC2_RGBA8", Source.Width, Source.Height, Levels.size(),
+                hiveVG::tools::getEtcSearchKernelName(), Options.ThreadCount, MipMs, EncodeMs);
+    std::printf("VRAM %zu KiB -> %zu KiB (%.1fx smaller than RGBA8)\n", RawBytes / 1024, EncodedBytes / 1024,
+                static_cast<double>(RawBytes) / EncodedBytes);
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "HullBuilder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hiveVG::tools
+{
+    namespace
+    {
+        struct SPoint
+        {
+            double X = 0.0, Y = 0.0;
+        };
+
+        // Keeps the part of convex vPolygon where vA * x + vB * y <= vC
+        std::vector<SPoint> clipPolygon(const std::vector<SPoint> &vPolygon, double vA, double vB, double vC)
+        {
+            std::vector<SPoint> Clipped;
+            for (size_t i = 0; i < vPolygon.size(); ++i)
+            {
+                const SPoint &Current = vPolygon[i], &Next = vPolygon[(i + 1) % vPolygon.size()];
+                const double CurrentSide = vA * Current.X + vB * Current.Y - vC, NextSide = vA * Next.X + vB * Next.Y - vC;
+                if (CurrentSide <= 0.0) Clipped.push_back(Current);
+                if ((CurrentSide < 0.0 && NextSide > 0.0) || (CurrentSide > 0.0 && NextSide < 0.0))
+                {
+                    const double T = CurrentSide / (CurrentSide - NextSide);
+                    Clipped.push_back({Current.X + (Next.X - Current.X) * T, Current.Y + (Next.Y - Current.Y) * T});
+                }
+            }
+            return Clipped;
+        }
+
+        // Box max filter, separable
+        void dilateMask(std::vector<uint8_t> &vioMask, int vWidth, int vHeight, int vRadius)
+        {
+            if (vRadius <= 0) return;
+            std::vector<uint8_t> Pass(vioMask.size(), 0);
+            for (int y = 0; y < vHeight; ++y)
+                for (int x = 0; x < vWidth; ++x)
+                {
+                    if (!vioMask[static_cast<size_t>(y) * vWidth + x]) continue;
+                    for (int i = std::max(x - vRadius, 0); i <= std::min(x + vRadius, vWidth - 1); ++i) Pass[static_cast<size_t>(y) * vWidth + i] = 1;
+                }
+            std::fill(vioMask.begin(), vioMask.end(), 0);
+            for (int y = 0; y < vHeight; ++y)
+                for (int x = 0; x < vWidth; ++x)
+                {
+                    if (!Pass[static_cast<size_t>(y) * vWidth + x]) continue;
+                    for (int i = std::max(y - vRadius, 0); i <= std::min(y + vRadius, vHeight - 1); ++i) vioMask[static_cast<size_t>(i) * vWidth + x] = 1;
+                }
+        }
+    }
+
+    std::vector<uint8_t> computePlaybackMask(const SImageData &vFrame, const SImageData &vNextFrame, int vAlphaThreshold, int vDilation)
+    {
+        std::vector<uint8_t> Mask(static_cast<size_t>(vFrame.Width) * vFrame.Height, 0);
+        for (int y = 0; y < vFrame.Height; ++y)
+        {
+            const uint8_t *pRow = vFrame.Pixels.data() + vFrame.getRowPitch() * y;
+            const uint8_t *pNextRow = vNextFrame.Pixels.data() + vNextFrame.getRowPitch() * y;
+            for (int x = 0; x < vFrame.Width; ++x)
+                Mask[static_cast<size_t>(y) * vFrame.Width + x] = (pRow[x * 4 + 3] > vAlphaThreshold || pNextRow[x * 4 + 3] > vAlphaThreshold) ? 1 : 0;
+        }
+        dilateMask(Mask, vFrame.Width, vFrame.Height, vDilation);
+        return Mask;
+    }
+
+    void buildCellHulls(const std::vector<uint8_t> &vMask, int vWidth, int vHeight, const SHullBuildOptions &vOptions, std::vector<uint16_t> &vioVertices)
+    {
+        constexpr int Unset = std::numeric_limits<int>::max();
+        for (int CellY = 0; CellY < vOptions.CellRows; ++CellY)
+        {
+            const int Top = vHeight * CellY / vOptions.CellRows, Bottom = vHeight * (CellY + 1) / vOptions.CellRows;
+            for (int CellX = 0; CellX < vOptions.CellColumns; ++CellX)
+            {
+                const int Left = vWidth * CellX / vOptions.CellColumns, Right = vWidth * (CellX + 1) / vOptions.CellColumns;
+                // Extremes over the corners of the set texels, texel (x, y) spans [x, x + 1] x [y, y + 1]
+                int MinX = Unset, MaxX = -Unset, MinY = Unset, MaxY = -Unset, MinSum = Unset, MaxSum = -Unset, MinDifference = Unset, MaxDifference = -Unset;
+                for (int y = Top; y < Bottom; ++y)
+                    for (int x = Left; x < Right; ++x)
+                    {
+                        if (!vMask[static_cast<size_t>(y) * vWidth + x]) continue;
+                        MinX          = std::min(MinX, x);
+                        MaxX          = std::max(MaxX, x + 1);
+                        MinY          = std::min(MinY, y);
+                        MaxY          = std::max(MaxY, y + 1);
+                        MinSum        = std::min(MinSum, x + y);
+                        MaxSum        = std::max(MaxSum, x + y + 2);
+                        MinDifference = std::min(MinDifference, x - y - 1);
+                        MaxDifference = std::max(MaxDifference, x + 1 - y);
+                    }
+                if (MinX == Unset) continue;
+
+                std::vector<SPoint> Octagon = {{double(MinX), double(MinY)}, {double(MaxX), double(MinY)}, {double(MaxX), double(MaxY)}, {double(MinX), double(MaxY)}};
+                Octagon = clipPolygon(Octagon, 1.0, 1.0, MaxSum);
+                Octagon = clipPolygon(Octagon, -1.0, -1.0, -MinSum);
+                Octagon = clipPolygon(Octagon, 1.0, -1.0, MaxDifference);
+                Octagon = clipPolygon(Octagon, -1.0, 1.0, -MinDifference);
+                // Every corner is an integer, see the declaration; rounding only removes floating point noise
+                std::vector<SPoint> Corners;
+                for (const SPoint &Point : Octagon)
+                {
+                    const SPoint Corner = {std::round(Point.X), std::round(Point.Y)};
+                    if (Corners.empty() || Corner.X != Corners.back().X || Corner.Y != Corners.back().Y) Corners.push_back(Corner);
+                }
+                while (Corners.size() > 1 && Corners.front().X == Corners.back().X && Corners.front().Y == Corners.back().Y) Corners.pop_back();
+                for (size_t i = 1; i + 1 < Corners.size(); ++i)
+                    for (const SPoint *pCorner : {&Corners[0], &Corners[i], &Corners[i + 1]})
+                    {
+                        vioVertices.push_back(static_cast<uint16_t>(pCorner->X));
+                        vioVertices.push_back(static_cast<uint16_t>(pCorner->Y));
+                    }
+            }
+        }
+    }
+
+    void buildHullMesh(const std::vector<SImageData> &vFrames, const SHullBuildOptions &vOptions, SHullMesh &voMesh)
+    {
+        voMesh = SHullMesh();
+        voMesh.FrameWidth  = vFrames.front().Width;
+        voMesh.FrameHeight = vFrames.front().Height;
+        for (size_t i = 0; i < vFrames.size(); ++i)
+        {
+            const SImageData &Frame = vFrames[i];
+            SHullFrame Record;
+            Record.FirstVertex = static_cast<uint32_t>(voMesh.Vertices.size() / 2);
+            for (int y = 0; y < Frame.Height; ++y)
+            {
+                const uint8_t *pRow = Frame.Pixels.data() + Frame.getRowPitch() * y;
+                for (int x = 0; x < Frame.Width; ++x) Record.VisibleTexels += pRow[x * 4 + 3] > vOptions.AlphaThreshold ? 1 : 0;
+            }
+            const std::vector<uint8_t> Mask = computePlaybackMask(Frame, vFrames[(i + 1) % vFrames.size()], vOptions.AlphaThreshold, vOptions.Dilation);
+            buildCellHulls(Mask, Frame.Width, Frame.Height, vOptions, voMesh.Vertices);
+            Record.VertexCount = static_cast<uint32_t>(voMesh.Vertices.size() / 2) - Record.FirstVertex;
+            voMesh.Frames.push_back(Record);
+        }
+    }
+
+    std::vector<uint8_t> rasterizeHull(const SHullMesh &vMesh, int vFrame)
+    {
+        std::vector<uint8_t> Coverage(static_cast<size_t>(vMesh.FrameWidth) * vMesh.FrameHeight, 0);
+        const SHullFrame &Frame = vMesh.Frames[vFrame];
+        for (uint32_t i = Frame.FirstVertex; i < Frame.FirstVertex + Frame.VertexCount; i += 3)
+        {
+            const uint16_t *pVertex = vMesh.Vertices.data() + static_cast<size_t>(i) * 2;
+            const double X0 = pVertex[0], Y0 = pVertex[1], X1 = pVertex[2], Y1 = pVertex[3], X2 = pVertex[4], Y2 = pVertex[5];
+            const double Area = (X1 - X0) * (Y2 - Y0) - (Y1 - Y0) * (X2 - X0);
+            if (Area == 0.0) continue;
+            const int MinX = static_cast<int>(std::min({X0, X1, X2})), MaxX = std::min(static_cast<int>(std::max({X0, X1, X2})), vMesh.FrameWidth);
+            const int MinY = static_cast<int>(std::min({Y0, Y1, Y2})), MaxY = std::min(static_cast<int>(std::max({Y0, Y1, Y2})), vMesh.FrameHeight);
+            for (int y = MinY; y < MaxY; ++y)
+                for (int x = MinX; x < MaxX; ++x)
+                {
+                    // Same sign edge functions at the texel centre, edges included
+                    const double PX = x + 0.5, PY = y + 0.5;
+                    const double E0 = ((X1 - X0) * (PY - Y0) - (Y1 - Y0) * (PX - X0)) * Area;
+                    const double E1 = ((X2 - X1) * (PY - Y1) - (Y2 - Y1) * (PX - X1)) * Area;
+                    const double E2 = ((X0 - X2) * (PY - Y2) - (Y0 - Y2) * (PX - X2)) * Area;
+                    if (E0 >= 0.0 && E1 >= 0.0 && E2 >= 0.0) Coverage[static_cast<size_t>(y) * vMesh.FrameWidth + x] = 1;
+                }
+        }
+        return Coverage;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "HullMesh.h"
+#include "ImageData.h"
+
+namespace hiveVG::tools
+{
+    struct SHullBuildOptions
+    {
+        int CellRows       = 8;   // the frame is split into cells, each gets its own convex hull, so the union follows concave shapes
+        int CellColumns    = 8;
+        int Dilation       = 2;   // texels the mask is grown by, covers bilinear filtering. Motion warped frames draw the full quad.
+        int AlphaThreshold = 0;   // texels with a larger alpha have to be covered
+    };
+
+    /*!
+     * Texels that can be visible while vFrame is on screen cross fading to vNextFrame: those above vAlphaThreshold in
+     * either frame, grown by a vDilation texel box. One byte per texel, row major.
+     */
+    std::vector<uint8_t> computePlaybackMask(const SImageData &vFrame, const SImageData &vNextFrame, int vAlphaThreshold, int vDilation);
+
+    /*!
+     * Appends triangles covering every set texel of vMask to vioVertices as X, Y texel corner pairs. Per cell, the
+     * hull is the octagon bounded by the extremes of x, y, x + y and x - y over the set texels' corners: convex,
+     * conservative, at most 8 vertices and always on integer corners, so it is stored exactly.
+     */
+    void buildCellHulls(const std::vector<uint8_t> &vMask, int vWidth, int vHeight, const SHullBuildOptions &vOptions, std::vector<uint16_t> &vioVertices);
+
+    // Hull triangles of every frame, frame i covering its cross fade to frame i + 1 (the last one to frame 0)
+    void buildHullMesh(const std::vector<SImageData> &vFrames, const SHullBuildOptions &vOptions, SHullMesh &voMesh);
+
+    // Texels of a vWidth x vHeight frame whose centre lies in one of frame vFrame's triangles, one byte per texel
+    std::vector<uint8_t> rasterizeHull(const SHullMesh &vMesh, int vFrame);
+}
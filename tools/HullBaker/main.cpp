@@ -0,0 +1,130 @@
+// Bakes per frame hull meshes of a grid atlas, so sequence layers rasterise only where their frames can be visible.
+// Usage: hullBaker <atlas.png|jpg> <output.hhul> --grid RxC [--cells RxC] [--dilate N] [--alpha-threshold N] [--per-frame]
+// Writes the mesh table, see app/src/main/cpp/HullMesh.h.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "HullBuilder.h"
+#include "HullMesh.h"
+#include "ImageDecoder.h"
+#include "../Common/ToolUtils.h"
+
+namespace
+{
+    struct SBakerOptions
+    {
+        std::string                      InputPath;
+        std::string                      OutputPath;
+        int                              GridRows     = 1;
+        int                              GridColumns  = 1;
+        bool                             IsPerFrame   = false;
+        hiveVG::tools::SHullBuildOptions Build;
+    };
+
+    bool parseOptions(int vArgc, char **vArgv, SBakerOptions &voOptions)
+    {
+        std::vector<std::string> Positionals;
+        for (int i = 1; i < vArgc; ++i)
+        {
+            const char *pArg = vArgv[i];
+            const bool HasValue = i + 1 < vArgc;
+            if (std::strcmp(pArg, "--grid") == 0 && HasValue)
+            {
+                if (!hiveVG::tools::parseGrid(vArgv[++i], voOptions.GridRows, voOptions.GridColumns)) return false;
+            }
+            else if (std::strcmp(pArg, "--cells") == 0 && HasValue)
+            {
+                if (!hiveVG::tools::parseGrid(vArgv[++i], voOptions.Build.CellRows, voOptions.Build.CellColumns)) return false;
+            }
+            else if (std::strcmp(pArg, "--dilate") == 0 && HasValue) voOptions.Build.Dilation = std::atoi(vArgv[++i]);
+            else if (std::strcmp(pArg, "--alpha-threshold") == 0 && HasValue) voOptions.Build.AlphaThreshold = std::atoi(vArgv[++i]);
+            else if (std::strcmp(pArg, "--per-frame") == 0) voOptions.IsPerFrame = true;
+            else Positionals.emplace_back(pArg);
+        }
+        if (Positionals.size() != 2 || voOptions.Build.Dilation < 0) return false;
+        voOptions.InputPath  = Positionals[0];
+        voOptions.OutputPath = Positionals[1];
+        return true;
+    }
+}
+
+int main(int vArgc, char **vArgv)
+{
+    SBakerOptions Options;
+    if (!parseOptions(vArgc, vArgv, Options))
+    {
+        std::fprintf(stderr, "Usage: %s <atlas.png|jpg> <output.hhul> --grid RxC [--cells RxC] [--dilate N] [--alpha-threshold N] [--per-frame]\n", vArgv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> FileBytes;
+    hiveVG::SImageData Atlas;
+    if (!hiveVG::tools::readFileBytes(Options.InputPath, FileBytes) || !hiveVG::decodeImageFromMemory(FileBytes.data(), FileBytes.size(), Atlas))
+    {
+        std::fprintf(stderr, "Cannot decode %s\n", Options.InputPath.c_str());
+        return 1;
+    }
+    const std::vector<hiveVG::SImageData> Frames = hiveVG::tools::sliceGridFrames(Atlas, Options.GridRows, Options.GridColumns);
+    if (Options.Build.CellRows > Frames.front().Height || Options.Build.CellColumns > Frames.front().Width)
+    {
+        std::fprintf(stderr, "More cells than texels in a %dx%d frame\n", Frames.front().Width, Frames.front().Height);
+        return 1;
+    }
+
+    auto StartTime = std::chrono::steady_clock::now();
+    hiveVG::SHullMesh Mesh;
+    hiveVG::tools::buildHullMesh(Frames, Options.Build, Mesh);
+    const double BuildMs = hiveVG::tools::elapsedMs(StartTime);
+
+    // What is written must read back, and its triangles must cover every texel of both frames of each cross fade
+    const std::vector<uint8_t> Table = hiveVG::serializeHullMesh(Mesh);
+    hiveVG::SHullMesh ReadBack;
+    std::string Error;
+    if (!hiveVG::parseHullMesh(Table.data(), Table.size(), ReadBack, Error))
+    {
+        std::fprintf(stderr, "The baked mesh does not read back: %s\n", Error.c_str());
+        return 1;
+    }
+    const double FrameTexels = static_cast<double>(Mesh.FrameWidth) * Mesh.FrameHeight;
+    double RasterizedSum = 0.0, VisibleSum = 0.0, WorstRatio = 0.0;
+    int WorstFrame = 0;
+    for (int i = 0; i < ReadBack.getFrameCount(); ++i)
+    {
+        const std::vector<uint8_t> Needed = hiveVG::tools::computePlaybackMask(Frames[i], Frames[(i + 1) % Frames.size()], Options.Build.AlphaThreshold, 0);
+        const std::vector<uint8_t> Covered = hiveVG::tools::rasterizeHull(ReadBack, i);
+        for (size_t t = 0; t < Needed.size(); ++t)
+        {
+            if (!Needed[t] || Covered[t]) continue;
+            std::fprintf(stderr, "Frame %d: texel (%zu, %zu) is visible but outside the hull\n", i, t % Mesh.FrameWidth, t / Mesh.FrameWidth);
+            return 1;
+        }
+
+        const double Rasterized = hiveVG::computeHullArea(ReadBack, i) / FrameTexels, Visible = ReadBack.Frames[i].VisibleTexels / FrameTexels;
+        RasterizedSum += Rasterized;
+        VisibleSum += Visible;
+        const double Ratio = Visible > 0.0 ? Rasterized / Visible : 0.0;
+        if (Ratio > WorstRatio)
+        {
+            WorstRatio = Ratio;
+            WorstFrame = i;
+        }
+        if (Options.IsPerFrame)
+            std::printf("frame %3d: rasterised %5.1f%%, visible %5.1f%%, %u triangles\n", i, 100.0 * Rasterized, 100.0 * Visible, ReadBack.Frames[i].VertexCount / 3);
+    }
+    if (!hiveVG::tools::writeFileBytes(Options.OutputPath, Table))
+    {
+        std::fprintf(stderr, "Cannot write %s\n", Options.OutputPath.c_str());
+        return 1;
+    }
+
+    const int FrameCount = Mesh.getFrameCount();
+    std::printf("%d frames of %dx%d, %dx%d cells, dilated by %d: hulls rasterise %.1f%% of the frame for %.1f%% visible texels (full quad 100%%)\n",
+                FrameCount, Mesh.FrameWidth, Mesh.FrameHeight, Options.Build.CellRows, Options.Build.CellColumns, Options.Build.Dilation,
+                100.0 * RasterizedSum / FrameCount, 100.0 * VisibleSum / FrameCount);
+    std::printf("Worst frame %d rasterises %.1fx its visible texels; %.1f triangles per frame, %zu bytes, baked in %.1f ms\n", WorstFrame, WorstRatio,
+                Mesh.Vertices.size() / 6.0 / FrameCount, Table.size(), BuildMs);
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include "MotionEstimator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include "MipChain.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HIVE_SAD_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HIVE_SAD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace hiveVG::tools
+{
+    namespace
+    {
+        uint32_t computeSadScalar(const uint8_t *vA, size_t vPitchA, const uint8_t *vB, size_t vPitchB, int vRowBytes, int vRows)
+        {
+            uint32_t Sum = 0;
+            for (int y = 0; y < vRows; ++y, vA += vPitchA, vB += vPitchB)
+                for (int x = 0; x < vRowBytes; ++x) Sum += static_cast<uint32_t>(std::abs(vA[x] - vB[x]));
+            return Sum;
+        }
+
+#ifdef HIVE_SAD_SSE2
+        uint32_t computeSadSSE2(const uint8_t *vA, size_t vPitchA, const uint8_t *vB, size_t vPitchB, int vRowBytes, int vRows)
+        {
+            __m128i Sum = _mm_setzero_si128();
+            uint32_t Tail = 0;
+            for (int y = 0; y < vRows; ++y, vA += vPitchA, vB += vPitchB)
+            {
+                int x = 0;
+                for (; x + 16 <= vRowBytes; x += 16)
+                {
+                    const __m128i A = _mm_loadu_si128(reinterpret_cast<const __m128i *>(vA + x));
+                    const __m128i B = _mm_loadu_si128(reinterpret_cast<const __m128i *>(vB + x));
+                    Sum = _mm_add_epi64(Sum, _mm_sad_epu8(A, B));
+                }
+                for (; x < vRowBytes; ++x) Tail += static_cast<uint32_t>(std::abs(vA[x] - vB[x]));
+            }
+            return static_cast<uint32_t>(_mm_cvtsi128_si32(Sum)) + static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(Sum, 8))) + Tail;
+        }
+#endif
+
+#ifdef HIVE_SAD_NEON
+        uint32_t computeSadNEON(const uint8_t *vA, size_t vPitchA, const uint8_t *vB, size_t vPitchB, int vRowBytes, int vRows)
+        {
+            uint32x4_t Sum = vdupq_n_u32(0);
+            uint32_t Tail = 0;
+            for (int y = 0; y < vRows; ++y, vA += vPitchA, vB += vPitchB)
+            {
+                int x = 0;
+                for (; x + 16 <= vRowBytes; x += 16)
+                {
+                    const uint8x16_t Difference = vabdq_u8(vld1q_u8(vA + x), vld1q_u8(vB + x));
+                    Sum = vpadalq_u16(Sum, vpaddlq_u8(Difference));
+                }
+                for (; x < vRowBytes; ++x) Tail += static_cast<uint32_t>(std::abs(vA[x] - vB[x]));
+            }
+            const uint64x2_t Pairs = vpaddlq_u32(Sum);
+            return static_cast<uint32_t>(vgetq_lane_u64(Pairs, 0) + vgetq_lane_u64(Pairs, 1)) + Tail;
+        }
+#endif
+
+        // Best offset of the block at (vX, vY) of vBlockImage into vSearchImage within vRadius of (vCenterX, vCenterY), in level texels
+        void searchBlock(const SImageData &vBlockImage, const SImageData &vSearchImage, int vX, int vY, int vBlockWidth, int vBlockHeight, int vCenterX, int vCenterY,
+                         int vRadius, int vLengthPenalty, ESadKernel vKernel, int &voDeltaX, int &voDeltaY)
+        {
+            const uint8_t *pBlock = vBlockImage.Pixels.data() + vBlockImage.getRowPitch() * vY + static_cast<size_t>(vX) * 4;
+            const uint32_t PenaltyPerTexel = static_cast<uint32_t>(std::max(vLengthPenalty, 0) * vBlockWidth * vBlockHeight);
+            uint32_t BestCost = std::numeric_limits<uint32_t>::max();
+            int BestLength = std::numeric_limits<int>::max();
+            voDeltaX = voDeltaY = 0;
+            for (int DeltaY = vCenterY - vRadius; DeltaY <= vCenterY + vRadius; ++DeltaY)
+            {
+                if (vY + DeltaY < 0 || vY + DeltaY + vBlockHeight > vSearchImage.Height) continue;
+                for (int DeltaX = vCenterX - vRadius; DeltaX <= vCenterX + vRadius; ++DeltaX)
+                {
+                    if (vX + DeltaX < 0 || vX + DeltaX + vBlockWidth > vSearchImage.Width) continue;
+                    const uint8_t *pSearch = vSearchImage.Pixels.data() + vSearchImage.getRowPitch() * (vY + DeltaY) + static_cast<size_t>(vX + DeltaX) * 4;
+                    const uint32_t Sad = computeSad(pBlock, vBlockImage.getRowPitch(), pSearch, vSearchImage.getRowPitch(), vBlockWidth * 4, vBlockHeight, vKernel);
+                    const int Length = DeltaX * DeltaX + DeltaY * DeltaY;
+                    const uint32_t Cost = Sad + PenaltyPerTexel * static_cast<uint32_t>(std::abs(DeltaX) + std::abs(DeltaY));
+                    if (Cost < BestCost || (Cost == BestCost && Length < BestLength))
+                    {
+                        BestCost   = Cost;
+                        BestLength = Length;
+                        voDeltaX   = DeltaX;
+                        voDeltaY   = DeltaY;
+                    }
+                }
+            }
+        }
+
+        // Straight alpha bilinear fetch with clamped edges, in texel coordinates
+        void sampleBilinear(const SImageData &vImage, float vX, float vY, uint8_t voTexel[4])
+        {
+            vX = std::clamp(vX, 0.0f, static_cast<float>(vImage.Width - 1));
+            vY = std::clamp(vY, 0.0f, static_cast<float>(vImage.Height - 1));
+            const int X0 = static_cast<int>(vX), Y0 = static_cast<int>(vY);
+            const int X1 = std::min(X0 + 1, vImage.Width - 1), Y1 = std::min(Y0 + 1, vImage.Height - 1);
+            const float FractionX = vX - X0, FractionY = vY - Y0;
+            const auto texel = [&](int vTexelX, int vTexelY) { return vImage.Pixels.data() + vImage.getRowPitch() * vTexelY + static_cast<size_t>(vTexelX) * 4; };
+            for (int c = 0; c < 4; ++c)
+            {
+                const float Top    = texel(X0, Y0)[c] + (texel(X1, Y0)[c] - texel(X0, Y0)[c]) * FractionX;
+                const float Bottom = texel(X0, Y1)[c] + (texel(X1, Y1)[c] - texel(X0, Y1)[c]) * FractionX;
+                voTexel[c] = static_cast<uint8_t>(std::lround(Top + (Bottom - Top) * FractionY));
+            }
+        }
+    }
+
+    ESadKernel getBestSadKernel()
+    {
+#if defined(HIVE_SAD_SSE2)
+        return ESadKernel::SSE2;
+#elif defined(HIVE_SAD_NEON)
+        return ESadKernel::NEON;
+#else
+        return ESadKernel::Scalar;
+#endif
+    }
+
+    const char *getSadKernelName(ESadKernel vKernel)
+    {
+        switch (vKernel)
+        {
+        case ESadKernel::SSE2: return "sse2";
+        case ESadKernel::NEON: return "neon";
+        default:               return "scalar";
+        }
+    }
+
+    uint32_t computeSad(const uint8_t *vA, size_t vPitchA, const uint8_t *vB, size_t vPitchB, int vRowBytes, int vRows, ESadKernel vKernel)
+    {
+#ifdef HIVE_SAD_SSE2
+        if (vKernel == ESadKernel::SSE2) return computeSadSSE2(vA, vPitchA, vB, vPitchB, vRowBytes, vRows);
+#endif
+#ifdef HIVE_SAD_NEON
+        if (vKernel == ESadKernel::NEON) return computeSadNEON(vA, vPitchA, vB, vPitchB, vRowBytes, vRows);
+#endif
+        return computeSadScalar(vA, vPitchA, vB, vPitchB, vRowBytes, vRows);
+    }
+
+    SMotionField estimateMotion(const SImageData &vFrom, const SImageData &vTo, const SMotionSearchOptions &vOptions, ESadKernel vKernel)
+    {
+        SMotionField Field;
+        Field.BlockSize    = vOptions.BlockSize;
+        Field.BlockColumns = (vFrom.Width + vOptions.BlockSize - 1) / vOptions.BlockSize;
+        Field.BlockRows    = (vFrom.Height + vOptions.BlockSize - 1) / vOptions.BlockSize;
+        Field.DeltaX.assign(static_cast<size_t>(Field.BlockColumns) * Field.BlockRows, 0.0f);
+        Field.DeltaY.assign(Field.DeltaX.size(), 0.0f);
+
+        // Level 0 is full resolution. Coarser levels match a BlockSize window centered on the block, which covers more of
+        // the frame: shrinking the block with the level leaves a few texels that match anything nearby.
+        std::vector<SImageData> FromLevels{vFrom}, ToLevels{vTo};
+        const int LevelCount = std::max(vOptions.PyramidLevels, 1);
+        while (static_cast<int>(FromLevels.size()) < LevelCount && FromLevels.back().Width / 2 >= vOptions.BlockSize &&
+               FromLevels.back().Height / 2 >= vOptions.BlockSize)
+        {
+            FromLevels.push_back(downsampleHalf(FromLevels.back(), EAlphaMode::Straight));
+            ToLevels.push_back(downsampleHalf(ToLevels.back(), EAlphaMode::Straight));
+        }
+
+        for (int BlockY = 0; BlockY < Field.BlockRows; ++BlockY)
+        {
+            for (int BlockX = 0; BlockX < Field.BlockColumns; ++BlockX)
+            {
+                // Offset from the block in vTo back to its source in vFrom, the motion is its negation
+                int DeltaX = 0, DeltaY = 0;
+                for (int Level = static_cast<int>(ToLevels.size()) - 1; Level >= 0; --Level)
+                {
+                    const SImageData &To = ToLevels[Level];
+                    int X = BlockX * vOptions.BlockSize, Y = BlockY * vOptions.BlockSize;
+                    int Width = std::min(vOptions.BlockSize, To.Width - X), Height = std::min(vOptions.BlockSize, To.Height - Y);
+                    if (Level > 0)
+                    {
+                        const int CenterX = ((2 * X + Width) >> (Level + 1)), CenterY = ((2 * Y + Height) >> (Level + 1));
+                        Width  = vOptions.BlockSize;
+                        Height = vOptions.BlockSize;
+                        X = std::clamp(CenterX - Width / 2, 0, To.Width - Width);
+                        Y = std::clamp(CenterY - Height / 2, 0, To.Height - Height);
+                    }
+                    const bool IsCoarsest = Level == static_cast<int>(ToLevels.size()) - 1;
+                    searchBlock(To, FromLevels[Level], X, Y, Width, Height, DeltaX, DeltaY, IsCoarsest ? vOptions.SearchRadius : vOptions.RefineRadius,
+                                vOptions.LengthPenalty, vKernel, DeltaX, DeltaY);
+                    if (Level > 0)
+                    {
+                        DeltaX *= 2;
+                        DeltaY *= 2;
+                    }
+                }
+                Field.DeltaX[Field.getIndex(BlockX, BlockY)] = static_cast<float>(-DeltaX);
+                Field.DeltaY[Field.getIndex(BlockX, BlockY)] = static_cast<float>(-DeltaY);
+            }
+        }
+        return Field;
+    }
+
+    SImageData warpFrame(const SImageData &vFrame, const SMotionField &vMotion, float vAmount)
+    {
+        SImageData Warped;
+        Warped.Width  = vFrame.Width;
+        Warped.Height = vFrame.Height;
+        Warped.Pixels.resize(Warped.getByteSize());
+        for (int y = 0; y < vFrame.Height; ++y)
+        {
+            for (int x = 0; x < vFrame.Width; ++x)
+            {
+                // Vectors sit at block centers, like texels of the motion atlas under linear filtering
+                const float BlockX = std::clamp((x + 0.5f) / vMotion.BlockSize - 0.5f, 0.0f, static_cast<float>(vMotion.BlockColumns - 1));
+                const float BlockY = std::clamp((y + 0.5f) / vMotion.BlockSize - 0.5f, 0.0f, static_cast<float>(vMotion.BlockRows - 1));
+                const int X0 = static_cast<int>(BlockX), Y0 = static_cast<int>(BlockY);
+                const int X1 = std::min(X0 + 1, vMotion.BlockColumns - 1), Y1 = std::min(Y0 + 1, vMotion.BlockRows - 1);
+                const float FractionX = BlockX - X0, FractionY = BlockY - Y0;
+                const auto interpolate = [&](const std::vector<float> &vValues) {
+                    const float Top    = vValues[vMotion.getIndex(X0, Y0)] + (vValues[vMotion.getIndex(X1, Y0)] - vValues[vMotion.getIndex(X0, Y0)]) * FractionX;
+                    const float Bottom = vValues[vMotion.getIndex(X0, Y1)] + (vValues[vMotion.getIndex(X1, Y1)] - vValues[vMotion.getIndex(X0, Y1)]) * FractionX;
+                    return Top + (Bottom - Top) * FractionY;
+                };
+                sampleBilinear(vFrame, x - vAmount * interpolate(vMotion.DeltaX), y - vAmount * interpolate(vMotion.DeltaY),
+                               Warped.Pixels.data() + Warped.getRowPitch() * y + static_cast<size_t>(x) * 4);
+            }
+        }
+        return Warped;
+    }
+
+    double computePsnr(const SImageData &vA, const SImageData &vB)
+    {
+        double SquaredError = 0.0;
+        for (size_t i = 0; i < vA.Pixels.size(); ++i)
+        {
+            const double Delta = static_cast<double>(vA.Pixels[i]) - vB.Pixels[i];
+            SquaredError += Delta * Delta;
+        }
+        if (SquaredError <= 0.0) return 99.0;
+        return 10.0 * std::log10(255.0 * 255.0 * vA.Pixels.size() / SquaredError);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ImageData.h"
+
+namespace hiveVG::tools
+{
+    struct SMotionSearchOptions
+    {
+        int BlockSize     = 8;   // texels per side of a block, one vector each
+        int SearchRadius  = 4;   // full search range at the coarsest pyramid level, in its texels
+        int PyramidLevels = 2;   // 1 is plain full search block matching at full resolution
+        int RefineRadius  = 1;   // search range around the upsampled vector at every finer level
+        int LengthPenalty = 2;   // SAD added per block texel and texel of vector length, keeps look alike blocks from matching far off
+    };
+
+    // One vector per block of To in texels, the motion that carried the block's content there from From
+    struct SMotionField
+    {
+        int                BlockColumns = 0;
+        int                BlockRows    = 0;
+        int                BlockSize    = 0;
+        std::vector<float> DeltaX;
+        std::vector<float> DeltaY;
+
+        [[nodiscard]] size_t getIndex(int vBlockX, int vBlockY) const { return static_cast<size_t>(vBlockY) * BlockColumns + vBlockX; }
+    };
+
+    enum class ESadKernel
+    {
+        Scalar,
+        SSE2,
+        NEON
+    };
+
+    ESadKernel  getBestSadKernel();
+    const char* getSadKernelName(ESadKernel vKernel);
+    // Sum of absolute differences over vRows rows of vRowBytes bytes
+    uint32_t    computeSad(const uint8_t *vA, size_t vPitchA, const uint8_t *vB, size_t vPitchB, int vRowBytes, int vRows, ESadKernel vKernel);
+
+    /*!
+     * Hierarchical block matching on RGBA8 frames of the same size: a full search at the coarsest level of a
+     * 2x pyramid, then a small refinement around the doubled vector at each finer one. Ties keep the shorter vector,
+     * so empty (all transparent) blocks stay still. Blocks are laid on vTo and matched back into vFrom, so the vector
+     * of a block is the motion of whatever arrives there, which is what a backward warp at that block needs.
+     */
+    SMotionField estimateMotion(const SImageData &vFrom, const SImageData &vTo, const SMotionSearchOptions &vOptions, ESadKernel vKernel);
+    // Predicts the frame vAmount of the way along the motion: texel p is fetched from vFrame at p - vAmount * motion(p),
+    // with the motion bilinearly interpolated between block centers the same way the snow shader samples it.
+    SImageData   warpFrame(const SImageData &vFrame, const SMotionField &vMotion, float vAmount);
+    double       computePsnr(const SImageData &vA, const SImageData &vB);
+}
@@ -0,0 +1,212 @@
+// Offline motion vector baker for sequence atlases, writes the EAC RG11 .ktx2 motion atlas read by interpolated snow playback.
+// Usage: motionBaker <atlas.png|jpg> <output.ktx2> --grid RxC [--block N] [--radius N] [--levels N] [--penalty N] [--threads N]
+// Frame f's cell holds the motion from frame f to frame f + 1 (see app/src/main/cpp/MotionVectors.h).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ImageDecoder.h"
+#include "MotionEstimator.h"
+#include "MotionVectors.h"
+#include "../Common/Ktx2Writer.h"
+#include "../Common/ToolUtils.h"
+#include "../Etc2Encoder/Etc2Codec.h"
+
+namespace
+{
+    constexpr uint32_t VkFormatEacRg11 = 155;
+
+    struct SBakerOptions
+    {
+        std::string                         InputPath;
+        std::string                         OutputPath;
+        int                                 GridRows    = 1;
+        int                                 GridColumns = 1;
+        hiveVG::tools::SMotionSearchOptions Search;
+        size_t                              ThreadCount = hiveVG::tools::defaultThreadCount();
+    };
+
+    bool parseOptions(int vArgc, char **vArgv, SBakerOptions &voOptions)
+    {
+        std::vector<std::string> Positionals;
+        for (int i = 1; i < vArgc; ++i)
+        {
+            const char *pArg = vArgv[i];
+            const bool HasValue = i + 1 < vArgc;
+            if (std::strcmp(pArg, "--grid") == 0 && HasValue)
+            {
+                if (!hiveVG::tools::parseGrid(vArgv[++i], voOptions.GridRows, voOptions.GridColumns)) return false;
+            }
+            else if (std::strcmp(pArg, "--block") == 0 && HasValue) voOptions.Search.BlockSize = std::atoi(vArgv[++i]);
+            else if (std::strcmp(pArg, "--radius") == 0 && HasValue) voOptions.Search.SearchRadius = std::atoi(vArgv[++i]);
+            else if (std::strcmp(pArg, "--levels") == 0 && HasValue) voOptions.Search.PyramidLevels = std::atoi(vArgv[++i]);
+            else if (std::strcmp(pArg, "--penalty") == 0 && HasValue) voOptions.Search.LengthPenalty = std::atoi(vArgv[++i]);
+            else if (std::strcmp(pArg, "--threads") == 0 && HasValue) voOptions.ThreadCount = std::strtoul(vArgv[++i], nullptr, 10);
+            else Positionals.emplace_back(pArg);
+        }
+        if (Positionals.size() != 2 || voOptions.Search.BlockSize < 2 || voOptions.Search.SearchRadius < 0) return false;
+        voOptions.InputPath  = Positionals[0];
+        voOptions.OutputPath = Positionals[1];
+        return true;
+    }
+
+    // Motion fields as RG texels of one atlas, cell f at the same grid position as frame f of the colour atlas
+    void packMotionAtlas(const std::vector<hiveVG::tools::SMotionField> &vFields, int vFrameWidth, int vFrameHeight, int vColumns, int vRows,
+                         std::vector<uint8_t> &voRed, std::vector<uint8_t> &voGreen, int &voWidth, int &voHeight)
+    {
+        const int CellWidth = vFields[0].BlockColumns, CellHeight = vFields[0].BlockRows;
+        voWidth  = CellWidth * vColumns;
+        voHeight = CellHeight * vRows;
+        voRed.assign(static_cast<size_t>(voWidth) * voHeight, 0);
+        voGreen.assign(voRed.size(), 0);
+        for (size_t Frame = 0; Frame < vFields.size(); ++Frame)
+        {
+            const int CellX = static_cast<int>(Frame % vColumns) * CellWidth, CellY = static_cast<int>(Frame / vColumns) * CellHeight;
+            for (int y = 0; y < CellHeight; ++y)
+            {
+                for (int x = 0; x < CellWidth; ++x)
+                {
+                    const size_t Texel = static_cast<size_t>(CellY + y) * voWidth + CellX + x;
+                    voRed[Texel]   = hiveVG::MOTION_VECTOR_FORMAT::encode(vFields[Frame].DeltaX[vFields[Frame].getIndex(x, y)] / vFrameWidth);
+                    voGreen[Texel] = hiveVG::MOTION_VECTOR_FORMAT::encode(vFields[Frame].DeltaY[vFields[Frame].getIndex(x, y)] / vFrameHeight);
+                }
+            }
+        }
+    }
+
+    // EAC RG11 blocks of the packed atlas, and the channels as the GPU will read them back for validation
+    std::vector<uint8_t> encodeRg11(std::vector<uint8_t> &vioRed, std::vector<uint8_t> &vioGreen, int vWidth, int vHeight)
+    {
+        const int BlocksX = (vWidth + 3) / 4, BlocksY = (vHeight + 3) / 4;
+        std::vector<uint8_t> Blocks(static_cast<size_t>(BlocksX) * BlocksY * 16);
+        for (int BlockY = 0; BlockY < BlocksY; ++BlockY)
+        {
+            for (int BlockX = 0; BlockX < BlocksX; ++BlockX)
+            {
+                uint8_t *pBlock = &Blocks[(static_cast<size_t>(BlockY) * BlocksX + BlockX) * 16];
+                for (auto [pChannel, Offset] : {std::make_pair(&vioRed, 0), std::make_pair(&vioGreen, 8)})
+                {
+                    uint8_t Values[16];
+                    for (int i = 0; i < 16; ++i)
+                    {
+                        // Texels past the edge repeat the last row/column
+                        const int X = std::min(BlockX * 4 + i % 4, vWidth - 1), Y = std::min(BlockY * 4 + i / 4, vHeight - 1);
+                        Values[i] = (*pChannel)[static_cast<size_t>(Y) * vWidth + X];
+                    }
+                    hiveVG::tools::encodeEacBlock(Values, true, pBlock + Offset);
+                    hiveVG::tools::decodeEacBlock(pBlock + Offset, true, Values);
+                    for (int i = 0; i < 16; ++i)
+                    {
+                        const int X = BlockX * 4 + i % 4, Y = BlockY * 4 + i / 4;
+                        if (X < vWidth && Y < vHeight) (*pChannel)[static_cast<size_t>(Y) * vWidth + X] = Values[i];
+                    }
+                }
+            }
+        }
+        return Blocks;
+    }
+
+    // Inverse of packMotionAtlas for one cell, back to texel vectors
+    hiveVG::tools::SMotionField unpackMotionCell(const std::vector<uint8_t> &vRed, const std::vector<uint8_t> &vGreen, int vAtlasWidth,
+                                                 const hiveVG::tools::SMotionField &vLayout, int vFrame, int vColumns, int vFrameWidth, int vFrameHeight)
+    {
+        hiveVG::tools::SMotionField Field = vLayout;
+        const int CellX = (vFrame % vColumns) * vLayout.BlockColumns, CellY = (vFrame / vColumns) * vLayout.BlockRows;
+        for (int y = 0; y < vLayout.BlockRows; ++y)
+        {
+            for (int x = 0; x < vLayout.BlockColumns; ++x)
+            {
+                const size_t Texel = static_cast<size_t>(CellY + y) * vAtlasWidth + CellX + x;
+                Field.DeltaX[Field.getIndex(x, y)] = hiveVG::MOTION_VECTOR_FORMAT::decode(vRed[Texel]) * vFrameWidth;
+                Field.DeltaY[Field.getIndex(x, y)] = hiveVG::MOTION_VECTOR_FORMAT::decode(vGreen[Texel]) * vFrameHeight;
+            }
+        }
+        return Field;
+    }
+}
+
+int main(int vArgc, char **vArgv)
+{
+    SBakerOptions Options;
+    if (!parseOptions(vArgc, vArgv, Options))
+    {
+        std::fprintf(stderr, "Usage: %s <atlas.png|jpg> <output.ktx2> --grid RxC [--block N] [--radius N] [--levels N] [--penalty N] [--threads N]\n", vArgv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> FileBytes;
+    hiveVG::SImageData Atlas;
+    if (!hiveVG::tools::readFileBytes(Options.InputPath, FileBytes) || !hiveVG::decodeImageFromMemory(FileBytes.data(), FileBytes.size(), Atlas))
+    {
+        std::fprintf(stderr, "Cannot decode %s\n", Options.InputPath.c_str());
+        return 1;
+    }
+    const std::vector<hiveVG::SImageData> Frames = hiveVG::tools::sliceGridFrames(Atlas, Options.GridRows, Options.GridColumns);
+    const int FrameCount = static_cast<int>(Frames.size());
+    const int FrameWidth = Frames[0].Width, FrameHeight = Frames[0].Height;
+    if (FrameCount < 2 || FrameWidth < Options.Search.BlockSize || FrameHeight < Options.Search.BlockSize)
+    {
+        std::fprintf(stderr, "A %dx%d grid of %dx%d frames has nothing to bake\n", Options.GridRows, Options.GridColumns, FrameWidth, FrameHeight);
+        return 1;
+    }
+
+    // The SIMD error metric has to pick the very same vectors as the scalar one
+    const hiveVG::tools::ESadKernel Kernel = hiveVG::tools::getBestSadKernel();
+    const hiveVG::tools::SMotionField ScalarField = hiveVG::tools::estimateMotion(Frames[0], Frames[1], Options.Search, hiveVG::tools::ESadKernel::Scalar);
+    const hiveVG::tools::SMotionField KernelField = hiveVG::tools::estimateMotion(Frames[0], Frames[1], Options.Search, Kernel);
+    if (ScalarField.DeltaX != KernelField.DeltaX || ScalarField.DeltaY != KernelField.DeltaY)
+    {
+        std::fprintf(stderr, "The %s SAD kernel does not match the scalar reference\n", hiveVG::tools::getSadKernelName(Kernel));
+        return 1;
+    }
+
+    auto StartTime = std::chrono::steady_clock::now();
+    std::vector<hiveVG::tools::SMotionField> Fields(FrameCount);
+    hiveVG::tools::parallelFor(Frames.size(), Options.ThreadCount, [&](size_t vFrame) {
+        Fields[vFrame] = hiveVG::tools::estimateMotion(Frames[vFrame], Frames[(vFrame + 1) % Frames.size()], Options.Search, Kernel);
+    });
+    const double EstimateMs = hiveVG::tools::elapsedMs(StartTime);
+
+    std::vector<uint8_t> Red, Green;
+    int MotionWidth, MotionHeight;
+    packMotionAtlas(Fields, FrameWidth, FrameHeight, Options.GridColumns, Options.GridRows, Red, Green, MotionWidth, MotionHeight);
+    hiveVG::tools::SKtx2WriteDesc Desc;
+    Desc.VkFormat       = VkFormatEacRg11;
+    Desc.Width          = MotionWidth;
+    Desc.Height         = MotionHeight;
+    Desc.LevelAlignment = 16;
+    Desc.Dfd            = hiveVG::tools::makeEacRg11Dfd();
+    Desc.Levels.push_back(encodeRg11(Red, Green, MotionWidth, MotionHeight));
+    const std::vector<uint8_t> Ktx2 = hiveVG::tools::writeKtx2(Desc);
+    if (!hiveVG::tools::writeFileBytes(Options.OutputPath, Ktx2))
+    {
+        std::fprintf(stderr, "Cannot write %s\n", Options.OutputPath.c_str());
+        return 1;
+    }
+
+    // Frame f warped all the way along its stored (quantized, EAC decoded) motion should look like frame f + 1
+    std::vector<double> HoldPsnr(FrameCount), WarpPsnr(FrameCount);
+    hiveVG::tools::parallelFor(Frames.size(), Options.ThreadCount, [&](size_t vFrame) {
+        const hiveVG::SImageData &Next = Frames[(vFrame + 1) % Frames.size()];
+        const hiveVG::tools::SMotionField Stored = unpackMotionCell(Red, Green, MotionWidth, Fields[vFrame], static_cast<int>(vFrame), Options.GridColumns,
+                                                                    FrameWidth, FrameHeight);
+        HoldPsnr[vFrame] = hiveVG::tools::computePsnr(Frames[vFrame], Next);
+        WarpPsnr[vFrame] = hiveVG::tools::computePsnr(hiveVG::tools::warpFrame(Frames[vFrame], Stored, 1.0f), Next);
+    });
+    double HoldSum = 0.0, WarpSum = 0.0, WorstGain = 99.0;
+    for (int i = 0; i < FrameCount; ++i)
+    {
+        HoldSum += HoldPsnr[i];
+        WarpSum += WarpPsnr[i];
+        WorstGain = std::min(WorstGain, WarpPsnr[i] - HoldPsnr[i]);
+    }
+
+    std::printf("%d frames of %dx%d, %dx%d blocks, %d levels, radius %d: %s SAD on %zu threads, estimate %.1f ms (%.2f ms per frame)\n", FrameCount,
+                FrameWidth, FrameHeight, Options.Search.BlockSize, Options.Search.BlockSize, Options.Search.PyramidLevels, Options.Search.SearchRadius,
+                hiveVG::tools::getSadKernelName(Kernel), Options.ThreadCount, EstimateMs, EstimateMs / FrameCount);
+    std::printf("motion atlas %dx%d EAC RG11, %zu KiB\n", MotionWidth, MotionHeight, Ktx2.size() / 1024);
+    std::printf("next frame PSNR: held %.2f dB, motion warped %.2f dB (worst frame gain %+.2f dB)\n", HoldSum / FrameCount, WarpSum / FrameCount, WorstGain);
+    return 0;
+}
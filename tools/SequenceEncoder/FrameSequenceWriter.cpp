@@ -0,0 +1,132 @@
+#include "FrameSequenceWriter.h"
+#include <algorithm>
+#include <cstring>
+#include "FrameSequence.h"
+#include "Lz4Block.h"
+
+namespace hiveVG::tools
+{
+    namespace
+    {
+        template<typename T>
+        void appendLE(std::vector<uint8_t> &vioBytes, T vValue)
+        {
+            for (size_t i = 0; i < sizeof(T); ++i) vioBytes.push_back(static_cast<uint8_t>(static_cast<uint64_t>(vValue) >> (8 * i)));
+        }
+
+        std::vector<uint8_t> compressBlock(const std::vector<uint8_t> &vRaw)
+        {
+            std::vector<uint8_t> Compressed(getLz4BlockBound(vRaw.size()));
+            Compressed.resize(compressLz4Block(vRaw.data(), vRaw.size(), Compressed.data(), Compressed.size()));
+            return Compressed;
+        }
+
+        struct SEncodedFrame
+        {
+            std::vector<uint8_t> Payload;
+            size_t               RawSize          = 0;
+            bool                 IsKeyframe       = false;
+            int                  ChangedTileCount = 0;
+        };
+
+        SEncodedFrame encodeKeyframe(const SImageData &vFrame)
+        {
+            SEncodedFrame Encoded;
+            Encoded.IsKeyframe = true;
+            Encoded.RawSize    = vFrame.getByteSize();
+            Encoded.Payload    = compressBlock(vFrame.Pixels);
+            return Encoded;
+        }
+
+        SEncodedFrame encodeDelta(const SImageData &vPrevious, const SImageData &vFrame, int vTileSize, int &voTileCount)
+        {
+            const int TileColumns = (vFrame.Width + vTileSize - 1) / vTileSize, TileRows = (vFrame.Height + vTileSize - 1) / vTileSize;
+            voTileCount = TileColumns * TileRows;
+            SEncodedFrame Encoded;
+            std::vector<uint8_t> Mask((static_cast<size_t>(voTileCount) + 7) / 8, 0), Tiles;
+            const size_t RowPitch = vFrame.getRowPitch();
+            for (int TileY = 0; TileY < TileRows; ++TileY)
+            {
+                for (int TileX = 0; TileX < TileColumns; ++TileX)
+                {
+                    const int X0 = TileX * vTileSize, Y0 = TileY * vTileSize;
+                    const size_t TileRowBytes = static_cast<size_t>(std::min(vTileSize, vFrame.Width - X0)) * 4;
+                    const int    TileHeight   = std::min(vTileSize, vFrame.Height - Y0);
+                    bool IsChanged = false;
+                    for (int y = 0; y < TileHeight && !IsChanged; ++y)
+                    {
+                        const size_t Offset = RowPitch * (Y0 + y) + static_cast<size_t>(X0) * 4;
+                        IsChanged = std::memcmp(vPrevious.Pixels.data() + Offset, vFrame.Pixels.data() + Offset, TileRowBytes) != 0;
+                    }
+                    if (!IsChanged) continue;
+
+                    const size_t TileIndex = static_cast<size_t>(TileY) * TileColumns + TileX;
+                    Mask[TileIndex / 8] |= static_cast<uint8_t>(1u << (TileIndex % 8));
+                    ++Encoded.ChangedTileCount;
+                    for (int y = 0; y < TileHeight; ++y)
+                    {
+                        const size_t Offset = RowPitch * (Y0 + y) + static_cast<size_t>(X0) * 4;
+                        for (size_t i = 0; i < TileRowBytes; ++i) Tiles.push_back(vPrevious.Pixels[Offset + i] ^ vFrame.Pixels[Offset + i]);
+                    }
+                }
+            }
+            Encoded.RawSize = Tiles.size();
+            Encoded.Payload = std::move(Mask);
+            if (!Tiles.empty())
+            {
+                const std::vector<uint8_t> Compressed = compressBlock(Tiles);
+                Encoded.Payload.insert(Encoded.Payload.end(), Compressed.begin(), Compressed.end());
+            }
+            return Encoded;
+        }
+    }
+
+    std::vector<uint8_t> encodeFrameSequence(const std::vector<SImageData> &vFrames, int vTileSize, int vKeyframeInterval, SFrameSequenceEncodeStats &voStats)
+    {
+        using namespace FRAME_SEQUENCE_FORMAT;
+        voStats = {};
+        if (vFrames.empty()) return {};
+
+        std::vector<SEncodedFrame> EncodedFrames;
+        for (size_t i = 0; i < vFrames.size(); ++i)
+        {
+            voStats.RawBytes += vFrames[i].getByteSize();
+            SEncodedFrame Keyframe = encodeKeyframe(vFrames[i]);
+            if (i % static_cast<size_t>(std::max(vKeyframeInterval, 1)) != 0)
+            {
+                int TileCount = 0;
+                SEncodedFrame Delta = encodeDelta(vFrames[i - 1], vFrames[i], vTileSize, TileCount);
+                if (Delta.Payload.size() < Keyframe.Payload.size())
+                {
+                    voStats.ChangedTileCount += Delta.ChangedTileCount;
+                    voStats.DeltaTileCount   += TileCount;
+                    EncodedFrames.push_back(std::move(Delta));
+                    continue;
+                }
+            }
+            ++voStats.KeyframeCount;
+            EncodedFrames.push_back(std::move(Keyframe));
+        }
+
+        std::vector<uint8_t> File(Magic, Magic + sizeof(Magic));
+        appendLE<uint32_t>(File, Version);
+        appendLE<uint32_t>(File, static_cast<uint32_t>(vFrames[0].Width));
+        appendLE<uint32_t>(File, static_cast<uint32_t>(vFrames[0].Height));
+        appendLE<uint32_t>(File, static_cast<uint32_t>(vFrames.size()));
+        appendLE<uint32_t>(File, static_cast<uint32_t>(vTileSize));
+        appendLE<uint32_t>(File, 0);
+        size_t Offset = HeaderSize + RecordSize * EncodedFrames.size();
+        for (const SEncodedFrame &Frame : EncodedFrames)
+        {
+            appendLE<uint64_t>(File, Offset);
+            appendLE<uint32_t>(File, static_cast<uint32_t>(Frame.Payload.size()));
+            appendLE<uint32_t>(File, static_cast<uint32_t>(Frame.RawSize));
+            appendLE<uint32_t>(File, Frame.IsKeyframe ? KeyframeFlag : 0);
+            appendLE<uint32_t>(File, static_cast<uint32_t>(Frame.ChangedTileCount));
+            Offset += Frame.Payload.size();
+        }
+        for (const SEncodedFrame &Frame : EncodedFrames) File.insert(File.end(), Frame.Payload.begin(), Frame.Payload.end());
+        voStats.EncodedBytes = File.size();
+        return File;
+    }
+}
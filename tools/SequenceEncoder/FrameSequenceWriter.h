@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ImageData.h"
+
+namespace hiveVG::tools
+{
+    struct SFrameSequenceEncodeStats
+    {
+        int      KeyframeCount    = 0;
+        uint64_t ChangedTileCount = 0;   // over all delta frames
+        uint64_t DeltaTileCount   = 0;   // tiles of all delta frames, changed or not
+        size_t   RawBytes         = 0;   // every frame as plain RGBA8
+        size_t   EncodedBytes     = 0;
+    };
+
+    /*!
+     * Builds a lossless .hseq file (see FrameSequence.h) from equally sized RGBA8 frames.
+     * A keyframe starts every vKeyframeInterval frames, and wherever the delta would not be smaller than a keyframe.
+     */
+    std::vector<uint8_t> encodeFrameSequence(const std::vector<SImageData> &vFrames, int vTileSize, int vKeyframeInterval, SFrameSequenceEncodeStats &voStats);
+}
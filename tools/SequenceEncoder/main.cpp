@@ -0,0 +1,135 @@
+// Offline encoder from grid atlases to .hseq keyframe + delta frame sequences read by CAsyncTextureLoader.
+// Usage: sequenceEncoder <atlas.png|jpg> <output.hseq> --grid RxC [--tile N] [--keyframe-interval N]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "FrameSequence.h"
+#include "FrameSequenceWriter.h"
+#include "ImageDecoder.h"
+#include "../Common/ToolUtils.h"
+
+namespace
+{
+    struct SEncoderOptions
+    {
+        std::string InputPath;
+        std::string OutputPath;
+        int         GridRows         = 1;
+        int         GridColumns      = 1;
+        int         TileSize         = 16;
+        int         KeyframeInterval = 16;
+    };
+
+    bool parseOptions(int vArgc, char **vArgv, SEncoderOptions &voOptions)
+    {
+        std::vector<std::string> Positionals;
+        for (int i = 1; i < vArgc; ++i)
+        {
+            const char *pArg = vArgv[i];
+            const bool HasValue = i + 1 < vArgc;
+            if (std::strcmp(pArg, "--grid") == 0 && HasValue)
+            {
+                if (!hiveVG::tools::parseGrid(vArgv[++i], voOptions.GridRows, voOptions.GridColumns)) return false;
+            }
+            else if (std::strcmp(pArg, "--tile") == 0 && HasValue) voOptions.TileSize = std::atoi(vArgv[++i]);
+            else if (std::strcmp(pArg, "--keyframe-interval") == 0 && HasValue) voOptions.KeyframeInterval = std::atoi(vArgv[++i]);
+            else Positionals.emplace_back(pArg);
+        }
+        if (Positionals.size() != 2 || voOptions.TileSize <= 0 || voOptions.KeyframeInterval <= 0) return false;
+        voOptions.InputPath  = Positionals[0];
+        voOptions.OutputPath = Positionals[1];
+        return true;
+    }
+
+    // Decodes every frame forward and then in random order, comparing each against its source frame.
+    bool verifySequence(const std::vector<uint8_t> &vFile, const std::vector<hiveVG::SImageData> &vFrames)
+    {
+        hiveVG::SFrameSequence Sequence;
+        std::string Error;
+        if (!hiveVG::parseFrameSequence(vFile.data(), vFile.size(), Sequence, Error))
+        {
+            std::fprintf(stderr, "Written sequence does not parse: %s\n", Error.c_str());
+            return false;
+        }
+
+        hiveVG::CFrameSequenceDecoder Decoder(vFile.data(), Sequence);
+        auto StartTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < Sequence.getFrameCount(); ++i)
+        {
+            if (!Decoder.decodeFrame(i) || Decoder.getFrame().Pixels != vFrames[i].Pixels)
+            {
+                std::fprintf(stderr, "Frame %d does not round trip\n", i);
+                return false;
+            }
+        }
+        const double SequentialMs = hiveVG::tools::elapsedMs(StartTime);
+
+        std::vector<int> Order(Sequence.getFrameCount());
+        for (int i = 0; i < Sequence.getFrameCount(); ++i) Order[i] = i;
+        std::shuffle(Order.begin(), Order.end(), std::mt19937(7));
+        const uint64_t AppliedBefore = Decoder.getAppliedFrameCount();
+        StartTime = std::chrono::steady_clock::now();
+        for (int Frame : Order)
+        {
+            if (!Decoder.decodeFrame(Frame) || Decoder.getFrame().Pixels != vFrames[Frame].Pixels)
+            {
+                std::fprintf(stderr, "Frame %d does not round trip in random order\n", Frame);
+                return false;
+            }
+        }
+        const double RandomMs = hiveVG::tools::elapsedMs(StartTime);
+
+        const double MegaPixels = static_cast<double>(Sequence.FrameWidth) * Sequence.FrameHeight * Sequence.getFrameCount() / 1e6;
+        std::printf("decode sequential %.1f ms (%.0f Mpix/s), random %.1f ms (%.0f Mpix/s, %.1f payloads per frame)\n",
+                    SequentialMs, MegaPixels / (SequentialMs / 1000.0), RandomMs, MegaPixels / (RandomMs / 1000.0),
+                    static_cast<double>(Decoder.getAppliedFrameCount() - AppliedBefore) / Sequence.getFrameCount());
+        return true;
+    }
+}
+
+int main(int vArgc, char **vArgv)
+{
+    SEncoderOptions Options;
+    if (!parseOptions(vArgc, vArgv, Options))
+    {
+        std::fprintf(stderr, "Usage: %s <atlas.png|jpg> <output.hseq> --grid RxC [--tile N] [--keyframe-interval N]\n", vArgv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> FileBytes;
+    hiveVG::SImageData Atlas;
+    if (!hiveVG::tools::readFileBytes(Options.InputPath, FileBytes) || !hiveVG::decodeImageFromMemory(FileBytes.data(), FileBytes.size(), Atlas))
+    {
+        std::fprintf(stderr, "Cannot decode %s\n", Options.InputPath.c_str());
+        return 1;
+    }
+    if (Atlas.Width % Options.GridColumns != 0 || Atlas.Height % Options.GridRows != 0)
+    {
+        std::fprintf(stderr, "%dx%d atlas does not split into a %dx%d grid\n", Atlas.Width, Atlas.Height, Options.GridRows, Options.GridColumns);
+        return 1;
+    }
+
+    const std::vector<hiveVG::SImageData> Frames = hiveVG::tools::sliceGridFrames(Atlas, Options.GridRows, Options.GridColumns);
+    auto StartTime = std::chrono::steady_clock::now();
+    hiveVG::tools::SFrameSequenceEncodeStats Stats;
+    const std::vector<uint8_t> Sequence = hiveVG::tools::encodeFrameSequence(Frames, Options.TileSize, Options.KeyframeInterval, Stats);
+    const double EncodeMs = hiveVG::tools::elapsedMs(StartTime);
+    if (!hiveVG::tools::writeFileBytes(Options.OutputPath, Sequence))
+    {
+        std::fprintf(stderr, "Cannot write %s\n", Options.OutputPath.c_str());
+        return 1;
+    }
+
+    std::printf("%zu frames of %dx%d, %d keyframes, %.1f%% of delta tiles changed, encode %.1f ms\n", Frames.size(),
+                Frames[0].Width, Frames[0].Height, Stats.KeyframeCount,
+                Stats.DeltaTileCount ? 100.0 * Stats.ChangedTileCount / Stats.DeltaTileCount : 0.0, EncodeMs);
+    std::printf("size: source %zu KiB, raw RGBA8 %zu KiB, hseq %zu KiB (%.1fx smaller than raw, %.2fx the source)\n", FileBytes.size() / 1024,
+                Stats.RawBytes / 1024, Stats.EncodedBytes / 1024, static_cast<double>(Stats.RawBytes) / Stats.EncodedBytes,
+                static_cast<double>(Stats.EncodedBytes) / FileBytes.size());
+    return verifySequence(Sequence, Frames) ? 0 : 1;
+}
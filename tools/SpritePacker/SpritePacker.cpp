@@ -0,0 +1,196 @@
+#include "SpritePacker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace hiveVG::tools
+{
+    bool computeTrimRect(const SImageData &vFrame, int vAlphaThreshold, int &voX, int &voY, int &voWidth, int &voHeight)
+    {
+        int MinX = vFrame.Width, MinY = vFrame.Height, MaxX = -1, MaxY = -1;
+        for (int y = 0; y < vFrame.Height; ++y)
+        {
+            const uint8_t *pRow = vFrame.Pixels.data() + vFrame.getRowPitch() * y;
+            for (int x = 0; x < vFrame.Width; ++x)
+            {
+                if (pRow[x * 4 + 3] <= vAlphaThreshold) continue;
+                MinX = std::min(MinX, x);
+                MaxX = std::max(MaxX, x);
+                MinY = std::min(MinY, y);
+                MaxY = y;
+            }
+        }
+        if (MaxX < 0) return false;
+        MinX = std::max(MinX - 1, 0);
+        MinY = std::max(MinY - 1, 0);
+        MaxX = std::min(MaxX + 1, vFrame.Width - 1);
+        MaxY = std::min(MaxY + 1, vFrame.Height - 1);
+        voX      = MinX;
+        voY      = MinY;
+        voWidth  = MaxX - MinX + 1;
+        voHeight = MaxY - MinY + 1;
+        return true;
+    }
+
+    CMaxRectsBin::CMaxRectsBin(int vWidth, int vHeight)
+    {
+        m_FreeRects.push_back({0, 0, vWidth, vHeight});
+    }
+
+    bool CMaxRectsBin::insert(int vWidth, int vHeight, int &voX, int &voY)
+    {
+        int BestShortSide = std::numeric_limits<int>::max(), BestLongSide = std::numeric_limits<int>::max();
+        const SRect *pBest = nullptr;
+        for (const SRect &Free : m_FreeRects)
+        {
+            if (Free.Width < vWidth || Free.Height < vHeight) continue;
+            const int LeftoverX = Free.Width - vWidth, LeftoverY = Free.Height - vHeight;
+            const int ShortSide = std::min(LeftoverX, LeftoverY), LongSide = std::max(LeftoverX, LeftoverY);
+            if (ShortSide < BestShortSide || (ShortSide == BestShortSide && LongSide < BestLongSide))
+            {
+                BestShortSide = ShortSide;
+                BestLongSide  = LongSide;
+                pBest         = &Free;
+            }
+        }
+        if (pBest == nullptr) return false;
+
+        const SRect Used = {pBest->X, pBest->Y, vWidth, vHeight};
+        __splitFreeRects(Used);
+        __pruneFreeRects();
+        m_UsedWidth  = std::max(m_UsedWidth, Used.X + Used.Width);
+        m_UsedHeight = std::max(m_UsedHeight, Used.Y + Used.Height);
+        voX = Used.X;
+        voY = Used.Y;
+        return true;
+    }
+
+    void CMaxRectsBin::__splitFreeRects(const SRect &vUsed)
+    {
+        std::vector<SRect> Split;
+        Split.reserve(m_FreeRects.size() + 4);
+        for (const SRect &Free : m_FreeRects)
+        {
+            const bool IsOverlapping = vUsed.X < Free.X + Free.Width && vUsed.X + vUsed.Width > Free.X && vUsed.Y < Free.Y + Free.Height &&
+                                       vUsed.Y + vUsed.Height > Free.Y;
+            if (!IsOverlapping)
+            {
+                Split.push_back(Free);
+                continue;
+            }
+            // What is left of the free rect on each side of the used one, each piece maximal and overlapping the others
+            if (vUsed.X > Free.X) Split.push_back({Free.X, Free.Y, vUsed.X - Free.X, Free.Height});
+            if (vUsed.X + vUsed.Width < Free.X + Free.Width)
+                Split.push_back({vUsed.X + vUsed.Width, Free.Y, Free.X + Free.Width - vUsed.X - vUsed.Width, Free.Height});
+            if (vUsed.Y > Free.Y) Split.push_back({Free.X, Free.Y, Free.Width, vUsed.Y - Free.Y});
+            if (vUsed.Y + vUsed.Height < Free.Y + Free.Height)
+                Split.push_back({Free.X, vUsed.Y + vUsed.Height, Free.Width, Free.Y + Free.Height - vUsed.Y - vUsed.Height});
+        }
+        m_FreeRects.swap(Split);
+    }
+
+    void CMaxRectsBin::__pruneFreeRects()
+    {
+        const auto isInside = [](const SRect &vInner, const SRect &vOuter) {
+            return vInner.X >= vOuter.X && vInner.Y >= vOuter.Y && vInner.X + vInner.Width <= vOuter.X + vOuter.Width &&
+                   vInner.Y + vInner.Height <= vOuter.Y + vOuter.Height;
+        };
+        std::vector<bool> IsRedundant(m_FreeRects.size(), false);
+        for (size_t i = 0; i < m_FreeRects.size(); ++i)
+        {
+            for (size_t k = 0; k < m_FreeRects.size() && !IsRedundant[i]; ++k)
+            {
+                // Of two equal rects only the later one goes
+                if (i == k || IsRedundant[k] || !isInside(m_FreeRects[i], m_FreeRects[k])) continue;
+                IsRedundant[i] = true;
+            }
+        }
+        size_t Kept = 0;
+        for (size_t i = 0; i < m_FreeRects.size(); ++i)
+            if (!IsRedundant[i]) m_FreeRects[Kept++] = m_FreeRects[i];
+        m_FreeRects.resize(Kept);
+    }
+
+    bool packSprites(const std::vector<SImageData> &vFrames, const SSpritePackOptions &vOptions, SSpriteAtlas &voAtlas, std::vector<SImageData> &voPages)
+    {
+        voAtlas = {};
+        voPages.clear();
+        if (vFrames.empty()) return false;
+        voAtlas.FrameWidth  = vFrames[0].Width;
+        voAtlas.FrameHeight = vFrames[0].Height;
+        voAtlas.Frames.resize(vFrames.size());
+        for (size_t i = 0; i < vFrames.size(); ++i)
+        {
+            SSpriteRect &Rect = voAtlas.Frames[i];
+            if (!computeTrimRect(vFrames[i], vOptions.AlphaThreshold, Rect.OffsetX, Rect.OffsetY, Rect.Width, Rect.Height)) Rect = {};
+            if (Rect.Width + vOptions.Padding > vOptions.PageSize || Rect.Height + vOptions.Padding > vOptions.PageSize) return false;
+        }
+
+        // Largest first, by the longer side then area, is what MaxRects packs tightest
+        std::vector<size_t> Order(vFrames.size());
+        std::iota(Order.begin(), Order.end(), 0);
+        std::stable_sort(Order.begin(), Order.end(), [&](size_t vLeft, size_t vRight) {
+            const SSpriteRect &Left = voAtlas.Frames[vLeft], &Right = voAtlas.Frames[vRight];
+            const int LeftSide = std::max(Left.Width, Left.Height), RightSide = std::max(Right.Width, Right.Height);
+            if (LeftSide != RightSide) return LeftSide > RightSide;
+            return Left.Width * Left.Height > Right.Width * Right.Height;
+        });
+
+        // The smallest square page that holds every remaining rect, found by growing from their total area. Rects that
+        // cannot share one page fill a full size page and the rest go on to the next.
+        std::vector<size_t> Remaining;
+        for (size_t Frame : Order)
+            if (!voAtlas.Frames[Frame].isEmpty()) Remaining.push_back(Frame);
+        std::vector<CMaxRectsBin> Bins;
+        while (!Remaining.empty())
+        {
+            uint64_t Area = 0;
+            for (size_t Frame : Remaining)
+                Area += static_cast<uint64_t>(voAtlas.Frames[Frame].Width + vOptions.Padding) * (voAtlas.Frames[Frame].Height + vOptions.Padding);
+            int Side = std::min((static_cast<int>(std::ceil(std::sqrt(static_cast<double>(Area)))) + 3) / 4 * 4, vOptions.PageSize);
+            std::vector<size_t> Overflow;
+            while (true)
+            {
+                CMaxRectsBin Bin(Side, Side);
+                Overflow.clear();
+                for (size_t Frame : Remaining)
+                {
+                    SSpriteRect &Rect = voAtlas.Frames[Frame];
+                    Rect.Page = static_cast<int>(Bins.size());
+                    if (!Bin.insert(Rect.Width + vOptions.Padding, Rect.Height + vOptions.Padding, Rect.X, Rect.Y)) Overflow.push_back(Frame);
+                }
+                if (Overflow.empty() || Side == vOptions.PageSize)
+                {
+                    Bins.push_back(std::move(Bin));
+                    break;
+                }
+                Side = std::min((Side + Side / 16 + 3) / 4 * 4, vOptions.PageSize);
+            }
+            Remaining.swap(Overflow);
+        }
+
+        // Pages shrink to what they use, kept a multiple of 4 for block compression
+        for (const CMaxRectsBin &Bin : Bins)
+        {
+            SImageData Page;
+            Page.Width  = std::min((Bin.getUsedWidth() + 3) / 4 * 4, vOptions.PageSize);
+            Page.Height = std::min((Bin.getUsedHeight() + 3) / 4 * 4, vOptions.PageSize);
+            Page.Pixels.assign(Page.getByteSize(), 0);
+            voAtlas.Pages.push_back({Page.Width, Page.Height});
+            voPages.push_back(std::move(Page));
+        }
+        for (size_t i = 0; i < vFrames.size(); ++i)
+        {
+            const SSpriteRect &Rect = voAtlas.Frames[i];
+            if (Rect.isEmpty()) continue;
+            SImageData &Page = voPages[Rect.Page];
+            for (int y = 0; y < Rect.Height; ++y)
+                std::memcpy(Page.Pixels.data() + Page.getRowPitch() * (Rect.Y + y) + static_cast<size_t>(Rect.X) * 4,
+                            vFrames[i].Pixels.data() + vFrames[i].getRowPitch() * (Rect.OffsetY + y) + static_cast<size_t>(Rect.OffsetX) * 4,
+                            static_cast<size_t>(Rect.Width) * 4);
+        }
+        return true;
+    }
+}
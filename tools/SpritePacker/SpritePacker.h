@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include "ImageData.h"
+#include "SpriteAtlas.h"
+
+namespace hiveVG::tools
+{
+    struct SSpritePackOptions
+    {
+        int PageSize       = 2048;   // largest page side, pages are cropped to what they use afterwards
+        int Padding        = 1;      // transparent texels between packed rects
+        int AlphaThreshold = 0;      // texels with a larger alpha are kept by the trim
+    };
+
+    /*!
+     * Smallest rect holding every texel of vFrame with alpha above vAlphaThreshold, grown by one texel on each side
+     * (within the frame) so the bilinear fade at its edge survives the trim.
+     * @return false if no texel is above the threshold
+     */
+    bool computeTrimRect(const SImageData &vFrame, int vAlphaThreshold, int &voX, int &voY, int &voWidth, int &voHeight);
+
+    /*!
+     * MaxRects bin (Jukka Jylänki, "A Thousand Ways to Pack the Bin"): keeps every maximal free rectangle, places a
+     * rect by best short side fit and splits every free rectangle it overlaps.
+     */
+    class CMaxRectsBin
+    {
+    public:
+        CMaxRectsBin(int vWidth, int vHeight);
+
+        bool insert(int vWidth, int vHeight, int &voX, int &voY);
+        [[nodiscard]] int getUsedWidth() const { return m_UsedWidth; }
+        [[nodiscard]] int getUsedHeight() const { return m_UsedHeight; }
+
+    private:
+        struct SRect
+        {
+            int X = 0, Y = 0, Width = 0, Height = 0;
+        };
+
+        void __splitFreeRects(const SRect &vUsed);
+        void __pruneFreeRects();
+
+        std::vector<SRect> m_FreeRects;
+        int                m_UsedWidth  = 0;
+        int                m_UsedHeight = 0;
+    };
+
+    /*!
+     * Trims equally sized frames and packs them into as few pages as MaxRects manages, largest rects first.
+     * voPages are straight alpha RGBA8, transparent outside the rects.
+     * @return false if a trimmed frame is larger than a page
+     */
+    bool packSprites(const std::vector<SImageData> &vFrames, const SSpritePackOptions &vOptions, SSpriteAtlas &voAtlas, std::vector<SImageData> &voPages);
+}
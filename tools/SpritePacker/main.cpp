@@ -0,0 +1,147 @@
+// Trims the frames of a grid atlas to their alpha bounds and packs them into pages, for tight per frame quads.
+// Usage: spritePacker <atlas.png|jpg> <output.hspr> --grid RxC [--page N] [--padding N] [--alpha-threshold N]
+// Writes the rect table (see app/src/main/cpp/SpriteAtlas.h) and its pages next to it as <output>_<page>.png.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ImageDecoder.h"
+#include "SpriteAtlas.h"
+#include "SpritePacker.h"
+#include "../Common/ToolUtils.h"
+
+namespace
+{
+    struct SPackerOptions
+    {
+        std::string                       InputPath;
+        std::string                       OutputPath;
+        int                               GridRows    = 1;
+        int                               GridColumns = 1;
+        hiveVG::tools::SSpritePackOptions Pack;
+    };
+
+    bool parseOptions(int vArgc, char **vArgv, SPackerOptions &voOptions)
+    {
+        std::vector<std::string> Positionals;
+        for (int i = 1; i < vArgc; ++i)
+        {
+            const char *pArg = vArgv[i];
+            const bool HasValue = i + 1 < vArgc;
+            if (std::strcmp(pArg, "--grid") == 0 && HasValue)
+            {
+                if (!hiveVG::tools::parseGrid(vArgv[++i], voOptions.GridRows, voOptions.GridColumns)) return false;
+            }
+            else if (std::strcmp(pArg, "--page") == 0 && HasValue) voOptions.Pack.PageSize = std::atoi(vArgv[++i]);
+            else if (std::strcmp(pArg, "--padding") == 0 && HasValue) voOptions.Pack.Padding = std::atoi(vArgv[++i]);
+            else if (std::strcmp(pArg, "--alpha-threshold") == 0 && HasValue) voOptions.Pack.AlphaThreshold = std::atoi(vArgv[++i]);
+            else Positionals.emplace_back(pArg);
+        }
+        if (Positionals.size() != 2 || voOptions.Pack.PageSize < 4 || voOptions.Pack.PageSize > 16384 || voOptions.Pack.Padding < 0) return false;
+        voOptions.InputPath  = Positionals[0];
+        voOptions.OutputPath = Positionals[1];
+        return true;
+    }
+
+    // Every frame rebuilt from its rect must match the source wherever the trim kept something
+    bool verifyFrames(const std::vector<hiveVG::SImageData> &vFrames, const hiveVG::SSpriteAtlas &vAtlas, const std::vector<hiveVG::SImageData> &vPages,
+                      int vAlphaThreshold)
+    {
+        for (size_t i = 0; i < vFrames.size(); ++i)
+        {
+            const hiveVG::SSpriteRect &Rect = vAtlas.Frames[i];
+            const hiveVG::SImageData &Frame = vFrames[i];
+            for (int y = 0; y < Frame.Height; ++y)
+            {
+                for (int x = 0; x < Frame.Width; ++x)
+                {
+                    const uint8_t *pSource = Frame.Pixels.data() + Frame.getRowPitch() * y + static_cast<size_t>(x) * 4;
+                    const bool IsInRect = !Rect.isEmpty() && x >= Rect.OffsetX && x < Rect.OffsetX + Rect.Width && y >= Rect.OffsetY &&
+                                          y < Rect.OffsetY + Rect.Height;
+                    if (!IsInRect)
+                    {
+                        if (pSource[3] > vAlphaThreshold) return false;
+                        continue;
+                    }
+                    const hiveVG::SImageData &Page = vPages[Rect.Page];
+                    const uint8_t *pPacked = Page.Pixels.data() + Page.getRowPitch() * (Rect.Y + y - Rect.OffsetY) + static_cast<size_t>(Rect.X + x - Rect.OffsetX) * 4;
+                    if (std::memcmp(pSource, pPacked, 4) != 0) return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+int main(int vArgc, char **vArgv)
+{
+    SPackerOptions Options;
+    if (!parseOptions(vArgc, vArgv, Options))
+    {
+        std::fprintf(stderr, "Usage: %s <atlas.png|jpg> <output.hspr> --grid RxC [--page N] [--padding N] [--alpha-threshold N]\n", vArgv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> FileBytes;
+    hiveVG::SImageData Atlas;
+    if (!hiveVG::tools::readFileBytes(Options.InputPath, FileBytes) || !hiveVG::decodeImageFromMemory(FileBytes.data(), FileBytes.size(), Atlas))
+    {
+        std::fprintf(stderr, "Cannot decode %s\n", Options.InputPath.c_str());
+        return 1;
+    }
+    const std::vector<hiveVG::SImageData> Frames = hiveVG::tools::sliceGridFrames(Atlas, Options.GridRows, Options.GridColumns);
+
+    auto StartTime = std::chrono::steady_clock::now();
+    hiveVG::SSpriteAtlas SpriteAtlas;
+    std::vector<hiveVG::SImageData> Pages;
+    if (!hiveVG::tools::packSprites(Frames, Options.Pack, SpriteAtlas, Pages))
+    {
+        std::fprintf(stderr, "A trimmed frame does not fit a %d texel page\n", Options.Pack.PageSize);
+        return 1;
+    }
+    const double PackMs = hiveVG::tools::elapsedMs(StartTime);
+
+    // What is written must read back as it was packed
+    const std::vector<uint8_t> Table = hiveVG::serializeSpriteAtlas(SpriteAtlas);
+    hiveVG::SSpriteAtlas ReadBack;
+    std::string Error;
+    if (!hiveVG::parseSpriteAtlas(Table.data(), Table.size(), ReadBack, Error) || !verifyFrames(Frames, ReadBack, Pages, Options.Pack.AlphaThreshold))
+    {
+        std::fprintf(stderr, "The packed atlas does not reproduce the frames %s\n", Error.c_str());
+        return 1;
+    }
+    if (!hiveVG::tools::writeFileBytes(Options.OutputPath, Table))
+    {
+        std::fprintf(stderr, "Cannot write %s\n", Options.OutputPath.c_str());
+        return 1;
+    }
+    for (size_t i = 0; i < Pages.size(); ++i)
+    {
+        const std::string PagePath = hiveVG::getSpritePagePath(Options.OutputPath, static_cast<int>(i));
+        if (!hiveVG::tools::writeFileBytes(PagePath, hiveVG::tools::encodePngStored(Pages[i])))
+        {
+            std::fprintf(stderr, "Cannot write %s\n", PagePath.c_str());
+            return 1;
+        }
+    }
+
+    // Fill rate is what the tight quads cover against full screen quads, density is how much of the pages they cover
+    uint64_t TrimmedTexels = 0, PageTexels = 0;
+    int EmptyCount = 0;
+    for (const hiveVG::SSpriteRect &Rect : SpriteAtlas.Frames)
+    {
+        TrimmedTexels += static_cast<uint64_t>(Rect.Width) * Rect.Height;
+        EmptyCount += Rect.isEmpty() ? 1 : 0;
+    }
+    for (const hiveVG::SImageData &Page : Pages) PageTexels += static_cast<uint64_t>(Page.Width) * Page.Height;
+    const uint64_t CellTexels = static_cast<uint64_t>(SpriteAtlas.FrameWidth) * SpriteAtlas.FrameHeight * Frames.size();
+    std::printf("%zu frames of %dx%d, %d empty: trimmed rects cover %.1f%% of the cells, fill rate saving %.1f%%\n", Frames.size(),
+                SpriteAtlas.FrameWidth, SpriteAtlas.FrameHeight, EmptyCount, 100.0 * TrimmedTexels / CellTexels, 100.0 - 100.0 * TrimmedTexels / CellTexels);
+    std::printf("%zu pages", Pages.size());
+    for (const hiveVG::SImageData &Page : Pages) std::printf(" %dx%d", Page.Width, Page.Height);
+    std::printf(", packing density %.1f%%, %.2f MiB of pages against %.2f MiB of atlas, packed in %.1f ms\n",
+                PageTexels ? 100.0 * TrimmedTexels / PageTexels : 0.0, PageTexels * 4 / 1048576.0, CellTexels * 4 / 1048576.0, PackMs);
+    return 0;
+}
@@ -0,0 +1,620 @@
+// Host benchmark for the decode half of the texture pipeline, with the premultiply kernels timed against the scalar one.
+// Usage: textureBench [--threads N] [--iterations K] [--io read|mmap] [--surface WxH] [--cache-dir DIR] [--stream SEQ.hseq] [--scene FILE]
+//                     [--tiles RxC] [--upsample RxC] [--composite] <image>...
+// Pass or fail checks of the same subsystems are the host checks in tools/Checks, run by ctest.
+// Run once per --io mode to compare load time and peak RSS of copying reads against mapped files.
+// --surface decodes every file once per quality tier as a full screen layer of that surface.
+// --cache-dir compares decoding against warm disk cache loads, raw and LZ4 compressed.
+// --stream plays a .hseq sequence twice through CSequenceStreamer with a 60 Hz consumer and reports hits, misses and late frames.
+// --scene parses a scene file and lists the layers each quality tier draws, in draw order, with their GL state changes
+// and the framebuffer traffic of a pass per layer, with static layer groups cached, and of the single composite pass. --composite also prints the
+// composite fragment shader of the top tier.
+// --tiles cuts every image into an RxC grid of frames and times the tile occupancy scan per kernel against the scalar
+// one, then draws frame 0's drawn tiles as text.
+// --upsample cuts every image into an RxC grid of frames and compares each against its half and quarter resolution
+// mip upsampled back by the composite's linear and edge filters, as PSNR over the pixels either one shows.
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AssetSource.h"
+#include "CompositeShader.h"
+#include "DiskTextureCache.h"
+#include "ImageDecoder.h"
+#include "ImageResize.h"
+#include "FrameSequence.h"
+#include "MipChain.h"
+#include "PixelConvert.h"
+#include "QualityTier.h"
+#include "SceneDescription.h"
+#include "SequenceStreamer.h"
+#include "ThreadPool.h"
+#include "TileOccupancy.h"
+#include "../Common/SceneComposite.h"
+#include "../Common/ToolUtils.h"
+
+namespace
+{
+    struct SBenchOptions
+    {
+        size_t                   ThreadCount = 4;
+        int                      Iterations  = 5;
+        bool                     IsMapped    = true;
+        bool                     IsCompositePrinted = false;
+        int                      SurfaceWidth  = 0;
+        int                      SurfaceHeight = 0;
+        std::string              CacheDirectory;
+        std::string              SequencePath;
+        std::string              ScenePath;
+        int                      TileGridRows    = 0;   // atlas grid for --tiles, 0 skips the occupancy bench
+        int                      TileGridColumns = 0;
+        int                      UpsampleGridRows    = 0;   // frame grid for --upsample, 0 skips the upsample bench
+        int                      UpsampleGridColumns = 0;
+        std::vector<std::string> Files;
+    };
+
+    bool parseOptions(int vArgc, char **vArgv, SBenchOptions &voOptions)
+    {
+        for (int i = 1; i < vArgc; ++i)
+        {
+            if (std::strcmp(vArgv[i], "--threads") == 0 && i + 1 < vArgc)
+                voOptions.ThreadCount = std::strtoul(vArgv[++i], nullptr, 10);
+            else if (std::strcmp(vArgv[i], "--iterations") == 0 && i + 1 < vArgc)
+                voOptions.Iterations = std::atoi(vArgv[++i]);
+            else if (std::strcmp(vArgv[i], "--io") == 0 && i + 1 < vArgc)
+                voOptions.IsMapped = std::strcmp(vArgv[++i], "mmap") == 0;
+            else if (std::strcmp(vArgv[i], "--cache-dir") == 0 && i + 1 < vArgc)
+                voOptions.CacheDirectory = vArgv[++i];
+            else if (std::strcmp(vArgv[i], "--stream") == 0 && i + 1 < vArgc)
+                voOptions.SequencePath = vArgv[++i];
+            else if (std::strcmp(vArgv[i], "--scene") == 0 && i + 1 < vArgc)
+                voOptions.ScenePath = vArgv[++i];
+            else if (std::strcmp(vArgv[i], "--composite") == 0)
+                voOptions.IsCompositePrinted = true;
+            else if (std::strcmp(vArgv[i], "--tiles") == 0 && i + 1 < vArgc)
+            {
+                if (!hiveVG::tools::parseGrid(vArgv[++i], voOptions.TileGridRows, voOptions.TileGridColumns)) return false;
+            }
+            else if (std::strcmp(vArgv[i], "--upsample") == 0 && i + 1 < vArgc)
+            {
+                if (!hiveVG::tools::parseGrid(vArgv[++i], voOptions.UpsampleGridRows, voOptions.UpsampleGridColumns)) return false;
+            }
+            else if (std::strcmp(vArgv[i], "--surface") == 0 && i + 1 < vArgc)
+            {
+                if (std::sscanf(vArgv[++i], "%dx%d", &voOptions.SurfaceWidth, &voOptions.SurfaceHeight) != 2) return false;
+            }
+            else
+                voOptions.Files.emplace_back(vArgv[i]);
+        }
+        return (!voOptions.Files.empty() || !voOptions.SequencePath.empty() || !voOptions.ScenePath.empty()) &&
+               voOptions.Iterations > 0;
+    }
+
+    using hiveVG::tools::elapsedMs;
+
+    struct SFileView
+    {
+        const uint8_t *pData = nullptr;
+        size_t         Size  = 0;
+    };
+
+    void benchDecode(const std::vector<SFileView> &vFiles, const SBenchOptions &vOptions)
+    {
+        double SerialMs = 0.0, PooledMs = 0.0;
+        hiveVG::CThreadPool Pool(vOptions.ThreadCount);
+        for (int Iteration = 0; Iteration < vOptions.Iterations; ++Iteration)
+        {
+            auto Start = std::chrono::steady_clock::now();
+            for (const auto &Bytes : vFiles)
+            {
+                hiveVG::SImageData Image;
+                hiveVG::decodeImageFromMemory(Bytes.pData, Bytes.Size, Image);
+            }
+            SerialMs += elapsedMs(Start);
+
+            Start = std::chrono::steady_clock::now();
+            std::mutex DoneMutex;
+            std::condition_variable DoneCondition;
+            size_t DoneCount = 0;
+            for (const auto &Bytes : vFiles)
+            {
+                Pool.submit([&]() {
+                    hiveVG::SImageData Image;
+                    hiveVG::decodeImageFromMemory(Bytes.pData, Bytes.Size, Image);
+                    std::lock_guard<std::mutex> Lock(DoneMutex);
+                    ++DoneCount;
+                    DoneCondition.notify_one();
+                });
+            }
+            std::unique_lock<std::mutex> Lock(DoneMutex);
+            DoneCondition.wait(Lock, [&]() { return DoneCount == vFiles.size(); });
+            PooledMs += elapsedMs(Start);
+        }
+        std::printf("decode  serial %8.2f ms   pool(%zu) %8.2f ms   speedup %.2fx\n",
+                    SerialMs / vOptions.Iterations, Pool.getThreadCount(), PooledMs / vOptions.Iterations, SerialMs / PooledMs);
+    }
+
+    // Each tier as the loader applies it to a full screen layer: decode time and the RGBA8 bytes it leaves for VRAM
+    void benchQualityTiers(const std::vector<SFileView> &vFiles, const SBenchOptions &vOptions)
+    {
+        for (auto Tier : {hiveVG::EQualityTier::Source, hiveVG::EQualityTier::High, hiveVG::EQualityTier::Medium, hiveVG::EQualityTier::Low})
+        {
+            const hiveVG::SDecodeTarget Target = {vOptions.SurfaceWidth, vOptions.SurfaceHeight, Tier};
+            double TotalMs = 0.0;
+            size_t TotalBytes = 0;
+            for (const auto &Bytes : vFiles)
+            {
+                for (int Iteration = 0; Iteration < vOptions.Iterations; ++Iteration)
+                {
+                    auto Start = std::chrono::steady_clock::now();
+                    auto pDecoder = hiveVG::createImageRegionDecoder(Bytes.pData, Bytes.Size);
+                    if (pDecoder == nullptr) break;
+                    int Width, Height;
+                    if (hiveVG::computeDecodeSize(Target, pDecoder->getWidth(), pDecoder->getHeight(), 1, 1, Width, Height)) pDecoder->setTargetSize(Width, Height);
+                    hiveVG::SImageData Image;
+                    if (!pDecoder->decodeRows(0, pDecoder->getHeight(), Image)) break;
+                    TotalMs += elapsedMs(Start);
+                    if (Iteration == 0) TotalBytes += Image.getByteSize();
+                }
+            }
+            std::printf("tier %-6s (%dx%d)   decode %8.2f ms   %8.1f MiB\n", hiveVG::getQualityTierName(Tier), vOptions.SurfaceWidth, vOptions.SurfaceHeight,
+                        TotalMs / vOptions.Iterations, TotalBytes / 1048576.0);
+        }
+    }
+
+    // The bilinear step of the downscaler per kernel. Sums are ordered differently per kernel, so a texel may round the other way.
+    void benchResample(const std::vector<SFileView> &vFiles, const SBenchOptions &vOptions)
+    {
+        std::vector<hiveVG::SImageData> Images;
+        for (const auto &Bytes : vFiles)
+        {
+            Images.emplace_back();
+            if (!hiveVG::decodeImageFromMemory(Bytes.pData, Bytes.Size, Images.back())) Images.pop_back();
+        }
+
+        std::vector<hiveVG::SImageData> References;
+        for (const auto &Image : Images)
+            References.push_back(hiveVG::resampleBilinear(Image, Image.Width * 2 / 3, Image.Height * 2 / 3, hiveVG::EPixelKernel::Scalar));
+        for (int Kernel = 0; Kernel < static_cast<int>(hiveVG::EPixelKernel::Count); ++Kernel)
+        {
+            const auto PixelKernel = static_cast<hiveVG::EPixelKernel>(Kernel);
+            if (!hiveVG::isPixelKernelAvailable(PixelKernel) || PixelKernel == hiveVG::EPixelKernel::AVX2) continue;
+            double TotalMs = 0.0;
+            size_t TotalPixels = 0;
+            int MaxDifference = 0;
+            for (size_t i = 0; i < Images.size(); ++i)
+            {
+                for (int Iteration = 0; Iteration < vOptions.Iterations; ++Iteration)
+                {
+                    auto Start = std::chrono::steady_clock::now();
+                    hiveVG::SImageData Resampled = hiveVG::resampleBilinear(Images[i], References[i].Width, References[i].Height, PixelKernel);
+                    TotalMs += elapsedMs(Start);
+                    TotalPixels += Resampled.Pixels.size() / 4;
+                    for (size_t k = 0; Iteration == 0 && k < Resampled.Pixels.size(); ++k)
+                        MaxDifference = std::max(MaxDifference, std::abs(Resampled.Pixels[k] - References[i].Pixels[k]));
+                }
+            }
+            std::printf("resample %-6s %8.1f Mpix/s   max diff %d\n", hiveVG::getPixelKernelName(PixelKernel), TotalPixels / (TotalMs * 1000.0), MaxDifference);
+        }
+    }
+
+    void benchDiskCache(const std::vector<SFileView> &vFiles, const SBenchOptions &vOptions)
+    {
+        for (auto Compression : {hiveVG::EDiskTextureCompression::None, hiveVG::EDiskTextureCompression::LZ4})
+        {
+            hiveVG::CDiskTextureCache Cache(vOptions.CacheDirectory, Compression);
+            Cache.clear();
+            double DecodeMs = 0.0, WarmMs = 0.0;
+            uint64_t DiskBytes = 0;
+            for (size_t i = 0; i < vFiles.size(); ++i)
+            {
+                const std::string Key = "bench/" + std::to_string(i) + "|" + std::to_string(hiveVG::CDiskTextureCache::hashBytes(vFiles[i].pData, vFiles[i].Size));
+                auto Start = std::chrono::steady_clock::now();
+                hiveVG::SImageData Image;
+                if (!hiveVG::decodeImageFromMemory(vFiles[i].pData, vFiles[i].Size, Image)) continue;
+                hiveVG::premultiplyAlpha(Image, hiveVG::EAlphaConversion::Premultiply);
+                const std::vector<hiveVG::SImageData> MipLevels = hiveVG::generateSubLevels(Image, hiveVG::EAlphaMode::Premultiplied);
+                DecodeMs += elapsedMs(Start);
+                if (!Cache.store(Key, Image, MipLevels)) continue;
+                for (int Iteration = 0; Iteration < vOptions.Iterations; ++Iteration)
+                {
+                    Start = std::chrono::steady_clock::now();
+                    hiveVG::SCachedTexture Warm;
+                    Cache.load(Key, Warm);
+                    WarmMs += elapsedMs(Start) / vOptions.Iterations;
+                }
+                struct stat FileStat{};
+                if (stat(Cache.getEntryPath(Key).c_str(), &FileStat) == 0) DiskBytes += static_cast<uint64_t>(FileStat.st_size);
+            }
+            const hiveVG::SDiskTextureCacheStats Stats = Cache.getStats();
+            std::printf("disk cache %-4s   decode+mips %8.2f ms   warm load %8.2f ms   %6.1f MiB on disk   %llu hits\n",
+                        Compression == hiveVG::EDiskTextureCompression::LZ4 ? "lz4" : "raw", DecodeMs, WarmMs, DiskBytes / 1048576.0,
+                        static_cast<unsigned long long>(Stats.HitCount));
+            Cache.clear();
+        }
+    }
+
+    void benchPremultiply(const std::vector<SFileView> &vFiles, const SBenchOptions &vOptions)
+    {
+        std::vector<hiveVG::SImageData> Images;
+        for (const auto &Bytes : vFiles)
+        {
+            Images.emplace_back();
+            if (!hiveVG::decodeImageFromMemory(Bytes.pData, Bytes.Size, Images.back())) Images.pop_back();
+        }
+
+        for (auto Conversion : {hiveVG::EAlphaConversion::Premultiply, hiveVG::EAlphaConversion::PremultiplyLinear})
+        {
+            const char *pConversionName = Conversion == hiveVG::EAlphaConversion::Premultiply ? "premul" : "premul+linear";
+            std::vector<hiveVG::SImageData> References = Images;
+            for (auto &Reference : References)
+                hiveVG::premultiplyAlpha(Reference.Pixels.data(), Reference.Pixels.size() / 4, Conversion, hiveVG::EPixelKernel::Scalar);
+
+            for (int Kernel = 0; Kernel < static_cast<int>(hiveVG::EPixelKernel::Count); ++Kernel)
+            {
+                const auto PixelKernel = static_cast<hiveVG::EPixelKernel>(Kernel);
+                if (!hiveVG::isPixelKernelAvailable(PixelKernel)) continue;
+
+                double TotalMs = 0.0;
+                size_t TotalPixels = 0;
+                bool IsKernelExact = true;
+                for (size_t i = 0; i < Images.size(); ++i)
+                {
+                    for (int Iteration = 0; Iteration < vOptions.Iterations; ++Iteration)
+                    {
+                        std::vector<uint8_t> Pixels = Images[i].Pixels;
+                        auto Start = std::chrono::steady_clock::now();
+                        hiveVG::premultiplyAlpha(Pixels.data(), Pixels.size() / 4, Conversion, PixelKernel);
+                        TotalMs += elapsedMs(Start);
+                        TotalPixels += Pixels.size() / 4;
+                        if (Iteration == 0 && Pixels != References[i].Pixels) IsKernelExact = false;
+                    }
+                }
+                std::printf("%-14s %-6s %8.1f Mpix/s   %s\n", pConversionName, hiveVG::getPixelKernelName(PixelKernel),
+                            TotalPixels / (TotalMs * 1000.0), IsKernelExact ? "exact" : "MISMATCH");
+            }
+        }
+    }
+
+    void benchTileOccupancy(const std::vector<SFileView> &vFiles, const SBenchOptions &vOptions)
+    {
+        std::vector<hiveVG::SImageData> Frames;
+        for (const auto &Bytes : vFiles)
+        {
+            hiveVG::SImageData Atlas;
+            if (!hiveVG::decodeImageFromMemory(Bytes.pData, Bytes.Size, Atlas)) continue;
+            for (hiveVG::SImageData &Frame : hiveVG::tools::sliceGridFrames(Atlas, vOptions.TileGridRows, vOptions.TileGridColumns))
+                Frames.push_back(std::move(Frame));
+        }
+        if (Frames.empty()) return;
+
+        using namespace hiveVG::TILE_OCCUPANCY;
+        std::vector<hiveVG::STileOccupancy> References(Frames.size());
+        for (size_t i = 0; i < Frames.size(); ++i)
+            hiveVG::buildTileOccupancy(Frames[i], TileSize, AlphaThreshold, Margin, hiveVG::EPixelKernel::Scalar, References[i]);
+
+        for (int Kernel = 0; Kernel < static_cast<int>(hiveVG::EPixelKernel::Count); ++Kernel)
+        {
+            const auto PixelKernel = static_cast<hiveVG::EPixelKernel>(Kernel);
+            if (!hiveVG::isPixelKernelAvailable(PixelKernel)) continue;
+            double TotalMs = 0.0;
+            size_t TotalPixels = 0;
+            bool IsKernelExact = true;
+            hiveVG::STileOccupancy Occupancy;
+            for (int Iteration = 0; Iteration < vOptions.Iterations; ++Iteration)
+            {
+                for (size_t i = 0; i < Frames.size(); ++i)
+                {
+                    auto Start = std::chrono::steady_clock::now();
+                    hiveVG::buildTileOccupancy(Frames[i], TileSize, AlphaThreshold, Margin, PixelKernel, Occupancy);
+                    TotalMs += elapsedMs(Start);
+                    TotalPixels += static_cast<size_t>(Frames[i].Width) * Frames[i].Height;
+                    if (Iteration == 0 && Occupancy.Bits != References[i].Bits) IsKernelExact = false;
+                }
+            }
+            std::printf("occupancy %-6s %8.1f Mpix/s   %.3f ms per frame   %s\n", hiveVG::getPixelKernelName(PixelKernel), TotalPixels / (TotalMs * 1000.0),
+                        TotalMs / (vOptions.Iterations * Frames.size()), IsKernelExact ? "exact" : "MISMATCH");
+        }
+
+        // What the renderer draws: the tiles of the frame and the one it fades to, grown by a tile while motion warps them
+        size_t TileCount = 0, FadeTileCount = 0, WarpTileCount = 0;
+        std::vector<uint16_t> Tiles;
+        for (size_t i = 0; i < Frames.size(); ++i)
+        {
+            const hiveVG::STileOccupancy *pNext = &References[(i + 1) % Frames.size()];
+            TileCount += References[i].getOccupiedCount();
+            Tiles.clear();
+            hiveVG::collectOccupiedTiles({&References[i], pNext}, 0, Tiles);
+            FadeTileCount += Tiles.size() / 2;
+            Tiles.clear();
+            hiveVG::collectOccupiedTiles({&References[i], pNext}, 1, Tiles);
+            WarpTileCount += Tiles.size() / 2;
+        }
+        const hiveVG::STileOccupancy &First = References.front();
+        const double GridTiles = static_cast<double>(First.Columns) * First.Rows * Frames.size();
+        std::printf("tiles %dx%d of %dpx: %.1f%% occupied, %.1f%% drawn cross fading, %.1f%% drawn motion warped\n", First.Columns, First.Rows, TileSize,
+                    100.0 * TileCount / GridTiles, 100.0 * FadeTileCount / GridTiles, 100.0 * WarpTileCount / GridTiles);
+        for (int Row = 0; Row < First.Rows; ++Row)
+        {
+            std::string Line;
+            for (int Column = 0; Column < First.Columns; ++Column) Line += First.isOccupied(Column, Row) ? '#' : '.';
+            std::printf("  %s\n", Line.c_str());
+        }
+    }
+
+    // upsampleLayer() of CompositeShader.cpp on the CPU, vLayer premultiplied RGBA8 stretched over vWidth x vHeight
+    hiveVG::SImageData upsampleLayer(const hiveVG::SImageData &vLayer, int vWidth, int vHeight, float vEdgeSharpness)
+    {
+        hiveVG::SImageData Result;
+        Result.Width  = vWidth;
+        Result.Height = vHeight;
+        Result.Pixels.resize(static_cast<size_t>(vWidth) * vHeight * 4);
+        auto fetch = [&vLayer](int vX, int vY) {
+            return &vLayer.Pixels[(static_cast<size_t>(std::clamp(vY, 0, vLayer.Height - 1)) * vLayer.Width + std::clamp(vX, 0, vLayer.Width - 1)) * 4];
+        };
+        auto smoothstep = [](float vValue) { return vValue * vValue * (3.0f - 2.0f * vValue); };
+        for (int Y = 0; Y < vHeight; ++Y)
+        {
+            for (int X = 0; X < vWidth; ++X)
+            {
+                const float PositionX = (X + 0.5f) / vWidth * vLayer.Width - 0.5f, PositionY = (Y + 0.5f) / vHeight * vLayer.Height - 0.5f;
+                const int BaseX = static_cast<int>(std::floor(PositionX)), BaseY = static_cast<int>(std::floor(PositionY));
+                float FractionX = PositionX - BaseX, FractionY = PositionY - BaseY;
+                const uint8_t *pTexels[4] = {fetch(BaseX, BaseY), fetch(BaseX + 1, BaseY), fetch(BaseX, BaseY + 1), fetch(BaseX + 1, BaseY + 1)};
+                if (vEdgeSharpness > 0.0f)
+                {
+                    const auto [MinAlpha, MaxAlpha] = std::minmax({pTexels[0][3], pTexels[1][3], pTexels[2][3], pTexels[3][3]});
+                    const float Sharpening = std::clamp((MaxAlpha - MinAlpha) / 255.0f * vEdgeSharpness, 0.0f, 1.0f);
+                    FractionX += (smoothstep(FractionX) - FractionX) * Sharpening;
+                    FractionY += (smoothstep(FractionY) - FractionY) * Sharpening;
+                }
+                uint8_t *pResult = &Result.Pixels[(static_cast<size_t>(Y) * vWidth + X) * 4];
+                for (int Channel = 0; Channel < 4; ++Channel)
+                {
+                    const float Top = pTexels[0][Channel] + (pTexels[1][Channel] - pTexels[0][Channel]) * FractionX;
+                    const float Bottom = pTexels[2][Channel] + (pTexels[3][Channel] - pTexels[2][Channel]) * FractionX;
+                    pResult[Channel] = static_cast<uint8_t>(std::lround(Top + (Bottom - Top) * FractionY));
+                }
+            }
+        }
+        return Result;
+    }
+
+    // A layer drawn at half and quarter scale against the full one; empty space in both is not counted
+    void benchUpsample(const std::vector<SFileView> &vFiles, const SBenchOptions &vOptions)
+    {
+        constexpr int ReducedLevelCount = 2;
+        std::vector<hiveVG::SImageData> Frames;
+        for (const auto &Bytes : vFiles)
+        {
+            hiveVG::SImageData Atlas;
+            if (!hiveVG::decodeImageFromMemory(Bytes.pData, Bytes.Size, Atlas)) continue;
+            for (hiveVG::SImageData &Frame : hiveVG::tools::sliceGridFrames(Atlas, vOptions.UpsampleGridRows, vOptions.UpsampleGridColumns))
+            {
+                hiveVG::premultiplyAlpha(Frame, hiveVG::EAlphaConversion::Premultiply);
+                Frames.push_back(std::move(Frame));
+            }
+        }
+        if (Frames.empty()) return;
+
+        for (int Level = 1; Level <= ReducedLevelCount; ++Level)
+        {
+            double SquaredErrors[2] = {0.0, 0.0};
+            size_t SampleCounts[2] = {0, 0};
+            double TotalMs[2] = {0.0, 0.0};
+            for (const hiveVG::SImageData &Frame : Frames)
+            {
+                const hiveVG::SImageData Reduced = hiveVG::generateMipChain(Frame, hiveVG::EAlphaMode::Premultiplied, ReducedLevelCount + 1)[Level];
+                for (int Filter = 0; Filter < 2; ++Filter)
+                {
+                    auto Start = std::chrono::steady_clock::now();
+                    const hiveVG::SImageData Upsampled = upsampleLayer(Reduced, Frame.Width, Frame.Height, Filter == 0 ? 0.0f : hiveVG::COMPOSITE_SHADER::EdgeSharpness);
+                    TotalMs[Filter] += elapsedMs(Start);
+                    for (size_t i = 0; i < Frame.Pixels.size(); i += 4)
+                    {
+                        if (Frame.Pixels[i + 3] == 0 && Upsampled.Pixels[i + 3] == 0) continue;
+                        for (size_t Channel = 0; Channel < 4; ++Channel)
+                        {
+                            const double Difference = Frame.Pixels[i + Channel] - Upsampled.Pixels[i + Channel];
+                            SquaredErrors[Filter] += Difference * Difference;
+                        }
+                        SampleCounts[Filter] += 4;
+                    }
+                }
+            }
+            auto psnr = [](double vSquaredError, size_t vCount) { return vSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 * vCount / vSquaredError) : 99.0; };
+            std::printf("upsample 1/%d: linear %.2f dB, edge %.2f dB visible PSNR over %zu frames (%.2f and %.2f ms per frame on the CPU)\n", 1 << Level,
+                        psnr(SquaredErrors[0], SampleCounts[0]), psnr(SquaredErrors[1], SampleCounts[1]), Frames.size(), TotalMs[0] / Frames.size(),
+                        TotalMs[1] / Frames.size());
+        }
+    }
+
+    // The renderer's playback loop without GL: a frame is due every 1/48 s, it is shown only if resident, and uploads
+    // just mark their ring layer. Two loops, so the ring wraps and the second loop starts from a warm decoder.
+    bool benchSequenceStream(const std::string &vSequencePath)
+    {
+        constexpr int FramesPerSecond = 48, WindowSize = 32, MaxUploadsPerTick = 1;
+        constexpr auto TickPeriod = std::chrono::microseconds(1000000 / 60);
+        hiveVG::CDirectoryAssetSource DirectorySource("");
+        auto pFile = DirectorySource.open(vSequencePath);
+        hiveVG::SFrameSequence Sequence;
+        std::string Error;
+        if (pFile == nullptr || !hiveVG::parseFrameSequence(pFile->getData(), pFile->getSize(), Sequence, Error))
+        {
+            std::fprintf(stderr, "Cannot read %s %s\n", vSequencePath.c_str(), Error.c_str());
+            return false;
+        }
+        const int FrameCount = Sequence.getFrameCount();
+        hiveVG::SSequenceStreamFormat Format;
+        Format.FrameWidth  = Sequence.FrameWidth;
+        Format.FrameHeight = Sequence.FrameHeight;
+        Format.LevelCount  = hiveVG::computeFullMipLevelCount(Format.FrameWidth, Format.FrameHeight);
+        Format.AlphaConversion = hiveVG::EAlphaConversion::Premultiply;
+        Format.MipAlphaMode    = hiveVG::EAlphaMode::Premultiplied;
+        const size_t FileSize = pFile->getSize();
+        hiveVG::CSequenceStreamer Streamer(std::make_unique<hiveVG::CFrameSequenceSource>(std::move(pFile), std::move(Sequence), Format), WindowSize - 1, FramesPerSecond);
+
+        std::vector<int> LayerFrames(WindowSize, -1);
+        const auto isResident = [&](int vFrame) { return std::find(LayerFrames.begin(), LayerFrames.end(), vFrame) != LayerFrames.end(); };
+        int CurrentFrame = 0, ShownCount = 0;
+        auto Start = std::chrono::steady_clock::now(), LastFrameTime = Start, NextTick = Start;
+        while (ShownCount < FrameCount * 2 && elapsedMs(Start) < FrameCount * 2 * 4000.0 / FramesPerSecond)
+        {
+            Streamer.setPlaybackFrame(CurrentFrame);
+            hiveVG::SStreamedFrame Streamed;
+            for (int i = 0; i < MaxUploadsPerTick && Streamer.popFrame(WindowSize, Streamed); ++i)
+            {
+                LayerFrames[Streamed.Position % WindowSize] = Streamed.Frame;
+                Streamer.recycleFrame(std::move(Streamed.pFrame));
+            }
+            const auto Now = std::chrono::steady_clock::now();
+            if (Now - LastFrameTime >= std::chrono::microseconds(1000000 / FramesPerSecond))
+            {
+                const int NextFrame = (CurrentFrame + 1) % FrameCount;
+                Streamer.recordFrameDue(isResident(NextFrame));
+                if (isResident(NextFrame))
+                {
+                    CurrentFrame = NextFrame;
+                    LastFrameTime = Now;
+                    ++ShownCount;
+                }
+            }
+            NextTick += TickPeriod;
+            std::this_thread::sleep_until(NextTick);
+        }
+
+        const hiveVG::SSequenceStreamStats Stats = Streamer.getStats();
+        std::printf("stream  %d frames of %dx%d (%zu KiB), window %d: %llu hits, %llu misses, %llu late, %llu skipped, %.2f ms per decoded frame\n",
+                    FrameCount, Format.FrameWidth, Format.FrameHeight, FileSize / 1024, WindowSize, static_cast<unsigned long long>(Stats.HitCount),
+                    static_cast<unsigned long long>(Stats.MissCount), static_cast<unsigned long long>(Stats.LateCount),
+                    static_cast<unsigned long long>(Stats.SkipCount), Stats.DecodedCount ? Stats.DecodeMs / Stats.DecodedCount : 0.0);
+        // Ring layers plus the streamer's four queued buffers and the one it decodes into, mip chains included
+        const double FrameMiB = static_cast<double>(Format.FrameWidth) * Format.FrameHeight * 4 * 4 / 3 / 1048576.0;
+        std::printf("stream  working set %.1f MiB, every frame resident would be %.1f MiB\n", FrameMiB * (WindowSize + 5), FrameMiB * FrameCount);
+        return ShownCount == FrameCount * 2;
+    }
+
+    // What the renderer builds from a scene file on each tier. File order is the same layers unsorted within a depth.
+    bool checkScene(const std::string &vScenePath, bool vIsCompositePrinted)
+    {
+        constexpr size_t MinStaticGroupLayers = 2;   // as the renderer groups them
+        std::vector<uint8_t> Bytes;
+        hiveVG::SSceneDescription Scene;
+        if (!hiveVG::tools::readFileBytes(vScenePath, Bytes) || !hiveVG::parseSceneDescription(reinterpret_cast<const char *>(Bytes.data()), Bytes.size(), Scene))
+            return false;
+        hiveVG::SCompositeShader CompositeShader;   // of the last tier with one
+        for (hiveVG::EQualityTier Tier : {hiveVG::EQualityTier::Low, hiveVG::EQualityTier::Medium, hiveVG::EQualityTier::High, hiveVG::EQualityTier::Source})
+        {
+            const std::vector<hiveVG::SSceneLayer> Layers = hiveVG::selectSceneLayers(Scene, Tier);
+            std::vector<hiveVG::SSceneLayer> FileOrder;
+            for (const auto &Layer : Scene.Layers)
+                if (Layer.MinTier <= Tier) FileOrder.push_back(Layer);
+            std::stable_sort(FileOrder.begin(), FileOrder.end(), [](const auto &vLeft, const auto &vRight) { return vLeft.Depth < vRight.Depth; });
+            std::string Names;
+            for (const auto &Layer : Layers) Names += (Names.empty() ? "" : ", ") + Layer.Name;
+            std::printf("scene   %-6s %zu of %zu layers, %d state changes (%d in file order): %s\n", hiveVG::getQualityTierName(Tier), Layers.size(),
+                        Scene.Layers.size(), hiveVG::countSceneStateChanges(Layers), hiveVG::countSceneStateChanges(FileOrder), Names.c_str());
+
+            // Framebuffer bytes per pixel of a pass per layer, then with the renderer's static groups drawn as one pass each
+            const std::vector<hiveVG::SStaticLayerGroup> Groups = hiveVG::findStaticLayerGroups(Layers, MinStaticGroupLayers);
+            std::vector<hiveVG::SCompositeLayer> CompositeLayers;
+            hiveVG::tools::buildSceneComposite(Layers, {}, Tier, CompositeLayers, CompositeShader);
+            const int LayerPassBytes = hiveVG::computeFramebufferBytesPerPixel(CompositeLayers);
+            const bool IsComposited = hiveVG::tools::buildSceneComposite(Layers, Groups, Tier, CompositeLayers, CompositeShader);
+            std::string GroupNames;
+            for (const auto &Group : Groups)
+                GroupNames += (GroupNames.empty() ? ", static groups " : " and ") + Layers[Group.FirstLayer].Name + " to " +
+                              Layers[Group.FirstLayer + Group.LayerCount - 1].Name + (Group.IsOpaque ? " (opaque)" : " (blended)");
+            std::printf("        %-6s %d framebuffer bytes per pixel a pass per layer, %d with static groups%s\n", "", LayerPassBytes,
+                        hiveVG::computeFramebufferBytesPerPixel(CompositeLayers), GroupNames.c_str());
+            std::string ReducedNames;
+            for (const auto &Layer : Layers)
+            {
+                if (Layer.getRenderScale(Tier) >= 1.0f) continue;
+                char Scale[64];
+                std::snprintf(Scale, sizeof(Scale), " at %.2f, %s upsampled", Layer.getRenderScale(Tier), Layer.UpsampleFilter == hiveVG::ESceneUpsampleFilter::Edge ? "edge" : "linear");
+                ReducedNames += (ReducedNames.empty() ? "" : ", ") + Layer.Name + Scale;
+            }
+            if (!ReducedNames.empty())
+                std::printf("        %-6s reduced layers %s\n", "", ReducedNames.c_str());
+            if (IsComposited)
+                std::printf("        %-6s composite on %d texture units, 4 framebuffer bytes per pixel\n", "", CompositeShader.TextureUnitCount);
+        }
+        if (vIsCompositePrinted && !CompositeShader.FragmentSource.empty())
+            std::printf("%s", CompositeShader.FragmentSource.c_str());
+        return true;
+    }
+}
+
+int main(int vArgc, char **vArgv)
+{
+    SBenchOptions Options;
+    if (!parseOptions(vArgc, vArgv, Options))
+    {
+        std::fprintf(stderr, "Usage: %s [--threads N] [--iterations K] [--io read|mmap] [--surface WxH] [--cache-dir DIR] [--stream SEQ.hseq] [--scene FILE] "
+                             "[--tiles RxC] [--upsample RxC] [--composite] <image>...\n", vArgv[0]);
+        return 1;
+    }
+
+    // Paths are taken as given, the same way the APK source resolves them against the asset root
+    hiveVG::CDirectoryAssetSource DirectorySource("");
+    std::vector<std::vector<uint8_t>> ReadFiles(Options.Files.size());
+    std::vector<std::unique_ptr<hiveVG::CAssetBuffer>> MappedFiles(Options.Files.size());
+    std::vector<SFileView> Files(Options.Files.size());
+    auto Start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < Options.Files.size(); ++i)
+    {
+        bool IsLoaded = false;
+        if (Options.IsMapped)
+        {
+            MappedFiles[i] = DirectorySource.open(Options.Files[i]);
+            if ((IsLoaded = MappedFiles[i] != nullptr)) Files[i] = {MappedFiles[i]->getData(), MappedFiles[i]->getSize()};
+        }
+        else if ((IsLoaded = hiveVG::tools::readFileBytes(Options.Files[i], ReadFiles[i])))
+            Files[i] = {ReadFiles[i].data(), ReadFiles[i].size()};
+        if (!IsLoaded)
+        {
+            std::fprintf(stderr, "Cannot read %s\n", Options.Files[i].c_str());
+            return 1;
+        }
+    }
+    std::printf("io      %-4s   %8.2f ms for %zu files\n", Options.IsMapped ? "mmap" : "read", elapsedMs(Start), Files.size());
+
+    if (!Files.empty())
+    {
+        benchDecode(Files, Options);
+        hiveVG::logImageDecoderStats();
+        if (Options.SurfaceWidth > 0 && Options.SurfaceHeight > 0) benchQualityTiers(Files, Options);
+        benchResample(Files, Options);
+        if (!Options.CacheDirectory.empty()) benchDiskCache(Files, Options);
+        benchPremultiply(Files, Options);
+        if (Options.TileGridRows > 0) benchTileOccupancy(Files, Options);
+        if (Options.UpsampleGridRows > 0) benchUpsample(Files, Options);
+    }
+    if (!Options.SequencePath.empty() && !benchSequenceStream(Options.SequencePath))
+    {
+        std::fprintf(stderr, "Streaming %s failed\n", Options.SequencePath.c_str());
+        return 1;
+    }
+
+    if (!Options.ScenePath.empty() && !checkScene(Options.ScenePath, Options.IsCompositePrinted))
+    {
+        std::fprintf(stderr, "Scene %s is not valid\n", Options.ScenePath.c_str());
+        return 1;
+    }
+
+    rusage Usage{};
+    getrusage(RUSAGE_SELF, &Usage);
+    std::printf("peak rss %.1f MiB\n", Usage.ru_maxrss / 1024.0);
+    return 0;
+}